@@ -1,9 +1,21 @@
 #include "application.h"
 
+#include "atlodutil.h"
+#include "benchmarkreport.h"
+#include "camerapath.h"
+#include "cbt/cbt.h"
+#include "cdlod/cdlod.h"
+#include "framestatistics.h"
+#include "geometryclipmap/geometryclipmap.h"
 #include "geomipmapping/geomipmapping.h"
+#include "gpuprofiler.h"
+#include "jobsystem.h"
 #include "naiverenderer/naiverenderer.h"
+#include "offscreentarget.h"
+#include "roam/roam.h"
 #include "shader.h"
 #include "skybox.h"
+#include "uniformbuffer.h"
 
 #include "stb_image.h"
 
@@ -14,6 +26,9 @@
 
 #include <glm/gtc/matrix_transform.hpp>
 
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
 #include <cstdlib>
 #include <filesystem>
 #include <iostream>
@@ -37,6 +52,17 @@ float lastFrame = 0.0f;
 double fpsSum = 0.0f;
 unsigned fpsCount = 0;
 
+/* Frame statistics, the last frame is the last complete one (its GPU
+ * times are only available a few frames later, see GpuProfiler) */
+FrameStatistics frameStatistics;
+GpuProfiler gpuProfiler;
+FrameRecord lastFrameRecord, lastGpuFrameRecord;
+float lastTitleUpdate = 0.0f;
+
+/* Camera, light and fog state shared by all terrain shaders */
+FrameUniforms frameUniforms;
+UniformBuffer frameUniformBuffer;
+
 /* Main settings */
 bool showOptions = true;
 bool showMainOptions = true;
@@ -50,7 +76,7 @@ float camYaw = 0.0f, camPitch = 0.0f, camRoll = 0.0f;
 float camZoom;
 
 /* Algorithms as strings for ImGui dropdown (I know this is somewhat hacky) */
-const char* algos[] = { "NAIVE", "GEOMIPMAPPING" };
+const char* algos[] = { "NAIVE", "GEOMIPMAPPING", "GEOMETRY_CLIPMAP", "CDLOD", "CBT", "ROAM" };
 int selectedItemIndex = 1;
 
 Camera camera = Camera(glm::vec3(0.0f, 1.0f, 0.0f),
@@ -63,12 +89,48 @@ bool showGeoMipMappingOptions = true;
 bool geoMipMappingDoubleDistEachLevel = false;
 bool freezeCamera = false;
 bool frustumCullingActive = true;
+bool quadTreeActive = true;
+bool batchedDrawingActive = true;
+bool planningThreadActive = true;
+bool parallelPlanningActive = true;
+bool geoMipMappingMorphActive = false;
 bool lodActive = true;
+bool incrementalActive = false;
+bool screenSpaceErrorLod = false;
+float geoMipMappingPixelError = 1.0f;
 float geoMipMappingBaseDist = 700.0f;
 unsigned geoMipMappingBlockSize = 257; /* Default block size, can be overwritten */
 unsigned geoMipMappingMaxPossibleLods;
 unsigned geoMipMappingMinLod = 0; /* Default, can be overwritten */
 unsigned geoMipMappingMaxLod = 20; /* Default, can be overwritten */
+bool geoMipMappingTessellation = false; /* Draw the blocks as tessellated patches, needs OpenGL 4.0 */
+float tessellationEdgeLength = 8.0f; /* Target edge length in pixels of the tessellation path */
+bool geoMipMappingGpuDriven = false; /* Plan in a compute shader and draw indirectly, needs OpenGL 4.3 */
+
+/* Geometry clipmap settings */
+bool showGeometryClipmapOptions = true;
+bool geometryClipmapTransition = true;
+unsigned geometryClipmapSize = 255; /* Default clipmap size, can be overwritten */
+unsigned geometryClipmapLevels = 0; /* Default (enough levels to cover the terrain), can be overwritten */
+
+/* CDLOD settings */
+bool showCdlodOptions = true;
+bool cdlodMorphActive = true;
+float cdlodLodDistance = 250.0f;
+unsigned cdlodLeafSize = 32; /* Default leaf size, can be overwritten */
+
+/* CBT settings */
+bool showCbtOptions = true;
+float cbtTargetEdgeLength = 8.0f;
+unsigned cbtPatchLevel = 2; /* Default patch level, can be overwritten */
+unsigned cbtMemoryBudget = 32; /* In MB, default, can be overwritten */
+
+/* ROAM settings */
+bool showRoamOptions = true;
+float roamPixelError = 1.0f;
+int roamTriangleBudget;
+int roamMaxOperations = 4096;
+unsigned roamMaxTriangleBudget = 65536; /* Default triangle budget, can be overwritten */
 
 /* Automatic camera movement settings */
 bool showAutomaticMovementOptions = true;
@@ -80,9 +142,16 @@ glm::vec3 camDest(0, 0, 0);
 /* Terrain instances */
 Terrain* naiveRenderer;
 Terrain* geoMipMapping;
+Terrain* geometryClipmap;
+Terrain* cdlod;
+Terrain* cbt;
+Terrain* roam;
 Terrain* current;
 ActiveTerrain activeTerrain;
 
+/* Worker threads shared by the terrains */
+JobSystem* jobSystem;
+
 /* Skybox and colors */
 Skybox* skybox;
 
@@ -96,17 +165,84 @@ std::string dataFolderPath;
 std::string heightmapFileName;
 std::string overlayFileName;
 std::string skyboxFolderName = "simple-gradient"; /* Default skybox, can be overwritten */
-
+unsigned heightmapCacheSize = 0; /* In MB, 0 maps or loads the whole heightmap */
+unsigned heightmapPageBudget = 64; /* In MB, GPU memory of the GeoMipMapping heightmap pages */
+unsigned jobThreads = 0; /* 0 uses all hardware threads */
+std::string frameCsvFileName = "frames.csv"; /* Written by the "Export CSV" button */
+bool writeFrameCsvOnExit = false; /* Set by --frame_csv */
+
+/* Benchmark mode: runs a camera path for a fixed number of frames for
+ * every configuration, then writes a report and exits */
+const unsigned BENCHMARK_WARMUP_FRAMES = 60;
+std::string benchmarkPathFileName; /* Empty if not benchmarking */
+bool benchmarkActive = false; /* The camera only follows the path, interactive input is ignored */
+std::string benchmarkReportFileName = "benchmark.json";
+unsigned benchmarkFrames = 1000;
+std::vector<unsigned> benchmarkBlockSizes, benchmarkMaxLods; /* Default to the current values */
+CameraPath benchmarkPath;
+BenchmarkReport benchmarkReport;
+std::vector<std::pair<unsigned, unsigned>> benchmarkConfigs; /* Block size and max. LOD */
+unsigned benchmarkConfig = 0;
+unsigned benchmarkFrame = 0; /* Of the current configuration, including warm-up frames */
+
+/* Headless mode: the frames are rendered into an offscreen framebuffer of
+ * an invisible window. With GLFW's null platform, the context is created
+ * without a display server through EGL (e.g. Mesa's surfaceless platform
+ * with llvmpipe) or OSMesa. */
+bool headless = false;
+std::string headlessContext = "egl"; /* "egl" or "osmesa" */
+unsigned headlessFrames = 1; /* Rendered before exiting, unless benchmarking */
+std::string headlessPathFileName; /* Followed over the rendered frames */
+CameraPath headlessPath;
+OffscreenTarget offscreenTarget;
+std::string frameOutputFolder; /* Every rendered frame is saved there if set */
+unsigned long long renderedFrames = 0;
+
+bool useBlockCache = true; /* Cache GeoMipMapping blocks and indices in <data folder>/cache */
+bool useShaderCache = true; /* Cache linked shader programs in <data folder>/cache */
 bool loadGeoMipMapping = true; /* Load GeoMipMapping by default */
 bool loadNaiveRendering = false; /* Do not load naive rendering by default */
+bool loadGeometryClipmap = false; /* Do not load geometry clipmaps by default */
+bool loadCdlod = false; /* Do not load CDLOD by default */
+bool loadCbt = false; /* Do not load CBT by default */
+bool loadRoam = false; /* Do not load ROAM by default */
 
 int setup()
 {
-    glfwInit();
-    glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
-    glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
+    glfwSetErrorCallback(errorCallback);
+
+#ifdef GLFW_PLATFORM_NULL
+    /* GLFW 3.4 and newer can run without a display server */
+    if (headless)
+        glfwInitHint(GLFW_PLATFORM, GLFW_PLATFORM_NULL);
+#endif
+
+    if (!glfwInit()) {
+        std::cerr << "Failed to initialize GLFW" << std::endl;
+        return 1;
+    }
+
+    /* Tessellation shaders are core since OpenGL 4.0, compute shaders and
+     * multi draw indirect since OpenGL 4.3 */
+    int glMajorVersion = 3, glMinorVersion = 3;
+    if (geoMipMappingGpuDriven) {
+        glMajorVersion = 4;
+        glMinorVersion = 3;
+    } else if (geoMipMappingTessellation) {
+        glMajorVersion = 4;
+        glMinorVersion = 0;
+    }
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, glMajorVersion);
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, glMinorVersion);
     glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
 
+    if (headless) {
+        glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
+#ifdef GLFW_PLATFORM_NULL
+        glfwWindowHint(GLFW_CONTEXT_CREATION_API, headlessContext == "osmesa" ? GLFW_OSMESA_CONTEXT_API : GLFW_EGL_CONTEXT_API);
+#endif
+    }
+
 #ifdef __APPLE__
     glfwWindowHint(GLFW_OPENGL_FORWARD_COMPAT, GL_TRUE);
 #endif
@@ -120,6 +256,7 @@ int setup()
     }
 
     glfwMakeContextCurrent(window);
+
     glfwSetFramebufferSizeCallback(window, framebufferSizeCallback);
     glfwSetKeyCallback(window, keyboardInputCallback);
 
@@ -137,6 +274,9 @@ int setup()
 
 void startAutomaticFlying()
 {
+    if (benchmarkActive)
+        return;
+
     camera.origin = camOrigin;
     camera.destination = camDest;
     camera.direction = camDest - camOrigin;
@@ -147,12 +287,31 @@ void startAutomaticFlying()
 
 void startAutomaticLookaround()
 {
+    if (benchmarkActive)
+        return;
+
     camera.initialYaw = camera.yaw();
     camera.isLookingAround360 = true;
 
     resetAverageFpsCounter();
 }
 
+/* Parses a comma-separated list such as "33,65,129", throws
+ * std::invalid_argument like std::stoi */
+std::vector<unsigned> parseUnsignedList(const std::string& value)
+{
+    std::vector<unsigned> result;
+    std::size_t start = 0;
+
+    while (start <= value.size()) {
+        std::size_t end = std::min(value.find(',', start), value.size());
+        result.push_back(std::stoi(value.substr(start, end - start)));
+        start = end + 1;
+    }
+
+    return result;
+}
+
 int parseArguments(int argc, char** argv)
 {
     for (int i = 1; i < argc; i++) {
@@ -177,6 +336,20 @@ int parseArguments(int argc, char** argv)
             } else if (property == "--heightmap_file_name") {
                 heightmapFileName = value;
 
+            } else if (property == "--heightmap_cache_size") {
+                try {
+                    heightmapCacheSize = std::stoi(value);
+                } catch (std::invalid_argument const& ex) {
+                    std::cout << "Heightmap cache size must be an integer" << std::endl;
+                }
+
+            } else if (property == "--heightmap_page_budget") {
+                try {
+                    heightmapPageBudget = std::stoi(value);
+                } catch (std::invalid_argument const& ex) {
+                    std::cout << "Heightmap page budget must be an integer" << std::endl;
+                }
+
             } else if (property == "--overlay_file_name") {
                 overlayFileName = value;
 
@@ -188,6 +361,155 @@ int parseArguments(int argc, char** argv)
 
             } else if (property == "--geomipmapping") { /* Any input != 0 is true */
                 loadGeoMipMapping = value != "0";
+
+            } else if (property == "--geomipmapping_tessellation") { /* Any input != 0 is true */
+                geoMipMappingTessellation = value != "0";
+
+            } else if (property == "--geomipmapping_gpu_driven") { /* Any input != 0 is true */
+                geoMipMappingGpuDriven = value != "0";
+
+            } else if (property == "--tessellation_edge_length") {
+                try {
+                    tessellationEdgeLength = std::stof(value);
+                } catch (std::invalid_argument const& ex) {
+                    std::cout << "Tessellation edge length must be a number" << std::endl;
+                }
+
+            } else if (property == "--geometry_clipmap") { /* Any input != 0 is true */
+                loadGeometryClipmap = value != "0";
+
+            } else if (property == "--clipmap_size") {
+                try {
+                    geometryClipmapSize = std::stoi(value);
+                } catch (std::invalid_argument const& ex) {
+                    std::cout << "Clipmap size must be an integer" << std::endl;
+                }
+
+            } else if (property == "--clipmap_levels") {
+                try {
+                    geometryClipmapLevels = std::stoi(value);
+                } catch (std::invalid_argument const& ex) {
+                    std::cout << "Number of clipmap levels must be an integer" << std::endl;
+                }
+
+            } else if (property == "--cdlod") { /* Any input != 0 is true */
+                loadCdlod = value != "0";
+
+            } else if (property == "--cdlod_leaf_size") {
+                try {
+                    cdlodLeafSize = std::stoi(value);
+                } catch (std::invalid_argument const& ex) {
+                    std::cout << "CDLOD leaf size must be an integer" << std::endl;
+                }
+
+            } else if (property == "--cbt") { /* Any input != 0 is true */
+                loadCbt = value != "0";
+
+            } else if (property == "--cbt_patch_level") {
+                try {
+                    cbtPatchLevel = std::stoi(value);
+                } catch (std::invalid_argument const& ex) {
+                    std::cout << "CBT patch level must be an integer" << std::endl;
+                }
+
+            } else if (property == "--cbt_memory_budget") {
+                try {
+                    cbtMemoryBudget = std::stoi(value);
+                } catch (std::invalid_argument const& ex) {
+                    std::cout << "CBT memory budget must be an integer" << std::endl;
+                }
+
+            } else if (property == "--roam") { /* Any input != 0 is true */
+                loadRoam = value != "0";
+
+            } else if (property == "--roam_triangle_budget") {
+                try {
+                    roamMaxTriangleBudget = std::stoi(value);
+                } catch (std::invalid_argument const& ex) {
+                    std::cout << "ROAM triangle budget must be an integer" << std::endl;
+                }
+
+            } else if (property == "--block_cache") { /* Any input != 0 is true */
+                useBlockCache = value != "0";
+
+            } else if (property == "--shader_cache") { /* Any input != 0 is true */
+                useShaderCache = value != "0";
+
+            } else if (property == "--planning_thread") { /* Any input != 0 is true */
+                planningThreadActive = value != "0";
+
+            } else if (property == "--job_threads") {
+                try {
+                    jobThreads = std::stoi(value);
+                } catch (std::invalid_argument const& ex) {
+                    std::cout << "Number of job threads must be an integer" << std::endl;
+                }
+
+            } else if (property == "--frame_csv") {
+                frameCsvFileName = value;
+                writeFrameCsvOnExit = true;
+
+            } else if (property == "--benchmark") {
+                benchmarkPathFileName = value;
+
+            } else if (property == "--benchmark_frames") {
+                try {
+                    benchmarkFrames = std::max(std::stoi(value), 1);
+                } catch (std::invalid_argument const& ex) {
+                    std::cout << "Number of benchmark frames must be an integer" << std::endl;
+                }
+
+            } else if (property == "--benchmark_block_sizes") {
+                try {
+                    benchmarkBlockSizes = parseUnsignedList(value);
+                } catch (std::invalid_argument const& ex) {
+                    std::cout << "Benchmark block sizes must be a comma-separated list of integers" << std::endl;
+                }
+
+            } else if (property == "--benchmark_max_lods") {
+                try {
+                    benchmarkMaxLods = parseUnsignedList(value);
+                } catch (std::invalid_argument const& ex) {
+                    std::cout << "Benchmark max. LODs must be a comma-separated list of integers" << std::endl;
+                }
+
+            } else if (property == "--benchmark_report") {
+                benchmarkReportFileName = value;
+
+            } else if (property == "--headless") { /* Any input != 0 is true */
+                headless = value != "0";
+
+            } else if (property == "--headless_context") {
+                if (value != "egl" && value != "osmesa") {
+                    std::cerr << "Headless context must be egl or osmesa" << std::endl;
+                    return 1;
+                }
+                headlessContext = value;
+
+            } else if (property == "--headless_frames") {
+                try {
+                    headlessFrames = std::max(std::stoi(value), 1);
+                } catch (std::invalid_argument const& ex) {
+                    std::cout << "Number of headless frames must be an integer" << std::endl;
+                }
+
+            } else if (property == "--camera_path") {
+                headlessPathFileName = value;
+
+            } else if (property == "--frame_output") {
+                frameOutputFolder = value;
+
+            } else if (property == "--width" || property == "--height") {
+                try {
+                    unsigned size = std::max(std::stoi(value), 1);
+                    if (property == "--width")
+                        windowWidth = size;
+                    else
+                        windowHeight = size;
+                } catch (std::invalid_argument const& ex) {
+                    std::cout << "Width and height must be integers" << std::endl;
+                }
+
             } else if (property == "--min_lod") {
                 try {
                     geoMipMappingMinLod = std::stoi(value);
@@ -213,8 +535,8 @@ int parseArguments(int argc, char** argv)
     }
 
     /* At least one terrain must be loaded */
-    if (!loadGeoMipMapping && !loadNaiveRendering) {
-        std::cerr << "Must load at least one terrain (naive or GeoMipMapping)" << std::endl;
+    if (!loadGeoMipMapping && !loadNaiveRendering && !loadGeometryClipmap && !loadCdlod && !loadCbt && !loadRoam) {
+        std::cerr << "Must load at least one terrain (naive, GeoMipMapping, geometry clipmap, CDLOD, CBT or ROAM)" << std::endl;
         return 1;
     }
 
@@ -243,6 +565,31 @@ void renderMainOptions()
     ImGui::Begin("Main options", &showMainOptions, ImGuiWindowFlags_MenuBar);
     ImGui::Text("Terrain size: %d x %d", current->width(), current->height());
     ImGui::Text("FPS: %d", (unsigned)displayFps);
+
+    ImGui::SeparatorText("Frame statistics");
+    ImGui::Text("Frame time p50: %.2f ms, p95: %.2f ms, p99: %.2f ms (last %u frames)",
+        frameStatistics.frameTimePercentile(50.0f), frameStatistics.frameTimePercentile(95.0f),
+        frameStatistics.frameTimePercentile(99.0f), frameStatistics.windowSize());
+    ImGui::Text("CPU culling: %.3f ms, LOD: %.3f ms, border: %.3f ms, dispatch: %.3f ms",
+        lastFrameRecord.cpuTimes[FRAME_PHASE_CULLING], lastFrameRecord.cpuTimes[FRAME_PHASE_LOD], lastFrameRecord.cpuTimes[FRAME_PHASE_BORDER],
+        lastFrameRecord.cpuTimes[FRAME_PHASE_DISPATCH]);
+    ImGui::Text("CPU submit: %.3f ms, skybox: %.3f ms",
+        lastFrameRecord.cpuTimes[FRAME_PHASE_SUBMIT], lastFrameRecord.cpuTimes[FRAME_PHASE_SKYBOX]);
+    ImGui::Text("GPU terrain: %.3f ms, skybox: %.3f ms",
+        std::max(lastGpuFrameRecord.gpuTimes[GPU_SECTION_TERRAIN], 0.0f), std::max(lastGpuFrameRecord.gpuTimes[GPU_SECTION_SKYBOX], 0.0f));
+    ImGui::Text("Visible blocks: %u, draw calls: %u, triangles: %lld",
+        lastFrameRecord.visibleBlocks, lastFrameRecord.drawCalls, std::max(lastGpuFrameRecord.triangles, 0ll));
+
+    if (ImGui::Button("Export CSV")) {
+        if (frameStatistics.writeCsv(frameCsvFileName))
+            std::cout << "Wrote " << frameStatistics.nFrames() << " frames to " << frameCsvFileName << std::endl;
+        else
+            std::cerr << "Warning: could not write " << frameCsvFileName << std::endl;
+    }
+    ImGui::SameLine();
+    if (ImGui::Button("Reset statistics"))
+        frameStatistics.clear();
+
     ImGui::SeparatorText("Terrain options");
 
     /* Note: changing the y-scale currently does not update the AABBs
@@ -321,10 +668,109 @@ void renderGeoMipMappingOptions()
     ImGui::Text("Maximum number of possible LODs: %u", geoMipMappingMaxPossibleLods);
     ImGui::Text("User set number of LODs: %u", geoMipMappingMaxLod - geoMipMappingMinLod + 1);
     ImGui::Text("Minimum LOD: %u, maximum LOD: %u", geoMipMappingMinLod, geoMipMappingMaxLod);
-    ImGui::InputFloat("Base distance", &geoMipMappingBaseDist, 100.0f, 1500.0f, "%.2f");
-    ImGui::Checkbox("Double distance each level", &geoMipMappingDoubleDistEachLevel);
+
+    /* The tessellation shaders choose the LOD of each edge on the GPU */
+    if (casted->tessellation()) {
+        ImGui::SliderFloat("Tessellation edge length", &tessellationEdgeLength, 1.0f, 64.0f, "%.2f");
+        ImGui::Checkbox("Culling active", &frustumCullingActive);
+        if (frustumCullingActive)
+            ImGui::Checkbox("Quadtree culling", &quadTreeActive);
+    } else if (casted->gpuDriven()) {
+        /* The compute shader updates every block every frame */
+        ImGui::Text("GPU-driven: culling, LOD and borders in a compute shader");
+        ImGui::Checkbox("Screen-space error LOD", &screenSpaceErrorLod);
+        if (screenSpaceErrorLod) {
+            ImGui::SliderFloat("Pixel error", &geoMipMappingPixelError, 0.1f, 16.0f, "%.2f");
+        } else {
+            ImGui::InputFloat("Base distance", &geoMipMappingBaseDist, 100.0f, 1500.0f, "%.2f");
+            ImGui::Checkbox("Double distance each level", &geoMipMappingDoubleDistEachLevel);
+        }
+        ImGui::Checkbox("Culling active", &frustumCullingActive);
+        ImGui::Checkbox("LOD active", &lodActive);
+        if (lodActive)
+            ImGui::Checkbox("Morphing", &geoMipMappingMorphActive);
+    } else {
+        ImGui::Checkbox("Screen-space error LOD", &screenSpaceErrorLod);
+        if (screenSpaceErrorLod) {
+            ImGui::SliderFloat("Pixel error", &geoMipMappingPixelError, 0.1f, 16.0f, "%.2f");
+        } else {
+            ImGui::InputFloat("Base distance", &geoMipMappingBaseDist, 100.0f, 1500.0f, "%.2f");
+            ImGui::Checkbox("Double distance each level", &geoMipMappingDoubleDistEachLevel);
+        }
+        ImGui::Checkbox("Culling active", &frustumCullingActive);
+        if (frustumCullingActive)
+            ImGui::Checkbox("Quadtree culling", &quadTreeActive);
+        ImGui::Checkbox("LOD active", &lodActive);
+        if (lodActive) {
+            ImGui::Checkbox("Incremental LOD updates", &incrementalActive);
+            ImGui::Checkbox("Morphing", &geoMipMappingMorphActive);
+        }
+        ImGui::Text("LOD updates: %u, border updates: %u", casted->lodUpdates(), casted->borderUpdates());
+        ImGui::Checkbox("Batched drawing", &batchedDrawingActive);
+    }
+    if (!casted->gpuDriven()) {
+        ImGui::Checkbox("Planning thread", &planningThreadActive);
+        ImGui::Checkbox("Parallel planning", &parallelPlanningActive);
+    }
+    ImGui::Checkbox("Freeze camera", &freezeCamera);
+    ImGui::End();
+}
+
+void renderGeometryClipmapOptions()
+{
+    GeometryClipmap* casted = (GeometryClipmap*)current;
+
+    ImGui::Begin("Geometry clipmap", &showGeometryClipmapOptions, ImGuiWindowFlags_MenuBar);
+    ImGui::Text("Clipmap size: %u x %u", casted->size(), casted->size());
+    ImGui::Text("Number of levels: %u", casted->nLevels());
+    ImGui::Text("Updated samples: %u", casted->updatedSamples());
+    ImGui::Checkbox("Transition regions", &geometryClipmapTransition);
+    ImGui::Checkbox("Freeze camera", &freezeCamera);
+    ImGui::End();
+}
+
+void renderCdlodOptions()
+{
+    Cdlod* casted = (Cdlod*)current;
+
+    ImGui::Begin("CDLOD", &showCdlodOptions, ImGuiWindowFlags_MenuBar);
+    ImGui::Text("Leaf size: %u", casted->leafSize());
+    ImGui::Text("Number of levels: %u", casted->nLevels());
+    ImGui::Text("Selected nodes: %u", casted->selectedNodes());
+    ImGui::InputFloat("LOD distance", &cdlodLodDistance, 10.0f, 100.0f, "%.2f");
+    ImGui::Text("Min. LOD distance: %.2f", casted->minLodDistance());
+    ImGui::Checkbox("Morphing", &cdlodMorphActive);
+    ImGui::Checkbox("Culling active", &frustumCullingActive);
+    ImGui::Checkbox("Freeze camera", &freezeCamera);
+    ImGui::End();
+}
+
+void renderCbtOptions()
+{
+    Cbt* casted = (Cbt*)current;
+
+    ImGui::Begin("CBT", &showCbtOptions, ImGuiWindowFlags_MenuBar);
+    ImGui::Text("Maximum depth: %u (%u KB)", casted->maxDepth(), (unsigned)(casted->memoryBytes() / 1024));
+    ImGui::Text("Leaves: %u", casted->leafCount());
+    ImGui::Text("Drawn triangles: %u", casted->drawnTriangles());
+    ImGui::SliderFloat("Target edge length", &cbtTargetEdgeLength, 1.0f, 64.0f, "%.2f");
+    ImGui::Checkbox("Culling active", &frustumCullingActive);
+    ImGui::Checkbox("Freeze camera", &freezeCamera);
+    ImGui::End();
+}
+
+void renderRoamOptions()
+{
+    Roam* casted = (Roam*)current;
+
+    ImGui::Begin("ROAM", &showRoamOptions, ImGuiWindowFlags_MenuBar);
+    ImGui::Text("Maximum depth: %u, pool: %u KB", casted->maxDepth(), (unsigned)(casted->memoryBytes() / 1024));
+    ImGui::Text("Triangles: %u, drawn: %u", casted->leafCount(), casted->drawnTriangles());
+    ImGui::Text("Splits: %u, merges: %u", casted->splits(), casted->merges());
+    ImGui::SliderInt("Triangle budget", &roamTriangleBudget, 2, casted->maxTriangleBudget());
+    ImGui::SliderFloat("Pixel error", &roamPixelError, 0.1f, 16.0f, "%.2f");
+    ImGui::SliderInt("Max. operations per frame", &roamMaxOperations, 1, 65536);
     ImGui::Checkbox("Culling active", &frustumCullingActive);
-    ImGui::Checkbox("LOD active", &lodActive);
     ImGui::Checkbox("Freeze camera", &freezeCamera);
     ImGui::End();
 }
@@ -335,10 +781,176 @@ void resetAverageFpsCounter()
     fpsCount = 0;
 }
 
+/* Creates GeoMipMapping with the current block size and LOD range */
+GeoMipMapping* createGeoMipMapping(const Heightmap& heightmap)
+{
+    std::string cacheFolder;
+    if (useBlockCache) {
+        cacheFolder = dataFolderPath + "/cache";
+
+        std::error_code error;
+        std::filesystem::create_directories(cacheFolder, error);
+        if (error) {
+            std::cerr << "Warning: could not create block cache folder " << cacheFolder << std::endl;
+            cacheFolder.clear();
+        }
+    }
+
+    GeoMipMapping* terrain = new GeoMipMapping(heightmap, 1.0f, yScale, geoMipMappingBlockSize, geoMipMappingMinLod, geoMipMappingMaxLod, cacheFolder, jobSystem, geoMipMappingTessellation, geoMipMappingGpuDriven);
+    terrain->pageBudget((std::size_t)heightmapPageBudget * 1024 * 1024);
+    terrain->loadBuffers();
+
+    if (!overlayFileName.empty())
+        terrain->loadTexture(dataFolderPath + std::string("/overlays/") + overlayFileName);
+
+    return terrain;
+}
+
+/* Loads the camera path and sets up the configurations of the benchmark.
+ * Block sizes and max. LODs only apply to GeoMipMapping, every combination
+ * of them is a configuration. */
+void startBenchmark()
+{
+    benchmarkPath.load(benchmarkPathFileName);
+    benchmarkActive = true;
+
+    if (benchmarkBlockSizes.empty() || activeTerrain != GEOMIPMAPPING)
+        benchmarkBlockSizes = { geoMipMappingBlockSize };
+    if (benchmarkMaxLods.empty() || activeTerrain != GEOMIPMAPPING)
+        benchmarkMaxLods = { geoMipMappingMaxLod };
+
+    /* Max. LODs above the maximum of a block size would repeat a configuration */
+    for (unsigned blockSize : benchmarkBlockSizes) {
+        for (unsigned maxLod : benchmarkMaxLods) {
+            std::pair<unsigned, unsigned> config(blockSize, std::min(maxLod, (unsigned)std::log2(blockSize - 1)));
+            if (std::find(benchmarkConfigs.begin(), benchmarkConfigs.end(), config) == benchmarkConfigs.end())
+                benchmarkConfigs.push_back(config);
+        }
+    }
+
+    benchmarkReport.info("heightmap", heightmapFileName);
+    benchmarkReport.info("camera_path", benchmarkPathFileName);
+    benchmarkReport.info("terrain", algos[activeTerrain]);
+    benchmarkReport.info("gl_renderer", (const char*)glGetString(GL_RENDERER));
+    benchmarkReport.info("gl_version", (const char*)glGetString(GL_VERSION));
+    benchmarkReport.info("window_width", windowWidth);
+    benchmarkReport.info("window_height", windowHeight);
+    benchmarkReport.info("frames", benchmarkFrames);
+    benchmarkReport.info("warmup_frames", BENCHMARK_WARMUP_FRAMES);
+    benchmarkReport.info("job_threads", jobSystem->nThreads());
+
+    if (activeTerrain == GEOMIPMAPPING) {
+        benchmarkReport.info("planning_thread", planningThreadActive);
+        benchmarkReport.info("parallel_planning", parallelPlanningActive);
+        benchmarkReport.info("batched_drawing", batchedDrawingActive);
+        benchmarkReport.info("screen_space_error_lod", screenSpaceErrorLod);
+        benchmarkReport.info("morphing", geoMipMappingMorphActive);
+        benchmarkReport.info("tessellation", geoMipMappingTessellation);
+        if (geoMipMappingTessellation)
+            benchmarkReport.info("tessellation_edge_length", tessellationEdgeLength);
+        benchmarkReport.info("gpu_driven", geoMipMappingGpuDriven);
+    }
+
+    /* The options windows would be part of the measured frame time */
+    showOptions = false;
+
+    /* Benchmarks measure the frame time, not the refresh rate */
+    glfwSwapInterval(0);
+
+    std::cout << "Benchmark: " << benchmarkConfigs.size() << " configuration(s) of "
+              << benchmarkFrames << " frames" << std::endl;
+}
+
+/* Rebuilds GeoMipMapping if the block size or max. LOD of the current
+ * configuration differs from the loaded one. The terrain keeps its own copy
+ * of the heightmap, so it is still available. */
+void applyBenchmarkConfig()
+{
+    const std::pair<unsigned, unsigned>& config = benchmarkConfigs[benchmarkConfig];
+    unsigned loadedMaxLod = std::min(geoMipMappingMaxLod, (unsigned)std::log2(geoMipMappingBlockSize - 1));
+
+    if (activeTerrain != GEOMIPMAPPING || (config.first == geoMipMappingBlockSize && config.second == loadedMaxLod))
+        return;
+
+    Heightmap heightmap = geoMipMapping->heightmap();
+    geoMipMapping->unloadBuffers();
+    if (geoMipMapping->hasTexture())
+        geoMipMapping->unloadTexture();
+    delete geoMipMapping;
+
+    geoMipMappingBlockSize = config.first;
+    geoMipMappingMaxPossibleLods = std::log2(geoMipMappingBlockSize - 1);
+    geoMipMappingMaxLod = config.second;
+
+    geoMipMapping = createGeoMipMapping(heightmap);
+    current = geoMipMapping;
+}
+
+void finishBenchmarkRun()
+{
+    const std::pair<unsigned, unsigned>& config = benchmarkConfigs[benchmarkConfig];
+    std::string name = algos[activeTerrain];
+    std::vector<std::pair<std::string, double>> parameters;
+
+    if (activeTerrain == GEOMIPMAPPING) {
+        name += " block_size=" + std::to_string(config.first) + " max_lod=" + std::to_string(config.second);
+        parameters = { { "block_size", config.first }, { "min_lod", geoMipMappingMinLod }, { "max_lod", config.second } };
+    }
+
+    const std::vector<FrameRecord>& records = frameStatistics.records();
+    benchmarkReport.addRun(name, parameters, records.begin(), records.begin() + std::min<std::size_t>(benchmarkFrames, records.size()));
+
+    const BenchmarkDistribution& frameTime = benchmarkReport.runs().back().frameTime;
+    std::cout << "Benchmark " << name << ": frame time mean " << frameTime.mean << " ms, p50 " << frameTime.p50
+              << " ms, p95 " << frameTime.p95 << " ms, p99 " << frameTime.p99 << " ms" << std::endl;
+}
+
+/* Moves the camera to the next frame of the benchmark, called before the
+ * frame is recorded. Every configuration starts with warm-up frames at the
+ * start of the path, which are not recorded, and ends with a few frames
+ * after the path, until the GPU times of its last frames are available. */
+void stepBenchmark()
+{
+    if (benchmarkFrame == BENCHMARK_WARMUP_FRAMES + benchmarkFrames + GpuProfiler::LATENCY) {
+        finishBenchmarkRun();
+        benchmarkConfig++;
+        benchmarkFrame = 0;
+
+        if (benchmarkConfig == benchmarkConfigs.size()) {
+            if (benchmarkReport.writeJson(benchmarkReportFileName))
+                std::cout << "Wrote benchmark report to " << benchmarkReportFileName << std::endl;
+            else
+                std::cerr << "Error: could not write benchmark report " << benchmarkReportFileName << std::endl;
+
+            glfwSetWindowShouldClose(window, true);
+            return;
+        }
+    }
+
+    if (benchmarkFrame == 0)
+        applyBenchmarkConfig();
+    if (benchmarkFrame == BENCHMARK_WARMUP_FRAMES)
+        frameStatistics.clear();
+
+    /* The path only depends on the frame number, not on the frame time */
+    float measuredFrame = (float)benchmarkFrame - (float)BENCHMARK_WARMUP_FRAMES;
+    float t = benchmarkFrames > 1 ? std::clamp(measuredFrame / (float)(benchmarkFrames - 1), 0.0f, 1.0f) : 0.0f;
+    benchmarkPath.apply(camera, t);
+
+    benchmarkFrame++;
+}
+
 int run()
 {
     GLenum err = glewInit();
 
+#ifdef GLEW_ERROR_NO_GLX_DISPLAY
+    /* A headless EGL context has no GLX display, so GLEW cannot load the
+     * GLX extensions, but the OpenGL functions are loaded nonetheless */
+    if (err == GLEW_ERROR_NO_GLX_DISPLAY)
+        err = GLEW_OK;
+#endif
+
     if (err != GLEW_OK) {
         glfwTerminate();
         shutDown();
@@ -350,22 +962,67 @@ int run()
     glEnable(GL_CULL_FACE);
     glEnable(GL_DEPTH_TEST);
 
+    camera.aspectRatio((float)windowWidth / (float)windowHeight);
+
+    if (headless) {
+        offscreenTarget.loadBuffers(windowWidth, windowHeight);
+        showOptions = false;
+
+        std::cout << "Rendering offscreen at " << windowWidth << " x " << windowHeight
+                  << " with " << (const char*)glGetString(GL_RENDERER) << std::endl;
+
+        if (!headlessPathFileName.empty())
+            headlessPath.load(headlessPathFileName);
+    }
+
+    auto startupStart = std::chrono::steady_clock::now();
+    auto stepStart = startupStart;
+
+    jobSystem = new JobSystem(jobThreads);
+    std::cout << "Job system with " << jobSystem->nThreads() << " threads" << std::endl;
+
+    /* Before the skybox and the terrains create their shaders */
+    if (useShaderCache) {
+        std::string cacheFolder = dataFolderPath + "/cache";
+
+        std::error_code error;
+        std::filesystem::create_directories(cacheFolder, error);
+        if (error)
+            std::cerr << "Warning: could not create shader cache folder " << cacheFolder << std::endl;
+        else
+            Shader::binaryCacheFolder(cacheFolder);
+    }
+
+    gpuProfiler.loadQueries(N_GPU_SECTIONS);
+    frameUniformBuffer.loadBuffer(sizeof(FrameUniforms), FRAME_UNIFORMS_BINDING);
+
     /* Load skybox */
     skybox = new Skybox();
     skybox->loadBuffers();
     skybox->loadTexture(dataFolderPath + "/skybox/" + skyboxFolderName + "/");
+    double skyboxTime = AtlodUtil::millisecondsSince(stepStart);
 
     /* Load heightmap */
+    stepStart = std::chrono::steady_clock::now();
     Heightmap heightmap;
-    heightmap.load(dataFolderPath + "/heightmaps/" + heightmapFileName, true);
+    heightmap.tileCacheBudget((std::size_t)heightmapCacheSize * 1024 * 1024);
+    heightmap.load(dataFolderPath + "/heightmaps/" + heightmapFileName, false);
+
+    /* Only naive rendering and geometry clipmaps do not sample the heightmap
+     * texture, GeoMipMapping pages in the tiles of a tiled heightmap itself */
+    bool geoMipMappingPaged = heightmap.tiled() && !geoMipMappingTessellation && !geoMipMappingGpuDriven;
+    if (loadCdlod || loadCbt || loadRoam || (loadGeoMipMapping && !geoMipMappingPaged))
+        heightmap.loadTexture(heightmap.data());
+    double heightmapTime = AtlodUtil::millisecondsSince(stepStart);
 
     /* Set camera origin and destination to bottom left corner and top right corner respectively */
     camOrigin = glm::vec3(-(int)heightmap.width() / 2.0f, 200.0f, -(int)heightmap.height() / 2.0f);
     camDest = glm::vec3(heightmap.width() / 2.0f, 200.0f, heightmap.height() / 2.0f);
 
     /* Load naive rendering (if set in command line arguments) */
+    stepStart = std::chrono::steady_clock::now();
     if (loadNaiveRendering) {
-        naiveRenderer = new NaiveRenderer(heightmap, 1.0f, yScale);
+        naiveRenderer = new NaiveRenderer(heightmap, 1.0f, yScale, jobSystem);
         naiveRenderer->loadBuffers();
         if (!overlayFileName.empty())
             naiveRenderer->loadTexture(dataFolderPath + std::string("/overlays/") + overlayFileName);
@@ -373,22 +1030,96 @@ int run()
         current = naiveRenderer;
         activeTerrain = ActiveTerrain::NAIVE;
     }
+    double naiveTime = AtlodUtil::millisecondsSince(stepStart);
 
     /* Load GeoMipMapping (if set in command line arguments) */
+    stepStart = std::chrono::steady_clock::now();
     if (loadGeoMipMapping) {
-        geoMipMapping = new GeoMipMapping(heightmap, 1.0f, yScale, geoMipMappingBlockSize, geoMipMappingMinLod, geoMipMappingMaxLod);
-        geoMipMapping->loadBuffers();
+        geoMipMapping = createGeoMipMapping(heightmap);
+        current = geoMipMapping;
+        activeTerrain = ActiveTerrain::GEOMIPMAPPING;
+    }
+    double geoMipMappingTime = AtlodUtil::millisecondsSince(stepStart);
+
+    /* Load geometry clipmap (if set in command line arguments) */
+    stepStart = std::chrono::steady_clock::now();
+    if (loadGeometryClipmap) {
+        geometryClipmap = new GeometryClipmap(heightmap, 1.0f, yScale, geometryClipmapSize, geometryClipmapLevels);
+        geometryClipmap->loadBuffers();
 
         if (!overlayFileName.empty())
-            geoMipMapping->loadTexture(dataFolderPath + std::string("/overlays/") + overlayFileName);
+            geometryClipmap->loadTexture(dataFolderPath + std::string("/overlays/") + overlayFileName);
 
-        current = geoMipMapping;
-        activeTerrain = ActiveTerrain::GEOMIPMAPPING;
+        current = geometryClipmap;
+        activeTerrain = ActiveTerrain::GEOMETRY_CLIPMAP;
     }
+    double geometryClipmapTime = AtlodUtil::millisecondsSince(stepStart);
+
+    /* Load CDLOD (if set in command line arguments) */
+    stepStart = std::chrono::steady_clock::now();
+    if (loadCdlod) {
+        cdlod = new Cdlod(heightmap, 1.0f, yScale, cdlodLeafSize);
+        cdlod->loadBuffers();
+
+        if (!overlayFileName.empty())
+            cdlod->loadTexture(dataFolderPath + std::string("/overlays/") + overlayFileName);
+
+        current = cdlod;
+        activeTerrain = ActiveTerrain::CDLOD;
+    }
+    double cdlodTime = AtlodUtil::millisecondsSince(stepStart);
+
+    /* Load CBT (if set in command line arguments) */
+    stepStart = std::chrono::steady_clock::now();
+    if (loadCbt) {
+        cbt = new Cbt(heightmap, 1.0f, yScale, cbtPatchLevel, (std::size_t)cbtMemoryBudget * 1024 * 1024);
+        cbt->loadBuffers();
+
+        if (!overlayFileName.empty())
+            cbt->loadTexture(dataFolderPath + std::string("/overlays/") + overlayFileName);
+
+        current = cbt;
+        activeTerrain = ActiveTerrain::CBT;
+    }
+    double cbtTime = AtlodUtil::millisecondsSince(stepStart);
+
+    /* Load ROAM (if set in command line arguments) */
+    stepStart = std::chrono::steady_clock::now();
+    if (loadRoam) {
+        roam = new Roam(heightmap, 1.0f, yScale, roamMaxTriangleBudget);
+        roam->loadBuffers();
+
+        if (!overlayFileName.empty())
+            roam->loadTexture(dataFolderPath + std::string("/overlays/") + overlayFileName);
+
+        roamTriangleBudget = ((Roam*)roam)->maxTriangleBudget();
+        current = roam;
+        activeTerrain = ActiveTerrain::ROAM;
+    }
+    double roamTime = AtlodUtil::millisecondsSince(stepStart);
+
+    std::cout << "Startup took " << AtlodUtil::millisecondsSince(startupStart) << " ms" << std::endl
+              << "    Skybox:            " << skyboxTime << " ms" << std::endl
+              << "    Heightmap:         " << heightmapTime << " ms" << std::endl;
+    if (loadNaiveRendering)
+        std::cout << "    Naive rendering:   " << naiveTime << " ms" << std::endl;
+    if (loadGeoMipMapping)
+        std::cout << "    GeoMipMapping:     " << geoMipMappingTime << " ms" << std::endl;
+    if (loadGeometryClipmap)
+        std::cout << "    Geometry clipmap:  " << geometryClipmapTime << " ms" << std::endl;
+    if (loadCdlod)
+        std::cout << "    CDLOD:             " << cdlodTime << " ms" << std::endl;
+    if (loadCbt)
+        std::cout << "    CBT:               " << cbtTime << " ms" << std::endl;
+    if (loadRoam)
+        std::cout << "    ROAM:              " << roamTime << " ms" << std::endl;
 
     /* Height values are now in vertices/textures, no longer needed in memory */
     heightmap.clear();
 
+    if (!benchmarkPathFileName.empty())
+        startBenchmark();
+
     float posLerp = 0.0f;
     float lookLerp = 0.0f;
 
@@ -411,9 +1142,21 @@ int run()
         fpsSum += (1.0f / deltaTime);
         fpsCount++;
 
-        /* Update window title with framerate */
-        std::string newTitle = "ATLOD: " + std::to_string((int)std::round(1.0f / deltaTime)) + " FPS";
-        glfwSetWindowTitle(window, newTitle.c_str());
+        if (!benchmarkPathFileName.empty())
+            stepBenchmark();
+        else if (!headlessPath.empty())
+            headlessPath.apply(camera, headlessFrames > 1 ? (float)renderedFrames / (float)(headlessFrames - 1) : 0.0f);
+
+        FrameRecord& frame = frameStatistics.beginFrame(deltaTime * 1000.0f);
+
+        /* Update window title with the median framerate twice per second,
+         * setting it every frame is not free on every platform */
+        if (currentFrame - lastTitleUpdate >= 0.5f) {
+            float medianFrameTime = frameStatistics.frameTimePercentile(50.0f);
+            std::string newTitle = "ATLOD: " + std::to_string((int)std::round(medianFrameTime > 0.0f ? 1000.0f / medianFrameTime : 0.0f)) + " FPS";
+            glfwSetWindowTitle(window, newTitle.c_str());
+            lastTitleUpdate = currentFrame;
+        }
 
         /* Set active terrain */
         switch (activeTerrain) {
@@ -423,6 +1166,18 @@ int run()
         case GEOMIPMAPPING:
             current = geoMipMapping;
             break;
+        case GEOMETRY_CLIPMAP:
+            current = geometryClipmap;
+            break;
+        case CDLOD:
+            current = cdlod;
+            break;
+        case CBT:
+            current = cbt;
+            break;
+        case ROAM:
+            current = roam;
+            break;
         }
 
         /* Get global camera yaw and pitch (for ImGui camera options) */
@@ -436,12 +1191,22 @@ int run()
 
             if (activeTerrain == ActiveTerrain::GEOMIPMAPPING)
                 renderGeoMipMappingOptions();
+            else if (activeTerrain == ActiveTerrain::GEOMETRY_CLIPMAP)
+                renderGeometryClipmapOptions();
+            else if (activeTerrain == ActiveTerrain::CDLOD)
+                renderCdlodOptions();
+            else if (activeTerrain == ActiveTerrain::CBT)
+                renderCbtOptions();
+            else if (activeTerrain == ActiveTerrain::ROAM)
+                renderRoamOptions();
         }
 
         /* Overwrite camera yaw and pitch with values from ImGui options */
-        camera.yaw(camYaw);
-        camera.pitch(camPitch);
-        camera.zoom(camZoom);
+        if (!benchmarkActive) {
+            camera.yaw(camYaw);
+            camera.pitch(camPitch);
+            camera.zoom(camZoom);
+        }
         camera.updateCameraVectors();
 
         /* Update camera values if flying */
@@ -480,10 +1245,14 @@ int run()
         camera.updateFrustum();
 
         /* Update window if resized */
-        int wWidth, wHeight;
-        glfwGetFramebufferSize(window, &wWidth, &wHeight);
-        windowWidth = wWidth;
-        windowHeight = wHeight;
+        if (!headless) {
+            int wWidth, wHeight;
+            glfwGetFramebufferSize(window, &wWidth, &wHeight);
+            windowWidth = wWidth;
+            windowHeight = wHeight;
+        } else {
+            offscreenTarget.bind();
+        }
 
         if (renderWireframe) {
             glPolygonMode(GL_FRONT_AND_BACK, GL_LINE);
@@ -500,18 +1269,6 @@ int run()
 
         glm::mat4 projection = glm::perspective(glm::radians(camera.zoom()), (float)windowWidth / (float)windowHeight, 0.1f, 100000.0f);
         glm::mat4 view = camera.getViewMatrix();
-        glm::vec2 settings = glm::vec2((float)isDark, (float)renderWireframe);
-        current->shader().use();
-
-        current->shader().setVec2("rendersettings", settings);
-        current->shader().setMat4("projection", projection);
-        current->shader().setMat4("view", view);
-        current->shader().setVec3("cameraPos", camera.position());
-        current->shader().setVec3("lightDirection", lightDirection);
-        current->shader().setVec3("skyColor", skyColor);
-        current->shader().setVec3("terrainColor", terrainColor);
-        current->shader().setFloat("fogDensity", fogDensity);
-        current->shader().setFloat("doFog", (float)doFog);
 
         /* Update GeoMipMapping options */
         if (activeTerrain == GEOMIPMAPPING) {
@@ -520,22 +1277,86 @@ int run()
             casted->doubleDistanceEachLevel(geoMipMappingDoubleDistEachLevel);
             casted->freezeCamera(freezeCamera);
             casted->lodActive(lodActive);
+            casted->incrementalActive(incrementalActive);
+            casted->lodMode(screenSpaceErrorLod ? GeoMipMappingLodMode::SCREEN_SPACE_ERROR : GeoMipMappingLodMode::DISTANCE);
+            casted->pixelError(geoMipMappingPixelError);
+            casted->viewportHeight(windowHeight);
+            casted->frustumCullingActive(frustumCullingActive);
+            casted->quadTreeActive(quadTreeActive);
+            casted->batchedDrawingActive(batchedDrawingActive);
+            casted->planningThreadActive(planningThreadActive);
+            casted->parallelPlanningActive(parallelPlanningActive);
+            casted->morphActive(geoMipMappingMorphActive);
+            casted->tessellationEdgeLength(tessellationEdgeLength);
+            casted->yScale(yScale);
+        }
+
+        /* Update geometry clipmap options */
+        if (activeTerrain == GEOMETRY_CLIPMAP) {
+            GeometryClipmap* casted = (GeometryClipmap*)current;
+            casted->freezeCamera(freezeCamera);
+            casted->transitionActive(geometryClipmapTransition);
+            casted->yScale(yScale);
+        }
+
+        /* Update CDLOD options */
+        if (activeTerrain == CDLOD) {
+            Cdlod* casted = (Cdlod*)current;
+            casted->lodDistance(cdlodLodDistance);
+            casted->morphActive(cdlodMorphActive);
+            casted->frustumCullingActive(frustumCullingActive);
+            casted->freezeCamera(freezeCamera);
+            casted->yScale(yScale);
+        }
+
+        /* Update CBT options */
+        if (activeTerrain == CBT) {
+            Cbt* casted = (Cbt*)current;
+            casted->targetEdgeLength(cbtTargetEdgeLength);
+            casted->viewportHeight(windowHeight);
+            casted->frustumCullingActive(frustumCullingActive);
+            casted->freezeCamera(freezeCamera);
+            casted->yScale(yScale);
+        }
+
+        /* Update ROAM options */
+        if (activeTerrain == ROAM) {
+            Roam* casted = (Roam*)current;
+            casted->triangleBudget(roamTriangleBudget);
+            casted->pixelError(roamPixelError);
+            casted->maxOperations(roamMaxOperations);
+            casted->viewportHeight(windowHeight);
             casted->frustumCullingActive(frustumCullingActive);
+            casted->freezeCamera(freezeCamera);
             casted->yScale(yScale);
         }
 
         glm::mat4 model = glm::mat4(1.0f);
         model = glm::scale(model, glm::vec3(current->xzScale(), current->yScale(), current->xzScale()));
-        current->shader().setMat4("model", model);
+
+        /* Upload the per-frame state of the terrain shaders at once */
+        frameUniforms.projection = projection;
+        frameUniforms.view = view;
+        frameUniforms.model = model;
+        frameUniforms.cameraPosition = glm::vec4(camera.position(), 1.0f);
+        frameUniforms.lightDirection = glm::vec4(lightDirection, 0.0f);
+        frameUniforms.skyColor = glm::vec4(skyColor, 1.0f);
+        frameUniforms.terrainColor = glm::vec4(terrainColor, 1.0f);
+        frameUniforms.renderSettings = glm::vec4((float)isDark, (float)renderWireframe, (float)doFog, fogDensity);
+        frameUniformBuffer.update(frameUniforms);
 
         /* Naive terrain additionally requires normal matrix for shading */
         if (activeTerrain == NAIVE) {
             /* http://www.lighthouse3d.com/tutorials/glsl-12-tutorial/the-normal-matrix/ */
+            current->shader().use();
             current->shader().setMat4("normalMatrix", glm::transpose(glm::inverse(model)));
         }
 
         try {
+            ScopedCpuTimer submitTimer(frame, FRAME_PHASE_SUBMIT);
+            gpuProfiler.begin(GPU_SECTION_TERRAIN, frame.number);
             current->render(camera);
+            gpuProfiler.end(GPU_SECTION_TERRAIN);
         } catch (std::exception e) {
             std::cout << "error: " << std::endl;
             std::cout << e.what() << std::endl;
@@ -544,19 +1365,66 @@ int run()
             return 1;
         }
 
+        frame.visibleBlocks = current->visibleBlocks();
+        frame.drawCalls = current->drawCalls();
+
+        /* The planning passes of GeoMipMapping, which run on the planning
+         * thread if it is active (and are part of submit otherwise) */
+        if (activeTerrain == GEOMIPMAPPING) {
+            const GeoMipMappingPlanTimings& timings = ((GeoMipMapping*)current)->planTimings();
+            frame.cpuTimes[FRAME_PHASE_CULLING] = timings.culling;
+            frame.cpuTimes[FRAME_PHASE_LOD] = timings.lod;
+            frame.cpuTimes[FRAME_PHASE_BORDER] = timings.border;
+            frame.cpuTimes[FRAME_PHASE_DISPATCH] = timings.dispatch;
+        }
+
         /* Render skybox */
         if (!renderWireframe && renderSkybox) {
+            ScopedCpuTimer skyboxTimer(frame, FRAME_PHASE_SKYBOX);
+            gpuProfiler.begin(GPU_SECTION_SKYBOX, frame.number);
+
             skybox->shader().use();
             view = glm::mat4(glm::mat3(camera.getViewMatrix()));
             skybox->shader().setMat4("projection", projection);
             skybox->shader().setMat4("view", view);
             skybox->render();
+
+            gpuProfiler.end(GPU_SECTION_SKYBOX);
         }
 
         ImGui::Render();
         ImGui_ImplOpenGL3_RenderDrawData(ImGui::GetDrawData());
 
-        glfwSwapBuffers(window);
+        /* Add the GPU results of earlier frames to their records */
+        for (unsigned long long number; (number = gpuProfiler.collect()) != 0;) {
+            FrameRecord* record = frameStatistics.record(number);
+            if (!record)
+                continue;
+
+            for (unsigned section = 0; section < N_GPU_SECTIONS; section++)
+                record->gpuTimes[section] = gpuProfiler.milliseconds(section);
+            record->triangles = gpuProfiler.primitives(GPU_SECTION_TERRAIN);
+            lastGpuFrameRecord = *record;
+        }
+
+        lastFrameRecord = frame;
+
+        if (!frameOutputFolder.empty()) {
+            char fileName[32];
+            std::snprintf(fileName, sizeof(fileName), "/frame_%06llu.ppm", renderedFrames);
+            if (!saveFramebuffer(frameOutputFolder + fileName, windowWidth, windowHeight))
+                std::cerr << "Warning: could not write " << frameOutputFolder + fileName << std::endl;
+        }
+        renderedFrames++;
+
+        /* The offscreen framebuffer is never presented */
+        if (!headless) {
+            glfwSwapBuffers(window);
+        } else {
+            glFlush();
+            if (benchmarkPathFileName.empty() && renderedFrames == headlessFrames)
+                glfwSetWindowShouldClose(window, true);
+        }
     }
 
     shutDown();
@@ -565,6 +1433,19 @@ int run()
 
 void shutDown()
 {
+    if (writeFrameCsvOnExit) {
+        if (frameStatistics.writeCsv(frameCsvFileName))
+            std::cout << "Wrote " << frameStatistics.nFrames() << " frames to " << frameCsvFileName << std::endl;
+        else
+            std::cerr << "Warning: could not write " << frameCsvFileName << std::endl;
+    }
+
+    gpuProfiler.unloadQueries();
+    frameUniformBuffer.unloadBuffer();
+
+    if (headless)
+        offscreenTarget.unloadBuffers();
+
     /* Unload vertex and index buffers */
     skybox->unloadBuffers();
 
@@ -574,6 +1455,18 @@ void shutDown()
     if (loadNaiveRendering)
         naiveRenderer->unloadBuffers();
 
+    if (loadGeometryClipmap)
+        geometryClipmap->unloadBuffers();
+
+    if (loadCdlod)
+        cdlod->unloadBuffers();
+
+    if (loadCbt)
+        cbt->unloadBuffers();
+
+    if (loadRoam)
+        roam->unloadBuffers();
+
     /* Delete instances */
     delete skybox;
 
@@ -581,6 +1474,17 @@ void shutDown()
         delete geoMipMapping;
     if (loadNaiveRendering)
         delete naiveRenderer;
+    if (loadGeometryClipmap)
+        delete geometryClipmap;
+    if (loadCdlod)
+        delete cdlod;
+    if (loadCbt)
+        delete cbt;
+    if (loadRoam)
+        delete roam;
+
+    /* After the terrains, which use it */
+    delete jobSystem;
 
     glfwTerminate();
 
@@ -593,6 +1497,11 @@ void processInput()
 {
     if (glfwGetKey(window, GLFW_KEY_ESCAPE) == GLFW_PRESS)
         glfwSetWindowShouldClose(window, true);
+
+    /* The benchmark path alone moves the camera */
+    if (benchmarkActive)
+        return;
+
     if (glfwGetKey(window, GLFW_KEY_LEFT_SHIFT) == GLFW_PRESS)
         camera.processKeyboard(CameraAction::SPEED_UP, deltaTime);
     if (glfwGetKey(window, GLFW_KEY_W) == GLFW_PRESS)
@@ -639,7 +1548,16 @@ void keyboardInputCallback(GLFWwindow* window, int key, int scanCode, int action
 
 void framebufferSizeCallback(GLFWwindow* window, int width, int height)
 {
+    /* The offscreen framebuffer keeps its size */
+    if (headless)
+        return;
+
     glViewport(0, 0, width, height);
     camera.aspectRatio((float)width / (float)height);
 }
+
+void errorCallback(int error, const char* description)
+{
+    std::cerr << "GLFW error " << error << ": " << description << std::endl;
+}
 }
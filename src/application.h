@@ -8,7 +8,11 @@ namespace Application {
 
 enum ActiveTerrain {
     NAIVE = 0,
-    GEOMIPMAPPING = 1
+    GEOMIPMAPPING = 1,
+    GEOMETRY_CLIPMAP = 2,
+    CDLOD = 3,
+    CBT = 4,
+    ROAM = 5
 };
 
 int setup();
@@ -19,9 +23,14 @@ void processInput();
 void resetAverageFpsCounter();
 void renderMainOptions();
 void renderGeoMipMappingOptions();
+void renderGeometryClipmapOptions();
+void renderCdlodOptions();
+void renderCbtOptions();
+void renderRoamOptions();
 void renderAutomaticMovementOptions();
 void keyboardInputCallback(GLFWwindow* window, int key, int scanCode, int action, int modifiers);
 void framebufferSizeCallback(GLFWwindow* window, int width, int height);
+void errorCallback(int error, const char* description);
 
 };
 
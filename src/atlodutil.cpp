@@ -14,3 +14,8 @@ void AtlodUtil::checkGlError(const std::string& message)
         std::exit(1);
     }
 }
+
+double AtlodUtil::millisecondsSince(std::chrono::steady_clock::time_point start)
+{
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
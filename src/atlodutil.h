@@ -1,10 +1,16 @@
 #ifndef ATLODUTIL_H
 #define ATLODUTIL_H
 
+#include <chrono>
+#include <limits>
 #include <string>
 
+/* For primitive restarts when creating index buffers */
+const unsigned RESTART_INDEX = std::numeric_limits<unsigned>::max();
+
 namespace AtlodUtil {
 void checkGlError(const std::string& message = "");
+double millisecondsSince(std::chrono::steady_clock::time_point start);
 }
 
 #endif // ATLODUTIL_H
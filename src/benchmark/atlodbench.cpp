@@ -0,0 +1,934 @@
+/* ATLOD benchmark
+ *
+ * Replays camera paths against a synthetic heightmap and measures the
+ * per-frame CPU cost of the GeoMipMapping frame planner. No OpenGL context
+ * is created, so the benchmark can be run on machines without a GPU.
+ *
+ * Example usage:
+ * ./atlod_bench --heightmap_size=16385 --block_size=65 --frames=2000
+ */
+#include "../camerapath.h"
+#include "../cbt/cbtplanner.h"
+#include "../cdlod/cdlodquadtree.h"
+#include "../geometryclipmap/geometryclipmapplanner.h"
+#include "../geomipmapping/geomipmappingindices.h"
+#include "../geomipmapping/geomipmappingplanner.h"
+#include "../geomipmapping/geomipmappingplanningthread.h"
+#include "../jobsystem.h"
+#include "../roam/roamplanner.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <memory>
+#include <new>
+#include <string>
+#include <thread>
+#include <vector>
+
+/* ========================== Allocation counting ==========================
+ * Every heap allocation of the process goes through the replaced global
+ * operator new, which allows counting the allocations during planning. */
+static std::atomic<unsigned long long> allocationCount(0);
+
+void* operator new(std::size_t size)
+{
+    allocationCount.fetch_add(1, std::memory_order_relaxed);
+    void* pointer = std::malloc(size == 0 ? 1 : size);
+    if (!pointer)
+        throw std::bad_alloc();
+    return pointer;
+}
+
+void* operator new[](std::size_t size)
+{
+    return operator new(size);
+}
+
+void operator delete(void* pointer) noexcept
+{
+    std::free(pointer);
+}
+
+void operator delete[](void* pointer) noexcept
+{
+    std::free(pointer);
+}
+
+void operator delete(void* pointer, std::size_t) noexcept
+{
+    std::free(pointer);
+}
+
+void operator delete[](void* pointer, std::size_t) noexcept
+{
+    std::free(pointer);
+}
+
+namespace Benchmark {
+
+/* Command line argument values */
+unsigned heightmapSize = 8193;
+unsigned blockSize = 65;
+unsigned minLod = 0;
+unsigned maxLod = 20;
+unsigned frames = 1000;
+float baseDistance = 700.0f;
+bool doubleDistanceEachLevel = false;
+float pixelError = 0.0f; /* Selects LODs by screen-space error if > 0 */
+unsigned clipmapSize = 255;
+unsigned cdlodLeafSize = 32;
+float cdlodLodDistance = 250.0f;
+float cbtTargetEdgeLength = 8.0f;
+unsigned cbtMemoryBudget = 32; /* In MB */
+unsigned roamTriangleBudget = 65536;
+float roamPixelError = 1.0f;
+unsigned jobThreads = 0; /* 0 uses all hardware threads */
+std::string cameraPathFileName;
+
+/* Same values as the defaults of the application */
+const float yScale = 1.0f / 30.0f;
+const float aspectRatio = 1280.0f / 720.0f;
+
+int parseArguments(int argc, char** argv)
+{
+    for (int i = 1; i < argc; i++) {
+        std::string current = std::string(argv[i]);
+        std::string property, value;
+        size_t delimiterPos = current.find('=');
+
+        if (delimiterPos == std::string::npos) {
+            std::cerr << "Invalid input format" << std::endl;
+            return 1;
+        }
+
+        property = current.substr(0, delimiterPos);
+        value = current.substr(delimiterPos + 1);
+
+        try {
+            if (property == "--heightmap_size")
+                heightmapSize = std::stoi(value);
+            else if (property == "--block_size")
+                blockSize = std::stoi(value);
+            else if (property == "--min_lod")
+                minLod = std::stoi(value);
+            else if (property == "--max_lod")
+                maxLod = std::stoi(value);
+            else if (property == "--frames")
+                frames = std::stoi(value);
+            else if (property == "--base_distance")
+                baseDistance = std::stof(value);
+            else if (property == "--double_distance_each_level") /* Any input != 0 is true */
+                doubleDistanceEachLevel = value != "0";
+            else if (property == "--pixel_error")
+                pixelError = std::stof(value);
+            else if (property == "--clipmap_size")
+                clipmapSize = std::stoi(value);
+            else if (property == "--cdlod_leaf_size")
+                cdlodLeafSize = std::stoi(value);
+            else if (property == "--cdlod_lod_distance")
+                cdlodLodDistance = std::stof(value);
+            else if (property == "--cbt_target_edge_length")
+                cbtTargetEdgeLength = std::stof(value);
+            else if (property == "--cbt_memory_budget")
+                cbtMemoryBudget = std::stoi(value);
+            else if (property == "--roam_triangle_budget")
+                roamTriangleBudget = std::stoi(value);
+            else if (property == "--roam_pixel_error")
+                roamPixelError = std::stof(value);
+            else if (property == "--job_threads")
+                jobThreads = std::stoi(value);
+            else if (property == "--camera_path")
+                cameraPathFileName = value;
+            else {
+                std::cerr << "Unknown option: " << property << std::endl;
+                return 1;
+            }
+        } catch (std::invalid_argument const& ex) {
+            std::cerr << "Value of " << property << " must be a number" << std::endl;
+            return 1;
+        }
+    }
+
+    /* Check whether block size is of the form 2^n + 1*/
+    if (blockSize < 3 || ((blockSize - 1) & (blockSize - 2)) != 0) {
+        std::cerr << "Block size must be of the form 2^n + 1" << std::endl;
+        return 1;
+    }
+
+    if (heightmapSize < blockSize) {
+        std::cerr << "Heightmap size must be at least the block size" << std::endl;
+        return 1;
+    }
+
+    if (minLod > maxLod) {
+        std::cerr << "Max LOD cannot be less than Min LOD" << std::endl;
+        return 1;
+    }
+
+    /* Check whether clipmap size is of the form 2^n - 1 */
+    if (clipmapSize < 15 || ((clipmapSize + 1) & clipmapSize) != 0) {
+        std::cerr << "Clipmap size must be of the form 2^n - 1 and at least 15" << std::endl;
+        return 1;
+    }
+
+    /* Check whether leaf size is a power of 2 */
+    if (cdlodLeafSize < 4 || (cdlodLeafSize & (cdlodLeafSize - 1)) != 0) {
+        std::cerr << "CDLOD leaf size must be a power of 2 and at least 4" << std::endl;
+        return 1;
+    }
+
+    if (frames == 0) {
+        std::cerr << "Number of frames must be greater than 0" << std::endl;
+        return 1;
+    }
+
+    return 0;
+}
+
+/* Generates a deterministic heightmap of size x size consisting of a
+ * few octaves of sine waves, which results in hills of varying size. */
+std::vector<unsigned short> generateHeightmap(unsigned size)
+{
+    std::vector<unsigned short> heights(size * size);
+
+    for (unsigned z = 0; z < size; z++) {
+        for (unsigned x = 0; x < size; x++) {
+            float y = 0.5f;
+            float amplitude = 0.25f;
+            float frequency = 0.002f;
+
+            for (unsigned octave = 0; octave < 4; octave++) {
+                y += amplitude * std::sin(x * frequency + octave * 1.7f) * std::cos(z * frequency * 1.3f + octave * 0.9f);
+                amplitude *= 0.45f;
+                frequency *= 2.3f;
+            }
+
+            heights[z * size + x] = (unsigned short)(std::min(std::max(y, 0.0f), 1.0f) * 65535.0f);
+        }
+    }
+
+    return heights;
+}
+
+struct PathResult {
+    double nanoseconds;
+    double batchNanoseconds;
+    GeoMipMappingPlanTimings passes; /* Summed over all frames */
+    unsigned long long visibleBlocks;
+    unsigned long long indices;
+    unsigned long long lodUpdates;
+    unsigned long long borderUpdates;
+    unsigned long long drawCalls;
+    unsigned long long batchedDrawCalls;
+    unsigned long long allocations;
+};
+
+PathResult runPath(const CameraPath& path, GeoMipMappingPlanner& planner, const GeoMipMappingIndices& indices)
+{
+    Camera camera = Camera(glm::vec3(0.0f, 1.0f, 0.0f),
+        glm::vec3(0.0f, 1.0f, 0.0f),
+        0.0f, 100000.0f, aspectRatio,
+        0.0f, -40.4f);
+
+    std::vector<GeoMipMappingDrawCommand> drawList;
+    std::vector<GeoMipMappingInstance> instances;
+    std::vector<GeoMipMappingDrawBatch> batches;
+
+    /* Warm-up frame, so that the draw list has reached its capacity */
+    path.apply(camera, 0.0f);
+    planner.plan(camera, indices, drawList);
+    planner.batch(drawList, indices, instances, batches);
+
+    PathResult result = { 0.0, 0.0, GeoMipMappingPlanTimings(), 0, 0, 0, 0, 0, 0, 0 };
+
+    for (unsigned frame = 0; frame < frames; frame++) {
+        path.apply(camera, frames > 1 ? (float)frame / (float)(frames - 1) : 0.0f);
+
+        unsigned long long allocationsBefore = allocationCount.load(std::memory_order_relaxed);
+        auto start = std::chrono::steady_clock::now();
+
+        planner.plan(camera, indices, drawList);
+
+        auto end = std::chrono::steady_clock::now();
+
+        planner.batch(drawList, indices, instances, batches);
+
+        auto batchEnd = std::chrono::steady_clock::now();
+        result.allocations += allocationCount.load(std::memory_order_relaxed) - allocationsBefore;
+        result.nanoseconds += std::chrono::duration<double, std::nano>(end - start).count();
+        result.batchNanoseconds += std::chrono::duration<double, std::nano>(batchEnd - end).count();
+        result.passes.culling += planner.timings().culling;
+        result.passes.lod += planner.timings().lod;
+        result.passes.border += planner.timings().border;
+        result.visibleBlocks += drawList.size();
+        result.lodUpdates += planner.lodUpdates();
+        result.borderUpdates += planner.borderUpdates();
+        result.batchedDrawCalls += batches.size();
+
+        for (const GeoMipMappingDrawCommand& command : drawList) {
+            result.drawCalls += command.centerCount > 0 ? 2 : 1;
+            result.indices += command.centerCount + command.borderCount;
+        }
+    }
+
+    return result;
+}
+
+void printResult(const std::string& name, const PathResult& result, unsigned nBlocks)
+{
+    double visiblePerFrame = (double)result.visibleBlocks / frames;
+
+    std::cout << "Path: " << name << " (" << frames << " frames)" << std::endl;
+    std::cout << "  Visible blocks/frame: " << visiblePerFrame << " of " << nBlocks << std::endl;
+    std::cout << "  Indices/frame: " << (double)result.indices / frames << std::endl;
+    std::cout << "  LOD updates/frame: " << (double)result.lodUpdates / frames
+              << ", border updates/frame: " << (double)result.borderUpdates / frames << std::endl;
+    std::cout << "  Planning time/frame: " << result.nanoseconds / frames / 1000.0 << " us" << std::endl;
+    std::cout << "  Passes/frame: culling " << result.passes.culling / frames * 1000.0
+              << " us, LOD " << result.passes.lod / frames * 1000.0
+              << " us, border " << result.passes.border / frames * 1000.0 << " us" << std::endl;
+    std::cout << "  ns/block: " << result.nanoseconds / ((double)frames * nBlocks) << std::endl;
+
+    if (result.visibleBlocks > 0)
+        std::cout << "  ns/visible block: " << result.nanoseconds / result.visibleBlocks << std::endl;
+
+    std::cout << "  Batching time/frame: " << result.batchNanoseconds / frames / 1000.0 << " us" << std::endl;
+    std::cout << "  Draw calls/frame: " << (double)result.drawCalls / frames << " per block, "
+              << (double)result.batchedDrawCalls / frames << " batched" << std::endl;
+    std::cout << "  Allocations/frame: " << (double)result.allocations / frames << std::endl;
+}
+
+/* ======================= Parallel planning benchmark =====================
+ * Plans every frame of the path twice, on the calling thread and on the
+ * job system, and checks that both draw lists are the same. Both planners
+ * start from the same block state, so they also stay in sync in
+ * incremental mode. */
+void runParallelPath(const std::string& name, const CameraPath& path, GeoMipMappingPlanner& planner,
+    const GeoMipMappingIndices& indices, JobSystem& jobSystem)
+{
+    GeoMipMappingPlanner parallelPlanner = planner;
+    parallelPlanner.jobSystem(&jobSystem);
+
+    Camera camera = Camera(glm::vec3(0.0f, 1.0f, 0.0f),
+        glm::vec3(0.0f, 1.0f, 0.0f),
+        0.0f, 100000.0f, aspectRatio,
+        0.0f, -40.4f);
+
+    std::vector<GeoMipMappingDrawCommand> drawList, parallelDrawList;
+    double nanoseconds = 0.0, parallelNanoseconds = 0.0;
+    unsigned mismatches = 0;
+
+    for (GeoMipMappingPlanner* current : { &planner, &parallelPlanner }) {
+        current->quadTreeActive(false);
+        current->incrementalActive(true);
+    }
+
+    for (unsigned frame = 0; frame < frames; frame++) {
+        path.apply(camera, frames > 1 ? (float)frame / (float)(frames - 1) : 0.0f);
+
+        auto start = std::chrono::steady_clock::now();
+        planner.plan(camera, indices, drawList);
+        auto middle = std::chrono::steady_clock::now();
+        parallelPlanner.plan(camera, indices, parallelDrawList);
+        auto end = std::chrono::steady_clock::now();
+
+        nanoseconds += std::chrono::duration<double, std::nano>(middle - start).count();
+        parallelNanoseconds += std::chrono::duration<double, std::nano>(end - middle).count();
+
+        bool same = drawList.size() == parallelDrawList.size()
+            && planner.lodUpdates() == parallelPlanner.lodUpdates()
+            && planner.borderUpdates() == parallelPlanner.borderUpdates();
+
+        for (unsigned i = 0; same && i < drawList.size(); i++) {
+            same = drawList[i].blockId == parallelDrawList[i].blockId
+                && drawList[i].lod == parallelDrawList[i].lod
+                && drawList[i].borderBitmap == parallelDrawList[i].borderBitmap;
+        }
+
+        if (!same)
+            mismatches++;
+    }
+
+    std::cout << "Path: " << name << ", linear culling, incremental, job system (" << frames << " frames)" << std::endl;
+    std::cout << "  1 thread: " << nanoseconds / frames / 1000.0 << " us/frame, "
+              << jobSystem.nThreads() << " job threads: " << parallelNanoseconds / frames / 1000.0 << " us/frame" << std::endl;
+    std::cout << "  Frames with different draw lists: " << mismatches << std::endl;
+}
+
+/* ======================= Planning thread benchmark =======================
+ * Measures the time the render thread spends on planning per frame, once
+ * planning on the render thread and once handing it off to the
+ * GeoMipMappingPlanningThread. Each frame sleeps afterwards as a stand-in
+ * for the draw submission and buffer swap, during which the planning
+ * thread plans the next frame. Also reports by how many frames the drawn
+ * draw list lags behind the camera. */
+void runPlanningThreadPath(const std::string& name, const CameraPath& path, GeoMipMappingPlanner& planner,
+    const GeoMipMappingIndices& indices, const GeoMipMappingPlannerSettings& settings)
+{
+    const auto submitTime = std::chrono::milliseconds(1);
+
+    Camera camera = Camera(glm::vec3(0.0f, 1.0f, 0.0f),
+        glm::vec3(0.0f, 1.0f, 0.0f),
+        0.0f, 100000.0f, aspectRatio,
+        0.0f, -40.4f);
+
+    std::cout << "Path: " << name << ", planning thread (" << frames << " frames)" << std::endl;
+
+    for (bool threaded : { false, true }) {
+        GeoMipMappingFrame ownFrame;
+        std::unique_ptr<GeoMipMappingPlanningThread> planningThread;
+        if (threaded)
+            planningThread.reset(new GeoMipMappingPlanningThread(planner, indices));
+
+        double nanoseconds = 0.0;
+        unsigned long long framesBehind = 0;
+
+        for (unsigned frame = 0; frame < frames; frame++) {
+            path.apply(camera, frames > 1 ? (float)frame / (float)(frames - 1) : 0.0f);
+
+            auto start = std::chrono::steady_clock::now();
+
+            if (threaded) {
+                planningThread->submit(camera, settings);
+                framesBehind += frame + 1 - planningThread->acquire().number;
+            } else {
+                GeoMipMappingPlanningThread::plan(planner, indices, camera, settings, ownFrame);
+            }
+
+            auto end = std::chrono::steady_clock::now();
+            nanoseconds += std::chrono::duration<double, std::nano>(end - start).count();
+
+            std::this_thread::sleep_for(submitTime);
+        }
+
+        std::cout << "  " << (threaded ? "Planning thread" : "Render thread") << ": "
+                  << nanoseconds / frames / 1000.0 << " us/frame on the render thread";
+        if (threaded)
+            std::cout << ", " << (double)framesBehind / frames << " frames behind";
+        std::cout << std::endl;
+    }
+}
+
+/* ======================== Block layout benchmark =========================
+ * Runs the same culling and distance-based LOD kernel over every block,
+ * once on an array of structs (the former GeoMipMappingBlock layout, with
+ * hot and cold fields interleaved) and once on the structure of arrays used
+ * by the planner. The kernel is scalar on purpose, so this measures the
+ * cost of the layout alone, without the SIMD kernels it was made for. */
+struct AosBlock {
+    unsigned blockId;
+    glm::vec3 worldCenter;
+    glm::vec3 p1, p2;
+    glm::vec2 translation;
+    unsigned currentLod;
+    unsigned currentBorderBitmap;
+};
+
+unsigned lodForDistance(float squaredDistance, unsigned minLod, unsigned maxLod)
+{
+    for (unsigned i = 0; i < maxLod - minLod; i++) {
+        float distance = (i + 1) * baseDistance;
+        if (squaredDistance < distance * distance)
+            return maxLod - i;
+    }
+    return minLod;
+}
+
+void runLayoutBenchmark(const CameraPath& path, GeoMipMappingPlanner& planner, unsigned minLod, unsigned maxLod)
+{
+    const GeoMipMappingBlocks& soa = planner.blocks();
+    unsigned nBlocks = soa.size();
+
+    std::vector<AosBlock> aos(nBlocks);
+    for (unsigned i = 0; i < nBlocks; i++) {
+        GeoMipMappingBlock block = soa.get(i);
+        aos[i] = { i, block.worldCenter, block.p1, block.p2, block.translation, 0, 0 };
+    }
+
+    std::vector<unsigned> soaLods(soa.lod.begin(), soa.lod.end());
+
+    Camera camera = Camera(glm::vec3(0.0f, 1.0f, 0.0f),
+        glm::vec3(0.0f, 1.0f, 0.0f),
+        0.0f, 100000.0f, aspectRatio,
+        0.0f, -40.4f);
+
+    double aosNanoseconds = 0.0, soaNanoseconds = 0.0;
+    unsigned long long aosChecksum = 0, soaChecksum = 0;
+
+    for (unsigned frame = 0; frame < frames; frame++) {
+        path.apply(camera, frames > 1 ? (float)frame / (float)(frames - 1) : 0.0f);
+        glm::vec3 position = camera.position();
+
+        auto start = std::chrono::steady_clock::now();
+
+        for (AosBlock& block : aos) {
+            if (camera.insideViewFrustum(block.p1, block.p2)) {
+                glm::vec3 temp = block.worldCenter - position;
+                block.currentLod = lodForDistance(glm::dot(temp, temp), minLod, maxLod);
+                aosChecksum += block.currentLod + 1;
+            }
+        }
+
+        auto middle = std::chrono::steady_clock::now();
+
+        for (unsigned i = 0; i < nBlocks; i++) {
+            glm::vec3 p1(soa.minX[i], soa.minY[i], soa.minZ[i]);
+            glm::vec3 p2(soa.maxX[i], soa.maxY[i], soa.maxZ[i]);
+
+            if (camera.insideViewFrustum(p1, p2)) {
+                float dx = soa.centerX[i] - position.x;
+                float dy = soa.centerY[i] - position.y;
+                float dz = soa.centerZ[i] - position.z;
+                soaLods[i] = lodForDistance(dx * dx + dy * dy + dz * dz, minLod, maxLod);
+                soaChecksum += soaLods[i] + 1;
+            }
+        }
+
+        auto end = std::chrono::steady_clock::now();
+        aosNanoseconds += std::chrono::duration<double, std::nano>(middle - start).count();
+        soaNanoseconds += std::chrono::duration<double, std::nano>(end - middle).count();
+    }
+
+    std::cout << "Block layout (culling and LOD over all blocks, " << frames << " frames)" << std::endl;
+    std::cout << "  Array of structs: " << aosNanoseconds / ((double)frames * nBlocks) << " ns/block ("
+              << sizeof(AosBlock) << " bytes/block)" << std::endl;
+    std::cout << "  Structure of arrays: " << soaNanoseconds / ((double)frames * nBlocks) << " ns/block" << std::endl;
+
+    if (aosChecksum != soaChecksum)
+        std::cout << "  Warning: results differ between the layouts" << std::endl;
+}
+
+/* ======================== Culling kernel benchmark ========================
+ * Tests every block against the view-frustum, once per block with
+ * Camera::insideViewFrustum and once in batches with each supported
+ * kernel of FrustumCulling. */
+void runCullingBenchmark(const CameraPath& path, GeoMipMappingPlanner& planner)
+{
+    const GeoMipMappingBlocks& blocks = planner.blocks();
+    AabbArrays aabbs = blocks.aabbs();
+    unsigned nBlocks = blocks.size();
+
+    Camera camera = Camera(glm::vec3(0.0f, 1.0f, 0.0f),
+        glm::vec3(0.0f, 1.0f, 0.0f),
+        0.0f, 100000.0f, aspectRatio,
+        0.0f, -40.4f);
+
+    FrustumCullingKernel selectedKernel = FrustumCulling::kernel();
+    FrustumCullingKernel kernels[] = { FrustumCullingKernel::SCALAR, FrustumCullingKernel::SSE, FrustumCullingKernel::AVX };
+
+    double blockNanoseconds = 0.0;
+    unsigned long long blockVisible = 0;
+
+    for (unsigned frame = 0; frame < frames; frame++) {
+        path.apply(camera, frames > 1 ? (float)frame / (float)(frames - 1) : 0.0f);
+
+        auto start = std::chrono::steady_clock::now();
+
+        for (unsigned i = 0; i < nBlocks; i++) {
+            glm::vec3 p1(blocks.minX[i], blocks.minY[i], blocks.minZ[i]);
+            glm::vec3 p2(blocks.maxX[i], blocks.maxY[i], blocks.maxZ[i]);
+
+            if (camera.insideViewFrustum(p1, p2))
+                blockVisible++;
+        }
+
+        auto end = std::chrono::steady_clock::now();
+        blockNanoseconds += std::chrono::duration<double, std::nano>(end - start).count();
+    }
+
+    std::cout << "Culling kernels (all blocks, " << frames << " frames, selected: "
+              << FrustumCulling::kernelName(selectedKernel) << ")" << std::endl;
+    std::cout << "  Per block: " << blockNanoseconds / ((double)frames * nBlocks) << " ns/block" << std::endl;
+
+    for (FrustumCullingKernel kernel : kernels) {
+        if (!FrustumCulling::supported(kernel))
+            continue;
+
+        FrustumCulling::kernel(kernel);
+
+        double nanoseconds = 0.0;
+        unsigned long long visible = 0, inside = 0;
+
+        for (unsigned frame = 0; frame < frames; frame++) {
+            path.apply(camera, frames > 1 ? (float)frame / (float)(frames - 1) : 0.0f);
+
+            auto start = std::chrono::steady_clock::now();
+
+            for (unsigned first = 0; first < nBlocks; first += FrustumCulling::BATCH_SIZE) {
+                unsigned count = std::min(FrustumCulling::BATCH_SIZE, nBlocks - first);
+                FrustumCullResult result = camera.intersectViewFrustum(aabbs, first, count);
+
+                for (unsigned i = 0; i < count; i++) {
+                    visible += (result.visibleMask >> i) & 1;
+                    inside += (result.insideMask >> i) & 1;
+                }
+            }
+
+            auto end = std::chrono::steady_clock::now();
+            nanoseconds += std::chrono::duration<double, std::nano>(end - start).count();
+        }
+
+        std::cout << "  " << FrustumCulling::kernelName(kernel) << ": " << nanoseconds / ((double)frames * nBlocks)
+                  << " ns/block, " << (double)inside / frames << " blocks/frame entirely inside" << std::endl;
+
+        if (visible != blockVisible)
+            std::cout << "  Warning: " << FrustumCulling::kernelName(kernel) << " kernel found "
+                      << (double)visible / frames << " instead of " << (double)blockVisible / frames
+                      << " visible blocks/frame" << std::endl;
+    }
+
+    FrustumCulling::kernel(selectedKernel);
+}
+
+/* ====================== Geometry clipmap benchmark =======================
+ * Replays a camera path against the geometry clipmap planner, measuring
+ * the time to move the levels and to fill the samples entering them. */
+void runGeometryClipmapPath(const std::string& name, const CameraPath& path, const std::vector<unsigned short>& heights)
+{
+    unsigned nLevels = GeometryClipmapPlanner::levelsFor(clipmapSize, heightmapSize, heightmapSize);
+    GeometryClipmapPlanner planner(clipmapSize, nLevels, heightmapSize, heightmapSize);
+
+    auto heightAt = [&heights](unsigned x, unsigned z) {
+        return heights[(std::size_t)z * heightmapSize + x];
+    };
+
+    Camera camera = Camera(glm::vec3(0.0f, 1.0f, 0.0f),
+        glm::vec3(0.0f, 1.0f, 0.0f),
+        0.0f, 100000.0f, aspectRatio,
+        0.0f, -40.4f);
+
+    std::vector<GeometryClipmapUpdate> updates;
+    std::vector<float> samples;
+
+    double nanoseconds = 0.0, initialNanoseconds = 0.0;
+    unsigned long long updatedSamples = 0, nUpdates = 0;
+
+    /* Frame -1 is the initial load of every level */
+    for (int frame = -1; frame < (int)frames; frame++) {
+        path.apply(camera, frame > 0 && frames > 1 ? (float)frame / (float)(frames - 1) : 0.0f);
+        glm::vec3 position = camera.position();
+        glm::vec2 viewer(position.x + heightmapSize / 2.0f, position.z + heightmapSize / 2.0f);
+
+        auto start = std::chrono::steady_clock::now();
+
+        updates.clear();
+        planner.plan(viewer, updates);
+
+        for (const GeometryClipmapUpdate& update : updates) {
+            samples.resize((std::size_t)update.width * update.height * 2);
+            planner.fill(update, heightAt, samples.data());
+        }
+
+        auto end = std::chrono::steady_clock::now();
+        double frameNanoseconds = std::chrono::duration<double, std::nano>(end - start).count();
+
+        if (frame < 0) {
+            initialNanoseconds = frameNanoseconds;
+            continue;
+        }
+
+        nanoseconds += frameNanoseconds;
+        updatedSamples += planner.updatedSamples();
+        nUpdates += updates.size();
+    }
+
+    std::cout << "Path: " << name << ", geometry clipmap (" << frames << " frames)" << std::endl;
+    std::cout << "  Levels: " << nLevels << " of " << clipmapSize << " x " << clipmapSize << " samples" << std::endl;
+    std::cout << "  Initial load: " << initialNanoseconds / 1000000.0 << " ms" << std::endl;
+    std::cout << "  Update time/frame: " << nanoseconds / frames / 1000.0 << " us" << std::endl;
+    std::cout << "  Updated samples/frame: " << (double)updatedSamples / frames
+              << " in " << (double)nUpdates / frames << " rectangles" << std::endl;
+}
+
+/* ========================= CDLOD selection benchmark ========================
+ * Replays a camera path against the CDLOD quadtree, measuring the time to
+ * select and batch the nodes. */
+void runCdlodPath(const std::string& name, const CameraPath& path, CdlodQuadTree& quadTree)
+{
+    Camera camera = Camera(glm::vec3(0.0f, 1.0f, 0.0f),
+        glm::vec3(0.0f, 1.0f, 0.0f),
+        0.0f, 100000.0f, aspectRatio,
+        0.0f, -40.4f);
+
+    std::vector<CdlodNode> selection;
+    std::vector<CdlodInstance> instances;
+    std::vector<CdlodDrawBatch> batches;
+
+    /* Warm-up frame, so that the selection has reached its capacity */
+    path.apply(camera, 0.0f);
+    quadTree.select(camera, yScale, selection);
+    quadTree.batch(selection, instances, batches);
+
+    double nanoseconds = 0.0;
+    unsigned long long selectedNodes = 0, drawCalls = 0, allocations = 0;
+
+    for (unsigned frame = 0; frame < frames; frame++) {
+        path.apply(camera, frames > 1 ? (float)frame / (float)(frames - 1) : 0.0f);
+
+        unsigned long long allocationsBefore = allocationCount.load(std::memory_order_relaxed);
+        auto start = std::chrono::steady_clock::now();
+
+        quadTree.select(camera, yScale, selection);
+        quadTree.batch(selection, instances, batches);
+
+        auto end = std::chrono::steady_clock::now();
+        allocations += allocationCount.load(std::memory_order_relaxed) - allocationsBefore;
+        nanoseconds += std::chrono::duration<double, std::nano>(end - start).count();
+        selectedNodes += selection.size();
+
+        /* Every run of consecutive quadrants is one instanced draw */
+        for (const CdlodDrawBatch& batch : batches)
+            for (unsigned quadrant = 0; quadrant < 4; quadrant++)
+                if ((batch.quadrantMask >> quadrant) & 1 && (quadrant == 0 || !((batch.quadrantMask >> (quadrant - 1)) & 1)))
+                    drawCalls++;
+    }
+
+    std::cout << "Path: " << name << ", CDLOD (" << frames << " frames)" << std::endl;
+    std::cout << "  Levels: " << quadTree.nLevels() << ", nodes: " << quadTree.nNodes()
+              << ", LOD distance: " << quadTree.lodDistance() << std::endl;
+    std::cout << "  Selected nodes/frame: " << (double)selectedNodes / frames << std::endl;
+    std::cout << "  Selection time/frame: " << nanoseconds / frames / 1000.0 << " us" << std::endl;
+    std::cout << "  Draw calls/frame: " << (double)drawCalls / frames << std::endl;
+    std::cout << "  Allocations/frame: " << (double)allocations / frames << std::endl;
+}
+
+/* ========================== CBT tessellation benchmark =========================
+ * Replays a camera path against the CBT planner, measuring the time of the
+ * split and merge passes and of collecting the visible leaves. The
+ * tessellation starts from the two root triangles and follows the camera,
+ * so the first frames mostly split. */
+void runCbtPath(const std::string& name, const CameraPath& path, CbtPlanner& planner)
+{
+    Camera camera = Camera(glm::vec3(0.0f, 1.0f, 0.0f),
+        glm::vec3(0.0f, 1.0f, 0.0f),
+        0.0f, 100000.0f, aspectRatio,
+        0.0f, -40.4f);
+
+    std::vector<CbtTriangle> triangles;
+
+    /* Warm-up frames, so that the tessellation has converged at the start
+     * of the path and the leaf vectors have reached their capacity */
+    planner.reset();
+    path.apply(camera, 0.0f);
+    for (unsigned i = 0; i < 2 * planner.tree().maxDepth(); i++)
+        planner.update(camera, yScale, triangles);
+
+    double nanoseconds = 0.0;
+    unsigned long long leaves = 0, drawnLeaves = 0, splits = 0, merges = 0, allocations = 0;
+
+    for (unsigned frame = 0; frame < frames; frame++) {
+        path.apply(camera, frames > 1 ? (float)frame / (float)(frames - 1) : 0.0f);
+
+        unsigned long long allocationsBefore = allocationCount.load(std::memory_order_relaxed);
+        auto start = std::chrono::steady_clock::now();
+
+        planner.update(camera, yScale, triangles);
+
+        auto end = std::chrono::steady_clock::now();
+        allocations += allocationCount.load(std::memory_order_relaxed) - allocationsBefore;
+        nanoseconds += std::chrono::duration<double, std::nano>(end - start).count();
+        leaves += planner.tree().leafCount();
+        drawnLeaves += triangles.size();
+        splits += planner.splits();
+        merges += planner.merges();
+    }
+
+    std::cout << "Path: " << name << ", CBT (" << frames << " frames)" << std::endl;
+    std::cout << "  Maximum depth: " << planner.tree().maxDepth() << " (" << planner.tree().memoryBytes() / 1024
+              << " KB), target edge length: " << cbtTargetEdgeLength << " px" << std::endl;
+    std::cout << "  Leaves/frame: " << (double)leaves / frames << ", drawn: " << (double)drawnLeaves / frames << std::endl;
+    std::cout << "  Splits/frame: " << (double)splits / frames << ", merges/frame: " << (double)merges / frames << std::endl;
+    std::cout << "  Update time/frame: " << nanoseconds / frames / 1000.0 << " us" << std::endl;
+    std::cout << "  Allocations/frame: " << (double)allocations / frames << std::endl;
+}
+
+/* ============================= ROAM benchmark =============================
+ * Replays a camera path against the ROAM planner, measuring the time to
+ * adapt the triangulation with the split and merge queues and to collect
+ * the visible triangles. The triangles/frame can be compared with the
+ * indices/frame of GeoMipMapping (about one triangle per index for
+ * triangle strips). */
+void runRoamPath(const std::string& name, const CameraPath& path, RoamPlanner& planner)
+{
+    Camera camera = Camera(glm::vec3(0.0f, 1.0f, 0.0f),
+        glm::vec3(0.0f, 1.0f, 0.0f),
+        0.0f, 100000.0f, aspectRatio,
+        0.0f, -40.4f);
+
+    std::vector<RoamVertex> vertices;
+
+    /* Warm-up frames, so that the triangulation has converged at the start
+     * of the path and the vertex vector has reached its capacity */
+    planner.reset();
+    path.apply(camera, 0.0f);
+    for (unsigned i = 0; i < 8; i++)
+        planner.update(camera, yScale, vertices);
+
+    double nanoseconds = 0.0;
+    unsigned long long triangles = 0, drawnTriangles = 0, splits = 0, merges = 0, allocations = 0;
+
+    for (unsigned frame = 0; frame < frames; frame++) {
+        path.apply(camera, frames > 1 ? (float)frame / (float)(frames - 1) : 0.0f);
+
+        unsigned long long allocationsBefore = allocationCount.load(std::memory_order_relaxed);
+        auto start = std::chrono::steady_clock::now();
+
+        planner.update(camera, yScale, vertices);
+
+        auto end = std::chrono::steady_clock::now();
+        allocations += allocationCount.load(std::memory_order_relaxed) - allocationsBefore;
+        nanoseconds += std::chrono::duration<double, std::nano>(end - start).count();
+        triangles += planner.leafCount();
+        drawnTriangles += vertices.size() / 3;
+        splits += planner.splits();
+        merges += planner.merges();
+    }
+
+    std::cout << "Path: " << name << ", ROAM (" << frames << " frames)" << std::endl;
+    std::cout << "  Triangle budget: " << planner.triangleBudget() << ", pool: " << planner.memoryBytes() / 1024
+              << " KB, pixel error: " << roamPixelError << std::endl;
+    std::cout << "  Triangles/frame: " << (double)triangles / frames << ", drawn: " << (double)drawnTriangles / frames << std::endl;
+    std::cout << "  Splits/frame: " << (double)splits / frames << ", merges/frame: " << (double)merges / frames << std::endl;
+    std::cout << "  Update time/frame: " << nanoseconds / frames / 1000.0 << " us" << std::endl;
+    std::cout << "  Allocations/frame: " << (double)allocations / frames << std::endl;
+}
+
+int run()
+{
+    unsigned maxPossibleLod = std::log2(blockSize - 1);
+    unsigned clampedMaxLod = std::min(maxLod, maxPossibleLod);
+    unsigned clampedMinLod = std::min(minLod, clampedMaxLod);
+
+    unsigned nBlocksX = (heightmapSize - 1) / (blockSize - 1);
+    unsigned nBlocksZ = nBlocksX;
+    unsigned nBlocks = nBlocksX * nBlocksZ;
+
+    std::cout << "Generating " << heightmapSize << " x " << heightmapSize << " heightmap" << std::endl;
+    std::vector<unsigned short> heights = generateHeightmap(heightmapSize);
+
+    GeoMipMappingIndices indices;
+    indices.load(blockSize, clampedMinLod, clampedMaxLod);
+
+    GeoMipMappingPlanner planner(blockSize, nBlocksX, nBlocksZ, clampedMinLod, clampedMaxLod);
+    JobSystem jobSystem(jobThreads);
+
+    /* Block loading on a single thread and on the job system */
+    for (JobSystem* loadJobSystem : { (JobSystem*)nullptr, &jobSystem }) {
+        planner.jobSystem(loadJobSystem);
+
+        auto start = std::chrono::steady_clock::now();
+        planner.loadBlocks(heights.data(), heightmapSize, 1.0f, yScale);
+        auto end = std::chrono::steady_clock::now();
+
+        std::cout << "Loaded blocks (" << (loadJobSystem ? std::to_string(jobSystem.nThreads()) + " job threads" : "1 thread") << ") in "
+                  << std::chrono::duration<double, std::milli>(end - start).count() << " ms" << std::endl;
+    }
+    planner.jobSystem(nullptr);
+    planner.baseDistance(baseDistance);
+    planner.doubleDistanceEachLevel(doubleDistanceEachLevel);
+
+    if (pixelError > 0.0f) {
+        planner.lodMode(GeoMipMappingLodMode::SCREEN_SPACE_ERROR);
+        planner.pixelError(pixelError);
+    }
+
+    std::cout << "Block size: " << blockSize << ", blocks: " << nBlocksX << " x " << nBlocksZ
+              << ", LODs: " << clampedMinLod << " - " << clampedMaxLod << std::endl;
+
+    std::vector<std::pair<std::string, CameraPath>> paths;
+
+    if (!cameraPathFileName.empty()) {
+        CameraPath path;
+        path.load(cameraPathFileName);
+        paths.push_back({ cameraPathFileName, path });
+    } else {
+        /* Same paths as the automatic flight (F key) and 360-degree
+         * look-around (R key) of the application */
+        float halfSize = (heightmapSize - 1) / 2.0f;
+
+        CameraPath flight;
+        flight.addKeyframe(glm::vec3(-halfSize, 200.0f, -halfSize), 45.0f, -10.0f);
+        flight.addKeyframe(glm::vec3(halfSize, 200.0f, halfSize), 45.0f, -10.0f);
+        paths.push_back({ "flight", flight });
+
+        CameraPath lookAround;
+        lookAround.addKeyframe(glm::vec3(0.0f, 2500.0f, 0.0f), 0.0f, -10.0f);
+        lookAround.addKeyframe(glm::vec3(0.0f, 2500.0f, 0.0f), 360.0f, -10.0f);
+        paths.push_back({ "look-around", lookAround });
+    }
+
+    /* Compare testing every block against the hierarchical quadtree culling,
+     * and full against incremental LOD and border bitmap updates */
+    for (auto& path : paths) {
+        planner.quadTreeActive(false);
+        planner.incrementalActive(false);
+        printResult(path.first + ", linear culling", runPath(path.second, planner, indices), nBlocks);
+
+        planner.quadTreeActive(true);
+        printResult(path.first + ", quadtree culling", runPath(path.second, planner, indices), nBlocks);
+
+        planner.incrementalActive(true);
+        printResult(path.first + ", quadtree culling, incremental", runPath(path.second, planner, indices), nBlocks);
+    }
+
+    /* The per-block passes on the job system, with linear culling so that
+     * the culling is split into jobs as well */
+    for (auto& path : paths)
+        runParallelPath(path.first, path.second, planner, indices, jobSystem);
+
+    GeoMipMappingPlannerSettings planningSettings;
+    planningSettings.baseDistance = baseDistance;
+    planningSettings.doubleDistanceEachLevel = doubleDistanceEachLevel;
+    if (pixelError > 0.0f) {
+        planningSettings.lodMode = GeoMipMappingLodMode::SCREEN_SPACE_ERROR;
+        planningSettings.pixelError = pixelError;
+    }
+
+    for (auto& path : paths)
+        runPlanningThreadPath(path.first, path.second, planner, indices, planningSettings);
+
+    /* The geometry clipmap reads the height values while the camera moves */
+    for (auto& path : paths)
+        runGeometryClipmapPath(path.first, path.second, heights);
+
+    CdlodQuadTree cdlodQuadTree(cdlodLeafSize, heightmapSize, heightmapSize, 1.0f);
+    cdlodQuadTree.loadHeights(heights.data(), heightmapSize);
+    cdlodQuadTree.lodDistance(cdlodLodDistance);
+
+    for (auto& path : paths)
+        runCdlodPath(path.first, path.second, cdlodQuadTree);
+
+    unsigned cbtMaxDepth = CbtPlanner::maxDepthFor(heightmapSize, heightmapSize, 2, (std::size_t)cbtMemoryBudget * 1024 * 1024);
+    CbtPlanner cbtPlanner(cbtMaxDepth, heightmapSize, heightmapSize, 1.0f);
+    cbtPlanner.loadHeights(heights.data(), heightmapSize);
+    cbtPlanner.targetEdgeLength(cbtTargetEdgeLength);
+
+    for (auto& path : paths)
+        runCbtPath(path.first, path.second, cbtPlanner);
+
+    RoamPlanner roamPlanner(roamTriangleBudget, heightmapSize, heightmapSize, 1.0f);
+    roamPlanner.loadHeights(heights.data(), heightmapSize);
+    roamPlanner.pixelError(roamPixelError);
+
+    for (auto& path : paths)
+        runRoamPath(path.first, path.second, roamPlanner);
+
+    runLayoutBenchmark(paths.front().second, planner, clampedMinLod, clampedMaxLod);
+    runCullingBenchmark(paths.front().second, planner);
+
+    return 0;
+}
+
+}
+
+int main(int argc, char** argv)
+{
+    if (Benchmark::parseArguments(argc, argv) != 0)
+        return 1;
+
+    return Benchmark::run();
+}
@@ -0,0 +1,175 @@
+#include "benchmarkreport.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+
+namespace {
+
+std::string jsonString(const std::string& value)
+{
+    std::string result = "\"";
+
+    for (char c : value) {
+        if (c == '"' || c == '\\') {
+            result += '\\';
+            result += c;
+        } else if ((unsigned char)c < 0x20) {
+            char escaped[8];
+            std::snprintf(escaped, sizeof(escaped), "\\u%04x", (unsigned)c);
+            result += escaped;
+        } else {
+            result += c;
+        }
+    }
+
+    return result + "\"";
+}
+
+std::string jsonNumber(double value)
+{
+    std::ostringstream stream;
+    stream.precision(9);
+    stream << value;
+    return stream.str();
+}
+
+void writeDistribution(std::ostream& out, const BenchmarkDistribution& distribution)
+{
+    out << "{ \"count\": " << distribution.count
+        << ", \"mean\": " << jsonNumber(distribution.mean)
+        << ", \"min\": " << jsonNumber(distribution.min)
+        << ", \"p50\": " << jsonNumber(distribution.p50)
+        << ", \"p95\": " << jsonNumber(distribution.p95)
+        << ", \"p99\": " << jsonNumber(distribution.p99)
+        << ", \"max\": " << jsonNumber(distribution.max) << " }";
+}
+
+}
+
+/* Uses nearest-rank percentiles, like FrameStatistics */
+BenchmarkDistribution BenchmarkDistribution::of(std::vector<double> values)
+{
+    values.erase(std::remove_if(values.begin(), values.end(), [](double value) { return value < 0.0; }), values.end());
+
+    BenchmarkDistribution distribution;
+    if (values.empty())
+        return distribution;
+
+    std::sort(values.begin(), values.end());
+
+    auto percentile = [&](double p) {
+        std::size_t rank = (std::size_t)std::ceil(p / 100.0 * values.size());
+        return values[rank > 0 ? rank - 1 : 0];
+    };
+
+    double sum = 0.0;
+    for (double value : values)
+        sum += value;
+
+    distribution.count = values.size();
+    distribution.mean = sum / values.size();
+    distribution.min = values.front();
+    distribution.max = values.back();
+    distribution.p50 = percentile(50.0);
+    distribution.p95 = percentile(95.0);
+    distribution.p99 = percentile(99.0);
+    return distribution;
+}
+
+void BenchmarkReport::info(const std::string& key, const std::string& value)
+{
+    _info.emplace_back(key, jsonString(value));
+}
+
+void BenchmarkReport::info(const std::string& key, double value)
+{
+    _info.emplace_back(key, jsonNumber(value));
+}
+
+void BenchmarkReport::addRun(const std::string& name, const std::vector<std::pair<std::string, double>>& parameters,
+    std::vector<FrameRecord>::const_iterator first, std::vector<FrameRecord>::const_iterator last)
+{
+    BenchmarkRun run;
+    run.name = name;
+    run.parameters = parameters;
+
+    std::vector<double> values;
+    auto distribution = [&](auto value) {
+        values.clear();
+        for (auto record = first; record != last; ++record)
+            values.push_back(value(*record));
+        return BenchmarkDistribution::of(values);
+    };
+
+    run.frameTime = distribution([](const FrameRecord& record) { return record.frameTime; });
+
+    for (unsigned phase = 0; phase < N_FRAME_PHASES; phase++)
+        run.cpuTimes[phase] = distribution([&](const FrameRecord& record) { return record.cpuTimes[phase]; });
+
+    for (unsigned section = 0; section < N_GPU_SECTIONS; section++)
+        run.gpuTimes[section] = distribution([&](const FrameRecord& record) { return record.gpuTimes[section]; });
+
+    run.visibleBlocks = distribution([](const FrameRecord& record) { return (double)record.visibleBlocks; });
+    run.drawCalls = distribution([](const FrameRecord& record) { return (double)record.drawCalls; });
+    run.triangles = distribution([](const FrameRecord& record) { return (double)record.triangles; });
+
+    _runs.push_back(run);
+}
+
+bool BenchmarkReport::writeJson(const std::string& fileName) const
+{
+    std::ofstream file(fileName);
+    if (!file)
+        return false;
+
+    file << "{\n";
+    for (const auto& entry : _info)
+        file << "  " << jsonString(entry.first) << ": " << entry.second << ",\n";
+
+    file << "  \"runs\": [";
+    for (std::size_t i = 0; i < _runs.size(); i++) {
+        const BenchmarkRun& run = _runs[i];
+
+        file << (i > 0 ? ",\n" : "\n") << "    {\n";
+        file << "      \"name\": " << jsonString(run.name) << ",\n";
+
+        file << "      \"parameters\": {";
+        for (std::size_t j = 0; j < run.parameters.size(); j++)
+            file << (j > 0 ? ", " : " ") << jsonString(run.parameters[j].first) << ": " << jsonNumber(run.parameters[j].second);
+        file << (run.parameters.empty() ? "},\n" : " },\n");
+
+        file << "      \"frame_time_ms\": ";
+        writeDistribution(file, run.frameTime);
+
+        file << ",\n      \"cpu_ms\": {";
+        for (unsigned phase = 0; phase < N_FRAME_PHASES; phase++) {
+            file << (phase > 0 ? ",\n" : "\n") << "        " << jsonString(FRAME_PHASE_NAMES[phase]) << ": ";
+            writeDistribution(file, run.cpuTimes[phase]);
+        }
+
+        file << "\n      },\n      \"gpu_ms\": {";
+        for (unsigned section = 0; section < N_GPU_SECTIONS; section++) {
+            file << (section > 0 ? ",\n" : "\n") << "        " << jsonString(GPU_SECTION_NAMES[section]) << ": ";
+            writeDistribution(file, run.gpuTimes[section]);
+        }
+
+        file << "\n      },\n      \"visible_blocks\": ";
+        writeDistribution(file, run.visibleBlocks);
+        file << ",\n      \"draw_calls\": ";
+        writeDistribution(file, run.drawCalls);
+        file << ",\n      \"triangles\": ";
+        writeDistribution(file, run.triangles);
+        file << "\n    }";
+    }
+    file << (_runs.empty() ? "]\n" : "\n  ]\n") << "}\n";
+
+    return (bool)file;
+}
+
+const std::vector<BenchmarkRun>& BenchmarkReport::runs() const
+{
+    return _runs;
+}
@@ -0,0 +1,55 @@
+#ifndef BENCHMARKREPORT_H
+#define BENCHMARKREPORT_H
+
+#include "framestatistics.h"
+
+#include <string>
+#include <utility>
+#include <vector>
+
+/* Distribution of a per-frame value over the frames of a benchmark run */
+struct BenchmarkDistribution {
+    unsigned count = 0; /* Frames the value was available for */
+    double mean = 0.0, min = 0.0, max = 0.0;
+    double p50 = 0.0, p95 = 0.0, p99 = 0.0;
+
+    /* Negative values (e.g. GPU times which never became available) are skipped */
+    static BenchmarkDistribution of(std::vector<double> values);
+};
+
+/* Summary of the frames of a benchmark run: the distributions of the frame
+ * time, of every CPU phase and GPU section, and of the per-frame counters */
+struct BenchmarkRun {
+    std::string name;
+    std::vector<std::pair<std::string, double>> parameters;
+
+    BenchmarkDistribution frameTime;
+    BenchmarkDistribution cpuTimes[N_FRAME_PHASES];
+    BenchmarkDistribution gpuTimes[N_GPU_SECTIONS];
+    BenchmarkDistribution visibleBlocks, drawCalls, triangles;
+};
+
+/* Report of a benchmark, i.e. of one or more runs of the same camera path
+ * with different parameters, written as JSON so that the results of
+ * different builds can be compared by scripts. Makes no OpenGL calls. */
+class BenchmarkReport {
+public:
+    /* Describes the whole benchmark, e.g. the heightmap or the GPU */
+    void info(const std::string& key, const std::string& value);
+    void info(const std::string& key, double value);
+
+    void addRun(const std::string& name, const std::vector<std::pair<std::string, double>>& parameters,
+        std::vector<FrameRecord>::const_iterator first, std::vector<FrameRecord>::const_iterator last);
+
+    /* Returns false if the file could not be written */
+    bool writeJson(const std::string& fileName) const;
+
+    /* Getters */
+    const std::vector<BenchmarkRun>& runs() const;
+
+private:
+    std::vector<std::pair<std::string, std::string>> _info; /* Values are JSON literals */
+    std::vector<BenchmarkRun> _runs;
+};
+
+#endif // BENCHMARKREPORT_H
@@ -39,20 +39,51 @@ void Camera::aspectRatio(float aspectRatio)
     _aspectRatio = aspectRatio;
 }
 
-bool Camera::insideViewFrustum(glm::vec3 p1, glm::vec3 p2)
+bool Camera::insideViewFrustum(const glm::vec3& p1, const glm::vec3& p2)
 {
-    // Frustum frustum = camera.viewFrustum();
-    Frustum frustum = _viewFrustum;
+    return (checkPlane(_viewFrustum.leftFace, p1, p2)
+        && checkPlane(_viewFrustum.rightFace, p1, p2)
+        && checkPlane(_viewFrustum.topFace, p1, p2)
+        && checkPlane(_viewFrustum.bottomFace, p1, p2)
+        && checkPlane(_viewFrustum.nearFace, p1, p2)
+        && checkPlane(_viewFrustum.farFace, p1, p2));
+}
+
+/* Unlike insideViewFrustum(), this also distinguishes between AABBs that are
+ * entirely inside the frustum and AABBs that only intersect it, and supports
+ * AABBs that are not square on the xz-plane. */
+FrustumIntersection Camera::intersectViewFrustum(const glm::vec3& p1, const glm::vec3& p2)
+{
+    const Plane* planes[] = { &_viewFrustum.leftFace, &_viewFrustum.rightFace,
+        &_viewFrustum.topFace, &_viewFrustum.bottomFace,
+        &_viewFrustum.nearFace, &_viewFrustum.farFace };
+
+    glm::vec3 aabbCenter = (p1 + p2) * 0.5f;
+    glm::vec3 extents = (p2 - p1) * 0.5f;
 
-    return (checkPlane(frustum.leftFace, p1, p2)
-        && checkPlane(frustum.rightFace, p1, p2)
-        && checkPlane(frustum.topFace, p1, p2)
-        && checkPlane(frustum.bottomFace, p1, p2)
-        && checkPlane(frustum.nearFace, p1, p2)
-        && checkPlane(frustum.farFace, p1, p2));
+    FrustumIntersection result = FrustumIntersection::INSIDE;
+
+    for (const Plane* plane : planes) {
+        float r = extents.x * std::abs(plane->normal.x)
+            + extents.y * std::abs(plane->normal.y)
+            + extents.z * std::abs(plane->normal.z);
+        float signedDistance = plane->getSignedDistanceToPlane(aabbCenter);
+
+        if (signedDistance < -r)
+            return FrustumIntersection::OUTSIDE;
+        if (signedDistance < r)
+            result = FrustumIntersection::INTERSECTING;
+    }
+
+    return result;
 }
 
-bool Camera::checkPlane(Plane& plane, glm::vec3 p1, glm::vec3 p2)
+FrustumCullResult Camera::intersectViewFrustum(const AabbArrays& aabbs, unsigned first, unsigned count)
+{
+    return FrustumCulling::cull(_frustumPlanes, aabbs, first, count);
+}
+
+bool Camera::checkPlane(const Plane& plane, const glm::vec3& p1, const glm::vec3& p2)
 {
     float minY = p1.y;
     float maxY = p2.y;
@@ -88,6 +119,11 @@ glm::vec3 Camera::position()
     return _position;
 }
 
+void Camera::position(glm::vec3 position)
+{
+    _position = position;
+}
+
 void Camera::yaw(float yaw)
 {
     _yaw = yaw;
@@ -166,6 +202,20 @@ void Camera::updateFrustum()
 
     _viewFrustum.bottomFace = { _position,
         glm::cross(frontMultFar + _up * halfVSide, _right) };
+
+    const Plane* planes[] = { &_viewFrustum.leftFace, &_viewFrustum.rightFace,
+        &_viewFrustum.topFace, &_viewFrustum.bottomFace,
+        &_viewFrustum.nearFace, &_viewFrustum.farFace };
+
+    for (unsigned i = 0; i < 6; i++) {
+        _frustumPlanes.normalX[i] = planes[i]->normal.x;
+        _frustumPlanes.normalY[i] = planes[i]->normal.y;
+        _frustumPlanes.normalZ[i] = planes[i]->normal.z;
+        _frustumPlanes.absNormalX[i] = std::abs(planes[i]->normal.x);
+        _frustumPlanes.absNormalY[i] = std::abs(planes[i]->normal.y);
+        _frustumPlanes.absNormalZ[i] = std::abs(planes[i]->normal.z);
+        _frustumPlanes.distance[i] = planes[i]->distance;
+    }
 }
 
 void Camera::updateCameraVectors()
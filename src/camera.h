@@ -1,7 +1,10 @@
 #ifndef CAMERA_H
 #define CAMERA_H
 
-#include <GL/glew.h>
+#include "frustumculling.h"
+
+#include <cmath>
+
 #include <glm/glm.hpp>
 #include <glm/gtc/matrix_transform.hpp>
 
@@ -68,6 +71,15 @@ struct Frustum {
     Plane nearFace;
 };
 
+/**
+ * @brief The result of an AABB-frustum intersection test
+ */
+enum class FrustumIntersection {
+    OUTSIDE,
+    INTERSECTING,
+    INSIDE
+};
+
 /* This class is based on the Camera class from learnopengl.com. */
 class Camera {
 public:
@@ -84,12 +96,17 @@ public:
 
     /* Setters */
     void aspectRatio(float aspectRatio);
+    void position(glm::vec3 position);
     void yaw(float yaw);
     void pitch(float pitch);
     void zoom(float zoom);
 
     /* Frustum culling */
-    bool insideViewFrustum(glm::vec3 p1, glm::vec3 p2);
+    bool insideViewFrustum(const glm::vec3& p1, const glm::vec3& p2);
+    FrustumIntersection intersectViewFrustum(const glm::vec3& p1, const glm::vec3& p2);
+
+    /* Batched frustum culling of up to FrustumCulling::BATCH_SIZE AABBs */
+    FrustumCullResult intersectViewFrustum(const AabbArrays& aabbs, unsigned first, unsigned count);
 
     /* Automatic flying and 360-look-around methods */
     void lerpFly(float lerpFactor);
@@ -109,9 +126,10 @@ public:
     void updateCameraVectors();
 
 private:
-    bool checkPlane(Plane& plane, glm::vec3 p1, glm::vec3 p2);
+    bool checkPlane(const Plane& plane, const glm::vec3& p1, const glm::vec3& p2);
 
     Frustum _viewFrustum;
+    FrustumPlanes _frustumPlanes; /* Same planes as _viewFrustum, for the batched tests */
     glm::vec3 _position;
     glm::vec3 _front;
     glm::vec3 _up;
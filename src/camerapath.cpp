@@ -0,0 +1,84 @@
+#include "camerapath.h"
+
+#include <algorithm>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+
+CameraPath::CameraPath()
+{
+}
+
+void CameraPath::load(const std::string& fileName)
+{
+    std::ifstream file(fileName);
+
+    if (!file.is_open()) {
+        std::cerr << "Failed to open camera path " << fileName << std::endl;
+        std::exit(1);
+    }
+
+    _keyframes.clear();
+
+    std::string line;
+    unsigned lineNumber = 0;
+    while (std::getline(file, line)) {
+        lineNumber++;
+
+        if (line.empty() || line[0] == '#')
+            continue;
+
+        std::istringstream stream(line);
+        CameraKeyframe keyframe;
+
+        if (!(stream >> keyframe.position.x >> keyframe.position.y >> keyframe.position.z >> keyframe.yaw >> keyframe.pitch)) {
+            std::cerr << "Invalid camera keyframe in " << fileName << " on line " << lineNumber << std::endl;
+            std::exit(1);
+        }
+
+        _keyframes.push_back(keyframe);
+    }
+
+    if (_keyframes.empty()) {
+        std::cerr << "Camera path " << fileName << " does not contain any keyframes" << std::endl;
+        std::exit(1);
+    }
+}
+
+void CameraPath::addKeyframe(const glm::vec3& position, float yaw, float pitch)
+{
+    _keyframes.push_back({ position, yaw, pitch });
+}
+
+void CameraPath::apply(Camera& camera, float t) const
+{
+    if (_keyframes.empty())
+        return;
+
+    t = std::min(std::max(t, 0.0f), 1.0f);
+
+    /* Find the two keyframes surrounding t */
+    float scaled = t * (_keyframes.size() - 1);
+    unsigned first = std::min((unsigned)scaled, (unsigned)_keyframes.size() - 1);
+    unsigned second = std::min(first + 1, (unsigned)_keyframes.size() - 1);
+    float lerpFactor = scaled - first;
+
+    const CameraKeyframe& a = _keyframes[first];
+    const CameraKeyframe& b = _keyframes[second];
+
+    camera.position(a.position + (b.position - a.position) * lerpFactor);
+    camera.yaw(a.yaw + (b.yaw - a.yaw) * lerpFactor);
+    camera.pitch(a.pitch + (b.pitch - a.pitch) * lerpFactor);
+    camera.updateCameraVectors();
+    camera.updateFrustum();
+}
+
+const std::vector<CameraKeyframe>& CameraPath::keyframes() const
+{
+    return _keyframes;
+}
+
+bool CameraPath::empty() const
+{
+    return _keyframes.empty();
+}
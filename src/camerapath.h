@@ -0,0 +1,39 @@
+#ifndef CAMERAPATH_H
+#define CAMERAPATH_H
+
+#include "camera.h"
+
+#include <string>
+#include <vector>
+
+struct CameraKeyframe {
+    glm::vec3 position;
+    float yaw;
+    float pitch;
+};
+
+/* A camera path is a list of keyframes, which are evenly distributed
+ * over the path and linearly interpolated.
+ *
+ * Camera path files are plain text files with one keyframe per line
+ * in the form "x y z yaw pitch". Empty lines and lines starting with '#'
+ * are ignored. */
+class CameraPath {
+public:
+    CameraPath();
+
+    void load(const std::string& fileName);
+    void addKeyframe(const glm::vec3& position, float yaw, float pitch);
+
+    /* Sets the camera to the interpolated keyframe at t in [0, 1] */
+    void apply(Camera& camera, float t) const;
+
+    /* Getters */
+    const std::vector<CameraKeyframe>& keyframes() const;
+    bool empty() const;
+
+private:
+    std::vector<CameraKeyframe> _keyframes;
+};
+
+#endif // CAMERAPATH_H
@@ -0,0 +1,239 @@
+#include "cbt.h"
+#include "../atlodutil.h"
+
+#include <algorithm>
+#include <chrono>
+
+Cbt::Cbt(Heightmap heightmap, float xzScale, float yScale, unsigned patchLevel, std::size_t memoryBudget)
+{
+    std::cout << "Initialize CBT" << std::endl;
+
+    if (patchLevel > 6) {
+        std::cerr << "Patch level must be at most 6" << std::endl;
+        std::exit(1);
+    }
+
+    _xzScale = xzScale;
+    _yScale = yScale;
+    _heightmap = heightmap;
+    _width = heightmap.width();
+    _height = heightmap.height();
+    _patchLevel = patchLevel;
+    _shader = Shader("../src/glsl/cbt.vert", "../src/glsl/geomipmapping.frag");
+
+    unsigned maxDepth = CbtPlanner::maxDepthFor(_width, _height, patchLevel, memoryBudget);
+    _planner = CbtPlanner(maxDepth, _width, _height, _xzScale);
+    _planner.patchLevel(patchLevel);
+
+    loadHeights();
+
+    std::cout << "CBT with maximum depth " << maxDepth << " (" << _planner.tree().memoryBytes() / 1024 << " KB)" << std::endl;
+
+    /* Set uniforms */
+    shader().use();
+    shader().setInt("texture1", 0);
+    shader().setInt("heightmapTexture", 1);
+    shader().setFloat("textureWidth", _heightmap.width());
+    shader().setFloat("textureHeight", _heightmap.height());
+}
+
+Cbt::~Cbt()
+{
+    std::cout << "CBT terrain destroyed" << std::endl;
+}
+
+void Cbt::render(Camera& camera)
+{
+    shader().use();
+    shader().setFloat("yScale", _yScale);
+
+    if (!_freezeCamera)
+        _lastCamera = camera;
+
+    _planner.update(_lastCamera, _yScale, _triangles);
+    _visibleBlocks = _triangles.size();
+    _drawCalls = _triangles.empty() ? 0 : 1;
+
+    glBindVertexArray(_vao);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, _ebo);
+
+    /* Apply overlay texture (if existent) */
+    if (_hasTexture) {
+        glActiveTexture(GL_TEXTURE0);
+        glBindTexture(GL_TEXTURE_2D, _textureId);
+        shader().setFloat("doTexture", 1.0f);
+    } else
+        shader().setFloat("doTexture", 0.0f);
+
+    /* Apply heightmap texture */
+    glActiveTexture(GL_TEXTURE1);
+    glBindTexture(GL_TEXTURE_2D, _heightmap.heightmapTextureId());
+
+    if (_triangles.empty())
+        return;
+
+    glBindBuffer(GL_ARRAY_BUFFER, _instanceVbo);
+    glBufferData(GL_ARRAY_BUFFER, _triangles.size() * sizeof(CbtTriangle), &_triangles[0], GL_STREAM_DRAW);
+
+    glDrawElementsInstanced(GL_TRIANGLES, _nPatchIndices, GL_UNSIGNED_INT, 0, _triangles.size());
+
+    AtlodUtil::checkGlError("CBT render failed");
+}
+
+void Cbt::loadHeights()
+{
+    auto start = std::chrono::steady_clock::now();
+    unsigned tileSize = CbtPlanner::HEIGHT_TILE_SIZE;
+
+    if (!_heightmap.tiled()) {
+        _planner.loadHeights(_heightmap.data(), _heightmap.width());
+    } else {
+        /* Only read the rows covered by a single row of height tiles at a time */
+        std::vector<unsigned short> strip((std::size_t)_heightmap.width() * (tileSize + 1));
+        unsigned nRows = (_heightmap.height() - 1 + tileSize - 1) / tileSize;
+
+        for (unsigned i = 0; i < nRows; i++) {
+            unsigned rows = std::min(tileSize + 1, _heightmap.height() - i * tileSize);
+            _heightmap.readRows(i * tileSize, rows, strip.data());
+            _planner.loadHeightRow(i, strip.data(), _heightmap.width());
+        }
+        _planner.endLoadHeights();
+    }
+
+    std::cout << "Loaded CBT height bounds in " << AtlodUtil::millisecondsSince(start) << " ms" << std::endl;
+}
+
+void Cbt::loadBuffers()
+{
+    auto start = std::chrono::steady_clock::now();
+    loadVertices();
+    loadIndices();
+    std::cout << "Loaded CBT buffers in " << AtlodUtil::millisecondsSince(start) << " ms" << std::endl;
+}
+
+void Cbt::loadVertices()
+{
+    unsigned n = 1u << _patchLevel;
+    std::vector<float> vertices;
+
+    /* Positions of a regular triangle grid inside a leaf, relative to its
+     * legs, the vertex shader moves them to the leaf triangle */
+    for (unsigned i = 0; i <= n; i++) {
+        for (unsigned j = 0; j <= n - i; j++) {
+            vertices.push_back((float)i / n); /* Weight of b */
+            vertices.push_back((float)j / n); /* Weight of c */
+        }
+    }
+
+    glGenVertexArrays(1, &_vao);
+    glBindVertexArray(_vao);
+
+    glGenBuffers(1, &_vbo);
+    glBindBuffer(GL_ARRAY_BUFFER, _vbo);
+    glBufferData(GL_ARRAY_BUFFER, vertices.size() * sizeof(float), &vertices[0], GL_STATIC_DRAW);
+
+    /* Weight attribute */
+    glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, 2 * sizeof(float), (void*)0);
+    glEnableVertexAttribArray(0);
+
+    /* Per-leaf attributes (the triangle vertices), advanced once per instance */
+    glGenBuffers(1, &_instanceVbo);
+    glBindBuffer(GL_ARRAY_BUFFER, _instanceVbo);
+    glVertexAttribPointer(1, 4, GL_FLOAT, GL_FALSE, sizeof(CbtTriangle), (void*)0);
+    glVertexAttribDivisor(1, 1);
+    glEnableVertexAttribArray(1);
+    glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, sizeof(CbtTriangle), (void*)(2 * sizeof(glm::vec2)));
+    glVertexAttribDivisor(2, 1);
+    glEnableVertexAttribArray(2);
+}
+
+/* The leaf triangles are oriented counterclockwise in (x, z), which is
+ * clockwise when seen from above, so the patch triangles are emitted in
+ * reverse order to be front facing */
+void Cbt::loadIndices()
+{
+    unsigned n = 1u << _patchLevel;
+    std::vector<unsigned> indices;
+
+    /* Index of the vertex with weights (i, j) / n */
+    auto vertex = [n](unsigned i, unsigned j) {
+        return i * (n + 1) - i * (i - 1) / 2 + j;
+    };
+
+    for (unsigned i = 0; i < n; i++) {
+        for (unsigned j = 0; j < n - i; j++) {
+            indices.push_back(vertex(i, j));
+            indices.push_back(vertex(i, j + 1));
+            indices.push_back(vertex(i + 1, j));
+
+            if (j + 1 < n - i) {
+                indices.push_back(vertex(i + 1, j));
+                indices.push_back(vertex(i, j + 1));
+                indices.push_back(vertex(i + 1, j + 1));
+            }
+        }
+    }
+    _nPatchIndices = indices.size();
+
+    std::cout << "Allocated number of indices: " << indices.size() << std::endl;
+
+    glGenBuffers(1, &_ebo);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, _ebo);
+    glBufferData(GL_ELEMENT_ARRAY_BUFFER, indices.size() * sizeof(unsigned), &indices[0], GL_STATIC_DRAW);
+}
+
+void Cbt::unloadBuffers()
+{
+    std::cout << "Unloading buffers" << std::endl;
+    glDeleteVertexArrays(1, &_vao);
+    glDeleteBuffers(1, &_vbo);
+    glDeleteBuffers(1, &_instanceVbo);
+    glDeleteBuffers(1, &_ebo);
+
+    AtlodUtil::checkGlError("CBT deletion failed");
+}
+
+unsigned Cbt::maxDepth()
+{
+    return _planner.tree().maxDepth();
+}
+
+unsigned Cbt::leafCount()
+{
+    return _planner.tree().leafCount();
+}
+
+unsigned Cbt::drawnTriangles()
+{
+    return _triangles.size() * (1u << (2 * _patchLevel));
+}
+
+std::size_t Cbt::memoryBytes()
+{
+    return _planner.tree().memoryBytes();
+}
+
+bool Cbt::freezeCamera()
+{
+    return _freezeCamera;
+}
+
+void Cbt::targetEdgeLength(float targetEdgeLength)
+{
+    _planner.targetEdgeLength(targetEdgeLength);
+}
+
+void Cbt::viewportHeight(unsigned viewportHeight)
+{
+    _planner.viewportHeight(viewportHeight);
+}
+
+void Cbt::freezeCamera(bool freezeCamera)
+{
+    _freezeCamera = freezeCamera;
+}
+
+void Cbt::frustumCullingActive(bool frustumCullingActive)
+{
+    _planner.frustumCullingActive(frustumCullingActive);
+}
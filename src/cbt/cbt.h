@@ -0,0 +1,68 @@
+#ifndef CBT_H
+#define CBT_H
+
+#include "../camera.h"
+#include "../terrain.h"
+#include "cbtplanner.h"
+
+#include <GL/glew.h>
+#include <GLFW/glfw3.h>
+
+#include <vector>
+
+/* Experimental adaptive tessellation with a concurrent binary tree
+ * (J. Dupuy, 2020).
+ *
+ * The subdivision itself (splits, merges and culling) is done on the CPU by
+ * the CbtPlanner, since OpenGL 3.3 has neither compute shaders nor the
+ * bit operations (findMSB) needed to decode the tree on the GPU. Each leaf
+ * triangle is uploaded as an instance and drawn as a patch of 4^patchLevel
+ * triangles, whose heights are sampled from the heightmap texture. */
+class Cbt : public Terrain {
+    static const unsigned DEFAULT_PATCH_LEVEL = 2;
+    static const std::size_t DEFAULT_MEMORY_BUDGET = 32 * 1024 * 1024;
+
+public:
+    /* The maximum depth of the tree is the deepest one fitting into the
+     * memory budget (in bytes) */
+    Cbt(Heightmap heightmap, float xzScale = 1.0f, float yScale = 1.0f, unsigned patchLevel = DEFAULT_PATCH_LEVEL, std::size_t memoryBudget = DEFAULT_MEMORY_BUDGET);
+    ~Cbt();
+
+    /* Overriden virtual methods */
+    void render(Camera& camera);
+    void loadBuffers();
+    void unloadBuffers();
+
+    /* Getters */
+    unsigned maxDepth();
+    unsigned leafCount();
+    unsigned drawnTriangles();
+    std::size_t memoryBytes();
+    bool freezeCamera();
+
+    /* Setters */
+    void targetEdgeLength(float targetEdgeLength);
+    void viewportHeight(unsigned viewportHeight);
+    void freezeCamera(bool freezeCamera);
+    void frustumCullingActive(bool frustumCullingActive);
+
+private:
+    void loadHeights();
+    void loadVertices();
+    void loadIndices();
+
+    CbtPlanner _planner;
+
+    /* Leaf triangles, reused every frame */
+    std::vector<CbtTriangle> _triangles;
+
+    Camera _lastCamera; /* Camera of the last unfrozen frame */
+
+    unsigned _patchLevel;
+    unsigned _nPatchIndices = 0;
+    bool _freezeCamera = false;
+
+    unsigned _vao, _vbo, _instanceVbo, _ebo;
+};
+
+#endif // CBT_H
@@ -0,0 +1,250 @@
+#include "cbtplanner.h"
+#include "leb.h"
+
+#include <algorithm>
+#include <cmath>
+
+CbtPlanner::CbtPlanner()
+    : _terrainWidth(0)
+    , _terrainHeight(0)
+    , _xzScale(1.0f)
+{
+}
+
+CbtPlanner::CbtPlanner(unsigned maxDepth, unsigned terrainWidth, unsigned terrainHeight, float xzScale)
+    : _tree(maxDepth)
+    , _heightBounds(terrainWidth, terrainHeight, HEIGHT_TILE_SIZE)
+    , _terrainWidth(terrainWidth)
+    , _terrainHeight(terrainHeight)
+    , _xzScale(xzScale)
+{
+    reset();
+}
+
+void CbtPlanner::loadHeights(const unsigned short* heights, unsigned rowLength)
+{
+    _heightBounds.loadHeights(heights, rowLength);
+}
+
+void CbtPlanner::loadHeightRow(unsigned row, const unsigned short* strip, unsigned rowLength)
+{
+    _heightBounds.loadRow(row, strip, rowLength);
+}
+
+void CbtPlanner::endLoadHeights()
+{
+    _heightBounds.endLoadHeights();
+}
+
+void CbtPlanner::update(Camera& camera, float yScale, std::vector<CbtTriangle>& triangles)
+{
+    _camera = &camera;
+    _cameraPosition = camera.position();
+    _selectYScale = yScale;
+    _pixelsPerUnit = _viewportHeight / (2.0f * std::tan(glm::radians(camera.zoom()) / 2.0f));
+    _splits = 0;
+    _merges = 0;
+
+    if (_frame++ % 2 == 0)
+        splitPass();
+    else
+        mergePass();
+
+    /* Draw the visible leaves */
+    _leaves.clear();
+    _tree.leaves(_leaves);
+    triangles.clear();
+
+    glm::vec2 scale((float)(_terrainWidth - 1), (float)(_terrainHeight - 1));
+
+    for (unsigned node : _leaves) {
+        if (_frustumCullingActive) {
+            glm::vec3 p1, p2;
+            nodeBounds(node, p1, p2);
+
+            if (camera.intersectViewFrustum(p1, p2) == FrustumIntersection::OUTSIDE)
+                continue;
+        }
+
+        CbtTriangle triangle;
+        Leb::decodeTriangle(node, triangle.a, triangle.b, triangle.c);
+        triangle.a *= scale;
+        triangle.b *= scale;
+        triangle.c *= scale;
+        triangles.push_back(triangle);
+    }
+
+    _camera = nullptr;
+}
+
+void CbtPlanner::reset()
+{
+    _tree.reset(1);
+    _frame = 0;
+}
+
+void CbtPlanner::splitPass()
+{
+    _leaves.clear();
+    _tree.leaves(_leaves);
+
+    for (unsigned node : _leaves) {
+        /* Might have been split by a neighbor already */
+        if (!_tree.isLeaf(node) || CbtTree::depth(node) >= _tree.maxDepth())
+            continue;
+
+        if (shouldSplit(node))
+            splitConforming(node);
+    }
+}
+
+/* Splits a node and its hypotenuse neighbor, so that no T-junctions occur.
+ * If the neighbor is coarser, its parent is split first (recursively). */
+void CbtPlanner::splitConforming(unsigned node)
+{
+    unsigned neighbor = Leb::decodeNeighbors(node).hypotenuse;
+
+    if (neighbor == 0) {
+        _tree.split(node);
+        _splits++;
+        return;
+    }
+
+    if (!_tree.isLeaf(neighbor)) {
+        /* In a conforming bisection, the neighbor is either a leaf or the
+         * child of a leaf */
+        if (!_tree.isLeaf(neighbor / 2))
+            return;
+
+        splitConforming(neighbor / 2);
+    }
+
+    _tree.split(node);
+    _tree.split(neighbor);
+    _splits += 2;
+}
+
+void CbtPlanner::mergePass()
+{
+    _leaves.clear();
+    _tree.leaves(_leaves);
+
+    for (unsigned node : _leaves) {
+        /* Only look at each pair of siblings once, never merge the two
+         * triangles of the square */
+        if ((node & 1) != 0 || CbtTree::depth(node) < 2)
+            continue;
+
+        unsigned parent = node / 2;
+
+        if (!_tree.isLeaf(node) || !_tree.isLeaf(node + 1) || shouldSplit(parent))
+            continue;
+
+        /* Both halves of the diamond have to be merged at once */
+        unsigned neighbor = Leb::decodeNeighbors(parent).hypotenuse;
+
+        if (neighbor != 0) {
+            if (!_tree.isLeaf(2 * neighbor) || !_tree.isLeaf(2 * neighbor + 1) || shouldSplit(neighbor))
+                continue;
+
+            _tree.merge(neighbor);
+            _merges++;
+        }
+
+        _tree.merge(parent);
+        _merges++;
+    }
+}
+
+/* Whether the hypotenuse of the node, divided into the 2^patchLevel edges
+ * of its patch, would be longer than the target edge length on screen.
+ * Nodes outside the view-frustum are never split. */
+bool CbtPlanner::shouldSplit(unsigned node)
+{
+    glm::vec3 p1, p2;
+    nodeBounds(node, p1, p2);
+
+    if (_frustumCullingActive && _camera->intersectViewFrustum(p1, p2) == FrustumIntersection::OUTSIDE)
+        return false;
+
+    glm::vec2 a, b, c;
+    Leb::decodeTriangle(node, a, b, c);
+    glm::vec2 hypotenuse = (c - a) * glm::vec2((float)(_terrainWidth - 1), (float)(_terrainHeight - 1)) * _xzScale;
+
+    glm::vec3 closest = glm::clamp(_cameraPosition, p1, p2) - _cameraPosition;
+    float distance = std::max(std::sqrt(glm::dot(closest, closest)), 1e-3f);
+
+    float edgeLength = glm::length(hypotenuse) / (float)(1u << _patchLevel);
+    return edgeLength * _pixelsPerUnit / distance > _targetEdgeLength;
+}
+
+/* World space AABB of a node */
+void CbtPlanner::nodeBounds(unsigned node, glm::vec3& p1, glm::vec3& p2)
+{
+    glm::vec2 a, b, c;
+    Leb::decodeTriangle(node, a, b, c);
+
+    glm::vec2 scale((float)(_terrainWidth - 1), (float)(_terrainHeight - 1));
+    glm::vec2 minimum = glm::min(glm::min(a, b), c) * scale;
+    glm::vec2 maximum = glm::max(glm::max(a, b), c) * scale;
+
+    unsigned short minHeight, maxHeight;
+    _heightBounds.bounds(minimum.x, minimum.y, maximum.x, maximum.y, minHeight, maxHeight);
+
+    float halfWidth = _terrainWidth / 2.0f, halfHeight = _terrainHeight / 2.0f;
+    p1 = glm::vec3((minimum.x - halfWidth) * _xzScale, minHeight * _selectYScale, (minimum.y - halfHeight) * _xzScale);
+    p2 = glm::vec3((maximum.x - halfWidth) * _xzScale, maxHeight * _selectYScale, (maximum.y - halfHeight) * _xzScale);
+}
+
+unsigned CbtPlanner::maxDepthFor(unsigned terrainWidth, unsigned terrainHeight, unsigned patchLevel, std::size_t memoryBudget)
+{
+    /* The legs of the triangles of depth d >= 1 are size / 2^((d - 1) / 2)
+     * samples long, stop once the edges of a patch are one sample long */
+    unsigned size = std::max(terrainWidth, terrainHeight) - 1;
+    unsigned log2Size = 0;
+    while ((1u << log2Size) < size)
+        log2Size++;
+
+    unsigned depth = 1 + 2 * (log2Size > patchLevel ? log2Size - patchLevel : 0);
+
+    /* 2^depth counts of 4 bytes plus 2^depth bits */
+    while (depth > 1 && ((std::size_t)1 << depth) * 33 / 8 > memoryBudget)
+        depth--;
+
+    return std::min(std::max(depth, 2u), 28u);
+}
+
+const CbtTree& CbtPlanner::tree() const
+{
+    return _tree;
+}
+
+unsigned CbtPlanner::splits() const
+{
+    return _splits;
+}
+
+unsigned CbtPlanner::merges() const
+{
+    return _merges;
+}
+
+void CbtPlanner::targetEdgeLength(float targetEdgeLength)
+{
+    _targetEdgeLength = targetEdgeLength;
+}
+
+void CbtPlanner::patchLevel(unsigned patchLevel)
+{
+    _patchLevel = patchLevel;
+}
+
+void CbtPlanner::viewportHeight(unsigned viewportHeight)
+{
+    _viewportHeight = viewportHeight;
+}
+
+void CbtPlanner::frustumCullingActive(bool frustumCullingActive)
+{
+    _frustumCullingActive = frustumCullingActive;
+}
@@ -0,0 +1,109 @@
+#ifndef CBTPLANNER_H
+#define CBTPLANNER_H
+
+#include "../camera.h"
+#include "../heightbounds.h"
+#include "cbttree.h"
+
+#include <vector>
+
+/* A leaf triangle in heightmap coordinates, with the same vertex order
+ * as Leb::decodeTriangle (right angle at b) */
+struct CbtTriangle {
+    glm::vec2 a, b, c;
+};
+
+/**
+ * @brief The CbtPlanner class
+ *
+ * Adaptive terrain tessellation with a concurrent binary tree (J. Dupuy,
+ * 2020). The terrain is covered by the longest edge bisection of a square,
+ * whose leaves are stored in a CbtTree of fixed maximum depth, so the
+ * memory does not depend on the view.
+ *
+ * Every frame, either all leaves are considered for splitting or all pairs
+ * of sibling leaves for merging (alternating, like the paper):
+ * - A visible leaf is split if its hypotenuse, drawn with 2^patchLevel
+ *   segments, would be longer than the target edge length in pixels
+ * - Two siblings are merged if their parent would not be split, or if the
+ *   parent is outside the view-frustum
+ * Splits keep the bisection conforming by first splitting the hypotenuse
+ * neighbor (recursively, if it is coarser), and merges always merge both
+ * halves of a diamond. Since the triangle density follows the projected
+ * edge length of each triangle instead of a per-block LOD, it changes
+ * continuously over the terrain.
+ *
+ * Like the planners of the other algorithms, this class does not make any
+ * OpenGL calls, so it also runs headlessly (e.g. in atlod_bench).
+ */
+class CbtPlanner {
+public:
+    CbtPlanner();
+    CbtPlanner(unsigned maxDepth, unsigned terrainWidth, unsigned terrainHeight, float xzScale);
+
+    /* Loads the min. and max. heights used for culling and distances */
+    void loadHeights(const unsigned short* heights, unsigned rowLength);
+
+    /* Same as above, but one row of height tiles at a time (for tiled
+     * heightmaps). Strip must contain the HEIGHT_TILE_SIZE + 1 rows
+     * starting at row * HEIGHT_TILE_SIZE (fewer for the last row of tiles).
+     * endLoadHeights() must be called after the last row. */
+    void loadHeightRow(unsigned row, const unsigned short* strip, unsigned rowLength);
+    void endLoadHeights();
+
+    /* Runs one split or merge pass and returns the leaf triangles */
+    void update(Camera& camera, float yScale, std::vector<CbtTriangle>& triangles);
+
+    /* Resets the tessellation to the two triangles of the square */
+    void reset();
+
+    /* Maximum depth with the given memory budget (in bytes), such that
+     * the finest triangles are not much smaller than a heightmap sample */
+    static unsigned maxDepthFor(unsigned terrainWidth, unsigned terrainHeight, unsigned patchLevel, std::size_t memoryBudget);
+
+    static const unsigned HEIGHT_TILE_SIZE = 16;
+
+    /* Getters */
+    const CbtTree& tree() const;
+    unsigned splits() const;
+    unsigned merges() const;
+
+    /* Setters */
+    void targetEdgeLength(float targetEdgeLength);
+    void patchLevel(unsigned patchLevel);
+    void viewportHeight(unsigned viewportHeight);
+    void frustumCullingActive(bool frustumCullingActive);
+
+private:
+    void splitPass();
+    void mergePass();
+    void splitConforming(unsigned node);
+    bool shouldSplit(unsigned node);
+    void nodeBounds(unsigned node, glm::vec3& p1, glm::vec3& p2);
+
+    CbtTree _tree;
+
+    HeightBounds _heightBounds;
+
+    /* Leaves of the last pass, reused every frame */
+    std::vector<unsigned> _leaves;
+
+    /* Camera state during update() */
+    Camera* _camera = nullptr;
+    glm::vec3 _cameraPosition;
+    float _selectYScale = 1.0f;
+    float _pixelsPerUnit = 1.0f; /* At a distance of 1 */
+
+    unsigned _terrainWidth, _terrainHeight;
+    float _xzScale;
+
+    float _targetEdgeLength = 8.0f; /* In pixels */
+    unsigned _patchLevel = 2;
+    unsigned _viewportHeight = 720;
+    bool _frustumCullingActive = true;
+
+    unsigned _frame = 0;
+    unsigned _splits = 0, _merges = 0; /* Of the last update() */
+};
+
+#endif // CBTPLANNER_H
@@ -0,0 +1,146 @@
+#include "cbttree.h"
+
+#include <algorithm>
+
+CbtTree::CbtTree()
+    : _maxDepth(0)
+{
+}
+
+CbtTree::CbtTree(unsigned maxDepth)
+    : _counts((std::size_t)1 << maxDepth, 0)
+    , _bits((((std::size_t)1 << maxDepth) + 63) / 64, 0)
+    , _maxDepth(maxDepth)
+{
+    reset(0);
+}
+
+void CbtTree::reset(unsigned depth)
+{
+    std::fill(_counts.begin(), _counts.end(), 0);
+    std::fill(_bits.begin(), _bits.end(), 0);
+
+    for (unsigned node = 1u << depth; node < 2u << depth; node++)
+        setBit(bitIndex(node), true);
+}
+
+void CbtTree::split(unsigned node)
+{
+    setBit(bitIndex(2 * node + 1), true);
+}
+
+void CbtTree::merge(unsigned node)
+{
+    setBit(bitIndex(2 * node + 1), false);
+}
+
+/* A node is a leaf if it has one leaf below it, which is not the leaf of
+ * an ancestor (whose bit is the leftmost bit of all its left descendants) */
+bool CbtTree::isLeaf(unsigned node) const
+{
+    if (count(node) != 1)
+        return false;
+
+    return node == 1 || count(node / 2) > 1;
+}
+
+unsigned CbtTree::leafCount() const
+{
+    return count(1);
+}
+
+unsigned CbtTree::count(unsigned node) const
+{
+    if (depth(node) < _maxDepth)
+        return _counts[node];
+
+    unsigned index = node - (1u << _maxDepth);
+    return (unsigned)(_bits[index / 64] >> (index % 64)) & 1;
+}
+
+unsigned CbtTree::decodeLeaf(unsigned leafIndex) const
+{
+    unsigned node = 1;
+
+    while (count(node) > 1) {
+        unsigned leftCount = count(2 * node);
+
+        if (leafIndex < leftCount) {
+            node = 2 * node;
+        } else {
+            leafIndex -= leftCount;
+            node = 2 * node + 1;
+        }
+    }
+
+    return node;
+}
+
+void CbtTree::leaves(std::vector<unsigned>& out) const
+{
+    _stack.clear();
+    _stack.push_back(1);
+
+    while (!_stack.empty()) {
+        unsigned node = _stack.back();
+        _stack.pop_back();
+
+        unsigned nodeCount = count(node);
+
+        if (nodeCount == 1) {
+            out.push_back(node);
+        } else if (nodeCount > 1) {
+            /* Right child first, so that the left one is visited first */
+            _stack.push_back(2 * node + 1);
+            _stack.push_back(2 * node);
+        }
+    }
+}
+
+unsigned CbtTree::depth(unsigned node)
+{
+    unsigned depth = 0;
+    while (node > 1) {
+        node >>= 1;
+        depth++;
+    }
+    return depth;
+}
+
+unsigned CbtTree::maxDepth() const
+{
+    return _maxDepth;
+}
+
+std::size_t CbtTree::memoryBytes() const
+{
+    return _counts.size() * sizeof(std::uint32_t) + _bits.size() * sizeof(std::uint64_t);
+}
+
+/* Index of the bit of the leftmost descendant at the maximum depth */
+unsigned CbtTree::bitIndex(unsigned node) const
+{
+    return (node << (_maxDepth - depth(node))) - (1u << _maxDepth);
+}
+
+void CbtTree::setBit(unsigned bitIndex, bool value)
+{
+    std::uint64_t mask = (std::uint64_t)1 << (bitIndex % 64);
+    bool current = (_bits[bitIndex / 64] & mask) != 0;
+
+    if (current == value)
+        return;
+
+    if (value)
+        _bits[bitIndex / 64] |= mask;
+    else
+        _bits[bitIndex / 64] &= ~mask;
+
+    /* Update the counts of all ancestors */
+    for (unsigned node = ((1u << _maxDepth) + bitIndex) / 2; node > 0; node /= 2) {
+        if (value)
+            _counts[node]++;
+        else
+            _counts[node]--;
+    }
+}
@@ -0,0 +1,81 @@
+#ifndef CBTTREE_H
+#define CBTTREE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/**
+ * @brief The CbtTree class
+ *
+ * A concurrent binary tree ("Concurrent Binary Trees (with application to
+ * Longest Edge Bisection)", J. Dupuy, 2020) of fixed maximum depth.
+ *
+ * The nodes are identified by their heap index (the root is 1, the
+ * children of node k are 2k and 2k + 1). The leaves of the tree are
+ * stored as a bitfield over the nodes of the maximum depth: a leaf sets
+ * the bit of its leftmost descendant at the maximum depth. On top of the
+ * bitfield, a sum-reduction tree stores the number of leaves below every
+ * node, so that leaf nodes are those whose count is 1:
+ *
+ *   depth 0            3
+ *                    /   \
+ *   depth 1         2     1
+ *                  / \   / \
+ *   depth 2       1   1 1   0   <- bitfield
+ *
+ * Splitting a leaf sets the bit of its right child, merging two sibling
+ * leaves clears it again, and both update the counts of the O(depth)
+ * ancestors of the bit. The memory is fixed by the maximum depth, i.e.
+ * 2^maxDepth bits plus 2^maxDepth counts, independent of the number of
+ * leaves.
+ *
+ * Unlike the GPU version of the paper, splits and merges are applied one
+ * after another on the CPU, so no parallel reduction pass is needed.
+ */
+class CbtTree {
+public:
+    CbtTree();
+    CbtTree(unsigned maxDepth);
+
+    /* Resets the tree to all nodes of the given depth */
+    void reset(unsigned depth);
+
+    /* Split requires a leaf above the maximum depth, merge requires both
+     * children of the node to be leaves */
+    void split(unsigned node);
+    void merge(unsigned node);
+
+    bool isLeaf(unsigned node) const;
+    unsigned leafCount() const;
+
+    /* Number of leaves below the given node */
+    unsigned count(unsigned node) const;
+
+    /* Heap index of the leaf with the given index (0 to leafCount() - 1),
+     * in the order of a depth-first traversal */
+    unsigned decodeLeaf(unsigned leafIndex) const;
+
+    /* Appends the heap indices of all leaves in depth-first order */
+    void leaves(std::vector<unsigned>& out) const;
+
+    static unsigned depth(unsigned node);
+
+    /* Getters */
+    unsigned maxDepth() const;
+    std::size_t memoryBytes() const;
+
+private:
+    unsigned bitIndex(unsigned node) const;
+    void setBit(unsigned bitIndex, bool value);
+
+    std::vector<std::uint32_t> _counts; /* Depths 0 to maxDepth - 1, by heap index */
+    std::vector<std::uint64_t> _bits; /* Depth maxDepth */
+
+    /* Traversal stack of leaves(), reused every frame */
+    mutable std::vector<unsigned> _stack;
+
+    unsigned _maxDepth;
+};
+
+#endif // CBTTREE_H
@@ -0,0 +1,89 @@
+#include "leb.h"
+
+namespace Leb {
+
+namespace {
+
+/* Index of the most significant bit, i.e. the depth of a node */
+unsigned depth(unsigned node)
+{
+    unsigned depth = 0;
+    while (node > 1) {
+        node >>= 1;
+        depth++;
+    }
+    return depth;
+}
+
+/* The children of a neighbor: 0 stays 0 (no neighbor) */
+unsigned child(unsigned node, unsigned bit)
+{
+    return node == 0 ? 0 : 2 * node + bit;
+}
+
+}
+
+void decodeTriangle(unsigned node, glm::vec2& a, glm::vec2& b, glm::vec2& c)
+{
+    unsigned nodeDepth = depth(node);
+
+    /* Triangle of depth 1 */
+    if ((node >> (nodeDepth - 1)) == 2) {
+        a = glm::vec2(0.0f, 0.0f);
+        b = glm::vec2(1.0f, 0.0f);
+        c = glm::vec2(1.0f, 1.0f);
+    } else {
+        a = glm::vec2(1.0f, 1.0f);
+        b = glm::vec2(0.0f, 1.0f);
+        c = glm::vec2(0.0f, 0.0f);
+    }
+
+    for (unsigned i = nodeDepth - 1; i-- > 0;) {
+        glm::vec2 m = (a + c) * 0.5f;
+
+        if (((node >> i) & 1) == 0) {
+            glm::vec2 oldA = a;
+            a = b;
+            b = m;
+            c = oldA;
+        } else {
+            a = c;
+            c = b;
+            b = m;
+        }
+    }
+}
+
+/**
+ * @brief decodeNeighbors
+ *
+ * Idea:
+ * - The two triangles of depth 1 are each other's hypotenuse neighbor
+ * - The children share their new leg with each other, and the other new
+ *   leg with a child of the hypotenuse neighbor
+ * - The hypotenuse of a child is a leg of its parent. Since a neighbor
+ *   across leg 1 always has the shared edge as its leg 2 (and vice versa),
+ *   the hypotenuse neighbor of child 0 is child 1 of the parent's leg 1
+ *   neighbor, and the one of child 1 is child 0 of the leg 2 neighbor
+ */
+LebNeighbors decodeNeighbors(unsigned node)
+{
+    unsigned nodeDepth = depth(node);
+    unsigned current = node >> (nodeDepth - 1);
+    LebNeighbors neighbors = { 0, 0, current == 2 ? 3u : 2u };
+
+    for (unsigned i = nodeDepth - 1; i-- > 0;) {
+        unsigned bit = (node >> i) & 1;
+
+        if (bit == 0)
+            neighbors = { 2 * current + 1, child(neighbors.hypotenuse, 1), child(neighbors.leg1, 1) };
+        else
+            neighbors = { child(neighbors.hypotenuse, 0), 2 * current, child(neighbors.leg2, 0) };
+
+        current = 2 * current + bit;
+    }
+
+    return neighbors;
+}
+
+}
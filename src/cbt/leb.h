@@ -0,0 +1,34 @@
+#ifndef LEB_H
+#define LEB_H
+
+#include <glm/glm.hpp>
+
+/* Heap indices of the neighbors of a node across its edges, 0 if the edge
+ * lies on the border of the square */
+struct LebNeighbors {
+    unsigned leg1, leg2, hypotenuse;
+};
+
+/* Longest edge bisection of the unit square, as used by the concurrent
+ * binary tree (J. Dupuy, 2020).
+ *
+ * Node 1 is the square, nodes 2 and 3 are the two triangles of its
+ * diagonal. A triangle (a, b, c) has its right angle at b, splitting it
+ * at the midpoint m of its hypotenuse c-a results in the children
+ * (b, m, a) (bit 0) and (c, m, b) (bit 1), which keep the winding of
+ * their parent. The legs of a triangle are a-b (leg 1) and b-c (leg 2).
+ *
+ * The triangle and the neighbors of a node are decoded from the bits of
+ * its heap index, from the most significant bit downwards, so neither
+ * requires any storage. */
+namespace Leb {
+
+/* Vertices of a node of depth >= 1 in the unit square */
+void decodeTriangle(unsigned node, glm::vec2& a, glm::vec2& b, glm::vec2& c);
+
+/* Neighbors of a node of depth >= 1 among the nodes of the same depth */
+LebNeighbors decodeNeighbors(unsigned node);
+
+}
+
+#endif // LEB_H
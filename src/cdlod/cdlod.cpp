@@ -0,0 +1,286 @@
+#include "cdlod.h"
+#include "../atlodutil.h"
+
+#include <chrono>
+#include <string>
+
+Cdlod::Cdlod(Heightmap heightmap, float xzScale, float yScale, unsigned leafSize)
+{
+    std::cout << "Initialize CDLOD" << std::endl;
+
+    /* Check whether leaf size is a power of 2 */
+    if (leafSize < 4 || (leafSize & (leafSize - 1)) != 0) {
+        std::cerr << "Leaf size must be a power of 2 and at least 4" << std::endl;
+        std::exit(1);
+    }
+
+    _xzScale = xzScale;
+    _yScale = yScale;
+    _heightmap = heightmap;
+    _width = heightmap.width();
+    _height = heightmap.height();
+    _shader = Shader("../src/glsl/cdlod.vert", "../src/glsl/geomipmapping.frag");
+
+    _quadTree = CdlodQuadTree(leafSize, _width, _height, _xzScale);
+
+    if (_quadTree.nLevels() > MAX_LEVELS) {
+        std::cerr << "Leaf size too small for the heightmap, the quadtree would have more than " << MAX_LEVELS << " levels" << std::endl;
+        std::exit(1);
+    }
+
+    loadHeights();
+
+    std::cout << "CDLOD quadtree with " << _quadTree.nLevels() << " levels and " << _quadTree.nNodes() << " nodes" << std::endl;
+
+    /* Set uniforms */
+    shader().use();
+    shader().setInt("texture1", 0);
+    shader().setInt("heightmapTexture", 1);
+    shader().setFloat("textureWidth", _heightmap.width());
+    shader().setFloat("textureHeight", _heightmap.height());
+}
+
+Cdlod::~Cdlod()
+{
+    std::cout << "CDLOD terrain destroyed" << std::endl;
+}
+
+void Cdlod::render(Camera& camera)
+{
+    shader().use();
+    shader().setFloat("yScale", _yScale);
+
+    glEnable(GL_PRIMITIVE_RESTART);
+    glPrimitiveRestartIndex(RESTART_INDEX);
+
+    if (!_freezeCamera)
+        _lastCamera = camera;
+
+    _quadTree.select(_lastCamera, _yScale, _selection);
+    _quadTree.batch(_selection, _instances, _batches);
+    _visibleBlocks = _selection.size();
+    _drawCalls = 0;
+
+    /* The morph ranges change with the LOD distance */
+    glm::vec2 morphRanges[MAX_LEVELS];
+    for (unsigned lod = 0; lod < _quadTree.nLevels(); lod++)
+        morphRanges[lod] = _quadTree.morphRange(lod);
+
+    shader().setVec2Array(shader().uniformLocation("morphRanges"), morphRanges, _quadTree.nLevels());
+
+    shader().setVec3("morphCameraPosition", _lastCamera.position());
+    shader().setFloat("morphActive", _morphActive ? 1.0f : 0.0f);
+
+    glBindVertexArray(_vao);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, _ebo);
+
+    /* Apply overlay texture (if existent) */
+    if (_hasTexture) {
+        glActiveTexture(GL_TEXTURE0);
+        glBindTexture(GL_TEXTURE_2D, _textureId);
+        shader().setFloat("doTexture", 1.0f);
+    } else
+        shader().setFloat("doTexture", 0.0f);
+
+    /* Apply heightmap texture */
+    glActiveTexture(GL_TEXTURE1);
+    glBindTexture(GL_TEXTURE_2D, _heightmap.heightmapTextureId());
+
+    if (_instances.empty())
+        return;
+
+    glBindBuffer(GL_ARRAY_BUFFER, _instanceVbo);
+    glBufferData(GL_ARRAY_BUFFER, _instances.size() * sizeof(CdlodInstance), &_instances[0], GL_STREAM_DRAW);
+
+    for (const CdlodDrawBatch& batch : _batches) {
+        /* There is no base instance in OpenGL 3.3, so point the instanced
+         * attribute to the first instance of the batch instead */
+        glVertexAttribPointer(1, 4, GL_FLOAT, GL_FALSE, sizeof(CdlodInstance),
+            (void*)(batch.firstInstance * sizeof(CdlodInstance)));
+
+        /* The quadrants are stored one after another, so every run of
+         * consecutive quadrants is a single draw */
+        unsigned quadrant = 0;
+        while (quadrant < 4) {
+            if (!(batch.quadrantMask & (1u << quadrant))) {
+                quadrant++;
+                continue;
+            }
+
+            unsigned first = quadrant;
+            while (quadrant < 4 && (batch.quadrantMask & (1u << quadrant)))
+                quadrant++;
+
+            glDrawElementsInstanced(GL_TRIANGLE_STRIP,
+                _quadrantStart[quadrant] - _quadrantStart[first],
+                GL_UNSIGNED_INT,
+                (void*)(_quadrantStart[first] * sizeof(unsigned)),
+                batch.instanceCount);
+            _drawCalls++;
+        }
+    }
+
+    AtlodUtil::checkGlError("CDLOD render failed");
+}
+
+void Cdlod::loadHeights()
+{
+    auto start = std::chrono::steady_clock::now();
+    unsigned leafSize = _quadTree.leafSize();
+
+    if (!_heightmap.tiled()) {
+        _quadTree.loadHeights(_heightmap.data(), _heightmap.width());
+    } else {
+        /* Only read the rows covered by a single row of leaves at a time */
+        std::vector<unsigned short> strip((std::size_t)_heightmap.width() * (leafSize + 1));
+        unsigned nRows = _quadTree.level(0).nNodesZ;
+
+        for (unsigned i = 0; i < nRows; i++) {
+            _heightmap.readRows(i * leafSize, leafSize + 1, strip.data());
+            _quadTree.loadLeafRow(i, strip.data(), _heightmap.width());
+        }
+        _quadTree.endLoadHeights();
+    }
+
+    std::cout << "Loaded CDLOD node heights in " << AtlodUtil::millisecondsSince(start) << " ms" << std::endl;
+}
+
+void Cdlod::loadBuffers()
+{
+    auto start = std::chrono::steady_clock::now();
+    loadVertices();
+    loadIndices();
+    std::cout << "Loaded CDLOD buffers in " << AtlodUtil::millisecondsSince(start) << " ms" << std::endl;
+}
+
+void Cdlod::loadVertices()
+{
+    unsigned size = _quadTree.leafSize() + 1;
+    std::vector<float> vertices;
+    vertices.reserve((std::size_t)size * size * 2);
+
+    /* Grid positions inside a node, the vertex shader translates and
+     * scales them to the node */
+    for (unsigned i = 0; i < size; i++) {
+        for (unsigned j = 0; j < size; j++) {
+            vertices.push_back(j); /* Position x */
+            vertices.push_back(i); /* Position z */
+        }
+    }
+
+    glGenVertexArrays(1, &_vao);
+    glBindVertexArray(_vao);
+
+    glGenBuffers(1, &_vbo);
+    glBindBuffer(GL_ARRAY_BUFFER, _vbo);
+    glBufferData(GL_ARRAY_BUFFER, vertices.size() * sizeof(float), &vertices[0], GL_STATIC_DRAW);
+
+    /* Position attribute */
+    glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, 2 * sizeof(float), (void*)0);
+    glEnableVertexAttribArray(0);
+
+    /* Per-node attribute (position, scale and LOD), advanced once per instance */
+    glGenBuffers(1, &_instanceVbo);
+    glBindBuffer(GL_ARRAY_BUFFER, _instanceVbo);
+    glVertexAttribPointer(1, 4, GL_FLOAT, GL_FALSE, sizeof(CdlodInstance), (void*)0);
+    glVertexAttribDivisor(1, 1);
+    glEnableVertexAttribArray(1);
+}
+
+/* Triangle strips of the four grid quadrants, ordered by quadrant
+ * x + 2 * quadrant z. The diagonals of the quads run in the same direction
+ * on every LOD, so a fully morphed grid matches the next coarser grid. */
+void Cdlod::loadIndices()
+{
+    unsigned leafSize = _quadTree.leafSize();
+    unsigned half = leafSize / 2;
+    std::vector<unsigned> indices;
+
+    for (unsigned quadrant = 0; quadrant < 4; quadrant++) {
+        unsigned x0 = (quadrant & 1) * half;
+        unsigned z0 = (quadrant >> 1) * half;
+
+        _quadrantStart[quadrant] = indices.size();
+
+        for (unsigned z = z0; z < z0 + half; z++) {
+            for (unsigned x = x0; x <= x0 + half; x++) {
+                indices.push_back(z * (leafSize + 1) + x);
+                indices.push_back((z + 1) * (leafSize + 1) + x);
+            }
+            indices.push_back(RESTART_INDEX);
+        }
+    }
+    _quadrantStart[4] = indices.size();
+
+    std::cout << "Allocated number of indices: " << indices.size() << std::endl;
+
+    glGenBuffers(1, &_ebo);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, _ebo);
+    glBufferData(GL_ELEMENT_ARRAY_BUFFER, indices.size() * sizeof(unsigned), &indices[0], GL_STATIC_DRAW);
+}
+
+void Cdlod::unloadBuffers()
+{
+    std::cout << "Unloading buffers" << std::endl;
+    glDeleteVertexArrays(1, &_vao);
+    glDeleteBuffers(1, &_vbo);
+    glDeleteBuffers(1, &_instanceVbo);
+    glDeleteBuffers(1, &_ebo);
+
+    AtlodUtil::checkGlError("CDLOD deletion failed");
+}
+
+unsigned Cdlod::leafSize()
+{
+    return _quadTree.leafSize();
+}
+
+unsigned Cdlod::nLevels()
+{
+    return _quadTree.nLevels();
+}
+
+unsigned Cdlod::selectedNodes()
+{
+    return _selection.size();
+}
+
+float Cdlod::lodDistance()
+{
+    return _quadTree.lodDistance();
+}
+
+float Cdlod::minLodDistance()
+{
+    return _quadTree.minLodDistance();
+}
+
+bool Cdlod::freezeCamera()
+{
+    return _freezeCamera;
+}
+
+bool Cdlod::morphActive()
+{
+    return _morphActive;
+}
+
+void Cdlod::lodDistance(float lodDistance)
+{
+    _quadTree.lodDistance(lodDistance);
+}
+
+void Cdlod::freezeCamera(bool freezeCamera)
+{
+    _freezeCamera = freezeCamera;
+}
+
+void Cdlod::morphActive(bool morphActive)
+{
+    _morphActive = morphActive;
+}
+
+void Cdlod::frustumCullingActive(bool frustumCullingActive)
+{
+    _quadTree.frustumCullingActive(frustumCullingActive);
+}
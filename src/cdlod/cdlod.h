@@ -0,0 +1,76 @@
+#ifndef CDLOD_H
+#define CDLOD_H
+
+#include "../camera.h"
+#include "../terrain.h"
+#include "cdlodquadtree.h"
+
+#include <GL/glew.h>
+#include <GLFW/glfw3.h>
+
+#include <vector>
+
+/* Continuous distance-dependent level of detail (F. Strugar, 2010).
+ *
+ * The nodes selected by the CdlodQuadTree are all drawn with the same
+ * (leafSize + 1) x (leafSize + 1) grid mesh, scaled to the node size.
+ * The heights are sampled from the heightmap texture, and every vertex is
+ * smoothly morphed onto the grid of the next coarser LOD as the camera
+ * distance approaches the end of the node's range. This removes popping,
+ * and since neighbouring nodes always match up, no border permutations
+ * (as in GeoMipMapping) are needed: the index buffer only contains the
+ * four quadrants of the grid. */
+class Cdlod : public Terrain {
+    static const unsigned DEFAULT_LEAF_SIZE = 32;
+    static const unsigned MAX_LEVELS = 24; /* Size of the morph range array in the vertex shader */
+
+public:
+    /* Leaf size must be a power of 2 */
+    Cdlod(Heightmap heightmap, float xzScale = 1.0f, float yScale = 1.0f, unsigned leafSize = DEFAULT_LEAF_SIZE);
+    ~Cdlod();
+
+    /* Overriden virtual methods */
+    void render(Camera& camera);
+    void loadBuffers();
+    void unloadBuffers();
+
+    /* Getters */
+    unsigned leafSize();
+    unsigned nLevels();
+    unsigned selectedNodes();
+    float lodDistance();
+    float minLodDistance();
+    bool freezeCamera();
+    bool morphActive();
+
+    /* Setters */
+    void lodDistance(float lodDistance);
+    void freezeCamera(bool freezeCamera);
+    void morphActive(bool morphActive);
+    void frustumCullingActive(bool frustumCullingActive);
+
+private:
+    void loadHeights();
+    void loadVertices();
+    void loadIndices();
+
+    CdlodQuadTree _quadTree;
+
+    /* Selected nodes and their instances, reused every frame */
+    std::vector<CdlodNode> _selection;
+    std::vector<CdlodInstance> _instances;
+    std::vector<CdlodDrawBatch> _batches;
+
+    /* Index range of each grid quadrant, quadrant q spans _quadrantStart[q]
+     * to _quadrantStart[q + 1] */
+    unsigned _quadrantStart[5];
+
+    Camera _lastCamera; /* Camera of the last unfrozen frame */
+
+    bool _freezeCamera = false;
+    bool _morphActive = true;
+
+    unsigned _vao, _vbo, _instanceVbo, _ebo;
+};
+
+#endif // CDLOD_H
@@ -0,0 +1,317 @@
+#include "cdlodquadtree.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+CdlodQuadTree::CdlodQuadTree()
+    : _leafSize(0)
+    , _terrainWidth(0)
+    , _terrainHeight(0)
+    , _xzScale(1.0f)
+    , _lodDistance(0.0f)
+{
+}
+
+CdlodQuadTree::CdlodQuadTree(unsigned leafSize, unsigned terrainWidth, unsigned terrainHeight, float xzScale)
+    : _leafSize(leafSize)
+    , _terrainWidth(terrainWidth)
+    , _terrainHeight(terrainHeight)
+    , _xzScale(xzScale)
+{
+    /* Add levels until a single node covers the terrain on both axes */
+    unsigned nNodesX = (terrainWidth - 1 + leafSize - 1) / leafSize;
+    unsigned nNodesZ = (terrainHeight - 1 + leafSize - 1) / leafSize;
+    unsigned nodeSize = leafSize;
+
+    while (true) {
+        CdlodLevel level;
+        level.nNodesX = nNodesX;
+        level.nNodesZ = nNodesZ;
+        level.nodeSize = nodeSize;
+        level.minHeights.assign((std::size_t)nNodesX * nNodesZ, 0);
+        level.maxHeights.assign((std::size_t)nNodesX * nNodesZ, 0);
+        _levels.push_back(std::move(level));
+
+        if (nNodesX == 1 && nNodesZ == 1)
+            break;
+
+        nNodesX = (nNodesX + 1) / 2;
+        nNodesZ = (nNodesZ + 1) / 2;
+        nodeSize *= 2;
+    }
+
+    _lodDistance = 2.0f * minLodDistance();
+    updateRanges();
+}
+
+void CdlodQuadTree::loadHeights(const unsigned short* heights, unsigned rowLength)
+{
+    for (unsigned row = 0; row < _levels[0].nNodesZ; row++)
+        loadLeafRow(row, heights + (std::size_t)row * _leafSize * rowLength, rowLength);
+    endLoadHeights();
+}
+
+void CdlodQuadTree::loadLeafRow(unsigned row, const unsigned short* strip, unsigned rowLength)
+{
+    CdlodLevel& leaves = _levels[0];
+    unsigned nRows = std::min(_leafSize, _terrainHeight - 1 - row * _leafSize) + 1;
+
+    for (unsigned x = 0; x < leaves.nNodesX; x++) {
+        unsigned firstColumn = x * _leafSize;
+        unsigned lastColumn = std::min(firstColumn + _leafSize, _terrainWidth - 1);
+
+        unsigned short minHeight = std::numeric_limits<unsigned short>::max();
+        unsigned short maxHeight = 0;
+
+        for (unsigned i = 0; i < nRows; i++) {
+            const unsigned short* heights = strip + (std::size_t)i * rowLength;
+
+            for (unsigned j = firstColumn; j <= lastColumn; j++) {
+                minHeight = std::min(minHeight, heights[j]);
+                maxHeight = std::max(maxHeight, heights[j]);
+            }
+        }
+
+        leaves.minHeights[(std::size_t)row * leaves.nNodesX + x] = minHeight;
+        leaves.maxHeights[(std::size_t)row * leaves.nNodesX + x] = maxHeight;
+    }
+}
+
+/* Combines the heights of the (up to four) children of every node */
+void CdlodQuadTree::endLoadHeights()
+{
+    for (unsigned l = 1; l < _levels.size(); l++) {
+        const CdlodLevel& children = _levels[l - 1];
+        CdlodLevel& level = _levels[l];
+
+        for (unsigned z = 0; z < level.nNodesZ; z++) {
+            for (unsigned x = 0; x < level.nNodesX; x++) {
+                unsigned short minHeight = std::numeric_limits<unsigned short>::max();
+                unsigned short maxHeight = 0;
+
+                for (unsigned childZ = 2 * z; childZ < std::min(2 * z + 2, children.nNodesZ); childZ++) {
+                    for (unsigned childX = 2 * x; childX < std::min(2 * x + 2, children.nNodesX); childX++) {
+                        std::size_t child = (std::size_t)childZ * children.nNodesX + childX;
+                        minHeight = std::min(minHeight, children.minHeights[child]);
+                        maxHeight = std::max(maxHeight, children.maxHeights[child]);
+                    }
+                }
+
+                level.minHeights[(std::size_t)z * level.nNodesX + x] = minHeight;
+                level.maxHeights[(std::size_t)z * level.nNodesX + x] = maxHeight;
+            }
+        }
+    }
+}
+
+/**
+ * @brief CdlodQuadTree::select
+ *
+ * Idea (Strugar, Algorithm 1):
+ * - Start with every node of the coarsest level, which has an infinite
+ *   range so that the whole terrain is always covered
+ * - Skip nodes outside the view-frustum, nodes entirely inside do not
+ *   test their children
+ * - Select a node as a whole if it is a leaf or if it does not intersect
+ *   the range of the next finer level
+ * - Otherwise, visit the children and draw the quadrants of the children
+ *   that are outside their own range at the LOD of this node
+ */
+void CdlodQuadTree::select(Camera& camera, float yScale, std::vector<CdlodNode>& selection)
+{
+    selection.clear();
+
+    _camera = &camera;
+    _cameraPosition = camera.position();
+    _selectYScale = yScale;
+
+    unsigned top = _levels.size() - 1;
+    for (unsigned z = 0; z < _levels[top].nNodesZ; z++)
+        for (unsigned x = 0; x < _levels[top].nNodesX; x++)
+            selectNode(top, x, z, false, selection);
+
+    _camera = nullptr;
+}
+
+/* Returns false if the node is outside its range, i.e. it has to be
+ * covered by its parent */
+bool CdlodQuadTree::selectNode(unsigned lod, unsigned x, unsigned z, bool parentInside, std::vector<CdlodNode>& selection)
+{
+    const CdlodLevel& level = _levels[lod];
+    std::size_t nodeId = (std::size_t)z * level.nNodesX + x;
+
+    unsigned nodeX = x * level.nodeSize;
+    unsigned nodeZ = z * level.nodeSize;
+
+    /* World space AABB, clamped to the terrain */
+    float halfWidth = _terrainWidth / 2.0f, halfHeight = _terrainHeight / 2.0f;
+    glm::vec3 p1((nodeX - halfWidth) * _xzScale,
+        level.minHeights[nodeId] * _selectYScale,
+        (nodeZ - halfHeight) * _xzScale);
+    glm::vec3 p2((std::min(nodeX + level.nodeSize, _terrainWidth - 1) - halfWidth) * _xzScale,
+        level.maxHeights[nodeId] * _selectYScale,
+        (std::min(nodeZ + level.nodeSize, _terrainHeight - 1) - halfHeight) * _xzScale);
+
+    /* Squared distance between the camera and the closest point of the AABB */
+    glm::vec3 closest = glm::clamp(_cameraPosition, p1, p2) - _cameraPosition;
+    float squaredDistance = glm::dot(closest, closest);
+
+    if (squaredDistance > _ranges[lod] * _ranges[lod])
+        return false;
+
+    bool inside = parentInside || !_frustumCullingActive;
+    if (!inside) {
+        FrustumIntersection intersection = _camera->intersectViewFrustum(p1, p2);
+
+        /* Culled, but handled */
+        if (intersection == FrustumIntersection::OUTSIDE)
+            return true;
+
+        inside = intersection == FrustumIntersection::INSIDE;
+    }
+
+    unsigned quadrants = childMask(lod, x, z);
+
+    if (lod == 0 || squaredDistance > _ranges[lod - 1] * _ranges[lod - 1]) {
+        selection.push_back({ nodeX, nodeZ, level.nodeSize, lod, quadrants });
+        return true;
+    }
+
+    unsigned quadrantMask = 0;
+
+    for (unsigned quadrant = 0; quadrant < 4; quadrant++) {
+        if (!(quadrants & (1u << quadrant)))
+            continue;
+
+        unsigned childX = 2 * x + (quadrant & 1);
+        unsigned childZ = 2 * z + (quadrant >> 1);
+
+        if (!selectNode(lod - 1, childX, childZ, inside, selection))
+            quadrantMask |= 1u << quadrant;
+    }
+
+    if (quadrantMask != 0)
+        selection.push_back({ nodeX, nodeZ, level.nodeSize, lod, quadrantMask });
+
+    return true;
+}
+
+/* Mask of the quadrants of a node that lie inside the terrain. Leaves
+ * always draw all quadrants, the vertex shader clamps them to the terrain. */
+unsigned CdlodQuadTree::childMask(unsigned lod, unsigned x, unsigned z) const
+{
+    if (lod == 0)
+        return 0xF;
+
+    const CdlodLevel& children = _levels[lod - 1];
+    unsigned mask = 0;
+
+    for (unsigned quadrant = 0; quadrant < 4; quadrant++) {
+        unsigned childX = 2 * x + (quadrant & 1);
+        unsigned childZ = 2 * z + (quadrant >> 1);
+
+        if (childX < children.nNodesX && childZ < children.nNodesZ)
+            mask |= 1u << quadrant;
+    }
+
+    return mask;
+}
+
+/* Sorts the nodes into one group per quadrant mask (counting sort) */
+void CdlodQuadTree::batch(const std::vector<CdlodNode>& selection, std::vector<CdlodInstance>& instances, std::vector<CdlodDrawBatch>& batches)
+{
+    _batchOffsets.assign(17, 0);
+
+    for (const CdlodNode& node : selection)
+        _batchOffsets[node.quadrantMask + 1]++;
+
+    for (unsigned i = 1; i < _batchOffsets.size(); i++)
+        _batchOffsets[i] += _batchOffsets[i - 1];
+
+    batches.clear();
+    for (unsigned mask = 1; mask < 16; mask++) {
+        unsigned count = _batchOffsets[mask + 1] - _batchOffsets[mask];
+        if (count > 0)
+            batches.push_back({ mask, _batchOffsets[mask], count });
+    }
+
+    instances.resize(selection.size());
+    for (const CdlodNode& node : selection) {
+        float scale = (float)node.size / (float)_leafSize;
+        instances[_batchOffsets[node.quadrantMask]++] = { (float)node.x, (float)node.z, scale, (float)node.lod };
+    }
+}
+
+void CdlodQuadTree::updateRanges()
+{
+    _ranges.resize(_levels.size());
+
+    for (unsigned l = 0; l < _levels.size(); l++)
+        _ranges[l] = std::ldexp(_lodDistance, l);
+
+    /* The coarsest level covers the whole terrain */
+    _ranges.back() = std::numeric_limits<float>::max();
+}
+
+glm::vec2 CdlodQuadTree::morphRange(unsigned lod) const
+{
+    if (lod + 1 >= _levels.size())
+        return glm::vec2(1e30f, 2e30f);
+
+    float previousRange = lod == 0 ? 0.0f : _ranges[lod - 1];
+    float end = _ranges[lod];
+    return glm::vec2(previousRange + (end - previousRange) * MORPH_START_RATIO, end);
+}
+
+/* The geometry of a LOD reaches up to one node diagonal beyond its range,
+ * where the next coarser LOD must not have started morphing yet:
+ * range * MORPH_START_RATIO >= sqrt(2) * node size, plus some room for
+ * the height differences within a node */
+float CdlodQuadTree::minLodDistance() const
+{
+    return 2.5f * _leafSize * _xzScale;
+}
+
+unsigned CdlodQuadTree::leafSize() const
+{
+    return _leafSize;
+}
+
+unsigned CdlodQuadTree::nLevels() const
+{
+    return _levels.size();
+}
+
+unsigned CdlodQuadTree::nNodes() const
+{
+    unsigned nNodes = 0;
+    for (const CdlodLevel& level : _levels)
+        nNodes += level.nNodesX * level.nNodesZ;
+    return nNodes;
+}
+
+float CdlodQuadTree::lodDistance() const
+{
+    return _lodDistance;
+}
+
+const CdlodLevel& CdlodQuadTree::level(unsigned level) const
+{
+    return _levels[level];
+}
+
+void CdlodQuadTree::lodDistance(float lodDistance)
+{
+    float clamped = std::max(lodDistance, minLodDistance());
+
+    if (clamped != _lodDistance) {
+        _lodDistance = clamped;
+        updateRanges();
+    }
+}
+
+void CdlodQuadTree::frustumCullingActive(bool frustumCullingActive)
+{
+    _frustumCullingActive = frustumCullingActive;
+}
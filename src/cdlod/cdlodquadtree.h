@@ -0,0 +1,138 @@
+#ifndef CDLODQUADTREE_H
+#define CDLODQUADTREE_H
+
+#include "../camera.h"
+
+#include <vector>
+
+/* A node selected for drawing. The node covers the heightmap samples
+ * x to x + size (and the same for z) and is drawn with the shared grid
+ * mesh scaled by size / leafSize. Only the quadrants whose bit
+ * (quadrant x + 2 * quadrant z) is set in quadrantMask are drawn, the
+ * other ones are covered by finer nodes (or lie outside the terrain). */
+struct CdlodNode {
+    unsigned x, z;
+    unsigned size;
+    unsigned lod;
+    unsigned quadrantMask;
+};
+
+/* Per-instance data of the shared grid mesh: node position, scale (in
+ * heightmap samples per grid cell) and LOD */
+struct CdlodInstance {
+    float x, z;
+    float scale;
+    float lod;
+};
+
+/* A single instanced draw: the quadrants in quadrantMask are drawn once for
+ * each of the instanceCount consecutive instances starting at firstInstance */
+struct CdlodDrawBatch {
+    unsigned quadrantMask;
+    unsigned firstInstance, instanceCount;
+};
+
+/* Per-level node grid, level 0 contains the leaves */
+struct CdlodLevel {
+    unsigned nNodesX, nNodesZ;
+    unsigned nodeSize; /* In heightmap samples, leafSize * 2^level */
+
+    /* Min. and max. height value of each node, row by row */
+    std::vector<unsigned short> minHeights, maxHeights;
+};
+
+/**
+ * @brief The CdlodQuadTree class
+ *
+ * Quadtree node selection of "Continuous Distance-Dependent Level of Detail
+ * for Rendering Heightmaps" (F. Strugar, 2010).
+ *
+ * Every level l of the quadtree has a distance range of lodDistance * 2^l.
+ * A node is selected as a whole if it is outside the range of the next
+ * finer level, otherwise its children are visited. Children that lie
+ * outside their own range are drawn as a quadrant of the parent instead,
+ * so every part of the terrain is covered exactly once:
+ *
+ *   *- - - - - - -*- - -*- - -*
+ *   |             |     |     |
+ *   |   parent    *- - -*- - -*
+ *   |  quadrant   |   child   |
+ *   *- - - - - - -*- - - - - -*
+ *
+ * The selected nodes are morphed towards the next coarser level in the
+ * vertex shader, starting at MORPH_START_RATIO of their range. Since each
+ * node is fully morphed at the end of its range, neighbouring nodes of
+ * different levels always match up and neither popping nor cracks occur.
+ *
+ * The min. and max. height of every node are kept in a separate grid per
+ * level, which is all the memory the quadtree needs. Like the planners of
+ * the other algorithms, this class does not make any OpenGL calls.
+ */
+class CdlodQuadTree {
+public:
+    static constexpr float MORPH_START_RATIO = 0.66f;
+
+    CdlodQuadTree();
+
+    /* Leaf size must be a power of 2 */
+    CdlodQuadTree(unsigned leafSize, unsigned terrainWidth, unsigned terrainHeight, float xzScale);
+
+    /* Loads the min. and max. heights of all nodes from the whole heightmap */
+    void loadHeights(const unsigned short* heights, unsigned rowLength);
+
+    /* Same as above, but one row of leaves at a time (for tiled heightmaps).
+     * Strip must contain the leafSize + 1 rows starting at row * leafSize
+     * (fewer for the last row of leaves). endLoadHeights() must be called
+     * after the last row. */
+    void loadLeafRow(unsigned row, const unsigned short* strip, unsigned rowLength);
+    void endLoadHeights();
+
+    /* Selects the nodes to draw for the given camera */
+    void select(Camera& camera, float yScale, std::vector<CdlodNode>& selection);
+
+    /* Groups the selected nodes by quadrant mask */
+    void batch(const std::vector<CdlodNode>& selection, std::vector<CdlodInstance>& instances, std::vector<CdlodDrawBatch>& batches);
+
+    /* Distance at which the given LOD starts and ends morphing to the next
+     * coarser LOD (never for the coarsest LOD) */
+    glm::vec2 morphRange(unsigned lod) const;
+
+    /* Getters */
+    unsigned leafSize() const;
+    unsigned nLevels() const;
+    unsigned nNodes() const;
+    float lodDistance() const;
+    const CdlodLevel& level(unsigned level) const;
+
+    /* Setters */
+    void lodDistance(float lodDistance); /* Clamped to minLodDistance() */
+    void frustumCullingActive(bool frustumCullingActive);
+
+    /* Smallest LOD distance for which neighbouring nodes never differ by
+     * more than one LOD */
+    float minLodDistance() const;
+
+private:
+    bool selectNode(unsigned lod, unsigned x, unsigned z, bool parentInside, std::vector<CdlodNode>& selection);
+    void updateRanges();
+    unsigned childMask(unsigned lod, unsigned x, unsigned z) const;
+
+    std::vector<CdlodLevel> _levels;
+    std::vector<float> _ranges; /* Distance range of each level */
+
+    /* Camera state during select() */
+    Camera* _camera = nullptr;
+    glm::vec3 _cameraPosition;
+    float _selectYScale = 1.0f;
+
+    /* Counting sort buckets of batch(), reused every frame */
+    std::vector<unsigned> _batchOffsets;
+
+    unsigned _leafSize;
+    unsigned _terrainWidth, _terrainHeight;
+    float _xzScale;
+    float _lodDistance;
+    bool _frustumCullingActive = true;
+};
+
+#endif // CDLODQUADTREE_H
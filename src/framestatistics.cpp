@@ -0,0 +1,122 @@
+#include "framestatistics.h"
+
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+
+namespace {
+
+/* About 60 MB of records, the older half is dropped once it is reached */
+const std::size_t MAX_RECORDS = 1 << 20;
+
+}
+
+ScopedCpuTimer::ScopedCpuTimer(FrameRecord& record, FramePhase phase)
+    : _milliseconds(record.cpuTimes[phase])
+    , _start(std::chrono::steady_clock::now())
+{
+}
+
+ScopedCpuTimer::~ScopedCpuTimer()
+{
+    _milliseconds += std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - _start).count();
+}
+
+FrameStatistics::FrameStatistics(unsigned windowSize)
+    : _windowSize(std::max(windowSize, 1u))
+{
+}
+
+FrameRecord& FrameStatistics::beginFrame(float frameTime)
+{
+    if (_records.size() == MAX_RECORDS)
+        _records.erase(_records.begin(), _records.begin() + MAX_RECORDS / 2);
+
+    _records.emplace_back();
+    _records.back().number = _nextNumber++;
+    _records.back().frameTime = frameTime;
+
+    return _records.back();
+}
+
+FrameRecord* FrameStatistics::record(unsigned long long number)
+{
+    if (_records.empty() || number < _records.front().number || number > _records.back().number)
+        return nullptr;
+
+    return &_records[number - _records.front().number];
+}
+
+/* Nearest-rank percentile of the frame times in the window */
+float FrameStatistics::frameTimePercentile(float p)
+{
+    if (_records.empty())
+        return 0.0f;
+
+    std::size_t n = std::min<std::size_t>(_records.size(), _windowSize);
+
+    _sortedWindow.clear();
+    for (std::size_t i = _records.size() - n; i < _records.size(); i++)
+        _sortedWindow.push_back(_records[i].frameTime);
+
+    std::size_t rank = (std::size_t)std::ceil(std::clamp(p, 0.0f, 100.0f) / 100.0f * n);
+    std::size_t index = rank > 0 ? rank - 1 : 0;
+
+    std::nth_element(_sortedWindow.begin(), _sortedWindow.begin() + index, _sortedWindow.end());
+    return _sortedWindow[index];
+}
+
+void FrameStatistics::clear()
+{
+    _records.clear();
+}
+
+const std::vector<FrameRecord>& FrameStatistics::records() const
+{
+    return _records;
+}
+
+bool FrameStatistics::writeCsv(const std::string& fileName) const
+{
+    std::ofstream file(fileName);
+    if (!file)
+        return false;
+
+    file << "frame,frame_ms";
+    for (const char* name : FRAME_PHASE_NAMES)
+        file << ",cpu_" << name << "_ms";
+    for (const char* name : GPU_SECTION_NAMES)
+        file << ",gpu_" << name << "_ms";
+    file << ",visible_blocks,draw_calls,triangles\n";
+
+    /* GPU values which never became available are left empty */
+    for (const FrameRecord& record : _records) {
+        file << record.number << ',' << record.frameTime;
+
+        for (float time : record.cpuTimes)
+            file << ',' << time;
+
+        for (float time : record.gpuTimes) {
+            file << ',';
+            if (time >= 0.0f)
+                file << time;
+        }
+
+        file << ',' << record.visibleBlocks << ',' << record.drawCalls << ',';
+        if (record.triangles >= 0)
+            file << record.triangles;
+        file << '\n';
+    }
+
+    return (bool)file;
+}
+
+unsigned FrameStatistics::windowSize()
+{
+    return _windowSize;
+}
+
+unsigned long long FrameStatistics::nFrames()
+{
+    return _records.size();
+}
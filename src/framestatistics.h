@@ -0,0 +1,100 @@
+#ifndef FRAMESTATISTICS_H
+#define FRAMESTATISTICS_H
+
+#include <chrono>
+#include <string>
+#include <vector>
+
+/* CPU phases of a frame. Culling, LOD and border are the passes of the
+ * GeoMipMapping planner, dispatch is the CPU side of GPU-driven planning
+ * (which replaces the other three), submit is the render() call of the
+ * terrain. */
+enum FramePhase {
+    FRAME_PHASE_CULLING,
+    FRAME_PHASE_LOD,
+    FRAME_PHASE_BORDER,
+    FRAME_PHASE_DISPATCH,
+    FRAME_PHASE_SUBMIT,
+    FRAME_PHASE_SKYBOX,
+    N_FRAME_PHASES
+};
+
+/* GPU sections of a frame, measured with timer queries */
+enum GpuSection {
+    GPU_SECTION_TERRAIN,
+    GPU_SECTION_SKYBOX,
+    N_GPU_SECTIONS
+};
+
+/* Names of the phases and sections in the CSV and JSON reports */
+const char* const FRAME_PHASE_NAMES[N_FRAME_PHASES] = { "culling", "lod", "border", "dispatch", "submit", "skybox" };
+const char* const GPU_SECTION_NAMES[N_GPU_SECTIONS] = { "terrain", "skybox" };
+
+/* Measurements of a single frame, all times in milliseconds. The GPU times
+ * and triangles only become available a few frames later, until then they
+ * are negative. */
+struct FrameRecord {
+    unsigned long long number = 0;
+    float frameTime = 0.0f; /* Time since the start of the previous frame */
+    float cpuTimes[N_FRAME_PHASES] = {};
+    float gpuTimes[N_GPU_SECTIONS] = { -1.0f, -1.0f };
+    long long triangles = -1; /* Generated by the terrain */
+    unsigned visibleBlocks = 0;
+    unsigned drawCalls = 0;
+};
+
+/* Adds the CPU time from its construction to its destruction to the given
+ * phase of a frame record */
+class ScopedCpuTimer {
+public:
+    ScopedCpuTimer(FrameRecord& record, FramePhase phase);
+    ~ScopedCpuTimer();
+
+    ScopedCpuTimer(const ScopedCpuTimer&) = delete;
+    ScopedCpuTimer& operator=(const ScopedCpuTimer&) = delete;
+
+private:
+    float& _milliseconds;
+    std::chrono::steady_clock::time_point _start;
+};
+
+/* Collects the records of all frames since the last clear(), for the CSV
+ * export, and computes frame time percentiles over a rolling window of the
+ * most recent frames. Makes no OpenGL calls. */
+class FrameStatistics {
+public:
+    FrameStatistics(unsigned windowSize = 512);
+
+    /* Starts the record of the next frame, which stays valid until the next
+     * call of beginFrame() or clear() */
+    FrameRecord& beginFrame(float frameTime);
+
+    /* Record of an earlier frame (e.g. to add its GPU times once they are
+     * available), nullptr if it was cleared already */
+    FrameRecord* record(unsigned long long number);
+
+    /* Frame time percentile (p in [0, 100]) over the rolling window */
+    float frameTimePercentile(float p);
+
+    void clear();
+
+    /* Records of all frames since the last clear(), oldest first */
+    const std::vector<FrameRecord>& records() const;
+
+    /* Writes one line per frame, returns false if the file could not be written */
+    bool writeCsv(const std::string& fileName) const;
+
+    /* Getters */
+    unsigned windowSize();
+    unsigned long long nFrames(); /* Since the last clear() */
+
+private:
+    std::vector<FrameRecord> _records;
+    unsigned long long _nextNumber = 1;
+    unsigned _windowSize;
+
+    /* Reused by every percentile calculation */
+    std::vector<float> _sortedWindow;
+};
+
+#endif // FRAMESTATISTICS_H
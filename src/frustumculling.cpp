@@ -0,0 +1,239 @@
+#include "frustumculling.h"
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#define ATLOD_X86
+#include <immintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+#endif
+
+/* GCC and Clang only allow intrinsics of instruction sets that are enabled
+ * for the function, MSVC allows them everywhere */
+#if defined(ATLOD_X86) && defined(__GNUC__)
+#define ATLOD_TARGET(isa) __attribute__((target(isa)))
+#else
+#define ATLOD_TARGET(isa)
+#endif
+
+namespace FrustumCulling {
+
+namespace {
+
+/**
+ * @brief cullScalar
+ *
+ * Idea (same as Camera::intersectViewFrustum, for each AABB):
+ * - Project the AABB's half extents onto the plane normal, which results
+ *   in the "radius" r of the AABB in the direction of the normal
+ * - If the signed distance of the AABB center is < -r for any plane, the
+ *   AABB is outside
+ * - If it is >= r for every plane, the AABB is entirely inside
+ */
+FrustumCullResult cullScalar(const FrustumPlanes& planes, const AabbArrays& aabbs, unsigned first, unsigned count)
+{
+    FrustumCullResult result = { 0, 0 };
+
+    for (unsigned i = 0; i < count; i++) {
+        unsigned id = first + i;
+        float centerX = (aabbs.minX[id] + aabbs.maxX[id]) * 0.5f;
+        float centerY = (aabbs.minY[id] + aabbs.maxY[id]) * 0.5f;
+        float centerZ = (aabbs.minZ[id] + aabbs.maxZ[id]) * 0.5f;
+        float extentX = (aabbs.maxX[id] - aabbs.minX[id]) * 0.5f;
+        float extentY = (aabbs.maxY[id] - aabbs.minY[id]) * 0.5f;
+        float extentZ = (aabbs.maxZ[id] - aabbs.minZ[id]) * 0.5f;
+
+        bool visible = true, inside = true;
+
+        for (unsigned p = 0; p < 6 && visible; p++) {
+            float signedDistance = planes.normalX[p] * centerX + planes.normalY[p] * centerY
+                + planes.normalZ[p] * centerZ - planes.distance[p];
+            float r = planes.absNormalX[p] * extentX + planes.absNormalY[p] * extentY
+                + planes.absNormalZ[p] * extentZ;
+
+            visible = signedDistance >= -r;
+            inside = inside && signedDistance >= r;
+        }
+
+        inside = inside && visible;
+
+        result.visibleMask |= (visible ? 1u : 0u) << i;
+        result.insideMask |= (inside ? 1u : 0u) << i;
+    }
+
+    return result;
+}
+
+#ifdef ATLOD_X86
+/* Same as cullScalar, but for four AABBs per iteration */
+ATLOD_TARGET("sse")
+FrustumCullResult cullSse(const FrustumPlanes& planes, const AabbArrays& aabbs, unsigned first, unsigned count)
+{
+    FrustumCullResult result = { 0, 0 };
+    unsigned i = 0;
+    const __m128 half = _mm_set1_ps(0.5f);
+
+    for (; i + 4 <= count; i += 4) {
+        unsigned id = first + i;
+        __m128 minX = _mm_loadu_ps(aabbs.minX + id), maxX = _mm_loadu_ps(aabbs.maxX + id);
+        __m128 minY = _mm_loadu_ps(aabbs.minY + id), maxY = _mm_loadu_ps(aabbs.maxY + id);
+        __m128 minZ = _mm_loadu_ps(aabbs.minZ + id), maxZ = _mm_loadu_ps(aabbs.maxZ + id);
+
+        __m128 centerX = _mm_mul_ps(_mm_add_ps(minX, maxX), half);
+        __m128 centerY = _mm_mul_ps(_mm_add_ps(minY, maxY), half);
+        __m128 centerZ = _mm_mul_ps(_mm_add_ps(minZ, maxZ), half);
+        __m128 extentX = _mm_mul_ps(_mm_sub_ps(maxX, minX), half);
+        __m128 extentY = _mm_mul_ps(_mm_sub_ps(maxY, minY), half);
+        __m128 extentZ = _mm_mul_ps(_mm_sub_ps(maxZ, minZ), half);
+
+        __m128 visible = _mm_cmpeq_ps(half, half); /* All bits set */
+        __m128 inside = visible;
+
+        for (unsigned p = 0; p < 6; p++) {
+            __m128 signedDistance = _mm_sub_ps(
+                _mm_add_ps(_mm_add_ps(_mm_mul_ps(_mm_set1_ps(planes.normalX[p]), centerX),
+                               _mm_mul_ps(_mm_set1_ps(planes.normalY[p]), centerY)),
+                    _mm_mul_ps(_mm_set1_ps(planes.normalZ[p]), centerZ)),
+                _mm_set1_ps(planes.distance[p]));
+            __m128 r = _mm_add_ps(_mm_add_ps(_mm_mul_ps(_mm_set1_ps(planes.absNormalX[p]), extentX),
+                                      _mm_mul_ps(_mm_set1_ps(planes.absNormalY[p]), extentY)),
+                _mm_mul_ps(_mm_set1_ps(planes.absNormalZ[p]), extentZ));
+
+            visible = _mm_and_ps(visible, _mm_cmpge_ps(signedDistance, _mm_sub_ps(_mm_setzero_ps(), r)));
+            inside = _mm_and_ps(inside, _mm_cmpge_ps(signedDistance, r));
+        }
+
+        result.visibleMask |= (unsigned)_mm_movemask_ps(visible) << i;
+        result.insideMask |= (unsigned)_mm_movemask_ps(inside) << i;
+    }
+
+    if (i < count) {
+        FrustumCullResult rest = cullScalar(planes, aabbs, first + i, count - i);
+        result.visibleMask |= rest.visibleMask << i;
+        result.insideMask |= rest.insideMask << i;
+    }
+
+    return result;
+}
+
+/* Same as cullScalar, but for eight AABBs at once */
+ATLOD_TARGET("avx")
+FrustumCullResult cullAvx(const FrustumPlanes& planes, const AabbArrays& aabbs, unsigned first, unsigned count)
+{
+    if (count < 8)
+        return cullSse(planes, aabbs, first, count);
+
+    const __m256 half = _mm256_set1_ps(0.5f);
+
+    __m256 minX = _mm256_loadu_ps(aabbs.minX + first), maxX = _mm256_loadu_ps(aabbs.maxX + first);
+    __m256 minY = _mm256_loadu_ps(aabbs.minY + first), maxY = _mm256_loadu_ps(aabbs.maxY + first);
+    __m256 minZ = _mm256_loadu_ps(aabbs.minZ + first), maxZ = _mm256_loadu_ps(aabbs.maxZ + first);
+
+    __m256 centerX = _mm256_mul_ps(_mm256_add_ps(minX, maxX), half);
+    __m256 centerY = _mm256_mul_ps(_mm256_add_ps(minY, maxY), half);
+    __m256 centerZ = _mm256_mul_ps(_mm256_add_ps(minZ, maxZ), half);
+    __m256 extentX = _mm256_mul_ps(_mm256_sub_ps(maxX, minX), half);
+    __m256 extentY = _mm256_mul_ps(_mm256_sub_ps(maxY, minY), half);
+    __m256 extentZ = _mm256_mul_ps(_mm256_sub_ps(maxZ, minZ), half);
+
+    __m256 visible = _mm256_cmp_ps(half, half, _CMP_EQ_OQ); /* All bits set */
+    __m256 inside = visible;
+
+    for (unsigned p = 0; p < 6; p++) {
+        __m256 signedDistance = _mm256_sub_ps(
+            _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(_mm256_set1_ps(planes.normalX[p]), centerX),
+                              _mm256_mul_ps(_mm256_set1_ps(planes.normalY[p]), centerY)),
+                _mm256_mul_ps(_mm256_set1_ps(planes.normalZ[p]), centerZ)),
+            _mm256_set1_ps(planes.distance[p]));
+        __m256 r = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(_mm256_set1_ps(planes.absNormalX[p]), extentX),
+                                     _mm256_mul_ps(_mm256_set1_ps(planes.absNormalY[p]), extentY)),
+            _mm256_mul_ps(_mm256_set1_ps(planes.absNormalZ[p]), extentZ));
+
+        visible = _mm256_and_ps(visible, _mm256_cmp_ps(signedDistance, _mm256_sub_ps(_mm256_setzero_ps(), r), _CMP_GE_OQ));
+        inside = _mm256_and_ps(inside, _mm256_cmp_ps(signedDistance, r, _CMP_GE_OQ));
+    }
+
+    return { (unsigned)_mm256_movemask_ps(visible), (unsigned)_mm256_movemask_ps(inside) };
+}
+#endif
+
+bool cpuSupports(FrustumCullingKernel kernel)
+{
+    if (kernel == FrustumCullingKernel::SCALAR)
+        return true;
+
+#if defined(ATLOD_X86) && defined(__GNUC__)
+    /* Required since this also runs during static initialization */
+    __builtin_cpu_init();
+
+    if (kernel == FrustumCullingKernel::SSE)
+        return __builtin_cpu_supports("sse");
+    return __builtin_cpu_supports("avx");
+#elif defined(ATLOD_X86) && defined(_MSC_VER)
+    int info[4];
+    __cpuid(info, 1);
+
+    if (kernel == FrustumCullingKernel::SSE)
+        return (info[3] & (1 << 25)) != 0;
+
+    /* AVX also requires the OS to save the YMM registers (OSXSAVE) */
+    bool osxsave = (info[2] & (1 << 27)) != 0;
+    bool avx = (info[2] & (1 << 28)) != 0;
+    return osxsave && avx && (_xgetbv(0) & 0x6) == 0x6;
+#else
+    return false;
+#endif
+}
+
+FrustumCullingKernel bestKernel()
+{
+    if (cpuSupports(FrustumCullingKernel::AVX))
+        return FrustumCullingKernel::AVX;
+    if (cpuSupports(FrustumCullingKernel::SSE))
+        return FrustumCullingKernel::SSE;
+    return FrustumCullingKernel::SCALAR;
+}
+
+FrustumCullingKernel currentKernel = bestKernel();
+
+}
+
+FrustumCullResult cull(const FrustumPlanes& planes, const AabbArrays& aabbs, unsigned first, unsigned count)
+{
+#ifdef ATLOD_X86
+    if (currentKernel == FrustumCullingKernel::AVX)
+        return cullAvx(planes, aabbs, first, count);
+    if (currentKernel == FrustumCullingKernel::SSE)
+        return cullSse(planes, aabbs, first, count);
+#endif
+    return cullScalar(planes, aabbs, first, count);
+}
+
+bool supported(FrustumCullingKernel kernel)
+{
+    return cpuSupports(kernel);
+}
+
+const char* kernelName(FrustumCullingKernel kernel)
+{
+    switch (kernel) {
+    case FrustumCullingKernel::SSE:
+        return "SSE";
+    case FrustumCullingKernel::AVX:
+        return "AVX";
+    default:
+        return "scalar";
+    }
+}
+
+FrustumCullingKernel kernel()
+{
+    return currentKernel;
+}
+
+void kernel(FrustumCullingKernel kernel)
+{
+    currentKernel = supported(kernel) ? kernel : FrustumCullingKernel::SCALAR;
+}
+
+}
@@ -0,0 +1,63 @@
+#ifndef FRUSTUMCULLING_H
+#define FRUSTUMCULLING_H
+
+/* The six planes of a view frustum as a structure of arrays, in the order
+ * left, right, top, bottom, near, far. The absolute values of the normals
+ * are stored as well, since every AABB test needs them. */
+struct FrustumPlanes {
+    float normalX[6], normalY[6], normalZ[6];
+    float absNormalX[6], absNormalY[6], absNormalZ[6];
+    float distance[6];
+};
+
+/* AABBs given as a structure of arrays, where AABB i spans from
+ * (minX[i], minY[i], minZ[i]) to (maxX[i], maxY[i], maxZ[i]) */
+struct AabbArrays {
+    const float* minX;
+    const float* minY;
+    const float* minZ;
+    const float* maxX;
+    const float* maxY;
+    const float* maxZ;
+};
+
+/* Result of testing a batch of AABBs, bit i refers to the i-th AABB of the
+ * batch. AABBs entirely inside the frustum are also visible. */
+struct FrustumCullResult {
+    unsigned visibleMask;
+    unsigned insideMask;
+};
+
+/* The instruction set a batch is tested with:
+ * - SCALAR: one AABB at a time, available on every CPU
+ * - SSE: four AABBs at a time
+ * - AVX: eight AABBs at a time */
+enum class FrustumCullingKernel {
+    SCALAR,
+    SSE,
+    AVX
+};
+
+/* Batched frustum culling: tests up to BATCH_SIZE AABBs against all six
+ * planes at once. The fastest kernel supported by the CPU is selected at
+ * runtime, so that the binary does not need to be compiled for a specific
+ * instruction set. */
+namespace FrustumCulling {
+
+const unsigned BATCH_SIZE = 8;
+
+/* Tests the AABBs first to first + count - 1, count must be <= BATCH_SIZE */
+FrustumCullResult cull(const FrustumPlanes& planes, const AabbArrays& aabbs, unsigned first, unsigned count);
+
+bool supported(FrustumCullingKernel kernel);
+const char* kernelName(FrustumCullingKernel kernel);
+
+/* Getters */
+FrustumCullingKernel kernel();
+
+/* Setters, falls back to the scalar kernel if the kernel is not supported */
+void kernel(FrustumCullingKernel kernel);
+
+}
+
+#endif // FRUSTUMCULLING_H
@@ -0,0 +1,269 @@
+#include "geometryclipmap.h"
+#include "../atlodutil.h"
+
+#include <chrono>
+#include <cmath>
+
+GeometryClipmap::GeometryClipmap(Heightmap heightmap, float xzScale, float yScale, unsigned size, unsigned nLevels)
+{
+    std::cout << "Initialize geometry clipmap" << std::endl;
+
+    /* Check whether size is of the form 2^n - 1 */
+    if (size < 15 || ((size + 1) & size) != 0) {
+        std::cerr << "Clipmap size must be of the form 2^n - 1 and at least 15" << std::endl;
+        std::exit(1);
+    }
+
+    _xzScale = xzScale;
+    _yScale = yScale;
+    _heightmap = heightmap;
+    _width = heightmap.width();
+    _height = heightmap.height();
+    _shader = Shader("../src/glsl/geometryclipmap.vert", "../src/glsl/geometryclipmap.frag");
+
+    if (nLevels == 0)
+        nLevels = GeometryClipmapPlanner::levelsFor(size, _width, _height);
+
+    _planner = GeometryClipmapPlanner(size, nLevels, _width, _height);
+    _indices.load(size);
+    _viewer = glm::vec2(_width / 2.0f, _height / 2.0f);
+
+    std::cout << "Geometry clipmap with " << nLevels << " levels of " << size << " x " << size << " samples" << std::endl;
+
+    /* Set uniforms */
+    shader().use();
+    shader().setInt("texture1", 0);
+    shader().setInt("levelTextures", 1);
+    shader().setInt("windowSize", size);
+    shader().setInt("textureSize", _planner.textureSize());
+    shader().setFloat("terrainWidth", _width);
+    shader().setFloat("terrainHeight", _height);
+
+    _levelLocation = shader().uniformLocation("level");
+    _levelScaleLocation = shader().uniformLocation("levelScale");
+    _levelOriginLocation = shader().uniformLocation("levelOrigin");
+    _viewerPositionLocation = shader().uniformLocation("viewerPosition");
+    _transitionWidthLocation = shader().uniformLocation("transitionWidth");
+}
+
+GeometryClipmap::~GeometryClipmap()
+{
+    std::cout << "Geometry clipmap terrain destroyed" << std::endl;
+}
+
+void GeometryClipmap::render(Camera& camera)
+{
+    shader().use();
+    shader().setFloat("yScale", _yScale);
+
+    glEnable(GL_PRIMITIVE_RESTART);
+    glPrimitiveRestartIndex(RESTART_INDEX);
+
+    if (!_freezeCamera) {
+        glm::vec3 position = camera.position() / _xzScale;
+        _viewer = glm::vec2(position.x + _width / 2.0f, position.z + _height / 2.0f);
+    }
+
+    /* Move the levels to the camera and upload the samples entering them */
+    updateTextures();
+
+    glBindVertexArray(_vao);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, _ebo);
+
+    /* Apply overlay texture (if existent) */
+    if (_hasTexture) {
+        glActiveTexture(GL_TEXTURE0);
+        glBindTexture(GL_TEXTURE_2D, _textureId);
+        shader().setFloat("doTexture", 1.0f);
+    } else
+        shader().setFloat("doTexture", 0.0f);
+
+    glActiveTexture(GL_TEXTURE1);
+    glBindTexture(GL_TEXTURE_2D_ARRAY, _levelTextureId);
+
+    unsigned nLevels = _planner.nLevels();
+    _visibleBlocks = nLevels;
+    _drawCalls = 0;
+
+    float transitionWidth = _planner.size() / 10.0f;
+
+    /* Finest level first, so that the coarser levels are mostly rejected
+     * by the depth test */
+    for (unsigned l = 0; l < nLevels; l++) {
+        const GeometryClipmapLevel& level = _planner.level(l);
+        float scale = std::ldexp(1.0f, l);
+
+        shader().setInt(_levelLocation, l);
+        shader().setFloat(_levelScaleLocation, scale);
+        shader().setVec2(_levelOriginLocation, glm::vec2(level.originX, level.originZ));
+        shader().setVec2(_viewerPositionLocation, _viewer / scale);
+
+        /* The coarsest level has nothing to blend towards */
+        shader().setFloat(_transitionWidthLocation, _transitionActive && l + 1 < nLevels ? transitionWidth : 0.0f);
+
+        if (l == 0) {
+            draw(_indices.grid());
+        } else {
+            draw(_indices.ring());
+            draw(_indices.trim(level.trimX, level.trimZ));
+        }
+
+        if (l + 1 < nLevels)
+            draw(_indices.perimeter());
+    }
+
+    AtlodUtil::checkGlError("Geometry clipmap render failed");
+}
+
+void GeometryClipmap::draw(const GeometryClipmapRange& range)
+{
+    glDrawElements(GL_TRIANGLE_STRIP,
+        range.count,
+        GL_UNSIGNED_INT,
+        (void*)(range.start * sizeof(unsigned)));
+    _drawCalls++;
+}
+
+void GeometryClipmap::updateTextures()
+{
+    _updates.clear();
+    _planner.plan(_viewer, _updates);
+
+    if (_updates.empty())
+        return;
+
+    const unsigned short* data = _heightmap.data();
+    unsigned width = _width;
+
+    /* Tiled heightmaps do not have all height values in memory */
+    auto heights = [this, data, width](unsigned x, unsigned z) {
+        return data ? data[(std::size_t)z * width + x] : _heightmap.at(x, z);
+    };
+
+    unsigned mask = _planner.textureSize() - 1;
+
+    glBindTexture(GL_TEXTURE_2D_ARRAY, _levelTextureId);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+
+    for (const GeometryClipmapUpdate& update : _updates) {
+        _samples.resize((std::size_t)update.width * update.height * 2);
+        _planner.fill(update, heights, _samples.data());
+
+        /* Toroidal addressing: sample (x, z) is stored at texel (x mod size, z mod size) */
+        glTexSubImage3D(GL_TEXTURE_2D_ARRAY, 0,
+            (unsigned)update.x & mask, (unsigned)update.z & mask, update.level,
+            update.width, update.height, 1,
+            GL_RG, GL_FLOAT, _samples.data());
+    }
+}
+
+void GeometryClipmap::loadBuffers()
+{
+    auto start = std::chrono::steady_clock::now();
+    loadVertices();
+    loadIndices();
+    loadTextures();
+    std::cout << "Loaded geometry clipmap buffers in " << AtlodUtil::millisecondsSince(start) << " ms" << std::endl;
+}
+
+void GeometryClipmap::loadVertices()
+{
+    unsigned size = _planner.size();
+    std::vector<float> vertices;
+    vertices.reserve((std::size_t)size * size * 2);
+
+    /* Sample positions inside a level window, the vertex shader translates
+     * and scales them to the level */
+    for (unsigned i = 0; i < size; i++) {
+        for (unsigned j = 0; j < size; j++) {
+            vertices.push_back(j); /* Position x */
+            vertices.push_back(i); /* Position z */
+        }
+    }
+
+    glGenVertexArrays(1, &_vao);
+    glBindVertexArray(_vao);
+
+    glGenBuffers(1, &_vbo);
+    glBindBuffer(GL_ARRAY_BUFFER, _vbo);
+    glBufferData(GL_ARRAY_BUFFER, vertices.size() * sizeof(float), &vertices[0], GL_STATIC_DRAW);
+
+    /* Position attribute */
+    glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, 2 * sizeof(float), (void*)0);
+    glEnableVertexAttribArray(0);
+}
+
+void GeometryClipmap::loadIndices()
+{
+    const std::vector<unsigned>& indices = _indices.indices();
+
+    glGenBuffers(1, &_ebo);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, _ebo);
+    glBufferData(GL_ELEMENT_ARRAY_BUFFER, indices.size() * sizeof(unsigned), &indices[0], GL_STATIC_DRAW);
+}
+
+void GeometryClipmap::loadTextures()
+{
+    unsigned textureSize = _planner.textureSize();
+
+    glGenTextures(1, &_levelTextureId);
+    glBindTexture(GL_TEXTURE_2D_ARRAY, _levelTextureId);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_S, GL_REPEAT);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_T, GL_REPEAT);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+
+    /* Height and coarse height per sample */
+    glTexImage3D(GL_TEXTURE_2D_ARRAY, 0, GL_RG32F, textureSize, textureSize, _planner.nLevels(), 0, GL_RG, GL_FLOAT, nullptr);
+
+    /* The samples are uploaded on the first render() */
+    _planner.invalidate();
+
+    AtlodUtil::checkGlError("Geometry clipmap texture load failed");
+}
+
+void GeometryClipmap::unloadBuffers()
+{
+    std::cout << "Unloading buffers" << std::endl;
+    glDeleteVertexArrays(1, &_vao);
+    glDeleteBuffers(1, &_vbo);
+    glDeleteBuffers(1, &_ebo);
+    glDeleteTextures(1, &_levelTextureId);
+
+    AtlodUtil::checkGlError("Geometry clipmap deletion failed");
+}
+
+unsigned GeometryClipmap::size()
+{
+    return _planner.size();
+}
+
+unsigned GeometryClipmap::nLevels()
+{
+    return _planner.nLevels();
+}
+
+unsigned GeometryClipmap::updatedSamples()
+{
+    return _planner.updatedSamples();
+}
+
+bool GeometryClipmap::freezeCamera()
+{
+    return _freezeCamera;
+}
+
+bool GeometryClipmap::transitionActive()
+{
+    return _transitionActive;
+}
+
+void GeometryClipmap::freezeCamera(bool freezeCamera)
+{
+    _freezeCamera = freezeCamera;
+}
+
+void GeometryClipmap::transitionActive(bool transitionActive)
+{
+    _transitionActive = transitionActive;
+}
@@ -0,0 +1,78 @@
+#ifndef GEOMETRYCLIPMAP_H
+#define GEOMETRYCLIPMAP_H
+
+#include "../camera.h"
+#include "../terrain.h"
+#include "geometryclipmapindices.h"
+#include "geometryclipmapplanner.h"
+
+#include <GL/glew.h>
+#include <GLFW/glfw3.h>
+
+#include <vector>
+
+/* GPU-based geometry clipmaps (A. Asirvatham and H. Hoppe, 2005).
+ *
+ * The terrain is drawn as a set of nested rings of the same flat grid,
+ * centered on the camera, where each ring has twice the sample spacing of
+ * the ring inside of it. The heights of each level are stored in one layer
+ * of a texture array, which is updated toroidally as the camera moves, so
+ * only the rows and columns of samples entering a level are uploaded.
+ *
+ * The per-frame CPU work (done by the GL-independent GeometryClipmapPlanner)
+ * and the number of draw calls only depend on the number of levels, not on
+ * the size of the terrain. The heightmap texture is not used, therefore the
+ * heightmap does not have to fit into a single texture. */
+class GeometryClipmap : public Terrain {
+    static const unsigned DEFAULT_SIZE = 255;
+
+public:
+    /* Size must be of the form 2^n - 1, if nLevels is 0, as many levels
+     * are used as needed for the coarsest level to cover the terrain */
+    GeometryClipmap(Heightmap heightmap, float xzScale = 1.0f, float yScale = 1.0f, unsigned size = DEFAULT_SIZE, unsigned nLevels = 0);
+    ~GeometryClipmap();
+
+    /* Overriden virtual methods */
+    void render(Camera& camera);
+    void loadBuffers();
+    void unloadBuffers();
+
+    /* Getters */
+    unsigned size();
+    unsigned nLevels();
+    unsigned updatedSamples();
+    bool freezeCamera();
+    bool transitionActive();
+
+    /* Setters */
+    void freezeCamera(bool freezeCamera);
+    void transitionActive(bool transitionActive);
+
+private:
+    void loadVertices();
+    void loadIndices();
+    void loadTextures();
+    void updateTextures();
+    void draw(const GeometryClipmapRange& range);
+
+    GeometryClipmapPlanner _planner;
+    GeometryClipmapIndices _indices;
+
+    /* Sample rectangles to upload and their samples, reused every frame */
+    std::vector<GeometryClipmapUpdate> _updates;
+    std::vector<float> _samples;
+
+    glm::vec2 _viewer; /* Camera position in heightmap coordinates */
+
+    /* Locations of the uniforms set once per level */
+    int _levelLocation, _levelScaleLocation, _levelOriginLocation;
+    int _viewerPositionLocation, _transitionWidthLocation;
+
+    bool _freezeCamera = false;
+    bool _transitionActive = true;
+
+    unsigned _vao, _vbo, _ebo;
+    unsigned _levelTextureId; /* 2D texture array with one layer per level */
+};
+
+#endif // GEOMETRYCLIPMAP_H
@@ -0,0 +1,132 @@
+#include "geometryclipmapindices.h"
+#include "../atlodutil.h"
+
+GeometryClipmapIndices::GeometryClipmapIndices()
+    : _grid { 0, 0 }
+    , _ring { 0, 0 }
+    , _perimeter { 0, 0 }
+    , _trims {}
+    , _size(0)
+{
+}
+
+/**
+ * @brief GeometryClipmapIndices::load
+ *
+ * Layout of a level with n = size samples per side, m = (n + 1) / 4:
+ * - The ring is m - 1 cells wide on every side (plus the fix-ups, which
+ *   are not distinguished here), its interior is n / 2 + 1 cells wide
+ * - The next finer level covers (n - 1) / 2 cells of the interior, either
+ *   starting at the first or the second interior cell on each axis
+ * - The remaining column and row of cells form the L-shaped trim
+ */
+void GeometryClipmapIndices::load(unsigned size)
+{
+    clear();
+    _size = size;
+
+    unsigned nCells = size - 1;
+    unsigned interiorStart = (size + 1) / 4 - 1;
+    unsigned interiorEnd = nCells - interiorStart;
+    unsigned innerCells = nCells / 2;
+
+    unsigned start = 0;
+    loadRectangle(0, 0, nCells, nCells);
+    _grid = rangeSince(start);
+
+    start = _indices.size();
+    loadRectangle(0, 0, nCells, interiorStart);
+    loadRectangle(0, interiorStart, interiorStart, interiorEnd);
+    loadRectangle(interiorEnd, interiorStart, nCells, interiorEnd);
+    loadRectangle(0, interiorEnd, nCells, nCells);
+    _ring = rangeSince(start);
+
+    for (unsigned trimZ = 0; trimZ < 2; trimZ++) {
+        for (unsigned trimX = 0; trimX < 2; trimX++) {
+            /* The finer level starts at interiorStart + trim, the trim
+             * covers the column and row it leaves uncovered */
+            unsigned column = trimX == 0 ? interiorStart + innerCells : interiorStart;
+            unsigned row = trimZ == 0 ? interiorStart + innerCells : interiorStart;
+
+            start = _indices.size();
+            loadRectangle(column, interiorStart, column + 1, interiorEnd);
+
+            if (column == interiorStart)
+                loadRectangle(interiorStart + 1, row, interiorEnd, row + 1);
+            else
+                loadRectangle(interiorStart, row, interiorEnd - 1, row + 1);
+
+            _trims[trimZ * 2 + trimX] = rangeSince(start);
+        }
+    }
+
+    start = _indices.size();
+    loadPerimeterEdge(0, 0, 1, 0);
+    loadPerimeterEdge(0, nCells, 1, 0);
+    loadPerimeterEdge(0, 0, 0, 1);
+    loadPerimeterEdge(nCells, 0, 0, 1);
+    _perimeter = rangeSince(start);
+}
+
+void GeometryClipmapIndices::loadRectangle(unsigned x0, unsigned z0, unsigned x1, unsigned z1)
+{
+    for (unsigned z = z0; z < z1; z++) {
+        for (unsigned x = x0; x <= x1; x++) {
+            pushIndex(x, z);
+            pushIndex(x, z + 1);
+        }
+        _indices.push_back(RESTART_INDEX);
+    }
+}
+
+/* Every second vertex of the outer border does not exist in the next
+ * coarser level, each of them gets a zero-area triangle with its neighbors */
+void GeometryClipmapIndices::loadPerimeterEdge(unsigned x, unsigned z, unsigned stepX, unsigned stepZ)
+{
+    for (unsigned i = 0; i + 2 < _size; i += 2) {
+        pushIndex(x + i * stepX, z + i * stepZ);
+        pushIndex(x + (i + 1) * stepX, z + (i + 1) * stepZ);
+        pushIndex(x + (i + 2) * stepX, z + (i + 2) * stepZ);
+        _indices.push_back(RESTART_INDEX);
+    }
+}
+
+GeometryClipmapRange GeometryClipmapIndices::rangeSince(unsigned start) const
+{
+    return { start, (unsigned)_indices.size() - start };
+}
+
+void GeometryClipmapIndices::pushIndex(unsigned x, unsigned z)
+{
+    _indices.push_back(z * _size + x);
+}
+
+void GeometryClipmapIndices::clear()
+{
+    _indices.clear();
+}
+
+const std::vector<unsigned>& GeometryClipmapIndices::indices() const
+{
+    return _indices;
+}
+
+GeometryClipmapRange GeometryClipmapIndices::grid() const
+{
+    return _grid;
+}
+
+GeometryClipmapRange GeometryClipmapIndices::ring() const
+{
+    return _ring;
+}
+
+GeometryClipmapRange GeometryClipmapIndices::trim(unsigned trimX, unsigned trimZ) const
+{
+    return _trims[trimZ * 2 + trimX];
+}
+
+GeometryClipmapRange GeometryClipmapIndices::perimeter() const
+{
+    return _perimeter;
+}
@@ -0,0 +1,57 @@
+#ifndef GEOMETRYCLIPMAPINDICES_H
+#define GEOMETRYCLIPMAPINDICES_H
+
+#include <vector>
+
+/* A range of the shared index buffer, in number of indices */
+struct GeometryClipmapRange {
+    unsigned start, count;
+};
+
+/* Generates the shared geometry clipmap index buffer on the CPU.
+ *
+ * Every level is drawn from the same flat grid of size x size vertices,
+ * translated and scaled in the vertex shader. The index buffer contains
+ * triangle strips (separated by primitive restarts) for the following
+ * parts of that grid:
+ * - the whole grid, only drawn for the finest level
+ * - the ring, i.e. the grid without the interior which is covered by the
+ *   next finer level (the blocks and fix-ups of the paper in one range)
+ * - the four possible L-shaped interior trims, filling the one sample
+ *   wide gap between the ring and the next finer level
+ * - zero-area triangles along the outer border, which avoid T-junctions
+ *   with the next coarser level
+ *
+ * This class does not make any OpenGL calls, uploading the generated
+ * indices is up to the caller. */
+class GeometryClipmapIndices {
+public:
+    GeometryClipmapIndices();
+
+    void load(unsigned size);
+    void clear();
+
+    /* Getters */
+    const std::vector<unsigned>& indices() const;
+    GeometryClipmapRange grid() const;
+    GeometryClipmapRange ring() const;
+    GeometryClipmapRange trim(unsigned trimX, unsigned trimZ) const;
+    GeometryClipmapRange perimeter() const;
+
+private:
+    /* Loads the cells [x0, x1) x [z0, z1) as one strip per row */
+    void loadRectangle(unsigned x0, unsigned z0, unsigned x1, unsigned z1);
+    void loadPerimeterEdge(unsigned x, unsigned z, unsigned stepX, unsigned stepZ);
+    GeometryClipmapRange rangeSince(unsigned start) const;
+
+    void pushIndex(unsigned x, unsigned z);
+
+    std::vector<unsigned> _indices;
+
+    GeometryClipmapRange _grid, _ring, _perimeter;
+    GeometryClipmapRange _trims[4];
+
+    unsigned _size;
+};
+
+#endif // GEOMETRYCLIPMAPINDICES_H
@@ -0,0 +1,165 @@
+#include "geometryclipmapplanner.h"
+
+#include <cmath>
+#include <cstdlib>
+
+GeometryClipmapPlanner::GeometryClipmapPlanner()
+    : _size(0)
+    , _blockSize(0)
+    , _terrainWidth(0)
+    , _terrainHeight(0)
+{
+}
+
+GeometryClipmapPlanner::GeometryClipmapPlanner(unsigned size, unsigned nLevels, unsigned terrainWidth, unsigned terrainHeight)
+    : _levels(nLevels, GeometryClipmapLevel { 0, 0, 0, 0, false })
+    , _size(size)
+    , _blockSize((size + 1) / 4)
+    , _terrainWidth(terrainWidth)
+    , _terrainHeight(terrainHeight)
+{
+}
+
+unsigned GeometryClipmapPlanner::levelsFor(unsigned size, unsigned terrainWidth, unsigned terrainHeight)
+{
+    unsigned nLevels = 1;
+    unsigned extent = size - 1;
+
+    while (extent < std::max(terrainWidth, terrainHeight)) {
+        extent *= 2;
+        nLevels++;
+    }
+
+    return nLevels;
+}
+
+/**
+ * @brief GeometryClipmapPlanner::plan
+ *
+ * Idea:
+ * - Place the coarsest window as close to centered on the viewer as possible
+ * - Going from coarse to fine, each finer window must lie in the interior
+ *   of the coarser level's ring, which leaves two possible positions per
+ *   axis. Take the one closer to centered on the viewer; this keeps every
+ *   window within one sample of being centered.
+ * - Compare each window with its previous position and reload the columns
+ *   and rows of samples that entered the window
+ */
+void GeometryClipmapPlanner::plan(const glm::vec2& viewer, std::vector<GeometryClipmapUpdate>& updates)
+{
+    _updatedSamples = 0;
+
+    int halfExtent = (int)(_size - 1) / 2;
+
+    for (unsigned l = (unsigned)_levels.size(); l-- > 0;) {
+        GeometryClipmapLevel& level = _levels[l];
+
+        /* Origin that would center the window on the viewer */
+        float scale = std::ldexp(1.0f, -(int)l);
+        float desiredX = viewer.x * scale - halfExtent;
+        float desiredZ = viewer.y * scale - halfExtent;
+
+        int originX, originZ;
+
+        if (l == _levels.size() - 1) {
+            originX = 2 * (int)std::round(desiredX / 2.0f);
+            originZ = 2 * (int)std::round(desiredZ / 2.0f);
+        } else {
+            GeometryClipmapLevel& coarser = _levels[l + 1];
+
+            /* First sample of the coarser level's ring interior */
+            int interiorX = coarser.originX + (int)_blockSize - 1;
+            int interiorZ = coarser.originZ + (int)_blockSize - 1;
+
+            coarser.trimX = (unsigned)std::min(std::max((int)std::round(desiredX / 2.0f - interiorX), 0), 1);
+            coarser.trimZ = (unsigned)std::min(std::max((int)std::round(desiredZ / 2.0f - interiorZ), 0), 1);
+
+            originX = 2 * (interiorX + (int)coarser.trimX);
+            originZ = 2 * (interiorZ + (int)coarser.trimZ);
+        }
+
+        int dx = originX - level.originX;
+        int dz = originZ - level.originZ;
+
+        if (!level.loaded || (unsigned)std::abs(dx) >= _size || (unsigned)std::abs(dz) >= _size) {
+            addUpdate(l, originX, originZ, _size, _size, updates);
+        } else {
+            /* Columns that entered the window */
+            if (dx > 0)
+                addUpdate(l, level.originX + (int)_size, originZ, dx, _size, updates);
+            else if (dx < 0)
+                addUpdate(l, originX, originZ, -dx, _size, updates);
+
+            /* Rows that entered the window */
+            if (dz > 0)
+                addUpdate(l, originX, level.originZ + (int)_size, _size, dz, updates);
+            else if (dz < 0)
+                addUpdate(l, originX, originZ, _size, -dz, updates);
+        }
+
+        level.originX = originX;
+        level.originZ = originZ;
+        level.loaded = true;
+    }
+}
+
+void GeometryClipmapPlanner::invalidate()
+{
+    for (GeometryClipmapLevel& level : _levels)
+        level.loaded = false;
+}
+
+/* Splits the rectangle where it wraps around the level texture */
+void GeometryClipmapPlanner::addUpdate(unsigned level, int x, int z, unsigned width, unsigned height, std::vector<GeometryClipmapUpdate>& updates)
+{
+    unsigned textureSize = this->textureSize();
+    unsigned textureX = (unsigned)x & (textureSize - 1);
+    unsigned textureZ = (unsigned)z & (textureSize - 1);
+
+    if (textureX + width > textureSize) {
+        unsigned first = textureSize - textureX;
+        addUpdate(level, x, z, first, height, updates);
+        addUpdate(level, x + (int)first, z, width - first, height, updates);
+        return;
+    }
+
+    if (textureZ + height > textureSize) {
+        unsigned first = textureSize - textureZ;
+        addUpdate(level, x, z, width, first, updates);
+        addUpdate(level, x, z + (int)first, width, height - first, updates);
+        return;
+    }
+
+    updates.push_back({ level, x, z, width, height });
+    _updatedSamples += width * height;
+}
+
+unsigned GeometryClipmapPlanner::size() const
+{
+    return _size;
+}
+
+unsigned GeometryClipmapPlanner::textureSize() const
+{
+    return _size + 1;
+}
+
+unsigned GeometryClipmapPlanner::blockSize() const
+{
+    return _blockSize;
+}
+
+unsigned GeometryClipmapPlanner::nLevels() const
+{
+    return _levels.size();
+}
+
+const GeometryClipmapLevel& GeometryClipmapPlanner::level(unsigned level) const
+{
+    return _levels[level];
+}
+
+unsigned GeometryClipmapPlanner::updatedSamples() const
+{
+    return _updatedSamples;
+}
@@ -0,0 +1,138 @@
+#ifndef GEOMETRYCLIPMAPPLANNER_H
+#define GEOMETRYCLIPMAPPLANNER_H
+
+#include <glm/glm.hpp>
+
+#include <algorithm>
+#include <vector>
+
+/* A rectangle of samples of a clipmap level that has to be reloaded, given
+ * in the sample coordinates of the level, i.e. sample (x, z) of level l lies
+ * at the heightmap position (x * 2^l, z * 2^l). Updates never wrap around
+ * the level texture, so each one can be uploaded with a single call. */
+struct GeometryClipmapUpdate {
+    unsigned level;
+    int x, z;
+    unsigned width, height;
+};
+
+/* The window of a clipmap level. The level covers the samples originX to
+ * originX + size - 1 (and the same for z). The origin is always even, so
+ * that the window lies on the sample grid of the next coarser level. */
+struct GeometryClipmapLevel {
+    int originX, originZ;
+
+    /* Offset (0 or 1) of the next finer level inside this level's ring,
+     * selects which of the four L-shaped interior trims is drawn */
+    unsigned trimX, trimZ;
+
+    bool loaded;
+};
+
+/* The geometry clipmap frame planner, based on "Terrain Rendering Using GPU-Based
+ * Geometry Clipmaps" (A. Asirvatham and H. Hoppe, 2005).
+ *
+ * The terrain is represented by nLevels nested square windows of size x size
+ * samples, centered on the viewer, where level l has a sample spacing of 2^l.
+ * The samples of each level are kept in a toroidally addressed texture of
+ * textureSize() x textureSize() texels. When the viewer moves, only the rows
+ * and columns of samples that entered a window have to be reloaded, so the
+ * per-frame work depends on the number of levels and the distance moved,
+ * not on the size of the terrain.
+ *
+ * Like GeoMipMappingPlanner, this class does not make any OpenGL calls. */
+class GeometryClipmapPlanner {
+public:
+    GeometryClipmapPlanner();
+
+    /* Size must be of the form 2^n - 1 */
+    GeometryClipmapPlanner(unsigned size, unsigned nLevels, unsigned terrainWidth, unsigned terrainHeight);
+
+    /* Moves the windows to the viewer (given in heightmap coordinates) and
+     * appends the sample rectangles that have to be reloaded */
+    void plan(const glm::vec2& viewer, std::vector<GeometryClipmapUpdate>& updates);
+
+    /* Reloads every level on the next plan() */
+    void invalidate();
+
+    /* Writes the samples of an update row by row as (height, coarse height)
+     * pairs. The coarse height is the height of the next coarser level,
+     * interpolated along its triangulation, which is blended in towards the
+     * outer border of the level to hide the transition. heights(x, z)
+     * returns the height at the heightmap position (x, z). */
+    template <typename Heights>
+    void fill(const GeometryClipmapUpdate& update, Heights heights, float* out) const;
+
+    /* Number of levels needed for the coarsest level to cover the terrain */
+    static unsigned levelsFor(unsigned size, unsigned terrainWidth, unsigned terrainHeight);
+
+    /* Getters */
+    unsigned size() const;
+    unsigned textureSize() const;
+    unsigned blockSize() const;
+    unsigned nLevels() const;
+    const GeometryClipmapLevel& level(unsigned level) const;
+    unsigned updatedSamples() const;
+
+private:
+    void addUpdate(unsigned level, int x, int z, unsigned width, unsigned height, std::vector<GeometryClipmapUpdate>& updates);
+
+    /* Height at sample (x, z) of the given level, clamped to the terrain */
+    template <typename Heights>
+    float sample(Heights& heights, unsigned level, int x, int z) const;
+
+    std::vector<GeometryClipmapLevel> _levels;
+
+    unsigned _size; /* Number of samples per window side (n in the paper) */
+    unsigned _blockSize; /* (size + 1) / 4 (m in the paper) */
+    unsigned _terrainWidth, _terrainHeight;
+
+    unsigned _updatedSamples = 0; /* Number of samples updated by the last plan() */
+};
+
+template <typename Heights>
+float GeometryClipmapPlanner::sample(Heights& heights, unsigned level, int x, int z) const
+{
+    long long heightmapX = (long long)x << level;
+    long long heightmapZ = (long long)z << level;
+
+    heightmapX = std::min(std::max(heightmapX, 0ll), (long long)_terrainWidth - 1);
+    heightmapZ = std::min(std::max(heightmapZ, 0ll), (long long)_terrainHeight - 1);
+
+    return (float)heights((unsigned)heightmapX, (unsigned)heightmapZ);
+}
+
+template <typename Heights>
+void GeometryClipmapPlanner::fill(const GeometryClipmapUpdate& update, Heights heights, float* out) const
+{
+    unsigned level = update.level;
+
+    for (unsigned i = 0; i < update.height; i++) {
+        int z = update.z + (int)i;
+
+        for (unsigned j = 0; j < update.width; j++) {
+            int x = update.x + (int)j;
+            float height = sample(heights, level, x, z);
+            float coarseHeight;
+
+            /* The coarse grid contains the even samples. Odd samples lie on
+             * an edge of a coarse triangle (or on the diagonal of a coarse
+             * quad, which is split the same way as the triangle strips). */
+            bool oddX = (x & 1) != 0, oddZ = (z & 1) != 0;
+
+            if (!oddX && !oddZ)
+                coarseHeight = height;
+            else if (oddX && !oddZ)
+                coarseHeight = 0.5f * (sample(heights, level, x - 1, z) + sample(heights, level, x + 1, z));
+            else if (!oddX && oddZ)
+                coarseHeight = 0.5f * (sample(heights, level, x, z - 1) + sample(heights, level, x, z + 1));
+            else
+                coarseHeight = 0.5f * (sample(heights, level, x - 1, z + 1) + sample(heights, level, x + 1, z - 1));
+
+            *out++ = height;
+            *out++ = coarseHeight;
+        }
+    }
+}
+
+#endif // GEOMETRYCLIPMAPPLANNER_H
@@ -3,10 +3,11 @@
 
 #include <algorithm>
 #include <cmath>
+#include <cstddef>
 
 #include <chrono>
 
-GeoMipMapping::GeoMipMapping(Heightmap heightmap, float xzScale, float yScale, unsigned blockSize, unsigned minLod, unsigned maxLod)
+GeoMipMapping::GeoMipMapping(Heightmap heightmap, float xzScale, float yScale, unsigned blockSize, unsigned minLod, unsigned maxLod, const std::string& cacheFolder, JobSystem* jobSystem, bool tessellation, bool gpuDriven)
 {
     std::cout << "Initialize GeoMipMapping" << std::endl;
 
@@ -22,11 +23,27 @@ GeoMipMapping::GeoMipMapping(Heightmap heightmap, float xzScale, float yScale, u
         std::exit(1);
     }
 
+    if (tessellation && gpuDriven) {
+        std::cerr << "Error: GPU-driven GeoMipMapping cannot be combined with tessellation" << std::endl;
+        std::exit(1);
+    }
+
     _xzScale = xzScale;
     _yScale = yScale;
     _blockSize = blockSize;
     _heightmap = heightmap;
-    _shader = Shader("../src/glsl/geomipmapping.vert", "../src/glsl/geomipmapping.frag");
+    _cacheFolder = cacheFolder;
+    _tessellation = tessellation;
+    _gpuDriven = gpuDriven;
+    _pagedHeightmap = heightmap.tiled() && !tessellation && !gpuDriven;
+
+    if (_tessellation) {
+        _shader = Shader("../src/glsl/geomipmappingtessellation.vert", "../src/glsl/geomipmappingtessellation.tesc",
+            "../src/glsl/geomipmappingtessellation.tese", "../src/glsl/geomipmapping.frag");
+        _settings.tessellationActive = true;
+    } else {
+        _shader = Shader("../src/glsl/geomipmapping.vert", "../src/glsl/geomipmapping.frag");
+    }
 
     /* Always floor so that we do not "overshoot" when multiplying the number
      * of blocks with the block size */
@@ -44,70 +61,113 @@ GeoMipMapping::GeoMipMapping(Heightmap heightmap, float xzScale, float yScale, u
     _maxLod = std::min(maxLod, _maxPossibleLod);
     _minLod = std::max(0u, minLod);
 
+    _planner = GeoMipMappingPlanner(_blockSize, _nBlocksX, _nBlocksZ, _minLod, _maxLod);
+    _planner.jobSystem(jobSystem);
+
     /* Set uniforms */
     shader().use();
     shader().setInt("texture1", 0);
     shader().setInt("heightmapTexture", 1);
     shader().setFloat("textureWidth", _heightmap.width());
     shader().setFloat("textureHeight", _heightmap.height());
+    shader().setInt("blockSize", _blockSize);
+    shader().setInt("maxLod", _maxLod);
+    shader().setBool("pagedHeightmap", _pagedHeightmap);
+    shader().setInt("heightmapPages", 2);
+    shader().setInt("heightmapPageTable", 3);
+    shader().setInt("heightmapFallback", 4);
+    shader().setVec2("pageOffset", glm::vec2(_width, _height) * 0.5f);
 
     if (_hasTexture) {
         glActiveTexture(GL_TEXTURE0);
         glBindTexture(GL_TEXTURE_2D, _textureId);
     }
 
-    loadBlocks();
+    /* The tessellation path only needs the blocks for culling */
+    if (_tessellation) {
+        int maxLevel;
+        glGetIntegerv(GL_MAX_TESS_GEN_LEVEL, &maxLevel);
+
+        shader().setFloat("minTessellationLevel", std::ldexp(1.0f, _minLod));
+        shader().setFloat("maxTessellationLevel", std::min(std::ldexp(1.0f, _maxLod), (float)maxLevel));
+
+        loadBlocks();
+        return;
+    }
+
+    /* Blocks and indices only depend on the heightmap and the parameters
+     * above, so on a warm start both are read from the block cache */
+    if (!loadCache()) {
+        loadBlocks();
+
+        auto start = std::chrono::steady_clock::now();
+        _indices.load(_blockSize, _minLod, _maxLod);
+        std::cout << "Generated indices in " << AtlodUtil::millisecondsSince(start) << " ms" << std::endl;
+
+        saveCache();
+    }
 }
 
 GeoMipMapping::~GeoMipMapping()
 {
+    _planningThread.reset();
     std::cout << "GeoMipMapping terrain destroyed" << std::endl;
 }
 
-void GeoMipMapping::render(Camera camera)
+void GeoMipMapping::render(Camera& camera)
 {
+    /* The GPU-driven path plans with its own compute shader, so only its
+     * dispatch is left on the CPU */
+    if (_gpuDriven) {
+        if (!_settings.freezeCamera)
+            _lastCamera = camera;
+
+        auto start = std::chrono::steady_clock::now();
+        _gpuPlanner.plan(_lastCamera, _settings);
+
+        _planTimings = GeoMipMappingPlanTimings();
+        _planTimings.dispatch = AtlodUtil::millisecondsSince(start);
+    }
+
     shader().use();
     shader().setFloat("yScale", _yScale);
 
     glEnable(GL_PRIMITIVE_RESTART);
     glPrimitiveRestartIndex(RESTART_INDEX);
 
-    if (!_freezeCamera)
-        _lastCamera = camera;
-
-    std::vector<unsigned> visibleBlocks;
-    visibleBlocks.reserve(_nBlocksX * _nBlocksZ);
-
-    /* ================================ First pass ===============================
-     * - For each block:
-     *   - Check whether the block intersects the view-frustum and
-     *     add it to the list of visible blocks if so
-     *   - Update the block's LOD based on the distance to the camera
-     */
-    for (unsigned i = 0; i < _nBlocksZ; i++) {
-        for (unsigned j = 0; j < _nBlocksX; j++) {
-            GeoMipMappingBlock& block = getBlock(j, i);
-
-            /* Add current block to visible block list if it intersects with
-             * the view-frustum and calculate new LOD level */
-            bool intersects = _lastCamera.insideViewFrustum(block.p1, block.p2);
-
-            if (!_frustumCullingActive || intersects) {
-                visibleBlocks.push_back(block.blockId);
-
-                glm::vec3 temp = block.worldCenter - _lastCamera.position();
-                float squaredDistance = glm::dot(temp, temp);
-
-                if (!_lodActive)
-                    block.currentLod = _maxLod;
-                else if (!_freezeCamera)
-                    block.currentLod = determineLodDistance(squaredDistance, _baseDistance, _doubleDistanceEachLevel);
-            }
+    /* Frustum culling, LOD selection and border bitmaps, either planned
+     * by the planning thread (while the last frame was submitted) or right
+     * now on this thread */
+    if (_planningThreadActive && !_planningThread && !_gpuDriven)
+        _planningThread.reset(new GeoMipMappingPlanningThread(_planner, _indices));
+    else if ((!_planningThreadActive || _gpuDriven) && _planningThread)
+        _planningThread.reset();
+
+    const GeoMipMappingFrame* frame = &_frame;
+
+    if (_gpuDriven) {
+        /* Read back a few frames late, the GPU does not report the updates */
+        _lodUpdates = 0;
+        _borderUpdates = 0;
+        _visibleBlocks = _gpuPlanner.visibleBlocks();
+    } else {
+        if (_planningThread) {
+            _planningThread->submit(camera, _settings);
+            frame = &_planningThread->acquire();
+        } else {
+            GeoMipMappingPlanningThread::plan(_planner, _indices, camera, _settings, _frame);
         }
+
+        _lodUpdates = frame->lodUpdates;
+        _borderUpdates = frame->borderUpdates;
+        _planTimings = frame->timings;
+        _visibleBlocks = _tessellation ? frame->instances.size() : frame->drawList.size();
     }
+    _drawCalls = 0;
 
     glBindVertexArray(_vao);
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, _ebo);
+    if (!_tessellation)
+        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, _ebo);
 
     /* Apply overlay texture (if existent) */
     if (_hasTexture) {
@@ -117,103 +177,234 @@ void GeoMipMapping::render(Camera camera)
     } else
         shader().setFloat("doTexture", 0.0f);
 
-    /* Apply heightmap texture */
-    glActiveTexture(GL_TEXTURE1);
-    glBindTexture(GL_TEXTURE_2D, _heightmap.heightmapTextureId());
+    /* Apply heightmap texture, or the pages of the blocks to be drawn */
+    if (_pagedHeightmap) {
+        requestPages(*frame);
+        _pageTexture.bind(2, 3, 4);
+    } else {
+        glActiveTexture(GL_TEXTURE1);
+        glBindTexture(GL_TEXTURE_2D, _heightmap.heightmapTextureId());
+    }
+
+    if (_tessellation) {
+        renderPatches(*frame);
+    } else if (_gpuDriven) {
+        _gpuPlanner.draw();
+        _drawCalls++;
+    } else if (_batchedDrawingActive) {
+        renderBatched(*frame);
+    } else {
+        renderPerBlock(*frame);
+    }
 
-    /* ============================== Second pass =============================
-     * - For each visible block:
-     *   - Update border bitmap
-     *   - Set uniforms
-     *   - Render center and border subblocks */
-    for (auto id : visibleBlocks) {
-        GeoMipMappingBlock& block = _blocks[id];
-        block.currentBorderBitmap = calculateBorderBitmap(id);
+    AtlodUtil::checkGlError("GeoMipMapping render failed");
+}
 
-        float r = 0.3f, g = 0.3f, b = 0.3f;
+/* Draws the blocks grouped by (LOD, border permutation), with a single
+ * instanced draw per group and LOD center. The per-block translation and
+ * LOD are read from the instance buffer. */
+void GeoMipMapping::renderBatched(const GeoMipMappingFrame& frame)
+{
+    if (frame.instances.empty())
+        return;
+
+    glBindBuffer(GL_ARRAY_BUFFER, _instanceVbo);
+    glBufferData(GL_ARRAY_BUFFER, frame.instances.size() * sizeof(GeoMipMappingInstance), &frame.instances[0], GL_STREAM_DRAW);
+    glEnableVertexAttribArray(1);
+    glEnableVertexAttribArray(2);
+    glEnableVertexAttribArray(3);
+
+    for (const GeoMipMappingDrawBatch& batch : frame.batches) {
+        /* There is no base instance in OpenGL 3.3, so point the instanced
+         * attributes to the first instance of the batch instead */
+        std::size_t first = batch.firstInstance * sizeof(GeoMipMappingInstance);
+        glVertexAttribPointer(1, 4, GL_FLOAT, GL_FALSE, sizeof(GeoMipMappingInstance), (void*)first);
+        glVertexAttribPointer(2, 1, GL_FLOAT, GL_FALSE, sizeof(GeoMipMappingInstance),
+            (void*)(first + offsetof(GeoMipMappingInstance, morph)));
+        glVertexAttribPointer(3, 4, GL_FLOAT, GL_FALSE, sizeof(GeoMipMappingInstance),
+            (void*)(first + offsetof(GeoMipMappingInstance, edgeMorph)));
+
+        glDrawElementsInstanced(GL_TRIANGLE_STRIP,
+            batch.count,
+            GL_UNSIGNED_INT,
+            (void*)(batch.start * sizeof(unsigned)),
+            batch.instanceCount);
+    }
 
-        if (block.currentLod % 3 == 0)
-            r = 0.7f;
-        else if (block.currentLod % 3 == 1)
-            g = 0.7f;
-        else
-            b = 0.7f;
+    _drawCalls += frame.batches.size();
+}
 
-        shader().setVec4("inColor", glm::vec4(r, g, b, 1.0f));
-        shader().setVec2("offset", block.translation);
+/* Draws the center and border subblocks of every block separately, setting
+ * the per-block attributes (see GeoMipMappingInstance) as constant vertex
+ * attributes */
+void GeoMipMapping::renderPerBlock(const GeoMipMappingFrame& frame)
+{
+    glDisableVertexAttribArray(1);
+    glDisableVertexAttribArray(2);
+    glDisableVertexAttribArray(3);
 
-        unsigned currentIndex = block.currentLod - _minLod;
+    for (const GeoMipMappingDrawCommand& command : frame.drawList) {
+        glVertexAttrib4f(1, command.translation.x, command.translation.y, (float)command.lod, (float)command.borderBitmap);
+        glVertexAttrib1f(2, command.morph);
+        glVertexAttrib4f(3, command.edgeMorph.x, command.edgeMorph.y, command.edgeMorph.z, command.edgeMorph.w);
 
         /* First render the center subblocks (only for LOD >= 2, since
          * LOD 0 and 1 do not have a center block) */
-        if (block.currentLod >= 2) {
+        if (command.centerCount > 0) {
             glDrawElements(GL_TRIANGLE_STRIP,
-                centerSizes[currentIndex],
+                command.centerCount,
                 GL_UNSIGNED_INT,
-                (void*)(centerStarts[currentIndex] * sizeof(unsigned)));
+                (void*)(command.centerStart * sizeof(unsigned)));
+            _drawCalls++;
         }
 
-        /* Then render the border subblocks
-         * Note: This couild probably be optimized with
-         * glMultiDrawElements() */
-        currentIndex = currentIndex * 16 + block.currentBorderBitmap;
+        /* Then render the border subblocks */
         glDrawElements(GL_TRIANGLE_STRIP,
-            borderSizes[currentIndex],
+            command.borderCount,
             GL_UNSIGNED_INT,
-            (void*)(borderStarts[currentIndex] * sizeof(unsigned)));
+            (void*)(command.borderStart * sizeof(unsigned)));
+        _drawCalls++;
     }
+}
 
-    AtlodUtil::checkGlError("GeoMipMapping render failed");
+/* Draws all patches with a single instanced draw, the translation of each
+ * block is read from the instance buffer. The tessellation levels are
+ * selected for the camera the patches were culled with. */
+void GeoMipMapping::renderPatches(const GeoMipMappingFrame& frame)
+{
+    if (frame.instances.empty())
+        return;
+
+    shader().setVec3("lodCameraPosition", frame.lodCameraPosition);
+    shader().setFloat("viewportHeight", _settings.viewportHeight);
+    shader().setFloat("edgeLength", _tessellationEdgeLength);
+
+    glBindBuffer(GL_ARRAY_BUFFER, _instanceVbo);
+    glBufferData(GL_ARRAY_BUFFER, frame.instances.size() * sizeof(GeoMipMappingInstance), &frame.instances[0], GL_STREAM_DRAW);
+
+    glPatchParameteri(GL_PATCH_VERTICES, 4);
+    glDrawArraysInstanced(GL_PATCHES, 0, 4, frame.instances.size());
+    _drawCalls++;
 }
 
-void GeoMipMapping::loadBlocks()
+/* Makes the tiles of all blocks in the draw list resident, those of the
+ * highest LOD blocks first. Blocks whose tile is not resident yet are drawn
+ * from the fallback by the vertex shader. */
+void GeoMipMapping::requestPages(const GeoMipMappingFrame& frame)
 {
-    glm::vec2 terrainCenter(_width / 2.0f, _height / 2.0f);
+    unsigned tileSize = _pageTexture.tileSize();
+
+    _pageTexture.beginFrame();
+    for (const GeoMipMappingDrawCommand& command : frame.drawList) {
+        unsigned x = command.blockId % _nBlocksX;
+        unsigned z = command.blockId / _nBlocksX;
+        _pageTexture.request(x * (_blockSize - 1) / tileSize, z * (_blockSize - 1) / tileSize, command.lod);
+    }
+    _pageTexture.update();
+}
 
-    for (unsigned i = 0; i < _nBlocksZ; i++) {
-        for (unsigned j = 0; j < _nBlocksX; j++) {
+bool GeoMipMapping::loadCache()
+{
+    if (_cacheFolder.empty())
+        return false;
 
-            /* Determine min and max y-coordinates per block for the AABB */
-            float minY = 9999999.0f, maxY = -9999999.0f;
-            for (unsigned k = 0; k < _blockSize; k++) {
-                for (unsigned l = 0; l < _blockSize; l++) {
-                    float x = (j * (_blockSize - 1)) + l;
-                    float z = (i * (_blockSize - 1)) + k;
+    auto start = std::chrono::steady_clock::now();
 
-                    float y = _heightmap.at(x, z);
-                    minY = std::min(y, minY);
-                    maxY = std::max(y, maxY);
-                }
-            }
+    /* Hash the height values row by row, so that tiled heightmaps do not
+     * have to be resident as a whole */
+    uint64_t hash = GeoMipMappingCache::HASH_SEED;
+    if (!_heightmap.tiled()) {
+        for (unsigned i = 0; i < _heightmap.height(); i++)
+            hash = GeoMipMappingCache::hashHeights(_heightmap.data() + (std::size_t)i * _heightmap.width(), _heightmap.width(), hash);
+    } else {
+        std::vector<unsigned short> row(_heightmap.width());
+        for (unsigned i = 0; i < _heightmap.height(); i++) {
+            _heightmap.readRows(i, 1, row.data());
+            hash = GeoMipMappingCache::hashHeights(row.data(), row.size(), hash);
+        }
+    }
 
-            unsigned currentBlockId = i * _nBlocksX + j;
+    _cacheKey = { hash, _heightmap.width(), _heightmap.height(), _blockSize, _minLod, _maxLod, _xzScale, _yScale, 0 };
 
-            float centerX = (j * (_blockSize - 1) + 0.5 * (_blockSize - 1));
-            float centerZ = (i * (_blockSize - 1) + 0.5 * (_blockSize - 1));
+    std::string fileName = GeoMipMappingCache::fileName(_cacheFolder, _cacheKey);
 
-            float trueY = _heightmap.at(centerX, centerZ) * _yScale;
-            float aabbY = minY * _yScale + (((maxY - minY) * _yScale) / (2.0f * _yScale));
+    if (!GeoMipMappingCache::load(fileName, _cacheKey, _planner, _indices)) {
+        std::cout << "No valid block cache found at " << fileName << std::endl;
+        return false;
+    }
 
-            glm::vec3 aabbCenter(((-(float)_width * _xzScale) / 2.0f) + centerX * _xzScale, aabbY, ((-(float)_height * _xzScale) / 2.0f) + centerZ * _xzScale);
-            glm::vec3 blockCenter(aabbCenter.x, trueY, aabbCenter.z);
+    std::cout << "Loaded blocks and indices from " << fileName << " in "
+              << AtlodUtil::millisecondsSince(start) << " ms" << std::endl;
+    return true;
+}
 
-            glm::vec2 translation = glm::vec2(centerX, centerZ) - terrainCenter;
+void GeoMipMapping::saveCache()
+{
+    if (_cacheFolder.empty())
+        return;
 
-            glm::vec3 p1 = glm::vec3(aabbCenter.x - (_blockSize / 2.0f), aabbCenter.y - ((maxY - minY) / 2.0f), aabbCenter.z - (_blockSize / 2.0f));
-            glm::vec3 p2 = glm::vec3(aabbCenter.x + (_blockSize / 2.0f), aabbCenter.y + ((maxY - minY) / 2.0f), aabbCenter.z + (_blockSize / 2.0f));
+    std::string fileName = GeoMipMappingCache::fileName(_cacheFolder, _cacheKey);
 
-            GeoMipMappingBlock block = { currentBlockId, blockCenter, p1, p2, translation, 0, 0 };
+    /* A missing cache only slows down the next start, so do not exit */
+    if (!GeoMipMappingCache::save(fileName, _cacheKey, _planner, _indices))
+        std::cerr << "Warning: could not write block cache " << fileName << std::endl;
+    else
+        std::cout << "Saved block cache to " << fileName << std::endl;
+}
 
-            _blocks.push_back(block);
+void GeoMipMapping::loadBlocks()
+{
+    auto start = std::chrono::steady_clock::now();
+
+    if (!_heightmap.tiled()) {
+        _planner.loadBlocks(_heightmap.data(), _heightmap.width(), _xzScale, _yScale);
+    } else {
+        /* Only read the rows covered by a single block row at a time. The
+         * tile cache is not thread-safe, so this is done on a single thread. */
+        std::vector<unsigned short> strip((std::size_t)_heightmap.width() * _blockSize);
+
+        _planner.beginLoadBlocks();
+        for (unsigned i = 0; i < _nBlocksZ; i++) {
+            _heightmap.readRows(i * (_blockSize - 1), _blockSize, strip.data());
+            _planner.loadBlockRow(i, strip.data(), _heightmap.width(), _xzScale, _yScale);
         }
+        _planner.endLoadBlocks();
     }
-    std::cout << "Finished blocks" << std::endl;
+
+    std::cout << "Finished " << _nBlocksX * _nBlocksZ << " blocks in "
+              << AtlodUtil::millisecondsSince(start) << " ms" << std::endl;
 }
 
 void GeoMipMapping::loadBuffers()
 {
+    if (_tessellation) {
+        loadPatchVertices();
+        return;
+    }
+
+    auto start = std::chrono::steady_clock::now();
     loadVertices();
+    std::cout << "Loaded vertices in " << AtlodUtil::millisecondsSince(start) << " ms" << std::endl;
+
+    start = std::chrono::steady_clock::now();
     loadIndices();
+    std::cout << "Uploaded indices in " << AtlodUtil::millisecondsSince(start) << " ms" << std::endl;
+
+    if (_gpuDriven) {
+        start = std::chrono::steady_clock::now();
+        _gpuPlanner.loadBuffers(_planner, _indices, _minLod, _maxLod);
+        std::cout << "Uploaded blocks for GPU-driven planning in " << AtlodUtil::millisecondsSince(start) << " ms" << std::endl;
+    }
+
+    /* Tiles of roughly 256 x 256 samples, but a multiple of the block size */
+    if (_pagedHeightmap) {
+        unsigned tileSize = std::max(1u, PAGE_TILE_SIZE / (_blockSize - 1)) * (_blockSize - 1);
+        _pageTexture.loadBuffers(_heightmap, tileSize, _pageBudget);
+
+        shader().use();
+        shader().setInt("pageTileSize", tileSize);
+        shader().setInt("fallbackStep", _pageTexture.fallbackStep());
+    }
 }
 
 void GeoMipMapping::loadVertices()
@@ -239,58 +430,49 @@ void GeoMipMapping::loadVertices()
     /* Position attribute */
     glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, 2 * sizeof(float), (void*)0);
     glEnableVertexAttribArray(0);
+
+    /* Per-block attributes (translation, LOD and border bitmap, morph
+     * factor and border morph factors), advanced once per instance */
+    glGenBuffers(1, &_instanceVbo);
+    glBindBuffer(GL_ARRAY_BUFFER, _instanceVbo);
+    glVertexAttribPointer(1, 4, GL_FLOAT, GL_FALSE, sizeof(GeoMipMappingInstance), (void*)0);
+    glVertexAttribPointer(2, 1, GL_FLOAT, GL_FALSE, sizeof(GeoMipMappingInstance), (void*)offsetof(GeoMipMappingInstance, morph));
+    glVertexAttribPointer(3, 4, GL_FLOAT, GL_FALSE, sizeof(GeoMipMappingInstance), (void*)offsetof(GeoMipMappingInstance, edgeMorph));
+    glVertexAttribDivisor(1, 1);
+    glVertexAttribDivisor(2, 1);
+    glVertexAttribDivisor(3, 1);
 }
 
-void GeoMipMapping::loadIndices()
+/* A single patch with the corners of the flat mesh (see loadVertices()),
+ * ordered counterclockwise starting at (0, 0) */
+void GeoMipMapping::loadPatchVertices()
 {
-    /* Disclaimer: some of the addition and subtraction below probably needs to be
-     * refactored, since on some lines I directly subtract after I add, which
-     * obviously makes no sense */
-    unsigned totalCount = 0;
-
-    if (_minLod == 0) {
-        /* ========================== Load LOD 0 block ==========================*/
-        unsigned lod0Count = loadLod0Block();
-        totalCount += lod0Count;
-
-        /* For LOD 0, the (single) border block is always the same */
-        for (int i = 0; i < 16; i++) {
-            borderStarts.push_back(totalCount - lod0Count);
-            borderSizes.push_back(lod0Count);
-        }
+    float first = -(float)_blockSize / 2.0f;
+    float last = first + (float)(_blockSize - 1);
 
-        /* LOD 0 border block does not have a center */
-        centerStarts.push_back(0);
-        centerSizes.push_back(0);
-    }
-
-    if (_minLod == 0 || _minLod == 1) {
+    _vertices = { first, first, last, first, last, last, first, last };
 
-        /* ========================== Load LOD 1 block ==========================*/
-        for (unsigned i = 0; i < 16; i++) {
-            unsigned lod1Count = loadLod1Block(i);
-            totalCount += lod1Count;
-            borderStarts.push_back(totalCount - lod1Count);
-            borderSizes.push_back(lod1Count);
-        }
+    glGenVertexArrays(1, &_vao);
+    glBindVertexArray(_vao);
 
-        /* LOD 1 border block does not have a center */
-        centerStarts.push_back(0);
-        centerSizes.push_back(0);
-    }
+    glGenBuffers(1, &_vbo);
+    glBindBuffer(GL_ARRAY_BUFFER, _vbo);
+    glBufferData(GL_ARRAY_BUFFER, _vertices.size() * sizeof(float), &_vertices[0], GL_STATIC_DRAW);
 
-    /* ============================= Load rest ==============================*/
-    for (unsigned i = std::max(_minLod, 2u); i <= _maxLod; i++) {
-        /* Load border subblocks */
-        unsigned borderCount = loadBorderAreaForLod(i, totalCount);
+    glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, 2 * sizeof(float), (void*)0);
+    glEnableVertexAttribArray(0);
 
-        totalCount += borderCount;
+    /* Per-block translation, advanced once per instance (i.e. patch) */
+    glGenBuffers(1, &_instanceVbo);
+    glBindBuffer(GL_ARRAY_BUFFER, _instanceVbo);
+    glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, sizeof(GeoMipMappingInstance), (void*)0);
+    glVertexAttribDivisor(1, 1);
+    glEnableVertexAttribArray(1);
+}
 
-        /* Load center subblocks */
-        unsigned centerCount = loadCenterAreaForLod(i);
-        totalCount += centerCount;
-        centerStarts.push_back(totalCount - centerCount);
-    }
+void GeoMipMapping::loadIndices()
+{
+    const std::vector<unsigned>& indices = _indices.indices();
 
     std::cout << "Allocated number of indices: " << indices.size() << std::endl;
 
@@ -300,1017 +482,205 @@ void GeoMipMapping::loadIndices()
     glBufferData(GL_ELEMENT_ARRAY_BUFFER, indices.size() * sizeof(unsigned), &indices[0], GL_STATIC_DRAW);
 }
 
-unsigned GeoMipMapping::calculateBorderBitmap(unsigned currentBlockId)
+void GeoMipMapping::unloadBuffers()
 {
-    unsigned z = std::floor((float)currentBlockId / (float)_nBlocksX);
-    unsigned x = currentBlockId - z * _nBlocksX;
-
-    unsigned currentLod = _blocks[currentBlockId].currentLod;
-
-    unsigned maxX = std::max((int)x - 1, 0);
-    unsigned minX = std::min((int)x + 1, (int)_nBlocksX - 1);
-    unsigned maxZ = std::max((int)z - 1, 0);
-    unsigned minZ = std::min((int)z + 1, (int)_nBlocksZ - 1);
+    std::cout << "Unloading buffers" << std::endl;
+    glDeleteVertexArrays(1, &_vao);
+    glDeleteBuffers(1, &_vbo);
+    glDeleteBuffers(1, &_instanceVbo);
+    glDeleteBuffers(1, &_ebo);
 
-    GeoMipMappingBlock& leftBlock = getBlock(maxX, z);
-    GeoMipMappingBlock& rightBlock = getBlock(minX, z);
-    GeoMipMappingBlock& topBlock = getBlock(x, maxZ);
-    GeoMipMappingBlock& bottomBlock = getBlock(x, minZ);
+    if (_gpuDriven)
+        _gpuPlanner.unloadBuffers();
 
-    unsigned leftLower = currentLod > leftBlock.currentLod ? 1 : 0;
-    unsigned rightLower = currentLod > rightBlock.currentLod ? 1 : 0;
-    unsigned topLower = currentLod > topBlock.currentLod ? 1 : 0;
-    unsigned bottomLower = currentLod > bottomBlock.currentLod ? 1 : 0;
+    if (_pagedHeightmap)
+        _pageTexture.unloadBuffers();
 
-    return (leftLower << 3) | (rightLower << 2) | (topLower << 1) | bottomLower;
+    AtlodUtil::checkGlError("GeoMipMapping deletion failed");
 }
 
-unsigned GeoMipMapping::determineLodDistance(float distance, float baseDist, bool doubleEachLevel)
+unsigned GeoMipMapping::nBlocksX()
 {
-    unsigned distancePower = 1;
-    for (int i = 0; i < _maxLod - _minLod; i++) {
-        if (distance < distancePower * distancePower * baseDist * baseDist)
-            return _maxLod - i;
-
-        if (doubleEachLevel)
-            distancePower <<= 1;
-        else
-            distancePower++;
-    }
-    return _minLod;
+    return _nBlocksX;
 }
 
-GeoMipMappingBlock& GeoMipMapping::getBlock(unsigned x, unsigned z)
+unsigned GeoMipMapping::nBlocksZ()
 {
-    return _blocks[z * _nBlocksX + x];
+    return _nBlocksZ;
 }
 
-void GeoMipMapping::pushIndex(unsigned x, unsigned y)
+bool GeoMipMapping::freezeCamera()
 {
-    indices.push_back(y * _blockSize + x);
+    return _settings.freezeCamera;
 }
 
-unsigned GeoMipMapping::loadCenterAreaForLod(unsigned lod)
+bool GeoMipMapping::lodActive()
 {
-    unsigned step = std::pow(2, _maxLod - lod);
-    unsigned count = 0;
-
-    for (unsigned i = step; i < _blockSize - step - 1; i += step) {
-        for (unsigned j = step; j < _blockSize - step; j += step) {
-            pushIndex(j, i);
-            pushIndex(j, i + step);
-            count += 2;
-        }
-        indices.push_back(RESTART_INDEX);
-        count++;
-    }
-
-    centerSizes.push_back(count);
-
-    return count;
+    return _settings.lodActive;
 }
 
-unsigned GeoMipMapping::loadBorderAreaForLod(unsigned lod, unsigned accumulatedCount)
+bool GeoMipMapping::incrementalActive()
 {
-    unsigned totalCount = 0;
-
-    /* 2^4 = 16 possible combinations */
-    for (int i = 0; i < 16; i++) {
-        unsigned count = loadBorderAreaForPermutation(lod, i);
-        totalCount += count;
-        accumulatedCount += count;
-        borderStarts.push_back(accumulatedCount - count);
-    }
-
-    return totalCount;
+    return _settings.incrementalActive;
 }
 
-unsigned GeoMipMapping::loadLod0Block()
+GeoMipMappingLodMode GeoMipMapping::lodMode()
 {
-    pushIndex(0, 0);
-    pushIndex(0, _blockSize - 1);
-    pushIndex(_blockSize - 1, 0);
-    pushIndex(_blockSize - 1, _blockSize - 1);
-    indices.push_back(RESTART_INDEX);
-
-    return 5;
+    return _settings.lodMode;
 }
 
-unsigned GeoMipMapping::loadLod1Block(unsigned permutation)
+float GeoMipMapping::pixelError()
 {
-    unsigned count = 0;
-    unsigned step = std::pow(2, _maxLod - 1);
-
-    /* ============== Block is surrounded by lower LOD blocks ============== */
-    if (permutation == 0b1111) {
-        pushIndex(0, 0);
-        pushIndex(step, step);
-        pushIndex(_blockSize - 1, 0);
-        pushIndex(_blockSize - 1, _blockSize - 1);
-        indices.push_back(RESTART_INDEX);
-
-        pushIndex(0, 0);
-        pushIndex(0, _blockSize - 1);
-        pushIndex(step, step);
-        pushIndex(_blockSize - 1, _blockSize - 1);
-        indices.push_back(RESTART_INDEX);
-        count += 10;
-    }
-
-    /* ======= Block is surrounded by exactly three lower LOD blocks ======= */
-    else if (permutation == 0b1110 || permutation == 0b1101 || permutation == 0b1011 || permutation == 0b00111) {
-        /* Left or bottom block has the same LOD */
-        if (permutation == 0b1110 || permutation == 0b0111) {
-
-            pushIndex(0, 0);
-            pushIndex(step, step);
-            pushIndex(_blockSize - 1, 0);
-            pushIndex(_blockSize - 1, _blockSize - 1);
-            indices.push_back(RESTART_INDEX);
-            count += 5;
-
-            /* Bottom block has the same LOD*/
-            if (permutation == 0b1110) {
-
-                pushIndex(_blockSize - 1, _blockSize - 1);
-                pushIndex(step, step);
-                pushIndex(step, _blockSize - 1);
-                pushIndex(0, _blockSize - 1);
-                indices.push_back(RESTART_INDEX);
-
-                pushIndex(0, _blockSize - 1);
-                pushIndex(step, step);
-                pushIndex(0, 0);
-                indices.push_back(RESTART_INDEX);
-
-                count += 9;
-            } else { /* Left block has the same LOD */
-                pushIndex(0, _blockSize - 1);
-                pushIndex(step, step);
-                pushIndex(0, step);
-                pushIndex(0, 0);
-                indices.push_back(RESTART_INDEX);
-
-                pushIndex(_blockSize - 1, _blockSize - 1);
-                pushIndex(step, step);
-                pushIndex(0, _blockSize - 1);
-                indices.push_back(RESTART_INDEX);
-
-                count += 9;
-            }
-
-        } else { /* Top or right block has the same LOD */
-
-            pushIndex(0, 0);
-            pushIndex(0, _blockSize - 1);
-            pushIndex(step, step);
-            pushIndex(_blockSize - 1, _blockSize - 1);
-            indices.push_back(RESTART_INDEX);
-
-            count += 5;
-
-            /* Top block has the same LOD*/
-            if (permutation == 0b1101) {
-
-                pushIndex(0, 0);
-                pushIndex(step, step);
-                pushIndex(step, 0);
-                pushIndex(_blockSize - 1, 0);
-                indices.push_back(RESTART_INDEX);
-
-                pushIndex(step, step);
-                pushIndex(_blockSize - 1, _blockSize - 1);
-                pushIndex(_blockSize - 1, 0);
-                indices.push_back(RESTART_INDEX);
-
-                count += 9;
-
-            } else { /* Right block has the same LOD */
-
-                pushIndex(_blockSize - 1, 0);
-                pushIndex(step, step);
-                pushIndex(_blockSize - 1, step);
-                pushIndex(_blockSize - 1, _blockSize - 1);
-                indices.push_back(RESTART_INDEX);
-
-                pushIndex(0, 0);
-                pushIndex(step, step);
-                pushIndex(_blockSize - 1, 0);
-                indices.push_back(RESTART_INDEX);
-
-                count += 9;
-            }
-        }
-    }
-
-    /* ======== Block is surrounded by exaclty two lower LOD blocks ======== */
-    else if (permutation == 0b0011 || permutation == 0b1100) {
-        if (permutation == 0b0011) {
-
-            pushIndex(_blockSize - 1, step);
-            pushIndex(_blockSize - 1, 0);
-            pushIndex(step, step);
-            pushIndex(0, 0);
-            pushIndex(0, _blockSize - 1);
-            indices.push_back(RESTART_INDEX);
-
-            pushIndex(0, step);
-            pushIndex(0, _blockSize - 1);
-            pushIndex(step, step);
-            pushIndex(_blockSize - 1, _blockSize - 1);
-            pushIndex(_blockSize - 1, step);
-            indices.push_back(RESTART_INDEX);
-
-            count += 12;
-        } else {
-
-            pushIndex(step, 0);
-            pushIndex(0, 0);
-            pushIndex(step, step);
-            pushIndex(0, _blockSize - 1);
-            pushIndex(step, _blockSize - 1);
-            indices.push_back(RESTART_INDEX);
-
-            pushIndex(step, _blockSize - 1);
-            pushIndex(_blockSize - 1, _blockSize - 1);
-            pushIndex(step, step);
-            pushIndex(_blockSize - 1, 0);
-            pushIndex(step, 0);
-            indices.push_back(RESTART_INDEX);
-
-            count += 12;
-        }
-    }
-
-    /* ==== Determine which corner is a regular quad and the method of the ====
-     *      opposing corner */
-    else if (!(permutation & (LEFT_BORDER_BITMASK | TOP_BORDER_BITMASK))) {
-        count += loadBottomRightCorner(step, permutation);
-
-        pushIndex(0, 0);
-        pushIndex(0, step);
-        pushIndex(step, 0);
-        pushIndex(step, step);
-        indices.push_back(RESTART_INDEX);
-        count += 5;
-    } else if (!(permutation & (TOP_BORDER_BITMASK | RIGHT_BORDER_BITMASK))) {
-        count += loadBottomLeftCorner(step, permutation);
-
-        pushIndex(step, 0);
-        pushIndex(step, step);
-        pushIndex(_blockSize - 1, 0);
-        pushIndex(_blockSize - 1, step);
-        indices.push_back(RESTART_INDEX);
-        count += 5;
-
-    } else if (!(permutation & (RIGHT_BORDER_BITMASK | BOTTOM_BORDER_BITMASK))) {
-        count += loadTopLeftCorner(step, permutation);
-
-        pushIndex(step, step);
-        pushIndex(step, _blockSize - 1);
-        pushIndex(_blockSize - 1, step);
-        pushIndex(_blockSize - 1, _blockSize - 1);
-        indices.push_back(RESTART_INDEX);
-        count += 5;
-    } else if (!(permutation & (BOTTOM_BORDER_BITMASK | LEFT_BORDER_BITMASK))) {
-        count += loadTopRightCorner(step, permutation);
-
-        pushIndex(0, step);
-        pushIndex(0, _blockSize - 1);
-        pushIndex(step, step);
-        pushIndex(step, _blockSize - 1);
-        indices.push_back(RESTART_INDEX);
-        count += 5;
-    }
-
-    return count;
+    return _settings.pixelError;
 }
 
-unsigned GeoMipMapping::loadBorderAreaForPermutation(unsigned lod, unsigned permutation)
+bool GeoMipMapping::frustumCullingActive()
 {
-    unsigned step = std::pow(2, _maxLod - lod);
-    unsigned count = 0;
-
-    count += loadTopLeftCorner(step, permutation);
-    count += loadTopBorder(step, permutation);
-    count += loadTopRightCorner(step, permutation);
-    count += loadRightBorder(step, permutation);
-    count += loadBottomRightCorner(step, permutation);
-    count += loadBottomBorder(step, permutation);
-    count += loadBottomLeftCorner(step, permutation);
-    count += loadLeftBorder(step, permutation);
-
-    borderSizes.push_back(count);
-
-    return count;
+    return _settings.frustumCullingActive;
 }
 
-unsigned GeoMipMapping::loadTopLeftCorner(unsigned step, unsigned permutation)
+bool GeoMipMapping::quadTreeActive()
 {
-    unsigned count = 0;
-    if ((permutation & LEFT_BORDER_BITMASK) && (permutation & TOP_BORDER_BITMASK)) { /* bitmask is 1_1_ */
-        /*
-         * *- - -*- - -*
-         * |\         /|
-         * |  \     /  |
-         * |    \ /    |
-         * *     *- - -*
-         * |    /|
-         * |  /  |
-         * |/    |
-         * *- - -*
-         *
-         */
-
-        pushIndex(2 * step, step);
-        pushIndex(2 * step, 0);
-        pushIndex(step, step);
-        pushIndex(0, 0);
-        pushIndex(0, 2 * step);
-        indices.push_back(RESTART_INDEX);
-
-        pushIndex(step, 2 * step);
-        pushIndex(step, step);
-        pushIndex(0, 2 * step);
-        indices.push_back(RESTART_INDEX);
-
-        count += 10;
-
-    } else if (permutation & LEFT_BORDER_BITMASK) { /* bitmask is 1_0_*/
-
-        /*
-         * *- - -*- - -*
-         * |\    |    /|
-         * |  \  |  /  |
-         * |    \|/    |
-         * *     *- - -*
-         * |    /|
-         * |  /  |
-         * |/    |
-         * *- - -*
-         *
-         */
-
-        pushIndex(step, 0);
-        pushIndex(0, 0);
-        pushIndex(step, step);
-        pushIndex(0, 2 * step);
-        pushIndex(step, 2 * step);
-        indices.push_back(RESTART_INDEX);
-
-        pushIndex(step, 0);
-        pushIndex(step, step);
-        pushIndex(2 * step, 0);
-        pushIndex(2 * step, step);
-        indices.push_back(RESTART_INDEX);
-
-        count += 11;
-
-    } else if (permutation & TOP_BORDER_BITMASK) { /* bitmask is 0_1_ */
-        /*
-         * *- - -*- - -*
-         * |\         /|
-         * |  \     /  |
-         * |    \ /    |
-         * *- - -*- - -*
-         * |    /|
-         * |  /  |
-         * |/    |
-         * *- - -*
-         *
-         */
-
-        pushIndex(0, step);
-        pushIndex(0, 2 * step);
-        pushIndex(step, step);
-        pushIndex(step, 2 * step);
-        indices.push_back(RESTART_INDEX);
-
-        pushIndex(2 * step, step);
-        pushIndex(2 * step, 0);
-        pushIndex(step, step);
-        pushIndex(0, 0);
-        pushIndex(0, step);
-        indices.push_back(RESTART_INDEX);
-
-        count += 11;
-
-    } else { /* bitmask is 0_0_*/
-        /*
-         * *- - -*- - -*
-         * |    /|    /|
-         * |  /  |  /  |
-         * |/    |/    |
-         * *- - -*- - -*
-         * |    /|
-         * |  /  |
-         * |/    |
-         * *- - -*
-         *
-         */
-
-        pushIndex(0, step);
-        pushIndex(0, 2 * step);
-        pushIndex(step, step);
-        pushIndex(step, 2 * step);
-        indices.push_back(RESTART_INDEX);
-
-        pushIndex(0, 0);
-        pushIndex(0, step);
-        pushIndex(step, 0);
-        pushIndex(step, step);
-        pushIndex(2 * step, 0);
-        pushIndex(2 * step, step);
-        indices.push_back(RESTART_INDEX);
-
-        count += 12;
-    }
-
-    return count;
+    return _settings.quadTreeActive;
 }
 
-unsigned GeoMipMapping::loadTopRightCorner(unsigned step, unsigned permutation)
+bool GeoMipMapping::batchedDrawingActive()
 {
-    unsigned count = 0;
-    if ((permutation & RIGHT_BORDER_BITMASK) && (permutation & TOP_BORDER_BITMASK)) { /* bitmask is _11_ */
-        /*
-         * *- - -*- - -*
-         * |\         /|
-         * |  \     /  |
-         * |    \ /    |
-         * *- - -*     *
-         *       |\    |
-         *       |  \  |
-         *       |    \|
-         *       *- - -*
-         *
-         */
-
-        pushIndex(_blockSize - 1 - step, 2 * step);
-        pushIndex(_blockSize - 1, 2 * step);
-        pushIndex(_blockSize - 1 - step, step);
-        pushIndex(_blockSize - 1, 0);
-        pushIndex(_blockSize - 1 - 2 * step, 0);
-        indices.push_back(RESTART_INDEX);
-
-        pushIndex(_blockSize - 1 - step, step);
-        pushIndex(_blockSize - 1 - 2 * step, 0);
-        pushIndex(_blockSize - 1 - 2 * step, step);
-        indices.push_back(RESTART_INDEX);
-
-        count += 10;
-
-    } else if (permutation & RIGHT_BORDER_BITMASK) { /* bitmask is _10_*/
-
-        /*
-         * *- - -*- - -*
-         * |    /|    /|
-         * |  /  |  /  |
-         * |/    |/    |
-         * *- - -*     *
-         *       |\    |
-         *       |  \  |
-         *       |    \|
-         *       *- - -*
-         */
-
-        pushIndex(_blockSize - 1 - step, 2 * step);
-        pushIndex(_blockSize - 1, 2 * step);
-        pushIndex(_blockSize - 1 - step, step);
-        pushIndex(_blockSize - 1, 0);
-        pushIndex(_blockSize - 1 - step, 0);
-        indices.push_back(RESTART_INDEX);
-
-        pushIndex(_blockSize - 1 - 2 * step, 0);
-        pushIndex(_blockSize - 1 - 2 * step, step);
-        pushIndex(_blockSize - 1 - step, 0);
-        pushIndex(_blockSize - 1 - step, step);
-        indices.push_back(RESTART_INDEX);
-
-        count += 11;
-
-    } else if (permutation & TOP_BORDER_BITMASK) { /* bitmask is _01_ */
-        /*
-         * *- - -*- - -*
-         * |\         /|
-         * |  \     /  |
-         * |    \ /    |
-         * *- - -*- - -*
-         *       |    /|
-         *       |  /  |
-         *       |/    |
-         *       *- - -*
-         *
-         */
-
-        pushIndex(_blockSize - 1 - step, step);
-        pushIndex(_blockSize - 1 - step, 2 * step);
-        pushIndex(_blockSize - 1, step);
-        pushIndex(_blockSize - 1, 2 * step);
-        indices.push_back(RESTART_INDEX);
-
-        pushIndex(_blockSize - 1, step);
-        pushIndex(_blockSize - 1, 0);
-        pushIndex(_blockSize - 1 - step, step);
-        pushIndex(_blockSize - 1 - 2 * step, 0);
-        pushIndex(_blockSize - 1 - 2 * step, step);
-        indices.push_back(RESTART_INDEX);
-
-        count += 11;
-
-    } else { /* bitmask is _00_*/
-        /*
-         * *- - -*- - -*
-         * |    /|    /|
-         * |  /  |  /  |
-         * |/    |/    |
-         * *- - -*- - -*
-         *       |    /|
-         *       |  /  |
-         *       |/    |
-         *       *- - -*
-         *
-         */
-
-        pushIndex(_blockSize - 1 - 2 * step, 0);
-        pushIndex(_blockSize - 1 - 2 * step, step);
-        pushIndex(_blockSize - 1 - step, 0);
-        pushIndex(_blockSize - 1 - step, step);
-        pushIndex(_blockSize - 1, 0);
-        pushIndex(_blockSize - 1, step);
-        indices.push_back(RESTART_INDEX);
-
-        pushIndex(_blockSize - 1 - step, step);
-        pushIndex(_blockSize - 1 - step, 2 * step);
-        pushIndex(_blockSize - 1, step);
-        pushIndex(_blockSize - 1, 2 * step);
-        indices.push_back(RESTART_INDEX);
-
-        count += 12;
-    }
-
-    return count;
+    return _batchedDrawingActive;
 }
 
-unsigned GeoMipMapping::loadBottomRightCorner(unsigned step, unsigned permutation)
+bool GeoMipMapping::planningThreadActive()
 {
-    unsigned count = 0;
-
-    if ((permutation & RIGHT_BORDER_BITMASK) && (permutation & BOTTOM_BORDER_BITMASK)) { /* bitmask is _1_1 */
-        /*
-         *       *- - -*
-         *       |    /|
-         *       |  /  |
-         *       |/    |
-         * *- - -*     *
-         * |    / \    |
-         * |  /     \  |
-         * |/         \|
-         * *- - -*- - -*
-         *
-         */
-
-        pushIndex(_blockSize - 1 - 2 * step, _blockSize - 1 - step);
-        pushIndex(_blockSize - 1 - 2 * step, _blockSize - 1);
-        pushIndex(_blockSize - 1 - step, _blockSize - 1 - step);
-        pushIndex(_blockSize - 1, _blockSize - 1);
-        pushIndex(_blockSize - 1, _blockSize - 1 - 2 * step);
-        indices.push_back(RESTART_INDEX);
-
-        pushIndex(_blockSize - 1 - step, _blockSize - 1 - 2 * step);
-        pushIndex(_blockSize - 1 - step, _blockSize - 1 - step);
-        pushIndex(_blockSize - 1, _blockSize - 1 - 2 * step);
-        indices.push_back(RESTART_INDEX);
-
-        count += 10;
-
-    } else if (permutation & RIGHT_BORDER_BITMASK) { /* bitmask is _1_0*/
-
-        /*
-         *       *- - -*
-         *       |    /|
-         *       |  /  |
-         *       |/    |
-         * *- - -*     *
-         * |    /|\    |
-         * |  /  |  \  |
-         * |/    |    \|
-         * *- - -*- - -*
-         *
-         */
-
-        pushIndex(_blockSize - 1 - step, _blockSize - 1);
-        pushIndex(_blockSize - 1, _blockSize - 1);
-        pushIndex(_blockSize - 1 - step, _blockSize - 1 - step);
-        pushIndex(_blockSize - 1, _blockSize - 1 - 2 * step);
-        pushIndex(_blockSize - 1 - step, _blockSize - 1 - 2 * step);
-        indices.push_back(RESTART_INDEX);
-
-        pushIndex(_blockSize - 1 - 2 * step, _blockSize - 1 - step);
-        pushIndex(_blockSize - 1 - 2 * step, _blockSize - 1);
-        pushIndex(_blockSize - 1 - step, _blockSize - 1 - step);
-        pushIndex(_blockSize - 1 - step, _blockSize - 1);
-        indices.push_back(RESTART_INDEX);
-
-        count += 11;
-
-    } else if (permutation & BOTTOM_BORDER_BITMASK) { /* bitmask is _0_1 */
-        /*
-         *       *- - -*
-         *       |    /|
-         *       |  /  |
-         *       |/    |
-         * *- - -*- - -*
-         * |    / \    |
-         * |  /     \  |
-         * |/         \|
-         * *- - -*- - -*
-         *
-         */
-
-        pushIndex(_blockSize - 1 - step, _blockSize - 1 - 2 * step);
-        pushIndex(_blockSize - 1 - step, _blockSize - 1 - step);
-        pushIndex(_blockSize - 1, _blockSize - 1 - 2 * step);
-        pushIndex(_blockSize - 1, _blockSize - 1 - step);
-        indices.push_back(RESTART_INDEX);
-
-        pushIndex(_blockSize - 1 - 2 * step, _blockSize - 1 - step);
-        pushIndex(_blockSize - 1 - 2 * step, _blockSize - 1);
-        pushIndex(_blockSize - 1 - step, _blockSize - 1 - step);
-        pushIndex(_blockSize - 1, _blockSize - 1);
-        pushIndex(_blockSize - 1, _blockSize - 1 - step);
-        indices.push_back(RESTART_INDEX);
-
-        count += 11;
-
-    } else { /* bitmask is _0_0*/
-        /*
-         *       *- - -*
-         *       |    /|
-         *       |  /  |
-         *       |/    |
-         * *- - -*- - -*
-         * |    /|    /|
-         * |  /  |  /  |
-         * |/    |/    |
-         * *- - -*- - -*
-         *
-         */
-
-        pushIndex(_blockSize - 1 - step, _blockSize - 1 - 2 * step);
-        pushIndex(_blockSize - 1 - step, _blockSize - 1 - step);
-        pushIndex(_blockSize - 1, _blockSize - 1 - 2 * step);
-        pushIndex(_blockSize - 1, _blockSize - 1 - step);
-        indices.push_back(RESTART_INDEX);
-
-        // TODO
-        pushIndex(_blockSize - 1, _blockSize - 1);
-        pushIndex(_blockSize - 1, _blockSize - 1 - step);
-        pushIndex(_blockSize - 1 - step, _blockSize - 1);
-        pushIndex(_blockSize - 1 - step, _blockSize - 1 - step);
-        pushIndex(_blockSize - 1 - 2 * step, _blockSize - 1);
-        pushIndex(_blockSize - 1 - 2 * step, _blockSize - 1 - step);
-        indices.push_back(RESTART_INDEX);
-
-        count += 12;
-    }
-
-    return count;
+    return _planningThreadActive;
 }
 
-unsigned GeoMipMapping::loadBottomLeftCorner(unsigned step, unsigned permutation)
+bool GeoMipMapping::morphActive()
 {
-    unsigned count = 0;
-
-    if ((permutation & LEFT_BORDER_BITMASK) && (permutation & BOTTOM_BORDER_BITMASK)) { /* bitmask is 1__1 */
-        /*
-         * *- - -*
-         * |\    |
-         * |  \  |
-         * |    \|
-         * *     *- - -*
-         * |    / \    |
-         * |  /     \  |
-         * |/         \|
-         * *- - -*- - -*
-         *
-         */
-
-        pushIndex(step, _blockSize - 1 - 2 * step);
-        pushIndex(0, _blockSize - 1 - 2 * step);
-        pushIndex(step, _blockSize - 1 - step);
-        pushIndex(0, _blockSize - 1);
-        pushIndex(2 * step, _blockSize - 1);
-        indices.push_back(RESTART_INDEX);
-
-        pushIndex(step, _blockSize - 1 - step);
-        pushIndex(2 * step, _blockSize - 1);
-        pushIndex(2 * step, _blockSize - 1 - step);
-        indices.push_back(RESTART_INDEX);
-
-        count += 10;
-
-    } else if (permutation & LEFT_BORDER_BITMASK) { /* bitmask is 1__0*/
-
-        /*
-         * *- - -*
-         * |\    |
-         * |  \  |
-         * |    \|
-         * *     *- - -*
-         * |    /|    /|
-         * |  /  |  /  |
-         * |/    |/    |
-         * *- - -*- - -*
-         *
-         */
-
-        pushIndex(2 * step, _blockSize - 1);
-        pushIndex(2 * step, _blockSize - 1 - step);
-        pushIndex(step, _blockSize - 1);
-        pushIndex(step, _blockSize - 1 - step);
-        indices.push_back(RESTART_INDEX);
-
-        pushIndex(step, _blockSize - 1 - 2 * step);
-        pushIndex(0, _blockSize - 1 - 2 * step);
-        pushIndex(step, _blockSize - 1 - step);
-        pushIndex(0, _blockSize - 1);
-        pushIndex(step, _blockSize - 1);
-        indices.push_back(RESTART_INDEX);
-
-        count += 11;
-
-    } else if (permutation & BOTTOM_BORDER_BITMASK) { /* bitmask is 0__1 */
-        /*
-         * *- - -*
-         * |    /|
-         * |  /  |
-         * |/    |
-         * *- - -*- - -*
-         * |    / \    |
-         * |  /     \  |
-         * |/         \|
-         * *- - -*- - -*
-         *
-         */
-
-        pushIndex(0, _blockSize - 1 - step);
-        pushIndex(0, _blockSize - 1);
-        pushIndex(step, _blockSize - 1 - step);
-        pushIndex(2 * step, _blockSize - 1);
-        pushIndex(2 * step, _blockSize - 1 - step);
-        indices.push_back(RESTART_INDEX);
-
-        pushIndex(0, _blockSize - 1 - 2 * step);
-        pushIndex(0, _blockSize - 1 - step);
-        pushIndex(step, _blockSize - 1 - 2 * step);
-        pushIndex(step, _blockSize - 1 - step);
-        indices.push_back(RESTART_INDEX);
-
-        count += 11;
-
-    } else { /* bitmask is 0__0*/
-        /*
-         * *- - -*
-         * |    /|
-         * |  /  |
-         * |/    |
-         * *- - -*- - -*
-         * |    /|    /|
-         * |  /  |  /  |
-         * |/    |/    |
-         * *- - -*- - -*
-         *
-         */
-
-        pushIndex(2 * step, _blockSize - 1);
-        pushIndex(2 * step, _blockSize - 1 - step);
-        pushIndex(step, _blockSize - 1);
-        pushIndex(step, _blockSize - 1 - step);
-        pushIndex(0, _blockSize - 1);
-        pushIndex(0, _blockSize - 1 - step);
-        indices.push_back(RESTART_INDEX);
-
-        pushIndex(0, _blockSize - 1 - 2 * step);
-        pushIndex(0, _blockSize - 1 - step);
-        pushIndex(step, _blockSize - 1 - 2 * step);
-        pushIndex(step, _blockSize - 1 - step);
-        indices.push_back(RESTART_INDEX);
-
-        count += 12;
-    }
-
-    return count;
+    return _settings.morphActive;
 }
 
-unsigned GeoMipMapping::loadTopBorder(unsigned step, unsigned permutation)
+bool GeoMipMapping::parallelPlanningActive()
 {
-    unsigned count = 0;
-    if (permutation & TOP_BORDER_BITMASK) {
-
-        /* Load border with crack avoidance */
-        for (int j = step * 2; j < (int)(_blockSize) - (int)step * 3; j += step * 2) {
-            pushIndex(j + 2 * step, step);
-            pushIndex(j + 2 * step, 0);
-            pushIndex(j + step, step);
-            pushIndex(j, 0);
-            pushIndex(j, step);
-            indices.push_back(RESTART_INDEX);
-
-            count += 6;
-        }
-
-    } else {
-        /* Load border normally like any other block */
-        for (int j = step * 2; j < (int)_blockSize - (int)step * 2; j += step) {
-            pushIndex(j, 0);
-            pushIndex(j, step);
-
-            count += 2;
-        }
-    }
-    indices.push_back(RESTART_INDEX);
-    count++;
-
-    return count;
+    return _settings.parallelActive;
 }
 
-unsigned GeoMipMapping::loadRightBorder(unsigned step, unsigned permutation)
+unsigned GeoMipMapping::lodUpdates()
 {
-    unsigned count = 0;
-
-    if (permutation & RIGHT_BORDER_BITMASK) {
-
-        /* Load border with crack avoidance */
-        for (int i = step * 2; i < (int)(_blockSize) - (int)step * 3; i += step * 2) {
-
-            pushIndex(_blockSize - 1 - step, i + 2 * step);
-            pushIndex(_blockSize - 1, i + 2 * step);
-            pushIndex(_blockSize - 1 - step, i + step);
-            pushIndex(_blockSize - 1, i);
-            pushIndex(_blockSize - 1 - step, i);
-            indices.push_back(RESTART_INDEX);
-
-            count += 6;
-        }
-
-    } else {
-        /* Load border normally like any other block */
-        /* Left and right borders are loaded specially due to CCW orientation */
-        pushIndex(_blockSize - 1 - step, 3 * step);
-        pushIndex(_blockSize - 1, 2 * step);
-        pushIndex(_blockSize - 1 - step, 2 * step);
-        indices.push_back(RESTART_INDEX);
-
-        count += 4;
-
-        for (int i = step * 2; i < (int)_blockSize - (int)step * 2 - 1; i += step) {
-            pushIndex(_blockSize - 1, i);
-            pushIndex(_blockSize - 1 - step, i + step);
-
-            count += 2;
-        }
-
-        pushIndex(_blockSize - 1, (int)_blockSize - (int)step * 2 - 1);
-        count++;
-    }
-
-    indices.push_back(RESTART_INDEX);
-    count++;
-
-    return count;
+    return _lodUpdates;
 }
 
-unsigned GeoMipMapping::loadBottomBorder(unsigned step, unsigned permutation)
+unsigned GeoMipMapping::borderUpdates()
 {
-    unsigned count = 0;
-
-    if (permutation & BOTTOM_BORDER_BITMASK) {
-
-        /* Load border with crack avoidance */
-        for (int j = step * 2; j < (int)_blockSize - (int)step * 3; j += step * 2) {
+    return _borderUpdates;
+}
 
-            pushIndex(j, _blockSize - step - 1);
-            pushIndex(j, _blockSize - 1);
-            pushIndex(j + step, _blockSize - step - 1);
-            pushIndex(j + 2 * step, _blockSize - 1);
-            pushIndex(j + 2 * step, _blockSize - step - 1);
-            indices.push_back(RESTART_INDEX);
+const GeoMipMappingPlanTimings& GeoMipMapping::planTimings()
+{
+    return _planTimings;
+}
 
-            count += 6;
-        }
-    } else {
-        /* Load border normally like any other block */
-        for (int j = step * 2; j < (int)_blockSize - (int)step * 2; j += step) {
-            pushIndex(j, _blockSize - 1 - step);
-            pushIndex(j, _blockSize - 1);
+bool GeoMipMapping::tessellation()
+{
+    return _tessellation;
+}
 
-            count += 2;
-        }
-    }
-    indices.push_back(RESTART_INDEX);
-    count++;
+float GeoMipMapping::tessellationEdgeLength()
+{
+    return _tessellationEdgeLength;
+}
 
-    return count;
+bool GeoMipMapping::gpuDriven()
+{
+    return _gpuDriven;
 }
 
-unsigned GeoMipMapping::loadLeftBorder(unsigned step, unsigned permutation)
+bool GeoMipMapping::pagedHeightmap()
 {
-    unsigned count = 0;
+    return _pagedHeightmap;
+}
 
-    if (permutation & LEFT_BORDER_BITMASK) {
-        for (int i = step * 2; i < (int)(_blockSize) - (int)(step * 3); i += step * 2) {
+std::size_t GeoMipMapping::pageBudget()
+{
+    return _pageBudget;
+}
 
-            pushIndex(step, i);
-            pushIndex(0, i);
-            pushIndex(step, i + step);
-            pushIndex(0, i + 2 * step);
-            pushIndex(step, i + 2 * step);
-            indices.push_back(RESTART_INDEX);
+void GeoMipMapping::freezeCamera(bool freezeCamera)
+{
+    _settings.freezeCamera = freezeCamera;
+}
 
-            count += 6;
-        }
-    } else {
-        /* Load border normally like any other block */
-        /* Left and right borders are loaded specially due to CCW orientation */
-        pushIndex(0, step * 3);
-        pushIndex(step, step * 2);
-        pushIndex(0, step * 2);
-        indices.push_back(RESTART_INDEX);
-
-        count += 4;
-
-        for (int i = step * 2; i < (int)_blockSize - (int)step * 2 - 1; i += step) {
-            pushIndex(step, i);
-            pushIndex(0, i + step);
-            count += 2;
-        }
+void GeoMipMapping::lodActive(bool lodActive)
+{
+    _settings.lodActive = lodActive;
+}
 
-        pushIndex(step, (int)_blockSize - (int)step * 2 - 1);
-        count++;
-    }
-    indices.push_back(RESTART_INDEX);
-    count++;
+void GeoMipMapping::incrementalActive(bool incrementalActive)
+{
+    _settings.incrementalActive = incrementalActive;
+}
 
-    return count;
+void GeoMipMapping::lodMode(GeoMipMappingLodMode lodMode)
+{
+    _settings.lodMode = lodMode;
 }
 
-void GeoMipMapping::unloadBuffers()
+void GeoMipMapping::pixelError(float pixelError)
 {
-    std::cout << "Unloading buffers" << std::endl;
-    glDeleteVertexArrays(1, &_vao);
-    glDeleteBuffers(1, &_vbo);
-    glDeleteBuffers(1, &_ebo);
+    _settings.pixelError = pixelError;
+}
 
-    AtlodUtil::checkGlError("GeoMipMapping deletion failed");
+void GeoMipMapping::viewportHeight(unsigned viewportHeight)
+{
+    _settings.viewportHeight = viewportHeight;
 }
 
-unsigned GeoMipMapping::nBlocksX()
+void GeoMipMapping::frustumCullingActive(bool frustumCullingActive)
 {
-    return _nBlocksX;
+    _settings.frustumCullingActive = frustumCullingActive;
 }
 
-unsigned GeoMipMapping::nBlocksZ()
+void GeoMipMapping::quadTreeActive(bool quadTreeActive)
 {
-    return _nBlocksZ;
+    _settings.quadTreeActive = quadTreeActive;
 }
 
-bool GeoMipMapping::freezeCamera()
+void GeoMipMapping::batchedDrawingActive(bool batchedDrawingActive)
 {
-    return _freezeCamera;
+    _batchedDrawingActive = batchedDrawingActive;
 }
 
-bool GeoMipMapping::lodActive()
+/* The planning thread is started or stopped with the next frame */
+void GeoMipMapping::planningThreadActive(bool planningThreadActive)
 {
-    return _lodActive;
+    _planningThreadActive = planningThreadActive;
 }
 
-bool GeoMipMapping::frustumCullingActive()
+void GeoMipMapping::morphActive(bool morphActive)
 {
-    return _frustumCullingActive;
+    _settings.morphActive = morphActive;
 }
 
-void GeoMipMapping::freezeCamera(bool freezeCamera)
+void GeoMipMapping::parallelPlanningActive(bool parallelPlanningActive)
 {
-    _freezeCamera = freezeCamera;
+    _settings.parallelActive = parallelPlanningActive;
 }
 
-void GeoMipMapping::lodActive(bool lodActive)
+void GeoMipMapping::tessellationEdgeLength(float tessellationEdgeLength)
 {
-    _lodActive = lodActive;
+    _tessellationEdgeLength = tessellationEdgeLength;
 }
 
-void GeoMipMapping::frustumCullingActive(bool frustumCullingActive)
+void GeoMipMapping::pageBudget(std::size_t pageBudget)
 {
-    _frustumCullingActive = frustumCullingActive;
+    _pageBudget = pageBudget;
 }
 
 void GeoMipMapping::baseDistance(float baseDistance)
 {
-    _baseDistance = baseDistance;
+    _settings.baseDistance = baseDistance;
 }
 
 void GeoMipMapping::doubleDistanceEachLevel(bool doubleDistanceEachLevel)
 {
-    _doubleDistanceEachLevel = doubleDistanceEachLevel;
+    _settings.doubleDistanceEachLevel = doubleDistanceEachLevel;
 }
@@ -2,29 +2,20 @@
 #define GEOMIPMAPPING_H
 
 #include "../camera.h"
+#include "../heightmappagetexture.h"
 #include "../terrain.h"
+#include "geomipmappingblock.h"
+#include "geomipmappingcache.h"
+#include "geomipmappinggpuplanner.h"
+#include "geomipmappingindices.h"
+#include "geomipmappingplanner.h"
+#include "geomipmappingplanningthread.h"
 
 #include <GL/glew.h>
 #include <GLFW/glfw3.h>
 
-struct GeoMipMappingBlock {
-    unsigned blockId;
-
-    /* Actual center in the world space (y-coordinate read from the heightmap) */
-    glm::vec3 worldCenter;
-
-    /* Points defining the AABB. _p1 contains minY and _p2 contains maxY */
-    glm::vec3 p1, p2;
-
-    /* 2D translation to place the flat mesh to its actual center */
-    glm::vec2 translation;
-
-    unsigned currentLod;
-
-    /* The bitmap represents the bordering left, right, top, bottom blocks, where
-     * each bit is either 1 if the bordering block has a lower LOD, otherwise 0 */
-    unsigned currentBorderBitmap;
-};
+#include <memory>
+#include <string>
 
 /* The GeoMipMapping algorithm splits up the terrain into blocks of size
  * _blockSize, which must be of the form 2^n + 1. These blocks contain
@@ -41,30 +32,55 @@ struct GeoMipMappingBlock {
  * indices this way prevents cracks from occuring, while also avoiding
  * unnecessary memory waste.
  *
+ * The per-frame block selection is performed by the GL-independent
+ * GeoMipMappingPlanner, this class only submits the resulting draw list.
+ * By default, the planner runs on a GeoMipMappingPlanningThread, so the
+ * draw list of the next frame is planned while the current one is drawn.
+ *
+ * Optionally (with OpenGL 4.0), every visible block is drawn as a single
+ * patch instead, which the tessellation shaders subdivide per edge based on
+ * its projected size (see geomipmappingtessellation.tesc). The planner then
+ * only culls the blocks, and there is neither an index buffer nor a border
+ * bitmap pass.
+ *
+ * Optionally (with OpenGL 4.3), the whole planning runs in a compute shader
+ * instead and the terrain is drawn with a single indirect draw, see
+ * GeoMipMappingGpuPlanner. The planning thread, the incremental mode and
+ * the quadtree are then unused.
+ *
+ * If the heightmap is tiled (see HeightmapTileCache), the heightmap is not
+ * uploaded as a whole. Instead, the tiles of the blocks in the draw list
+ * are paged into a HeightmapPageTexture every frame, within its own memory
+ * budget (see pageBudget()). Blocks whose tile is not resident yet are
+ * drawn from the coarse fallback of the page texture. The page tiles are a
+ * multiple of the block size, so every block lies within a single tile. The
+ * tessellation and
+ * GPU-driven paths do not know which blocks they draw on the CPU, so they
+ * still need the whole heightmap texture.
+ *
  * As a general rule of thumb, the smaller the block size is, the more CPU
  * computations have to be performed per frame. So, for a small terrain,
  * small block sizes are appropriate, whereas for larger terrains, larger
  * block sizes should be considered. */
 class GeoMipMapping : public Terrain {
-    /* Bitmasks for the 2^4 = 16 possible border permutations.
-     * The bits are organized in left, right, top and bottom.
-     * Each bit is set if the corresponding side has a lower LOD.
-     */
-    static const unsigned LEFT_BORDER_BITMASK = 0b1000;
-    static const unsigned RIGHT_BORDER_BITMASK = 0b0100;
-    static const unsigned TOP_BORDER_BITMASK = 0b0010;
-    static const unsigned BOTTOM_BORDER_BITMASK = 0b0001;
-
     static const unsigned DEFAULT_BLOCK_SIZE = 65;
     static const unsigned DEFAULT_MIN_LOD = 0;
     static const unsigned DEFAULT_MAX_LOD = 100; /* Can be anything, since it is min()-ed anyway */
+    static const unsigned PAGE_TILE_SIZE = 256; /* Approximate, see loadBuffers() */
+    static const std::size_t DEFAULT_PAGE_BUDGET = 64 * 1024 * 1024;
 
 public:
-    GeoMipMapping(Heightmap heightmap, float xzScale = 1.0f, float yScale = 1.0f, unsigned blockSize = DEFAULT_BLOCK_SIZE, unsigned minLod = DEFAULT_MIN_LOD, unsigned maxLod = DEFAULT_MAX_LOD);
+    /* If cacheFolder is not empty, the blocks and indices are loaded from
+     * (or saved to) the block cache in that folder, see GeoMipMappingCache.
+     * If a job system is given (not owned), the blocks are loaded and
+     * planned in parallel on it. With tessellation, the blocks are drawn as
+     * patches (the block cache is not used, since it mainly holds indices).
+     * GPU-driven planning cannot be combined with tessellation. */
+    GeoMipMapping(Heightmap heightmap, float xzScale = 1.0f, float yScale = 1.0f, unsigned blockSize = DEFAULT_BLOCK_SIZE, unsigned minLod = DEFAULT_MIN_LOD, unsigned maxLod = DEFAULT_MAX_LOD, const std::string& cacheFolder = "", JobSystem* jobSystem = nullptr, bool tessellation = false, bool gpuDriven = false);
     ~GeoMipMapping();
 
     /* Overriden virtual methods */
-    void render(Camera camera);
+    void render(Camera& camera);
     void loadBuffers();
     void unloadBuffers();
 
@@ -73,75 +89,99 @@ public:
     unsigned nBlocksZ();
     bool freezeCamera();
     bool lodActive();
+    bool incrementalActive();
+    GeoMipMappingLodMode lodMode();
+    float pixelError();
     bool frustumCullingActive();
+    bool quadTreeActive();
+    bool batchedDrawingActive();
+    bool planningThreadActive();
+    bool morphActive();
+    bool parallelPlanningActive();
+    unsigned lodUpdates();
+    unsigned borderUpdates();
+    const GeoMipMappingPlanTimings& planTimings(); /* Run on the planning thread if it is active */
+    bool tessellation();
+    float tessellationEdgeLength();
+    bool gpuDriven();
+    bool pagedHeightmap();
+    std::size_t pageBudget();
 
     /* Setters */
     void baseDistance(float baseDistance);
     void doubleDistanceEachLevel(bool doubleDistanceEachLevel);
     void freezeCamera(bool freezeCamera);
     void lodActive(bool lodActive);
+    void incrementalActive(bool incrementalActive);
+    void lodMode(GeoMipMappingLodMode lodMode);
+    void pixelError(float pixelError);
+    void viewportHeight(unsigned viewportHeight);
     void frustumCullingActive(bool frustumCullingActive);
+    void quadTreeActive(bool quadTreeActive);
+    void batchedDrawingActive(bool batchedDrawingActive);
+    void planningThreadActive(bool planningThreadActive);
+    void morphActive(bool morphActive);
+    void parallelPlanningActive(bool parallelPlanningActive);
+    void tessellationEdgeLength(float tessellationEdgeLength); /* In pixels */
+    void pageBudget(std::size_t pageBudget); /* In bytes, applied by loadBuffers() */
 
 private:
-    GeoMipMappingBlock& getBlock(unsigned x, unsigned z);
-    unsigned calculateBorderBitmap(unsigned currentBlockId);
-    unsigned determineLodDistance(float distance, float baseDist, bool doubleEachLevel = true);
-    unsigned determineLodPaper(float distance);
-
+    void renderBatched(const GeoMipMappingFrame& frame);
+    void renderPerBlock(const GeoMipMappingFrame& frame);
+    void renderPatches(const GeoMipMappingFrame& frame);
+    bool loadCache();
+    void saveCache();
     void loadBlocks();
     void loadIndices();
     void loadVertices();
+    void loadPatchVertices();
+    void requestPages(const GeoMipMappingFrame& frame);
 
-    /* Note that the below could probably be refactored into fewer methods,
-     * which I didn't manage to do yet due to time constraints. */
-    void loadGeoMipMaps();
-    unsigned loadBorderAreaForPermutation(unsigned lod, unsigned permutation);
-    unsigned loadBorderAreaForLod(unsigned lod, unsigned accumulatedCount);
-    unsigned loadCenterAreaForLod(unsigned lod);
-
-    unsigned loadTopLeftCorner(unsigned step, unsigned permutation);
-    unsigned loadTopRightCorner(unsigned step, unsigned permutation);
-    unsigned loadBottomRightCorner(unsigned step, unsigned permutation);
-    unsigned loadBottomLeftCorner(unsigned step, unsigned permutation);
+    std::vector<float> _vertices;
 
-    unsigned loadTopBorder(unsigned permutation, unsigned step);
-    unsigned loadRightBorder(unsigned permutation, unsigned step);
-    unsigned loadBottomBorder(unsigned permutation, unsigned step);
-    unsigned loadLeftBorder(unsigned permutation, unsigned step);
+    GeoMipMappingIndices _indices;
+    GeoMipMappingCache::Key _cacheKey;
+    std::string _cacheFolder;
+    GeoMipMappingPlanner _planner;
+    GeoMipMappingPlannerSettings _settings;
 
-    /* LOD 0 and LOD 1 blocks are special since they do not have a center area,
-     * but only a border area, which must be loaded specially. */
-    unsigned loadLod0Block();
-    unsigned loadLod1Block(unsigned permutation);
+    /* Uses the planner while it exists, destroyed before the planner */
+    std::unique_ptr<GeoMipMappingPlanningThread> _planningThread;
+    bool _planningThreadActive = true;
 
-    void pushIndex(unsigned x, unsigned y);
+    /* Frame planned on the render thread (without the planning thread),
+     * reused every frame */
+    GeoMipMappingFrame _frame;
 
-    std::vector<float> _vertices;
-    std::vector<unsigned> indices;
+    /* Of the last drawn frame */
+    unsigned _lodUpdates = 0, _borderUpdates = 0;
+    GeoMipMappingPlanTimings _planTimings;
+    bool _batchedDrawingActive = true;
 
-    std::vector<GeoMipMappingBlock> _blocks;
+    /* The number of blocks on the x and z axis */
+    unsigned _nBlocksX, _nBlocksZ;
 
-    std::vector<unsigned> borderSizes;
-    std::vector<unsigned> borderStarts;
-    std::vector<unsigned> centerSizes;
-    std::vector<unsigned> centerStarts;
+    unsigned _vao, _vbo, _ebo = 0;
+    unsigned _instanceVbo; /* Per-block data of the batched draw and tessellation paths */
 
-    float _baseDistance;
-    bool _doubleDistanceEachLevel;
+    /* Tessellation path */
+    bool _tessellation = false;
+    float _tessellationEdgeLength = 8.0f;
 
-    /* The number of blocks on the x and z axis */
-    unsigned _nBlocksX, _nBlocksZ;
+    /* GPU-driven path */
+    bool _gpuDriven = false;
+    Camera _lastCamera; /* Camera of the last unfrozen frame */
+    GeoMipMappingGpuPlanner _gpuPlanner;
 
-    unsigned _vao, _vbo, _ebo;
+    /* Paged heightmap */
+    bool _pagedHeightmap = false;
+    HeightmapPageTexture _pageTexture;
+    std::size_t _pageBudget = DEFAULT_PAGE_BUDGET;
 
     unsigned _blockSize;
 
     unsigned _maxPossibleLod; /* Maximum possible number of LODs, calculated from block size */
     unsigned _minLod, _maxLod; /* Min. anx max. LOD level, defined by user */
-
-    bool _frustumCullingActive = true, _lodActive = true;
-    bool _freezeCamera = false;
-    Camera _lastCamera; /* Used for freezing the camera */
 };
 
 #endif // GEOMIPMAPPING_H
@@ -0,0 +1,22 @@
+#ifndef GEOMIPMAPPINGBLOCK_H
+#define GEOMIPMAPPINGBLOCK_H
+
+#include <glm/glm.hpp>
+
+/* The metadata of a single block. The planner does not store the blocks as
+ * an array of this struct, but splits them up into GeoMipMappingBlocks, it
+ * is used to pass single blocks around (e.g. when loading or caching). */
+struct GeoMipMappingBlock {
+    unsigned blockId;
+
+    /* Actual center in the world space (y-coordinate read from the heightmap) */
+    glm::vec3 worldCenter;
+
+    /* Points defining the AABB. _p1 contains minY and _p2 contains maxY */
+    glm::vec3 p1, p2;
+
+    /* 2D translation to place the flat mesh to its actual center */
+    glm::vec2 translation;
+};
+
+#endif // GEOMIPMAPPINGBLOCK_H
@@ -0,0 +1,57 @@
+#include "geomipmappingblocks.h"
+
+void GeoMipMappingBlocks::resize(unsigned nBlocks)
+{
+    minX.assign(nBlocks, 0.0f);
+    minY.assign(nBlocks, 0.0f);
+    minZ.assign(nBlocks, 0.0f);
+    maxX.assign(nBlocks, 0.0f);
+    maxY.assign(nBlocks, 0.0f);
+    maxZ.assign(nBlocks, 0.0f);
+    centerX.assign(nBlocks, 0.0f);
+    centerY.assign(nBlocks, 0.0f);
+    centerZ.assign(nBlocks, 0.0f);
+    translationX.assign(nBlocks, 0.0f);
+    translationZ.assign(nBlocks, 0.0f);
+    lod.assign(nBlocks, 0);
+    borderBitmap.assign(nBlocks, 0);
+}
+
+unsigned GeoMipMappingBlocks::size() const
+{
+    return lod.size();
+}
+
+void GeoMipMappingBlocks::set(unsigned blockId, const GeoMipMappingBlock& block)
+{
+    minX[blockId] = block.p1.x;
+    minY[blockId] = block.p1.y;
+    minZ[blockId] = block.p1.z;
+    maxX[blockId] = block.p2.x;
+    maxY[blockId] = block.p2.y;
+    maxZ[blockId] = block.p2.z;
+    centerX[blockId] = block.worldCenter.x;
+    centerY[blockId] = block.worldCenter.y;
+    centerZ[blockId] = block.worldCenter.z;
+    translationX[blockId] = block.translation.x;
+    translationZ[blockId] = block.translation.y;
+    lod[blockId] = 0;
+    borderBitmap[blockId] = 0;
+}
+
+GeoMipMappingBlock GeoMipMappingBlocks::get(unsigned blockId) const
+{
+    GeoMipMappingBlock block;
+    block.blockId = blockId;
+    block.worldCenter = glm::vec3(centerX[blockId], centerY[blockId], centerZ[blockId]);
+    block.p1 = glm::vec3(minX[blockId], minY[blockId], minZ[blockId]);
+    block.p2 = glm::vec3(maxX[blockId], maxY[blockId], maxZ[blockId]);
+    block.translation = glm::vec2(translationX[blockId], translationZ[blockId]);
+
+    return block;
+}
+
+AabbArrays GeoMipMappingBlocks::aabbs() const
+{
+    return { minX.data(), minY.data(), minZ.data(), maxX.data(), maxY.data(), maxZ.data() };
+}
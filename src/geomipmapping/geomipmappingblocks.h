@@ -0,0 +1,55 @@
+#ifndef GEOMIPMAPPINGBLOCKS_H
+#define GEOMIPMAPPINGBLOCKS_H
+
+#include "../alignedallocator.h"
+#include "../frustumculling.h"
+#include "geomipmappingblock.h"
+
+#include <vector>
+
+/* Structure-of-arrays storage of all GeoMipMapping blocks.
+ *
+ * Instead of an array of GeoMipMappingBlock structs, every field is kept in
+ * its own contiguous, 32-byte aligned array indexed by block ID. This is
+ * mainly groundwork for the SIMD kernels (see FrustumCulling), which load
+ * the same field of several consecutive blocks at once. Scalar per-block
+ * loops do not gain from it: they read more streams per block, and the
+ * layout benchmark of atlodbench measures them slightly slower than on an
+ * array of structs.
+ *
+ * Besides the metadata, the current LOD and border bitmap of each block are
+ * stored here as well, since these are updated every frame. */
+class GeoMipMappingBlocks {
+public:
+    static const unsigned ALIGNMENT = 32;
+
+    template <typename T>
+    using Array = std::vector<T, AlignedAllocator<T, ALIGNMENT>>;
+
+    void resize(unsigned nBlocks);
+    unsigned size() const;
+
+    /* Stores a single block at the given ID, its LOD and border bitmap are reset */
+    void set(unsigned blockId, const GeoMipMappingBlock& block);
+    GeoMipMappingBlock get(unsigned blockId) const;
+
+    /* The AABB arrays, for batched frustum culling */
+    AabbArrays aabbs() const;
+
+    /* AABB, p1 contains minY and p2 contains maxY */
+    Array<float> minX, minY, minZ;
+    Array<float> maxX, maxY, maxZ;
+
+    /* Actual center in the world space (y-coordinate read from the heightmap) */
+    Array<float> centerX, centerY, centerZ;
+
+    /* 2D translation to place the flat mesh to its actual center */
+    Array<float> translationX, translationZ;
+
+    /* Per-frame state: the current LOD and the bitmap of bordering left,
+     * right, top and bottom blocks with a lower LOD */
+    Array<unsigned> lod;
+    Array<unsigned> borderBitmap;
+};
+
+#endif // GEOMIPMAPPINGBLOCKS_H
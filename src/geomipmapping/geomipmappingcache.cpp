@@ -0,0 +1,172 @@
+#include "geomipmappingcache.h"
+
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+#include <vector>
+
+namespace {
+
+struct Header {
+    char magic[8];
+    uint32_t version;
+
+    /* Size of a single block in bytes, the blocks are stored as is */
+    uint32_t blockStride;
+
+    uint32_t nBlocks;
+    uint32_t nErrors; /* Number of geometric errors, one per block and LOD */
+    uint32_t nIndices;
+    uint32_t nBorders; /* Number of border start/size pairs */
+    uint32_t nCenters; /* Number of center start/size pairs */
+
+    GeoMipMappingCache::Key key;
+};
+
+template <typename T>
+bool readVector(std::ifstream& file, std::vector<T>& values, std::size_t count)
+{
+    values.resize(count);
+    file.read(reinterpret_cast<char*>(values.data()), count * sizeof(T));
+    return file.good();
+}
+
+template <typename T>
+void writeVector(std::ofstream& file, const std::vector<T>& values)
+{
+    file.write(reinterpret_cast<const char*>(values.data()), values.size() * sizeof(T));
+}
+
+}
+
+uint64_t GeoMipMappingCache::hashHeights(const unsigned short* heights, std::size_t count, uint64_t hash)
+{
+    const uint64_t prime = 0x100000001b3ull;
+
+    /* Hash four height values at once */
+    std::size_t i = 0;
+    for (; i + 4 <= count; i += 4) {
+        uint64_t word;
+        std::memcpy(&word, heights + i, sizeof(word));
+
+        hash = (hash ^ word) * prime;
+        hash ^= hash >> 32;
+    }
+
+    for (; i < count; i++) {
+        hash = (hash ^ heights[i]) * prime;
+        hash ^= hash >> 32;
+    }
+
+    return hash;
+}
+
+std::string GeoMipMappingCache::fileName(const std::string& folder, const Key& key)
+{
+    std::ostringstream name;
+    name << folder << "/geomipmapping-" << std::hex << std::setw(16) << std::setfill('0') << key.heightmapHash
+         << std::dec << "-" << key.blockSize << "-" << key.minLod << "-" << key.maxLod << ".atlodc";
+
+    return name.str();
+}
+
+bool GeoMipMappingCache::load(const std::string& fileName, const Key& key, GeoMipMappingPlanner& planner, GeoMipMappingIndices& indices)
+{
+    std::ifstream file(fileName, std::ios::binary);
+
+    if (!file.is_open())
+        return false;
+
+    Header header;
+    file.read(reinterpret_cast<char*>(&header), sizeof(Header));
+
+    if (!file.good()
+        || std::memcmp(header.magic, MAGIC, sizeof(MAGIC)) != 0
+        || header.version != VERSION
+        || header.blockStride != sizeof(GeoMipMappingBlock)
+        || std::memcmp(&header.key, &key, sizeof(Key)) != 0)
+        return false;
+
+    /* Every LOD has a center and 16 border permutations */
+    if (header.nBlocks != planner.nBlocksX() * planner.nBlocksZ()
+        || header.nCenters != GeoMipMappingIndices::nLods(key.minLod, key.maxLod)
+        || header.nBorders != header.nCenters * 16
+        || header.nErrors != header.nBlocks * (key.maxLod - key.minLod + 1))
+        return false;
+
+    std::vector<GeoMipMappingBlock> blocks;
+    std::vector<float> errors;
+    std::vector<unsigned> indexValues, borderStarts, borderSizes, centerStarts, centerSizes;
+
+    if (!readVector(file, blocks, header.nBlocks)
+        || !readVector(file, errors, header.nErrors)
+        || !readVector(file, indexValues, header.nIndices)
+        || !readVector(file, borderStarts, header.nBorders)
+        || !readVector(file, borderSizes, header.nBorders)
+        || !readVector(file, centerStarts, header.nCenters)
+        || !readVector(file, centerSizes, header.nCenters))
+        return false;
+
+    /* Reject truncated or corrupted offsets before they reach glDrawElements */
+    for (unsigned i = 0; i < header.nBorders; i++) {
+        if ((std::size_t)borderStarts[i] + borderSizes[i] > header.nIndices)
+            return false;
+    }
+    for (unsigned i = 0; i < header.nCenters; i++) {
+        if ((std::size_t)centerStarts[i] + centerSizes[i] > header.nIndices)
+            return false;
+    }
+
+    planner.loadBlocks(std::move(blocks), std::move(errors));
+    indices.load(key.blockSize, key.minLod, key.maxLod, std::move(indexValues),
+        std::move(borderStarts), std::move(borderSizes), std::move(centerStarts), std::move(centerSizes));
+
+    return true;
+}
+
+bool GeoMipMappingCache::save(const std::string& fileName, const Key& key, GeoMipMappingPlanner& planner, const GeoMipMappingIndices& indices)
+{
+    /* Write to a temporary file first, so that an interrupted write never
+     * leaves a partial cache file behind */
+    std::string tempFileName = fileName + ".tmp";
+
+    {
+        std::ofstream file(tempFileName, std::ios::binary);
+
+        if (!file.is_open())
+            return false;
+
+        Header header = {};
+        std::memcpy(header.magic, MAGIC, sizeof(MAGIC));
+        header.version = VERSION;
+        header.blockStride = sizeof(GeoMipMappingBlock);
+        header.nBlocks = planner.blocks().size();
+        header.nErrors = planner.geometricErrors().size();
+        header.nIndices = indices.indices().size();
+        header.nBorders = indices.borderStarts().size();
+        header.nCenters = indices.centerStarts().size();
+        header.key = key;
+
+        file.write(reinterpret_cast<const char*>(&header), sizeof(Header));
+        /* The blocks are stored as an array of GeoMipMappingBlock structs */
+        std::vector<GeoMipMappingBlock> blocks(planner.blocks().size());
+        for (unsigned i = 0; i < blocks.size(); i++)
+            blocks[i] = planner.blocks().get(i);
+
+        writeVector(file, blocks);
+        writeVector(file, planner.geometricErrors());
+        writeVector(file, indices.indices());
+        writeVector(file, indices.borderStarts());
+        writeVector(file, indices.borderSizes());
+        writeVector(file, indices.centerStarts());
+        writeVector(file, indices.centerSizes());
+
+        if (!file.good())
+            return false;
+    }
+
+    std::remove(fileName.c_str());
+    return std::rename(tempFileName.c_str(), fileName.c_str()) == 0;
+}
@@ -0,0 +1,56 @@
+#ifndef GEOMIPMAPPINGCACHE_H
+#define GEOMIPMAPPINGCACHE_H
+
+#include "geomipmappingindices.h"
+#include "geomipmappingplanner.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+/* On-disk cache of the GeoMipMapping preprocessing results, i.e. the block
+ * metadata (AABBs, world centers, translations and geometric errors) and
+ * the generated index buffer with its border and center offsets.
+ *
+ * These only depend on the height values, the block size, the LOD range
+ * and the scales, which together form the cache key. A cache file is only
+ * used if its key matches exactly, otherwise the terrain is preprocessed
+ * as usual and the cache file is rewritten. */
+namespace GeoMipMappingCache {
+
+const char MAGIC[8] = { 'A', 'T', 'L', 'O', 'D', 'C', '\0', '\0' };
+const uint32_t VERSION = 3;
+
+struct Key {
+    uint64_t heightmapHash;
+    uint32_t heightmapWidth;
+    uint32_t heightmapHeight;
+    uint32_t blockSize;
+    uint32_t minLod;
+    uint32_t maxLod;
+    float xzScale;
+    float yScale;
+    uint32_t reserved;
+};
+
+static_assert(sizeof(Key) == 40, "Block cache key must be 40 bytes");
+
+const uint64_t HASH_SEED = 0xcbf29ce484222325ull;
+
+/* Incremental 64-bit hash over height values. Feed the heightmap row by
+ * row, starting with HASH_SEED, so that resident and tiled heightmaps
+ * result in the same hash. */
+uint64_t hashHeights(const unsigned short* heights, std::size_t count, uint64_t hash = HASH_SEED);
+
+/* Returns the cache file name for the given key inside the given folder */
+std::string fileName(const std::string& folder, const Key& key);
+
+/* Loads the blocks and indices from the given cache file. Returns false
+ * (and leaves planner and indices untouched) if the file does not exist,
+ * is invalid or was written for a different key. */
+bool load(const std::string& fileName, const Key& key, GeoMipMappingPlanner& planner, GeoMipMappingIndices& indices);
+
+bool save(const std::string& fileName, const Key& key, GeoMipMappingPlanner& planner, const GeoMipMappingIndices& indices);
+}
+
+#endif // GEOMIPMAPPINGCACHE_H
@@ -0,0 +1,221 @@
+#include "geomipmappinggpuplanner.h"
+#include "../atlodutil.h"
+
+#include <GL/glew.h>
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+namespace {
+
+/* Binding points of the shader storage buffers in geomipmappingcull.comp */
+const unsigned BLOCK_BINDING = 0;
+const unsigned ERROR_BINDING = 1;
+const unsigned INDEX_RANGE_BINDING = 2;
+const unsigned STATE_BINDING = 3;
+const unsigned COMMAND_BINDING = 4;
+const unsigned INSTANCE_BINDING = 5;
+const unsigned COUNTER_BINDING = 6;
+
+/* Layout of the Block and BlockState structs of the compute shader */
+const unsigned BLOCK_SIZE_IN_FLOATS = 12;
+const unsigned BLOCK_STATE_SIZE = 3 * sizeof(unsigned);
+
+/* The center and the 16 border permutations of a LOD */
+const unsigned INDEX_RANGES_PER_LOD = 17;
+
+/* Same layout as DrawElementsIndirectCommand */
+struct DrawCommand {
+    unsigned count;
+    unsigned instanceCount;
+    unsigned firstIndex;
+    int baseVertex;
+    unsigned baseInstance;
+};
+
+static_assert(sizeof(GeoMipMappingInstance) == 9 * sizeof(float), "The compute shader writes 9 floats per instance");
+
+unsigned createStorageBuffer(std::size_t size, const void* data, GLenum usage)
+{
+    unsigned buffer;
+    glGenBuffers(1, &buffer);
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, buffer);
+    glBufferData(GL_SHADER_STORAGE_BUFFER, size, data, usage);
+    return buffer;
+}
+
+}
+
+void GeoMipMappingGpuPlanner::loadBuffers(GeoMipMappingPlanner& planner, const GeoMipMappingIndices& indices, unsigned minLod, unsigned maxLod)
+{
+    _shader = Shader("../src/glsl/geomipmappingcull.comp");
+    _frustumPlanesLocation = _shader.uniformLocation("frustumPlanes");
+
+    const GeoMipMappingBlocks& blocks = planner.blocks();
+    _nBlocks = blocks.size();
+
+    _shader.use();
+    _shader.setUint("nBlocksX", planner.nBlocksX());
+    _shader.setUint("nBlocksZ", planner.nBlocksZ());
+    _shader.setUint("minLod", minLod);
+    _shader.setUint("maxLod", maxLod);
+
+    std::vector<float> blockData((std::size_t)_nBlocks * BLOCK_SIZE_IN_FLOATS);
+    for (unsigned i = 0; i < _nBlocks; i++) {
+        float* block = &blockData[(std::size_t)i * BLOCK_SIZE_IN_FLOATS];
+        block[0] = blocks.minX[i];
+        block[1] = blocks.minY[i];
+        block[2] = blocks.minZ[i];
+        block[3] = blocks.translationX[i];
+        block[4] = blocks.maxX[i];
+        block[5] = blocks.maxY[i];
+        block[6] = blocks.maxZ[i];
+        block[7] = blocks.translationZ[i];
+        block[8] = blocks.centerX[i];
+        block[9] = blocks.centerY[i];
+        block[10] = blocks.centerZ[i];
+        block[11] = 0.0f;
+    }
+
+    /* Only LOD >= 2 blocks have a center subblock */
+    std::vector<unsigned> indexRanges;
+    indexRanges.reserve((maxLod - minLod + 1) * INDEX_RANGES_PER_LOD * 2);
+    for (unsigned lod = minLod; lod <= maxLod; lod++) {
+        indexRanges.push_back(lod >= 2 ? indices.centerStart(lod) : 0);
+        indexRanges.push_back(lod >= 2 ? indices.centerSize(lod) : 0);
+
+        for (unsigned permutation = 0; permutation < 16; permutation++) {
+            indexRanges.push_back(indices.borderStart(lod, permutation));
+            indexRanges.push_back(indices.borderSize(lod, permutation));
+        }
+    }
+
+    const std::vector<float>& errors = planner.geometricErrors();
+
+    _blockBuffer = createStorageBuffer(blockData.size() * sizeof(float), blockData.data(), GL_STATIC_DRAW);
+    _errorBuffer = createStorageBuffer(errors.size() * sizeof(float), errors.data(), GL_STATIC_DRAW);
+    _indexRangeBuffer = createStorageBuffer(indexRanges.size() * sizeof(unsigned), indexRanges.data(), GL_STATIC_DRAW);
+    _stateBuffer = createStorageBuffer((std::size_t)_nBlocks * BLOCK_STATE_SIZE, nullptr, GL_DYNAMIC_COPY);
+    _instanceBuffer = createStorageBuffer((std::size_t)_nBlocks * sizeof(GeoMipMappingInstance), nullptr, GL_DYNAMIC_COPY);
+
+    /* Empty until the first frame is planned */
+    std::vector<DrawCommand> commands((std::size_t)_nBlocks * 2, DrawCommand());
+    _commandBuffer = createStorageBuffer(commands.size() * sizeof(DrawCommand), commands.data(), GL_DYNAMIC_COPY);
+
+    unsigned zero = 0;
+    for (unsigned& counterBuffer : _counterBuffers)
+        counterBuffer = createStorageBuffer(sizeof(unsigned), &zero, GL_DYNAMIC_READ);
+
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+    _frame = 0;
+    _visibleBlocks = 0;
+
+    AtlodUtil::checkGlError("GeoMipMapping GPU planner buffer creation failed");
+}
+
+void GeoMipMappingGpuPlanner::unloadBuffers()
+{
+    unsigned buffers[] = { _blockBuffer, _errorBuffer, _indexRangeBuffer, _stateBuffer, _commandBuffer, _instanceBuffer };
+    glDeleteBuffers(6, buffers);
+    glDeleteBuffers(N_COUNTERS, _counterBuffers);
+
+    for (GLsync& fence : _counterFences) {
+        glDeleteSync(fence);
+        fence = nullptr;
+    }
+}
+
+void GeoMipMappingGpuPlanner::plan(Camera& camera, const GeoMipMappingPlannerSettings& settings)
+{
+    /* Read back the counter of the oldest frame if it has finished by now
+     * (otherwise the last value is kept), then reuse it for this frame */
+    unsigned counter = _frame % N_COUNTERS;
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, _counterBuffers[counter]);
+    if (_counterFences[counter]) {
+        GLenum status = glClientWaitSync(_counterFences[counter], 0, 0);
+        if (status == GL_ALREADY_SIGNALED || status == GL_CONDITION_SATISFIED)
+            glGetBufferSubData(GL_SHADER_STORAGE_BUFFER, 0, sizeof(unsigned), &_visibleBlocks);
+
+        glDeleteSync(_counterFences[counter]);
+        _counterFences[counter] = nullptr;
+    }
+
+    unsigned zero = 0;
+    glBufferSubData(GL_SHADER_STORAGE_BUFFER, 0, sizeof(unsigned), &zero);
+    _frame++;
+
+    /* Same distance factor as GeoMipMappingPlanner::plan() */
+    float pixelError = std::max(settings.pixelError, 0.01f);
+    unsigned viewportHeight = std::max(settings.viewportHeight, 1u);
+    float errorDistanceFactor = viewportHeight / (2.0f * std::tan(glm::radians(camera.zoom()) / 2.0f) * pixelError);
+
+    _shader.use();
+
+    Frustum frustum = camera.viewFrustum();
+    const Plane* planes[] = { &frustum.leftFace, &frustum.rightFace, &frustum.topFace,
+        &frustum.bottomFace, &frustum.nearFace, &frustum.farFace };
+    for (unsigned i = 0; i < 6; i++)
+        _shader.setVec4(_frustumPlanesLocation + (int)i, glm::vec4(planes[i]->normal, planes[i]->distance));
+
+    _shader.setVec3("lodCameraPosition", camera.position());
+    _shader.setBool("frustumCullingActive", settings.frustumCullingActive);
+    _shader.setBool("lodActive", settings.lodActive);
+    _shader.setBool("morphActive", settings.morphActive);
+    _shader.setInt("lodMode", settings.lodMode == GeoMipMappingLodMode::SCREEN_SPACE_ERROR ? 1 : 0);
+    _shader.setFloat("baseDistance", settings.baseDistance);
+    _shader.setBool("doubleDistanceEachLevel", settings.doubleDistanceEachLevel);
+    _shader.setFloat("errorDistanceFactor", errorDistanceFactor);
+    _shader.setFloat("morphStartRatio", GeoMipMappingPlanner::MORPH_START_RATIO);
+
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, BLOCK_BINDING, _blockBuffer);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, ERROR_BINDING, _errorBuffer);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, INDEX_RANGE_BINDING, _indexRangeBuffer);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, STATE_BINDING, _stateBuffer);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, COMMAND_BINDING, _commandBuffer);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, INSTANCE_BINDING, _instanceBuffer);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, COUNTER_BINDING, _counterBuffers[counter]);
+
+    unsigned nGroups = (_nBlocks + WORK_GROUP_SIZE - 1) / WORK_GROUP_SIZE;
+
+    /* The border pass reads the LODs and geomorphing factors of the
+     * neighbors, which the first pass has to have written */
+    _shader.setInt("pass", 0);
+    glDispatchCompute(nGroups, 1, 1);
+    glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT);
+
+    _shader.setInt("pass", 1);
+    glDispatchCompute(nGroups, 1, 1);
+
+    /* The commands and instances are read as draw commands and vertex
+     * attributes, the counter by glGetBufferSubData() */
+    glMemoryBarrier(GL_COMMAND_BARRIER_BIT | GL_VERTEX_ATTRIB_ARRAY_BARRIER_BIT | GL_BUFFER_UPDATE_BARRIER_BIT);
+    _counterFences[counter] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+
+    AtlodUtil::checkGlError("GeoMipMapping GPU planning failed");
+}
+
+void GeoMipMappingGpuPlanner::draw()
+{
+    if (_nBlocks == 0)
+        return;
+
+    /* Same per-block attributes as the batched draw path, the base instance
+     * of both commands of a block is its ID */
+    glBindBuffer(GL_ARRAY_BUFFER, _instanceBuffer);
+    glVertexAttribPointer(1, 4, GL_FLOAT, GL_FALSE, sizeof(GeoMipMappingInstance), (void*)0);
+    glVertexAttribPointer(2, 1, GL_FLOAT, GL_FALSE, sizeof(GeoMipMappingInstance), (void*)offsetof(GeoMipMappingInstance, morph));
+    glVertexAttribPointer(3, 4, GL_FLOAT, GL_FALSE, sizeof(GeoMipMappingInstance), (void*)offsetof(GeoMipMappingInstance, edgeMorph));
+    glEnableVertexAttribArray(1);
+    glEnableVertexAttribArray(2);
+    glEnableVertexAttribArray(3);
+
+    glBindBuffer(GL_DRAW_INDIRECT_BUFFER, _commandBuffer);
+    glMultiDrawElementsIndirect(GL_TRIANGLE_STRIP, GL_UNSIGNED_INT, (void*)0, _nBlocks * 2, 0);
+    glBindBuffer(GL_DRAW_INDIRECT_BUFFER, 0);
+}
+
+unsigned GeoMipMappingGpuPlanner::visibleBlocks()
+{
+    return _visibleBlocks;
+}
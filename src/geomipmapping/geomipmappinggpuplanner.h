@@ -0,0 +1,68 @@
+#ifndef GEOMIPMAPPINGGPUPLANNER_H
+#define GEOMIPMAPPINGGPUPLANNER_H
+
+#include "../camera.h"
+#include "../shader.h"
+#include "geomipmappingindices.h"
+#include "geomipmappingplanner.h"
+
+#include <GL/glew.h>
+
+/* GPU-driven counterpart of the GeoMipMappingPlanner, needs OpenGL 4.3.
+ *
+ * The block AABBs, centers and geometric errors and the index ranges of
+ * every (LOD, border permutation) pair are uploaded once into shader
+ * storage buffers. Every frame, a compute shader (see
+ * geomipmappingcull.comp) culls the blocks, selects their LODs, resolves
+ * the border bitmaps and geomorphing factors and writes the draw commands
+ * and per-block attributes directly into the indirect and instance buffers.
+ * The terrain is then drawn with a single glMultiDrawElementsIndirect()
+ * call, so the CPU cost of a frame does not depend on the number of blocks.
+ *
+ * Every block owns two fixed command slots, for its center and border
+ * subblock, which stay empty if the block is culled. The draw count is
+ * therefore constant and never has to be read back. Only the number of
+ * visible blocks is read back for the statistics, a few frames late and
+ * only once the fence of its frame has signalled, so that the CPU never
+ * waits for the GPU.
+ *
+ * Unlike the CPU planner, the LOD of every block is updated every frame
+ * (there is no incremental mode), which makes the culled neighbors of a
+ * visible block up to date as well. */
+class GeoMipMappingGpuPlanner {
+public:
+    static const unsigned WORK_GROUP_SIZE = 64; /* local_size_x of the compute shader */
+
+    /* Uploads the blocks and geometric errors of the planner and the index
+     * ranges, the planner and indices are not needed afterwards */
+    void loadBuffers(GeoMipMappingPlanner& planner, const GeoMipMappingIndices& indices, unsigned minLod, unsigned maxLod);
+    void unloadBuffers();
+
+    /* Dispatches the compute shader for the given (possibly frozen) camera */
+    void plan(Camera& camera, const GeoMipMappingPlannerSettings& settings);
+
+    /* Draws the last planned frame, the terrain's vertex array, index buffer
+     * and shader must be bound */
+    void draw();
+
+    /* Getters */
+    unsigned visibleBlocks(); /* Of the last finished frame among those planned N_COUNTERS frames before the last one */
+
+private:
+    /* Number of visible block counters, used round robin */
+    static const unsigned N_COUNTERS = 3;
+
+    Shader _shader;
+    int _frustumPlanesLocation = -1;
+
+    unsigned _blockBuffer = 0, _errorBuffer = 0, _indexRangeBuffer = 0;
+    unsigned _stateBuffer = 0, _commandBuffer = 0, _instanceBuffer = 0;
+    unsigned _counterBuffers[N_COUNTERS] = {};
+    GLsync _counterFences[N_COUNTERS] = {}; /* Signalled once the frame of the counter finished */
+    unsigned _frame = 0;
+    unsigned _visibleBlocks = 0;
+
+    unsigned _nBlocks = 0;
+};
+
+#endif // GEOMIPMAPPINGGPUPLANNER_H
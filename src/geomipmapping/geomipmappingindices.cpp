@@ -0,0 +1,1053 @@
+#include "geomipmappingindices.h"
+#include "../atlodutil.h"
+
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <utility>
+
+GeoMipMappingIndices::GeoMipMappingIndices()
+{
+}
+
+void GeoMipMappingIndices::load(unsigned blockSize, unsigned minLod, unsigned maxLod)
+{
+    _blockSize = blockSize;
+    _minLod = minLod;
+    _maxLod = maxLod;
+
+    clear();
+
+    /* Disclaimer: some of the addition and subtraction below probably needs to be
+     * refactored, since on some lines I directly subtract after I add, which
+     * obviously makes no sense */
+    unsigned totalCount = 0;
+
+    if (_minLod == 0) {
+        /* ========================== Load LOD 0 block ==========================*/
+        unsigned lod0Count = loadLod0Block();
+        totalCount += lod0Count;
+
+        /* For LOD 0, the (single) border block is always the same */
+        for (int i = 0; i < 16; i++) {
+            _borderStarts.push_back(totalCount - lod0Count);
+            _borderSizes.push_back(lod0Count);
+        }
+
+        /* LOD 0 border block does not have a center */
+        _centerStarts.push_back(0);
+        _centerSizes.push_back(0);
+    }
+
+    if (_minLod == 0 || _minLod == 1) {
+
+        /* ========================== Load LOD 1 block ==========================*/
+        for (unsigned i = 0; i < 16; i++) {
+            unsigned lod1Count = loadLod1Block(i);
+            totalCount += lod1Count;
+            _borderStarts.push_back(totalCount - lod1Count);
+            _borderSizes.push_back(lod1Count);
+        }
+
+        /* LOD 1 border block does not have a center */
+        _centerStarts.push_back(0);
+        _centerSizes.push_back(0);
+    }
+
+    /* ============================= Load rest ==============================*/
+    for (unsigned i = std::max(_minLod, 2u); i <= _maxLod; i++) {
+        /* Load border subblocks */
+        unsigned borderCount = loadBorderAreaForLod(i, totalCount);
+
+        totalCount += borderCount;
+
+        /* Load center subblocks */
+        unsigned centerCount = loadCenterAreaForLod(i);
+        totalCount += centerCount;
+        _centerStarts.push_back(totalCount - centerCount);
+    }
+}
+
+unsigned GeoMipMappingIndices::nLods(unsigned minLod, unsigned maxLod)
+{
+    return std::max(maxLod, 1u) - minLod + 1;
+}
+
+void GeoMipMappingIndices::load(unsigned blockSize, unsigned minLod, unsigned maxLod,
+    std::vector<unsigned> indices,
+    std::vector<unsigned> borderStarts, std::vector<unsigned> borderSizes,
+    std::vector<unsigned> centerStarts, std::vector<unsigned> centerSizes)
+{
+    _blockSize = blockSize;
+    _minLod = minLod;
+    _maxLod = maxLod;
+
+    _indices = std::move(indices);
+    _borderStarts = std::move(borderStarts);
+    _borderSizes = std::move(borderSizes);
+    _centerStarts = std::move(centerStarts);
+    _centerSizes = std::move(centerSizes);
+}
+
+void GeoMipMappingIndices::pushIndex(unsigned x, unsigned y)
+{
+    _indices.push_back(y * _blockSize + x);
+}
+
+unsigned GeoMipMappingIndices::loadCenterAreaForLod(unsigned lod)
+{
+    unsigned step = std::pow(2, _maxLod - lod);
+    unsigned count = 0;
+
+    for (unsigned i = step; i < _blockSize - step - 1; i += step) {
+        for (unsigned j = step; j < _blockSize - step; j += step) {
+            pushIndex(j, i);
+            pushIndex(j, i + step);
+            count += 2;
+        }
+        _indices.push_back(RESTART_INDEX);
+        count++;
+    }
+
+    _centerSizes.push_back(count);
+
+    return count;
+}
+
+unsigned GeoMipMappingIndices::loadBorderAreaForLod(unsigned lod, unsigned accumulatedCount)
+{
+    unsigned totalCount = 0;
+
+    /* 2^4 = 16 possible combinations */
+    for (int i = 0; i < 16; i++) {
+        unsigned count = loadBorderAreaForPermutation(lod, i);
+        totalCount += count;
+        accumulatedCount += count;
+        _borderStarts.push_back(accumulatedCount - count);
+    }
+
+    return totalCount;
+}
+
+unsigned GeoMipMappingIndices::loadLod0Block()
+{
+    pushIndex(0, 0);
+    pushIndex(0, _blockSize - 1);
+    pushIndex(_blockSize - 1, 0);
+    pushIndex(_blockSize - 1, _blockSize - 1);
+    _indices.push_back(RESTART_INDEX);
+
+    return 5;
+}
+
+unsigned GeoMipMappingIndices::loadLod1Block(unsigned permutation)
+{
+    unsigned count = 0;
+    unsigned step = std::pow(2, _maxLod - 1);
+
+    /* ============== Block is surrounded by lower LOD blocks ============== */
+    if (permutation == 0b1111) {
+        pushIndex(0, 0);
+        pushIndex(step, step);
+        pushIndex(_blockSize - 1, 0);
+        pushIndex(_blockSize - 1, _blockSize - 1);
+        _indices.push_back(RESTART_INDEX);
+
+        pushIndex(0, 0);
+        pushIndex(0, _blockSize - 1);
+        pushIndex(step, step);
+        pushIndex(_blockSize - 1, _blockSize - 1);
+        _indices.push_back(RESTART_INDEX);
+        count += 10;
+    }
+
+    /* ======= Block is surrounded by exactly three lower LOD blocks ======= */
+    else if (permutation == 0b1110 || permutation == 0b1101 || permutation == 0b1011 || permutation == 0b00111) {
+        /* Left or bottom block has the same LOD */
+        if (permutation == 0b1110 || permutation == 0b0111) {
+
+            pushIndex(0, 0);
+            pushIndex(step, step);
+            pushIndex(_blockSize - 1, 0);
+            pushIndex(_blockSize - 1, _blockSize - 1);
+            _indices.push_back(RESTART_INDEX);
+            count += 5;
+
+            /* Bottom block has the same LOD*/
+            if (permutation == 0b1110) {
+
+                pushIndex(_blockSize - 1, _blockSize - 1);
+                pushIndex(step, step);
+                pushIndex(step, _blockSize - 1);
+                pushIndex(0, _blockSize - 1);
+                _indices.push_back(RESTART_INDEX);
+
+                pushIndex(0, _blockSize - 1);
+                pushIndex(step, step);
+                pushIndex(0, 0);
+                _indices.push_back(RESTART_INDEX);
+
+                count += 9;
+            } else { /* Left block has the same LOD */
+                pushIndex(0, _blockSize - 1);
+                pushIndex(step, step);
+                pushIndex(0, step);
+                pushIndex(0, 0);
+                _indices.push_back(RESTART_INDEX);
+
+                pushIndex(_blockSize - 1, _blockSize - 1);
+                pushIndex(step, step);
+                pushIndex(0, _blockSize - 1);
+                _indices.push_back(RESTART_INDEX);
+
+                count += 9;
+            }
+
+        } else { /* Top or right block has the same LOD */
+
+            pushIndex(0, 0);
+            pushIndex(0, _blockSize - 1);
+            pushIndex(step, step);
+            pushIndex(_blockSize - 1, _blockSize - 1);
+            _indices.push_back(RESTART_INDEX);
+
+            count += 5;
+
+            /* Top block has the same LOD*/
+            if (permutation == 0b1101) {
+
+                pushIndex(0, 0);
+                pushIndex(step, step);
+                pushIndex(step, 0);
+                pushIndex(_blockSize - 1, 0);
+                _indices.push_back(RESTART_INDEX);
+
+                pushIndex(step, step);
+                pushIndex(_blockSize - 1, _blockSize - 1);
+                pushIndex(_blockSize - 1, 0);
+                _indices.push_back(RESTART_INDEX);
+
+                count += 9;
+
+            } else { /* Right block has the same LOD */
+
+                pushIndex(_blockSize - 1, 0);
+                pushIndex(step, step);
+                pushIndex(_blockSize - 1, step);
+                pushIndex(_blockSize - 1, _blockSize - 1);
+                _indices.push_back(RESTART_INDEX);
+
+                pushIndex(0, 0);
+                pushIndex(step, step);
+                pushIndex(_blockSize - 1, 0);
+                _indices.push_back(RESTART_INDEX);
+
+                count += 9;
+            }
+        }
+    }
+
+    /* ======== Block is surrounded by exaclty two lower LOD blocks ======== */
+    else if (permutation == 0b0011 || permutation == 0b1100) {
+        if (permutation == 0b0011) {
+
+            pushIndex(_blockSize - 1, step);
+            pushIndex(_blockSize - 1, 0);
+            pushIndex(step, step);
+            pushIndex(0, 0);
+            pushIndex(0, _blockSize - 1);
+            _indices.push_back(RESTART_INDEX);
+
+            pushIndex(0, step);
+            pushIndex(0, _blockSize - 1);
+            pushIndex(step, step);
+            pushIndex(_blockSize - 1, _blockSize - 1);
+            pushIndex(_blockSize - 1, step);
+            _indices.push_back(RESTART_INDEX);
+
+            count += 12;
+        } else {
+
+            pushIndex(step, 0);
+            pushIndex(0, 0);
+            pushIndex(step, step);
+            pushIndex(0, _blockSize - 1);
+            pushIndex(step, _blockSize - 1);
+            _indices.push_back(RESTART_INDEX);
+
+            pushIndex(step, _blockSize - 1);
+            pushIndex(_blockSize - 1, _blockSize - 1);
+            pushIndex(step, step);
+            pushIndex(_blockSize - 1, 0);
+            pushIndex(step, 0);
+            _indices.push_back(RESTART_INDEX);
+
+            count += 12;
+        }
+    }
+
+    /* ==== Determine which corner is a regular quad and the method of the ====
+     *      opposing corner */
+    else if (!(permutation & (LEFT_BORDER_BITMASK | TOP_BORDER_BITMASK))) {
+        count += loadBottomRightCorner(step, permutation);
+
+        pushIndex(0, 0);
+        pushIndex(0, step);
+        pushIndex(step, 0);
+        pushIndex(step, step);
+        _indices.push_back(RESTART_INDEX);
+        count += 5;
+    } else if (!(permutation & (TOP_BORDER_BITMASK | RIGHT_BORDER_BITMASK))) {
+        count += loadBottomLeftCorner(step, permutation);
+
+        pushIndex(step, 0);
+        pushIndex(step, step);
+        pushIndex(_blockSize - 1, 0);
+        pushIndex(_blockSize - 1, step);
+        _indices.push_back(RESTART_INDEX);
+        count += 5;
+
+    } else if (!(permutation & (RIGHT_BORDER_BITMASK | BOTTOM_BORDER_BITMASK))) {
+        count += loadTopLeftCorner(step, permutation);
+
+        pushIndex(step, step);
+        pushIndex(step, _blockSize - 1);
+        pushIndex(_blockSize - 1, step);
+        pushIndex(_blockSize - 1, _blockSize - 1);
+        _indices.push_back(RESTART_INDEX);
+        count += 5;
+    } else if (!(permutation & (BOTTOM_BORDER_BITMASK | LEFT_BORDER_BITMASK))) {
+        count += loadTopRightCorner(step, permutation);
+
+        pushIndex(0, step);
+        pushIndex(0, _blockSize - 1);
+        pushIndex(step, step);
+        pushIndex(step, _blockSize - 1);
+        _indices.push_back(RESTART_INDEX);
+        count += 5;
+    }
+
+    return count;
+}
+
+unsigned GeoMipMappingIndices::loadBorderAreaForPermutation(unsigned lod, unsigned permutation)
+{
+    unsigned step = std::pow(2, _maxLod - lod);
+    unsigned count = 0;
+
+    count += loadTopLeftCorner(step, permutation);
+    count += loadTopBorder(step, permutation);
+    count += loadTopRightCorner(step, permutation);
+    count += loadRightBorder(step, permutation);
+    count += loadBottomRightCorner(step, permutation);
+    count += loadBottomBorder(step, permutation);
+    count += loadBottomLeftCorner(step, permutation);
+    count += loadLeftBorder(step, permutation);
+
+    _borderSizes.push_back(count);
+
+    return count;
+}
+
+unsigned GeoMipMappingIndices::loadTopLeftCorner(unsigned step, unsigned permutation)
+{
+    unsigned count = 0;
+    if ((permutation & LEFT_BORDER_BITMASK) && (permutation & TOP_BORDER_BITMASK)) { /* bitmask is 1_1_ */
+        /*
+         * *- - -*- - -*
+         * |\         /|
+         * |  \     /  |
+         * |    \ /    |
+         * *     *- - -*
+         * |    /|
+         * |  /  |
+         * |/    |
+         * *- - -*
+         *
+         */
+
+        pushIndex(2 * step, step);
+        pushIndex(2 * step, 0);
+        pushIndex(step, step);
+        pushIndex(0, 0);
+        pushIndex(0, 2 * step);
+        _indices.push_back(RESTART_INDEX);
+
+        pushIndex(step, 2 * step);
+        pushIndex(step, step);
+        pushIndex(0, 2 * step);
+        _indices.push_back(RESTART_INDEX);
+
+        count += 10;
+
+    } else if (permutation & LEFT_BORDER_BITMASK) { /* bitmask is 1_0_*/
+
+        /*
+         * *- - -*- - -*
+         * |\    |    /|
+         * |  \  |  /  |
+         * |    \|/    |
+         * *     *- - -*
+         * |    /|
+         * |  /  |
+         * |/    |
+         * *- - -*
+         *
+         */
+
+        pushIndex(step, 0);
+        pushIndex(0, 0);
+        pushIndex(step, step);
+        pushIndex(0, 2 * step);
+        pushIndex(step, 2 * step);
+        _indices.push_back(RESTART_INDEX);
+
+        pushIndex(step, 0);
+        pushIndex(step, step);
+        pushIndex(2 * step, 0);
+        pushIndex(2 * step, step);
+        _indices.push_back(RESTART_INDEX);
+
+        count += 11;
+
+    } else if (permutation & TOP_BORDER_BITMASK) { /* bitmask is 0_1_ */
+        /*
+         * *- - -*- - -*
+         * |\         /|
+         * |  \     /  |
+         * |    \ /    |
+         * *- - -*- - -*
+         * |    /|
+         * |  /  |
+         * |/    |
+         * *- - -*
+         *
+         */
+
+        pushIndex(0, step);
+        pushIndex(0, 2 * step);
+        pushIndex(step, step);
+        pushIndex(step, 2 * step);
+        _indices.push_back(RESTART_INDEX);
+
+        pushIndex(2 * step, step);
+        pushIndex(2 * step, 0);
+        pushIndex(step, step);
+        pushIndex(0, 0);
+        pushIndex(0, step);
+        _indices.push_back(RESTART_INDEX);
+
+        count += 11;
+
+    } else { /* bitmask is 0_0_*/
+        /*
+         * *- - -*- - -*
+         * |    /|    /|
+         * |  /  |  /  |
+         * |/    |/    |
+         * *- - -*- - -*
+         * |    /|
+         * |  /  |
+         * |/    |
+         * *- - -*
+         *
+         */
+
+        pushIndex(0, step);
+        pushIndex(0, 2 * step);
+        pushIndex(step, step);
+        pushIndex(step, 2 * step);
+        _indices.push_back(RESTART_INDEX);
+
+        pushIndex(0, 0);
+        pushIndex(0, step);
+        pushIndex(step, 0);
+        pushIndex(step, step);
+        pushIndex(2 * step, 0);
+        pushIndex(2 * step, step);
+        _indices.push_back(RESTART_INDEX);
+
+        count += 12;
+    }
+
+    return count;
+}
+
+unsigned GeoMipMappingIndices::loadTopRightCorner(unsigned step, unsigned permutation)
+{
+    unsigned count = 0;
+    if ((permutation & RIGHT_BORDER_BITMASK) && (permutation & TOP_BORDER_BITMASK)) { /* bitmask is _11_ */
+        /*
+         * *- - -*- - -*
+         * |\         /|
+         * |  \     /  |
+         * |    \ /    |
+         * *- - -*     *
+         *       |\    |
+         *       |  \  |
+         *       |    \|
+         *       *- - -*
+         *
+         */
+
+        pushIndex(_blockSize - 1 - step, 2 * step);
+        pushIndex(_blockSize - 1, 2 * step);
+        pushIndex(_blockSize - 1 - step, step);
+        pushIndex(_blockSize - 1, 0);
+        pushIndex(_blockSize - 1 - 2 * step, 0);
+        _indices.push_back(RESTART_INDEX);
+
+        pushIndex(_blockSize - 1 - step, step);
+        pushIndex(_blockSize - 1 - 2 * step, 0);
+        pushIndex(_blockSize - 1 - 2 * step, step);
+        _indices.push_back(RESTART_INDEX);
+
+        count += 10;
+
+    } else if (permutation & RIGHT_BORDER_BITMASK) { /* bitmask is _10_*/
+
+        /*
+         * *- - -*- - -*
+         * |    /|    /|
+         * |  /  |  /  |
+         * |/    |/    |
+         * *- - -*     *
+         *       |\    |
+         *       |  \  |
+         *       |    \|
+         *       *- - -*
+         */
+
+        pushIndex(_blockSize - 1 - step, 2 * step);
+        pushIndex(_blockSize - 1, 2 * step);
+        pushIndex(_blockSize - 1 - step, step);
+        pushIndex(_blockSize - 1, 0);
+        pushIndex(_blockSize - 1 - step, 0);
+        _indices.push_back(RESTART_INDEX);
+
+        pushIndex(_blockSize - 1 - 2 * step, 0);
+        pushIndex(_blockSize - 1 - 2 * step, step);
+        pushIndex(_blockSize - 1 - step, 0);
+        pushIndex(_blockSize - 1 - step, step);
+        _indices.push_back(RESTART_INDEX);
+
+        count += 11;
+
+    } else if (permutation & TOP_BORDER_BITMASK) { /* bitmask is _01_ */
+        /*
+         * *- - -*- - -*
+         * |\         /|
+         * |  \     /  |
+         * |    \ /    |
+         * *- - -*- - -*
+         *       |    /|
+         *       |  /  |
+         *       |/    |
+         *       *- - -*
+         *
+         */
+
+        pushIndex(_blockSize - 1 - step, step);
+        pushIndex(_blockSize - 1 - step, 2 * step);
+        pushIndex(_blockSize - 1, step);
+        pushIndex(_blockSize - 1, 2 * step);
+        _indices.push_back(RESTART_INDEX);
+
+        pushIndex(_blockSize - 1, step);
+        pushIndex(_blockSize - 1, 0);
+        pushIndex(_blockSize - 1 - step, step);
+        pushIndex(_blockSize - 1 - 2 * step, 0);
+        pushIndex(_blockSize - 1 - 2 * step, step);
+        _indices.push_back(RESTART_INDEX);
+
+        count += 11;
+
+    } else { /* bitmask is _00_*/
+        /*
+         * *- - -*- - -*
+         * |    /|    /|
+         * |  /  |  /  |
+         * |/    |/    |
+         * *- - -*- - -*
+         *       |    /|
+         *       |  /  |
+         *       |/    |
+         *       *- - -*
+         *
+         */
+
+        pushIndex(_blockSize - 1 - 2 * step, 0);
+        pushIndex(_blockSize - 1 - 2 * step, step);
+        pushIndex(_blockSize - 1 - step, 0);
+        pushIndex(_blockSize - 1 - step, step);
+        pushIndex(_blockSize - 1, 0);
+        pushIndex(_blockSize - 1, step);
+        _indices.push_back(RESTART_INDEX);
+
+        pushIndex(_blockSize - 1 - step, step);
+        pushIndex(_blockSize - 1 - step, 2 * step);
+        pushIndex(_blockSize - 1, step);
+        pushIndex(_blockSize - 1, 2 * step);
+        _indices.push_back(RESTART_INDEX);
+
+        count += 12;
+    }
+
+    return count;
+}
+
+unsigned GeoMipMappingIndices::loadBottomRightCorner(unsigned step, unsigned permutation)
+{
+    unsigned count = 0;
+
+    if ((permutation & RIGHT_BORDER_BITMASK) && (permutation & BOTTOM_BORDER_BITMASK)) { /* bitmask is _1_1 */
+        /*
+         *       *- - -*
+         *       |    /|
+         *       |  /  |
+         *       |/    |
+         * *- - -*     *
+         * |    / \    |
+         * |  /     \  |
+         * |/         \|
+         * *- - -*- - -*
+         *
+         */
+
+        pushIndex(_blockSize - 1 - 2 * step, _blockSize - 1 - step);
+        pushIndex(_blockSize - 1 - 2 * step, _blockSize - 1);
+        pushIndex(_blockSize - 1 - step, _blockSize - 1 - step);
+        pushIndex(_blockSize - 1, _blockSize - 1);
+        pushIndex(_blockSize - 1, _blockSize - 1 - 2 * step);
+        _indices.push_back(RESTART_INDEX);
+
+        pushIndex(_blockSize - 1 - step, _blockSize - 1 - 2 * step);
+        pushIndex(_blockSize - 1 - step, _blockSize - 1 - step);
+        pushIndex(_blockSize - 1, _blockSize - 1 - 2 * step);
+        _indices.push_back(RESTART_INDEX);
+
+        count += 10;
+
+    } else if (permutation & RIGHT_BORDER_BITMASK) { /* bitmask is _1_0*/
+
+        /*
+         *       *- - -*
+         *       |    /|
+         *       |  /  |
+         *       |/    |
+         * *- - -*     *
+         * |    /|\    |
+         * |  /  |  \  |
+         * |/    |    \|
+         * *- - -*- - -*
+         *
+         */
+
+        pushIndex(_blockSize - 1 - step, _blockSize - 1);
+        pushIndex(_blockSize - 1, _blockSize - 1);
+        pushIndex(_blockSize - 1 - step, _blockSize - 1 - step);
+        pushIndex(_blockSize - 1, _blockSize - 1 - 2 * step);
+        pushIndex(_blockSize - 1 - step, _blockSize - 1 - 2 * step);
+        _indices.push_back(RESTART_INDEX);
+
+        pushIndex(_blockSize - 1 - 2 * step, _blockSize - 1 - step);
+        pushIndex(_blockSize - 1 - 2 * step, _blockSize - 1);
+        pushIndex(_blockSize - 1 - step, _blockSize - 1 - step);
+        pushIndex(_blockSize - 1 - step, _blockSize - 1);
+        _indices.push_back(RESTART_INDEX);
+
+        count += 11;
+
+    } else if (permutation & BOTTOM_BORDER_BITMASK) { /* bitmask is _0_1 */
+        /*
+         *       *- - -*
+         *       |    /|
+         *       |  /  |
+         *       |/    |
+         * *- - -*- - -*
+         * |    / \    |
+         * |  /     \  |
+         * |/         \|
+         * *- - -*- - -*
+         *
+         */
+
+        pushIndex(_blockSize - 1 - step, _blockSize - 1 - 2 * step);
+        pushIndex(_blockSize - 1 - step, _blockSize - 1 - step);
+        pushIndex(_blockSize - 1, _blockSize - 1 - 2 * step);
+        pushIndex(_blockSize - 1, _blockSize - 1 - step);
+        _indices.push_back(RESTART_INDEX);
+
+        pushIndex(_blockSize - 1 - 2 * step, _blockSize - 1 - step);
+        pushIndex(_blockSize - 1 - 2 * step, _blockSize - 1);
+        pushIndex(_blockSize - 1 - step, _blockSize - 1 - step);
+        pushIndex(_blockSize - 1, _blockSize - 1);
+        pushIndex(_blockSize - 1, _blockSize - 1 - step);
+        _indices.push_back(RESTART_INDEX);
+
+        count += 11;
+
+    } else { /* bitmask is _0_0*/
+        /*
+         *       *- - -*
+         *       |    /|
+         *       |  /  |
+         *       |/    |
+         * *- - -*- - -*
+         * |    /|    /|
+         * |  /  |  /  |
+         * |/    |/    |
+         * *- - -*- - -*
+         *
+         */
+
+        pushIndex(_blockSize - 1 - step, _blockSize - 1 - 2 * step);
+        pushIndex(_blockSize - 1 - step, _blockSize - 1 - step);
+        pushIndex(_blockSize - 1, _blockSize - 1 - 2 * step);
+        pushIndex(_blockSize - 1, _blockSize - 1 - step);
+        _indices.push_back(RESTART_INDEX);
+
+        // TODO
+        pushIndex(_blockSize - 1, _blockSize - 1);
+        pushIndex(_blockSize - 1, _blockSize - 1 - step);
+        pushIndex(_blockSize - 1 - step, _blockSize - 1);
+        pushIndex(_blockSize - 1 - step, _blockSize - 1 - step);
+        pushIndex(_blockSize - 1 - 2 * step, _blockSize - 1);
+        pushIndex(_blockSize - 1 - 2 * step, _blockSize - 1 - step);
+        _indices.push_back(RESTART_INDEX);
+
+        count += 12;
+    }
+
+    return count;
+}
+
+unsigned GeoMipMappingIndices::loadBottomLeftCorner(unsigned step, unsigned permutation)
+{
+    unsigned count = 0;
+
+    if ((permutation & LEFT_BORDER_BITMASK) && (permutation & BOTTOM_BORDER_BITMASK)) { /* bitmask is 1__1 */
+        /*
+         * *- - -*
+         * |\    |
+         * |  \  |
+         * |    \|
+         * *     *- - -*
+         * |    / \    |
+         * |  /     \  |
+         * |/         \|
+         * *- - -*- - -*
+         *
+         */
+
+        pushIndex(step, _blockSize - 1 - 2 * step);
+        pushIndex(0, _blockSize - 1 - 2 * step);
+        pushIndex(step, _blockSize - 1 - step);
+        pushIndex(0, _blockSize - 1);
+        pushIndex(2 * step, _blockSize - 1);
+        _indices.push_back(RESTART_INDEX);
+
+        pushIndex(step, _blockSize - 1 - step);
+        pushIndex(2 * step, _blockSize - 1);
+        pushIndex(2 * step, _blockSize - 1 - step);
+        _indices.push_back(RESTART_INDEX);
+
+        count += 10;
+
+    } else if (permutation & LEFT_BORDER_BITMASK) { /* bitmask is 1__0*/
+
+        /*
+         * *- - -*
+         * |\    |
+         * |  \  |
+         * |    \|
+         * *     *- - -*
+         * |    /|    /|
+         * |  /  |  /  |
+         * |/    |/    |
+         * *- - -*- - -*
+         *
+         */
+
+        pushIndex(2 * step, _blockSize - 1);
+        pushIndex(2 * step, _blockSize - 1 - step);
+        pushIndex(step, _blockSize - 1);
+        pushIndex(step, _blockSize - 1 - step);
+        _indices.push_back(RESTART_INDEX);
+
+        pushIndex(step, _blockSize - 1 - 2 * step);
+        pushIndex(0, _blockSize - 1 - 2 * step);
+        pushIndex(step, _blockSize - 1 - step);
+        pushIndex(0, _blockSize - 1);
+        pushIndex(step, _blockSize - 1);
+        _indices.push_back(RESTART_INDEX);
+
+        count += 11;
+
+    } else if (permutation & BOTTOM_BORDER_BITMASK) { /* bitmask is 0__1 */
+        /*
+         * *- - -*
+         * |    /|
+         * |  /  |
+         * |/    |
+         * *- - -*- - -*
+         * |    / \    |
+         * |  /     \  |
+         * |/         \|
+         * *- - -*- - -*
+         *
+         */
+
+        pushIndex(0, _blockSize - 1 - step);
+        pushIndex(0, _blockSize - 1);
+        pushIndex(step, _blockSize - 1 - step);
+        pushIndex(2 * step, _blockSize - 1);
+        pushIndex(2 * step, _blockSize - 1 - step);
+        _indices.push_back(RESTART_INDEX);
+
+        pushIndex(0, _blockSize - 1 - 2 * step);
+        pushIndex(0, _blockSize - 1 - step);
+        pushIndex(step, _blockSize - 1 - 2 * step);
+        pushIndex(step, _blockSize - 1 - step);
+        _indices.push_back(RESTART_INDEX);
+
+        count += 11;
+
+    } else { /* bitmask is 0__0*/
+        /*
+         * *- - -*
+         * |    /|
+         * |  /  |
+         * |/    |
+         * *- - -*- - -*
+         * |    /|    /|
+         * |  /  |  /  |
+         * |/    |/    |
+         * *- - -*- - -*
+         *
+         */
+
+        pushIndex(2 * step, _blockSize - 1);
+        pushIndex(2 * step, _blockSize - 1 - step);
+        pushIndex(step, _blockSize - 1);
+        pushIndex(step, _blockSize - 1 - step);
+        pushIndex(0, _blockSize - 1);
+        pushIndex(0, _blockSize - 1 - step);
+        _indices.push_back(RESTART_INDEX);
+
+        pushIndex(0, _blockSize - 1 - 2 * step);
+        pushIndex(0, _blockSize - 1 - step);
+        pushIndex(step, _blockSize - 1 - 2 * step);
+        pushIndex(step, _blockSize - 1 - step);
+        _indices.push_back(RESTART_INDEX);
+
+        count += 12;
+    }
+
+    return count;
+}
+
+unsigned GeoMipMappingIndices::loadTopBorder(unsigned step, unsigned permutation)
+{
+    unsigned count = 0;
+    if (permutation & TOP_BORDER_BITMASK) {
+
+        /* Load border with crack avoidance */
+        for (int j = step * 2; j < (int)(_blockSize) - (int)step * 3; j += step * 2) {
+            pushIndex(j + 2 * step, step);
+            pushIndex(j + 2 * step, 0);
+            pushIndex(j + step, step);
+            pushIndex(j, 0);
+            pushIndex(j, step);
+            _indices.push_back(RESTART_INDEX);
+
+            count += 6;
+        }
+
+    } else {
+        /* Load border normally like any other block */
+        for (int j = step * 2; j < (int)_blockSize - (int)step * 2; j += step) {
+            pushIndex(j, 0);
+            pushIndex(j, step);
+
+            count += 2;
+        }
+    }
+    _indices.push_back(RESTART_INDEX);
+    count++;
+
+    return count;
+}
+
+unsigned GeoMipMappingIndices::loadRightBorder(unsigned step, unsigned permutation)
+{
+    unsigned count = 0;
+
+    if (permutation & RIGHT_BORDER_BITMASK) {
+
+        /* Load border with crack avoidance */
+        for (int i = step * 2; i < (int)(_blockSize) - (int)step * 3; i += step * 2) {
+
+            pushIndex(_blockSize - 1 - step, i + 2 * step);
+            pushIndex(_blockSize - 1, i + 2 * step);
+            pushIndex(_blockSize - 1 - step, i + step);
+            pushIndex(_blockSize - 1, i);
+            pushIndex(_blockSize - 1 - step, i);
+            _indices.push_back(RESTART_INDEX);
+
+            count += 6;
+        }
+
+    } else {
+        /* Load border normally like any other block */
+        /* Left and right borders are loaded specially due to CCW orientation */
+        pushIndex(_blockSize - 1 - step, 3 * step);
+        pushIndex(_blockSize - 1, 2 * step);
+        pushIndex(_blockSize - 1 - step, 2 * step);
+        _indices.push_back(RESTART_INDEX);
+
+        count += 4;
+
+        for (int i = step * 2; i < (int)_blockSize - (int)step * 2 - 1; i += step) {
+            pushIndex(_blockSize - 1, i);
+            pushIndex(_blockSize - 1 - step, i + step);
+
+            count += 2;
+        }
+
+        pushIndex(_blockSize - 1, (int)_blockSize - (int)step * 2 - 1);
+        count++;
+    }
+
+    _indices.push_back(RESTART_INDEX);
+    count++;
+
+    return count;
+}
+
+unsigned GeoMipMappingIndices::loadBottomBorder(unsigned step, unsigned permutation)
+{
+    unsigned count = 0;
+
+    if (permutation & BOTTOM_BORDER_BITMASK) {
+
+        /* Load border with crack avoidance */
+        for (int j = step * 2; j < (int)_blockSize - (int)step * 3; j += step * 2) {
+
+            pushIndex(j, _blockSize - step - 1);
+            pushIndex(j, _blockSize - 1);
+            pushIndex(j + step, _blockSize - step - 1);
+            pushIndex(j + 2 * step, _blockSize - 1);
+            pushIndex(j + 2 * step, _blockSize - step - 1);
+            _indices.push_back(RESTART_INDEX);
+
+            count += 6;
+        }
+    } else {
+        /* Load border normally like any other block */
+        for (int j = step * 2; j < (int)_blockSize - (int)step * 2; j += step) {
+            pushIndex(j, _blockSize - 1 - step);
+            pushIndex(j, _blockSize - 1);
+
+            count += 2;
+        }
+    }
+    _indices.push_back(RESTART_INDEX);
+    count++;
+
+    return count;
+}
+
+unsigned GeoMipMappingIndices::loadLeftBorder(unsigned step, unsigned permutation)
+{
+    unsigned count = 0;
+
+    if (permutation & LEFT_BORDER_BITMASK) {
+        for (int i = step * 2; i < (int)(_blockSize) - (int)(step * 3); i += step * 2) {
+
+            pushIndex(step, i);
+            pushIndex(0, i);
+            pushIndex(step, i + step);
+            pushIndex(0, i + 2 * step);
+            pushIndex(step, i + 2 * step);
+            _indices.push_back(RESTART_INDEX);
+
+            count += 6;
+        }
+    } else {
+        /* Load border normally like any other block */
+        /* Left and right borders are loaded specially due to CCW orientation */
+        pushIndex(0, step * 3);
+        pushIndex(step, step * 2);
+        pushIndex(0, step * 2);
+        _indices.push_back(RESTART_INDEX);
+
+        count += 4;
+
+        for (int i = step * 2; i < (int)_blockSize - (int)step * 2 - 1; i += step) {
+            pushIndex(step, i);
+            pushIndex(0, i + step);
+            count += 2;
+        }
+
+        pushIndex(step, (int)_blockSize - (int)step * 2 - 1);
+        count++;
+    }
+    _indices.push_back(RESTART_INDEX);
+    count++;
+
+    return count;
+}
+void GeoMipMappingIndices::clear()
+{
+    _indices.clear();
+    _borderSizes.clear();
+    _borderStarts.clear();
+    _centerSizes.clear();
+    _centerStarts.clear();
+}
+
+const std::vector<unsigned>& GeoMipMappingIndices::indices() const
+{
+    return _indices;
+}
+
+const std::vector<unsigned>& GeoMipMappingIndices::borderStarts() const
+{
+    return _borderStarts;
+}
+
+const std::vector<unsigned>& GeoMipMappingIndices::borderSizes() const
+{
+    return _borderSizes;
+}
+
+const std::vector<unsigned>& GeoMipMappingIndices::centerStarts() const
+{
+    return _centerStarts;
+}
+
+const std::vector<unsigned>& GeoMipMappingIndices::centerSizes() const
+{
+    return _centerSizes;
+}
+
+unsigned GeoMipMappingIndices::borderStart(unsigned lod, unsigned permutation) const
+{
+    return _borderStarts[(lod - _minLod) * 16 + permutation];
+}
+
+unsigned GeoMipMappingIndices::borderSize(unsigned lod, unsigned permutation) const
+{
+    return _borderSizes[(lod - _minLod) * 16 + permutation];
+}
+
+unsigned GeoMipMappingIndices::centerStart(unsigned lod) const
+{
+    return _centerStarts[lod - _minLod];
+}
+
+unsigned GeoMipMappingIndices::centerSize(unsigned lod) const
+{
+    return _centerSizes[lod - _minLod];
+}
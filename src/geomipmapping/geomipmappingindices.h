@@ -0,0 +1,89 @@
+#ifndef GEOMIPMAPPINGINDICES_H
+#define GEOMIPMAPPINGINDICES_H
+
+#include <vector>
+
+/* Generates the shared GeoMipMapping index buffer on the CPU.
+ *
+ * The flat block mesh is split into its center and border area. The
+ * indices of the center area are stored at every LOD resolution, and the
+ * indices of the border area are stored at every LOD resolution and for
+ * every of the 16 possible border permutations. The start offsets and sizes
+ * (in number of indices) of each subblock are kept alongside, so that the
+ * index range for any (LOD, permutation) pair can be looked up directly.
+ *
+ * This class does not make any OpenGL calls, uploading the generated
+ * indices is up to the caller. */
+class GeoMipMappingIndices {
+public:
+    /* Bitmasks for the 2^4 = 16 possible border permutations.
+     * The bits are organized in left, right, top and bottom.
+     * Each bit is set if the corresponding side has a lower LOD.
+     */
+    static const unsigned LEFT_BORDER_BITMASK = 0b1000;
+    static const unsigned RIGHT_BORDER_BITMASK = 0b0100;
+    static const unsigned TOP_BORDER_BITMASK = 0b0010;
+    static const unsigned BOTTOM_BORDER_BITMASK = 0b0001;
+
+    GeoMipMappingIndices();
+
+    void load(unsigned blockSize, unsigned minLod, unsigned maxLod);
+
+    /* Number of LODs load() generates the center and border subblocks for.
+     * With min. LOD 0, LOD 1 is always generated as well. */
+    static unsigned nLods(unsigned minLod, unsigned maxLod);
+
+    /* Restores previously generated indices and offsets (e.g. from the block cache) */
+    void load(unsigned blockSize, unsigned minLod, unsigned maxLod,
+        std::vector<unsigned> indices,
+        std::vector<unsigned> borderStarts, std::vector<unsigned> borderSizes,
+        std::vector<unsigned> centerStarts, std::vector<unsigned> centerSizes);
+    void clear();
+
+    /* Getters */
+    const std::vector<unsigned>& indices() const;
+    const std::vector<unsigned>& borderStarts() const;
+    const std::vector<unsigned>& borderSizes() const;
+    const std::vector<unsigned>& centerStarts() const;
+    const std::vector<unsigned>& centerSizes() const;
+    unsigned borderStart(unsigned lod, unsigned permutation) const;
+    unsigned borderSize(unsigned lod, unsigned permutation) const;
+    unsigned centerStart(unsigned lod) const;
+    unsigned centerSize(unsigned lod) const;
+
+private:
+    /* Note that the below could probably be refactored into fewer methods,
+     * which I didn't manage to do yet due to time constraints. */
+    unsigned loadBorderAreaForPermutation(unsigned lod, unsigned permutation);
+    unsigned loadBorderAreaForLod(unsigned lod, unsigned accumulatedCount);
+    unsigned loadCenterAreaForLod(unsigned lod);
+
+    unsigned loadTopLeftCorner(unsigned step, unsigned permutation);
+    unsigned loadTopRightCorner(unsigned step, unsigned permutation);
+    unsigned loadBottomRightCorner(unsigned step, unsigned permutation);
+    unsigned loadBottomLeftCorner(unsigned step, unsigned permutation);
+
+    unsigned loadTopBorder(unsigned permutation, unsigned step);
+    unsigned loadRightBorder(unsigned permutation, unsigned step);
+    unsigned loadBottomBorder(unsigned permutation, unsigned step);
+    unsigned loadLeftBorder(unsigned permutation, unsigned step);
+
+    /* LOD 0 and LOD 1 blocks are special since they do not have a center area,
+     * but only a border area, which must be loaded specially. */
+    unsigned loadLod0Block();
+    unsigned loadLod1Block(unsigned permutation);
+
+    void pushIndex(unsigned x, unsigned y);
+
+    std::vector<unsigned> _indices;
+
+    std::vector<unsigned> _borderSizes;
+    std::vector<unsigned> _borderStarts;
+    std::vector<unsigned> _centerSizes;
+    std::vector<unsigned> _centerStarts;
+
+    unsigned _blockSize;
+    unsigned _minLod, _maxLod;
+};
+
+#endif // GEOMIPMAPPINGINDICES_H
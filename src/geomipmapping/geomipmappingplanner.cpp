@@ -0,0 +1,821 @@
+#include "geomipmappingplanner.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <limits>
+#include <utility>
+
+namespace {
+
+double millisecondsSince(std::chrono::steady_clock::time_point start)
+{
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+/* Returns the maximum vertical deviation of the height values of a block
+ * from the mesh with the given step size. The coarse mesh is approximated
+ * by bilinearly interpolating the corners of each of its cells. */
+float maxDeviation(const unsigned short* heights, unsigned rowLength, unsigned blockSize, unsigned step)
+{
+    float maxError = 0.0f;
+    float invStep = 1.0f / step;
+
+    for (unsigned z0 = 0; z0 + step < blockSize; z0 += step) {
+        const unsigned short* row0 = heights + (std::size_t)z0 * rowLength;
+        const unsigned short* row1 = heights + (std::size_t)(z0 + step) * rowLength;
+
+        for (unsigned x0 = 0; x0 + step < blockSize; x0 += step) {
+            float h00 = row0[x0], h10 = row0[x0 + step];
+            float h01 = row1[x0], h11 = row1[x0 + step];
+
+            for (unsigned k = 0; k <= step; k++) {
+                const unsigned short* row = heights + (std::size_t)(z0 + k) * rowLength + x0;
+                float fz = k * invStep;
+                float left = h00 + (h01 - h00) * fz;
+                float right = h10 + (h11 - h10) * fz;
+
+                for (unsigned l = 0; l <= step; l++) {
+                    float interpolated = left + (right - left) * (l * invStep);
+                    maxError = std::max(maxError, std::abs(row[l] - interpolated));
+                }
+            }
+        }
+    }
+
+    return maxError;
+}
+
+}
+
+GeoMipMappingPlanner::GeoMipMappingPlanner()
+    : _blockSize(0)
+    , _nBlocksX(0)
+    , _nBlocksZ(0)
+    , _minLod(0)
+    , _maxLod(0)
+{
+}
+
+GeoMipMappingPlanner::GeoMipMappingPlanner(unsigned blockSize, unsigned nBlocksX, unsigned nBlocksZ, unsigned minLod, unsigned maxLod)
+    : _blockSize(blockSize)
+    , _nBlocksX(nBlocksX)
+    , _nBlocksZ(nBlocksZ)
+    , _minLod(minLod)
+    , _maxLod(maxLod)
+{
+    _visibleBlocks.reserve(_nBlocksX * _nBlocksZ);
+}
+
+/* Loads the block metadata (AABB, world center, mesh translation and
+ * geometric errors) from
+ * the given row-major height values. rowLength is the width of the
+ * heightmap, which can be larger than the width covered by the blocks.
+ *
+ * The block rows are distributed over the threads of the job system (if
+ * there is one). Since every block row only writes its own blocks, the
+ * result does not depend on the number of threads. */
+void GeoMipMappingPlanner::loadBlocks(const unsigned short* heights, unsigned rowLength, float xzScale, float yScale)
+{
+    beginLoadBlocks();
+
+    auto loadRows = [&](unsigned, unsigned begin, unsigned end) {
+        for (unsigned i = begin; i < end; i++)
+            loadBlockRow(i, heights + (std::size_t)i * (_blockSize - 1) * rowLength, rowLength, xzScale, yScale);
+    };
+
+    if (_jobSystem)
+        _jobSystem->parallelFor(_nBlocksZ, 1, loadRows);
+    else
+        loadRows(0, 0, _nBlocksZ);
+
+    endLoadBlocks();
+}
+
+void GeoMipMappingPlanner::loadBlocks(std::vector<GeoMipMappingBlock> blocks, std::vector<float> geometricErrors)
+{
+    _blocks.resize(blocks.size());
+    for (unsigned i = 0; i < blocks.size(); i++)
+        _blocks.set(i, blocks[i]);
+
+    _geometricErrors = std::move(geometricErrors);
+    endLoadBlocks();
+}
+
+void GeoMipMappingPlanner::beginLoadBlocks()
+{
+    _blocks.resize(_nBlocksX * _nBlocksZ);
+    _geometricErrors.assign((std::size_t)_nBlocksX * _nBlocksZ * (_maxLod - _minLod + 1), 0.0f);
+}
+
+/* Loads the blocks of a single row of blocks. heights points to the first
+ * of the _blockSize rows of height values covered by the block row. */
+void GeoMipMappingPlanner::loadBlockRow(unsigned blockRow, const unsigned short* heights, unsigned rowLength, float xzScale, float yScale)
+{
+    unsigned width = _nBlocksX * (_blockSize - 1) + 1;
+    unsigned height = _nBlocksZ * (_blockSize - 1) + 1;
+    glm::vec2 terrainCenter(width / 2.0f, height / 2.0f);
+
+    unsigned i = blockRow;
+
+    for (unsigned j = 0; j < _nBlocksX; j++) {
+
+        /* Determine min and max y-coordinates per block for the AABB */
+        float minY = 9999999.0f, maxY = -9999999.0f;
+        for (unsigned k = 0; k < _blockSize; k++) {
+            for (unsigned l = 0; l < _blockSize; l++) {
+                unsigned x = (j * (_blockSize - 1)) + l;
+
+                float y = heights[(std::size_t)k * rowLength + x];
+                minY = std::min(y, minY);
+                maxY = std::max(y, maxY);
+            }
+        }
+
+        unsigned currentBlockId = i * _nBlocksX + j;
+
+        float centerX = (j * (_blockSize - 1) + 0.5 * (_blockSize - 1));
+        float centerZ = (i * (_blockSize - 1) + 0.5 * (_blockSize - 1));
+
+        /* The center row is relative to the first row of the block row */
+        float trueY = heights[(std::size_t)(0.5 * (_blockSize - 1)) * rowLength + (unsigned)centerX] * yScale;
+        float aabbY = minY * yScale + (((maxY - minY) * yScale) / (2.0f * yScale));
+
+        glm::vec3 aabbCenter(((-(float)width * xzScale) / 2.0f) + centerX * xzScale, aabbY, ((-(float)height * xzScale) / 2.0f) + centerZ * xzScale);
+        glm::vec3 blockCenter(aabbCenter.x, trueY, aabbCenter.z);
+
+        glm::vec2 translation = glm::vec2(centerX, centerZ) - terrainCenter;
+
+        glm::vec3 p1 = glm::vec3(aabbCenter.x - (_blockSize / 2.0f), aabbCenter.y - ((maxY - minY) / 2.0f), aabbCenter.z - (_blockSize / 2.0f));
+        glm::vec3 p2 = glm::vec3(aabbCenter.x + (_blockSize / 2.0f), aabbCenter.y + ((maxY - minY) / 2.0f), aabbCenter.z + (_blockSize / 2.0f));
+
+        _blocks.set(currentBlockId, { currentBlockId, blockCenter, p1, p2, translation });
+
+        /* Geometric error of each LOD as described by de Boer, i.e. the
+         * maximum vertical deviation when dropping to the LOD's step size.
+         * The max. LOD is the full resolution mesh and has no error. Each
+         * error is at least the error of the next finer LOD, so that the
+         * errors decrease monotonically with increasing LOD. */
+        float* errors = &_geometricErrors[(std::size_t)currentBlockId * (_maxLod - _minLod + 1)];
+        float finerError = 0.0f;
+
+        errors[_maxLod - _minLod] = 0.0f;
+        for (unsigned lod = _maxLod; lod-- > _minLod;) {
+            unsigned step = 1u << (_maxLod - lod);
+            float error = maxDeviation(heights + j * (_blockSize - 1), rowLength, _blockSize, step) * yScale;
+
+            finerError = std::max(finerError, error);
+            errors[lod - _minLod] = finerError;
+        }
+    }
+}
+
+void GeoMipMappingPlanner::endLoadBlocks()
+{
+    _quadTree.build(_blocks, _nBlocksX, _nBlocksZ);
+
+    _lodExpiry.resize(_blocks.size());
+    _borderDirty.resize(_blocks.size());
+    _lodInvalidated = true;
+}
+
+/* Every pass is split into chunks, which only write the data of their own
+ * blocks and their own per-chunk results. The chunks run on the job system
+ * if there is one (otherwise the whole pass is one chunk), and their results
+ * are combined in chunk order, so the draw list does not depend on the
+ * number of threads. Returns the number of chunks. */
+template <typename Job>
+unsigned GeoMipMappingPlanner::forEachChunk(unsigned count, const Job& job)
+{
+    bool parallel = _jobSystem != nullptr && _parallelActive;
+    unsigned nChunks = parallel ? JobSystem::nChunks(count, PARALLEL_CHUNK_SIZE) : 1;
+
+    if (_chunkBlocks.size() < nChunks) {
+        _chunkBlocks.resize(nChunks);
+        _chunkCounts.resize(nChunks);
+    }
+    for (unsigned i = 0; i < nChunks; i++) {
+        _chunkBlocks[i].clear();
+        _chunkCounts[i] = 0;
+    }
+
+    if (parallel)
+        _jobSystem->parallelFor(count, PARALLEL_CHUNK_SIZE, job);
+    else
+        job(0, 0, count);
+
+    return nChunks;
+}
+
+/* Collects the blocks intersecting the view-frustum of the last camera,
+ * either hierarchically using the quadtree or by testing every block */
+void GeoMipMappingPlanner::cullBlocks()
+{
+    _visibleBlocks.clear();
+
+    if (!_frustumCullingActive) {
+        for (unsigned i = 0; i < _blocks.size(); i++)
+            _visibleBlocks.push_back(i);
+    } else if (_quadTreeActive) {
+        _quadTree.cull(_lastCamera, _visibleBlocks);
+    } else {
+        /* Test the blocks in batches, so that several AABBs can be tested at once */
+        AabbArrays aabbs = _blocks.aabbs();
+
+        unsigned nChunks = forEachChunk(_blocks.size(), [&](unsigned chunk, unsigned begin, unsigned end) {
+            std::vector<unsigned>& visibleBlocks = _chunkBlocks[chunk];
+
+            for (unsigned first = begin; first < end; first += FrustumCulling::BATCH_SIZE) {
+                unsigned count = std::min(FrustumCulling::BATCH_SIZE, end - first);
+                unsigned visibleMask = _lastCamera.intersectViewFrustum(aabbs, first, count).visibleMask;
+
+                for (unsigned i = 0; i < count; i++) {
+                    if (visibleMask & (1u << i))
+                        visibleBlocks.push_back(first + i);
+                }
+            }
+        });
+
+        for (unsigned i = 0; i < nChunks; i++)
+            _visibleBlocks.insert(_visibleBlocks.end(), _chunkBlocks[i].begin(), _chunkBlocks[i].end());
+    }
+}
+
+void GeoMipMappingPlanner::plan(Camera& camera, const GeoMipMappingIndices& indices, std::vector<GeoMipMappingDrawCommand>& drawList)
+{
+    auto passStart = std::chrono::steady_clock::now();
+
+    if (!_freezeCamera) {
+        /* The camera cannot be further away from any earlier position than
+         * the distance it travelled since then */
+        _cameraTravel += glm::length(camera.position() - _lastCamera.position());
+        _lastCamera = camera;
+    }
+
+    /* A geometric error e projects to e * viewportHeight / (2 * tan(fov / 2) * d)
+     * pixels at distance d, so it stays below the pixel error for every
+     * d >= e * factor */
+    float errorDistanceFactor = _viewportHeight / (2.0f * std::tan(glm::radians(_lastCamera.zoom()) / 2.0f) * _pixelError);
+    if (errorDistanceFactor != _errorDistanceFactor) {
+        _errorDistanceFactor = errorDistanceFactor;
+        if (_lodMode == GeoMipMappingLodMode::SCREEN_SPACE_ERROR)
+            _lodInvalidated = true;
+    }
+
+    /* Re-evaluate every block after loading and after the LOD settings changed */
+    if (_lodInvalidated) {
+        std::fill(_lodExpiry.begin(), _lodExpiry.end(), -1.0);
+        std::fill(_borderDirty.begin(), _borderDirty.end(), 1);
+        _cameraTravel = 0.0;
+        _lodInvalidated = false;
+    }
+
+    /* ================================ First pass ===============================
+     * - Collect the blocks intersecting the view-frustum (see cullBlocks())
+     * - For each visible block, update the block's LOD based on the
+     *   distance to the camera
+     */
+    cullBlocks();
+
+    _timings.culling = millisecondsSince(passStart);
+    passStart = std::chrono::steady_clock::now();
+
+    glm::vec3 cameraPosition = _lastCamera.position();
+
+    /* Blocks whose LOD changed are collected per chunk, since marking the
+     * borders of the neighbors dirty would write to other chunks' blocks */
+    unsigned nChunks = forEachChunk(_visibleBlocks.size(), [&](unsigned chunk, unsigned begin, unsigned end) {
+        for (unsigned i = begin; i < end; i++) {
+            unsigned id = _visibleBlocks[i];
+            unsigned lod;
+
+            if (!_lodActive) {
+                lod = _maxLod;
+            } else if (_freezeCamera) {
+                continue;
+            } else if (_incrementalActive && _cameraTravel <= _lodExpiry[id]) {
+                /* The camera has not moved far enough to cross a distance band */
+                continue;
+            } else {
+                float dx = _blocks.centerX[id] - cameraPosition.x;
+                float dy = _blocks.centerY[id] - cameraPosition.y;
+                float dz = _blocks.centerZ[id] - cameraPosition.z;
+                float squaredDistance = dx * dx + dy * dy + dz * dz;
+
+                if (_lodMode == GeoMipMappingLodMode::SCREEN_SPACE_ERROR)
+                    lod = determineLodPaper(id, squaredDistance);
+                else
+                    lod = determineLodDistance(squaredDistance, _baseDistance, _doubleDistanceEachLevel);
+                _chunkCounts[chunk]++;
+
+                if (_incrementalActive)
+                    _lodExpiry[id] = _cameraTravel + lodDistanceMargin(id, std::sqrt(squaredDistance));
+            }
+
+            if (lod != _blocks.lod[id]) {
+                _blocks.lod[id] = lod;
+                _chunkBlocks[chunk].push_back(id);
+            }
+        }
+    });
+
+    _lodUpdates = 0;
+
+    for (unsigned i = 0; i < nChunks; i++) {
+        _lodUpdates += _chunkCounts[i];
+        for (unsigned id : _chunkBlocks[i])
+            markBorderDirty(id);
+    }
+
+    _timings.lod = millisecondsSince(passStart);
+    passStart = std::chrono::steady_clock::now();
+
+    /* ============================== Second pass =============================
+     * - For each visible block:
+     *   - Update border bitmap (in incremental mode only if the block or
+     *     one of its neighbors changed its LOD)
+     *   - Calculate the geomorphing factors (every frame, since they change
+     *     continuously with the camera distance)
+     *   - Look up the index ranges of the center and border subblocks */
+    drawList.resize(_visibleBlocks.size());
+
+    /* Thresholds of determineLodDistance(), for the geomorphing factors */
+    _switchDistances.resize(_maxLod - _minLod);
+    unsigned distancePower = 1;
+    for (unsigned i = 0; i < _maxLod - _minLod; i++) {
+        _switchDistances[i] = distancePower * _baseDistance;
+
+        if (_doubleDistanceEachLevel)
+            distancePower <<= 1;
+        else
+            distancePower++;
+    }
+
+    nChunks = forEachChunk(_visibleBlocks.size(), [&](unsigned chunk, unsigned begin, unsigned end) {
+        for (unsigned i = begin; i < end; i++) {
+            unsigned id = _visibleBlocks[i];
+
+            if (!_incrementalActive || _borderDirty[id]) {
+                _blocks.borderBitmap[id] = calculateBorderBitmap(id);
+                _borderDirty[id] = 0;
+                _chunkCounts[chunk]++;
+            }
+
+            unsigned lod = _blocks.lod[id];
+            unsigned borderBitmap = _blocks.borderBitmap[id];
+
+            GeoMipMappingDrawCommand& command = drawList[i];
+            command.blockId = id;
+            command.lod = lod;
+            command.borderBitmap = borderBitmap;
+            command.translation = glm::vec2(_blocks.translationX[id], _blocks.translationZ[id]);
+            command.morph = morphFactor(id, cameraPosition);
+            command.edgeMorph = edgeMorphFactors(id, command.morph, cameraPosition);
+
+            /* Only LOD >= 2 blocks have a center subblock */
+            if (lod >= 2) {
+                command.centerStart = indices.centerStart(lod);
+                command.centerCount = indices.centerSize(lod);
+            } else {
+                command.centerStart = 0;
+                command.centerCount = 0;
+            }
+
+            command.borderStart = indices.borderStart(lod, borderBitmap);
+            command.borderCount = indices.borderSize(lod, borderBitmap);
+        }
+    });
+
+    _borderUpdates = 0;
+    for (unsigned i = 0; i < nChunks; i++)
+        _borderUpdates += _chunkCounts[i];
+
+    _timings.border = millisecondsSince(passStart);
+}
+
+/* The tessellation path selects the LOD per block edge in the tessellation
+ * control shader, so only the culling pass is left on the CPU */
+void GeoMipMappingPlanner::planPatches(Camera& camera, std::vector<GeoMipMappingInstance>& patches)
+{
+    auto passStart = std::chrono::steady_clock::now();
+
+    if (!_freezeCamera)
+        _lastCamera = camera;
+
+    cullBlocks();
+
+    patches.resize(_visibleBlocks.size());
+    for (unsigned i = 0; i < _visibleBlocks.size(); i++) {
+        unsigned id = _visibleBlocks[i];
+        patches[i] = GeoMipMappingInstance();
+        patches[i].translation = glm::vec2(_blocks.translationX[id], _blocks.translationZ[id]);
+    }
+
+    _lodUpdates = 0;
+    _borderUpdates = 0;
+    _timings.culling = millisecondsSince(passStart);
+    _timings.lod = 0.0;
+    _timings.border = 0.0;
+}
+
+void GeoMipMappingPlanner::batch(const std::vector<GeoMipMappingDrawCommand>& drawList, const GeoMipMappingIndices& indices,
+    std::vector<GeoMipMappingInstance>& instances, std::vector<GeoMipMappingDrawBatch>& batches)
+{
+    unsigned nLods = _maxLod - _minLod + 1;
+
+    /* Counting sort of the draw list by (LOD, border permutation). Since the
+     * permutation is the minor key, all instances of a LOD are consecutive,
+     * which allows drawing the centers of a LOD with a single draw too. */
+    _batchOffsets.assign(nLods * 16 + 1, 0);
+
+    for (const GeoMipMappingDrawCommand& command : drawList)
+        _batchOffsets[(command.lod - _minLod) * 16 + command.borderBitmap + 1]++;
+
+    for (unsigned i = 1; i < _batchOffsets.size(); i++)
+        _batchOffsets[i] += _batchOffsets[i - 1];
+
+    _batchCursors = _batchOffsets;
+    instances.resize(drawList.size());
+
+    for (const GeoMipMappingDrawCommand& command : drawList) {
+        unsigned key = (command.lod - _minLod) * 16 + command.borderBitmap;
+        instances[_batchCursors[key]++] = { command.translation, (float)command.lod, (float)command.borderBitmap, command.morph, command.edgeMorph };
+    }
+
+    batches.clear();
+
+    for (unsigned i = 0; i < nLods; i++) {
+        unsigned lod = _minLod + i;
+        unsigned lodStart = _batchOffsets[i * 16];
+        unsigned lodEnd = _batchOffsets[(i + 1) * 16];
+
+        if (lodStart == lodEnd)
+            continue;
+
+        /* Only LOD >= 2 blocks have a center subblock */
+        if (lod >= 2)
+            batches.push_back({ indices.centerStart(lod), indices.centerSize(lod), lodStart, lodEnd - lodStart });
+
+        for (unsigned permutation = 0; permutation < 16; permutation++) {
+            unsigned first = _batchOffsets[i * 16 + permutation];
+            unsigned last = _batchOffsets[i * 16 + permutation + 1];
+
+            if (first < last)
+                batches.push_back({ indices.borderStart(lod, permutation), indices.borderSize(lod, permutation), first, last - first });
+        }
+    }
+}
+
+unsigned GeoMipMappingPlanner::calculateBorderBitmap(unsigned currentBlockId)
+{
+    unsigned z = std::floor((float)currentBlockId / (float)_nBlocksX);
+    unsigned x = currentBlockId - z * _nBlocksX;
+
+    const unsigned* lods = _blocks.lod.data();
+    unsigned currentLod = lods[currentBlockId];
+
+    unsigned maxX = std::max((int)x - 1, 0);
+    unsigned minX = std::min((int)x + 1, (int)_nBlocksX - 1);
+    unsigned maxZ = std::max((int)z - 1, 0);
+    unsigned minZ = std::min((int)z + 1, (int)_nBlocksZ - 1);
+
+    unsigned leftLower = currentLod > lods[z * _nBlocksX + maxX] ? 1 : 0;
+    unsigned rightLower = currentLod > lods[z * _nBlocksX + minX] ? 1 : 0;
+    unsigned topLower = currentLod > lods[maxZ * _nBlocksX + x] ? 1 : 0;
+    unsigned bottomLower = currentLod > lods[minZ * _nBlocksX + x] ? 1 : 0;
+
+    return (leftLower << 3) | (rightLower << 2) | (topLower << 1) | bottomLower;
+}
+
+/* Marks the border bitmaps of a block and its four neighbors as outdated */
+void GeoMipMappingPlanner::markBorderDirty(unsigned blockId)
+{
+    unsigned z = blockId / _nBlocksX;
+    unsigned x = blockId - z * _nBlocksX;
+
+    _borderDirty[blockId] = 1;
+
+    if (x > 0)
+        _borderDirty[blockId - 1] = 1;
+    if (x < _nBlocksX - 1)
+        _borderDirty[blockId + 1] = 1;
+    if (z > 0)
+        _borderDirty[blockId - _nBlocksX] = 1;
+    if (z < _nBlocksZ - 1)
+        _borderDirty[blockId + _nBlocksX] = 1;
+}
+
+/* Returns how far the camera can move before the LOD of the given block,
+ * currently at the given (non-squared) distance, can change, i.e. the
+ * distance to the nearest threshold of the current LOD mode. */
+float GeoMipMappingPlanner::lodDistanceMargin(unsigned blockId, float distance)
+{
+    float margin = std::numeric_limits<float>::max();
+
+    if (_lodMode == GeoMipMappingLodMode::SCREEN_SPACE_ERROR) {
+        const float* errors = &_geometricErrors[(std::size_t)blockId * (_maxLod - _minLod + 1)];
+
+        for (unsigned i = 0; i < _maxLod - _minLod; i++)
+            margin = std::min(margin, std::abs(distance - errors[i] * _errorDistanceFactor));
+    } else {
+        unsigned distancePower = 1;
+        for (unsigned i = 0; i < _maxLod - _minLod; i++) {
+            margin = std::min(margin, std::abs(distance - distancePower * _baseDistance));
+
+            if (_doubleDistanceEachLevel)
+                distancePower <<= 1;
+            else
+                distancePower++;
+        }
+    }
+
+    /* Both modes compare squared distances, leave some room for rounding errors */
+    return margin - distance * 1e-5f;
+}
+
+/* Selects the coarsest LOD whose geometric error, projected onto the screen,
+ * does not exceed the pixel error (de Boer, "Fast Terrain Rendering Using
+ * Geometrical MipMapping"). Since the errors decrease with increasing LOD,
+ * the first LOD that passes is the coarsest one. */
+unsigned GeoMipMappingPlanner::determineLodPaper(unsigned blockId, float squaredDistance)
+{
+    const float* errors = &_geometricErrors[(std::size_t)blockId * (_maxLod - _minLod + 1)];
+
+    for (unsigned lod = _minLod; lod < _maxLod; lod++) {
+        float minDistance = errors[lod - _minLod] * _errorDistanceFactor;
+
+        if (squaredDistance >= minDistance * minDistance)
+            return lod;
+    }
+
+    return _maxLod;
+}
+
+unsigned GeoMipMappingPlanner::determineLodDistance(float distance, float baseDist, bool doubleEachLevel)
+{
+    unsigned distancePower = 1;
+    for (int i = 0; i < _maxLod - _minLod; i++) {
+        if (distance < distancePower * distancePower * baseDist * baseDist)
+            return _maxLod - i;
+
+        if (doubleEachLevel)
+            distancePower <<= 1;
+        else
+            distancePower++;
+    }
+    return _minLod;
+}
+
+/* Returns the camera distance at which a block switches from the given LOD
+ * to the next coarser one. The distance band of a LOD therefore starts at
+ * the switch distance of the next finer LOD, or at 0 for the max. LOD. */
+float GeoMipMappingPlanner::lodSwitchDistance(unsigned blockId, unsigned lod)
+{
+    if (lod > _maxLod)
+        return 0.0f;
+
+    if (_lodMode == GeoMipMappingLodMode::SCREEN_SPACE_ERROR)
+        return geometricError(blockId, lod - 1) * _errorDistanceFactor;
+
+    return _switchDistances[_maxLod - lod];
+}
+
+/* Returns the geomorphing factor of a block at its current LOD: 0 at the
+ * start of the morph range, i.e. MORPH_START_RATIO of the LOD's distance
+ * band, and 1 at the switch to the next coarser LOD. The min. LOD has no
+ * coarser LOD to morph to. */
+float GeoMipMappingPlanner::morphFactor(unsigned blockId, const glm::vec3& cameraPosition)
+{
+    unsigned lod = _blocks.lod[blockId];
+    if (!_morphActive || !_lodActive || lod <= _minLod)
+        return 0.0f;
+
+    float dx = _blocks.centerX[blockId] - cameraPosition.x;
+    float dy = _blocks.centerY[blockId] - cameraPosition.y;
+    float dz = _blocks.centerZ[blockId] - cameraPosition.z;
+    float distance = std::sqrt(dx * dx + dy * dy + dz * dz);
+
+    float end = lodSwitchDistance(blockId, lod);
+    float start = lodSwitchDistance(blockId, lod + 1);
+    start += (end - start) * MORPH_START_RATIO;
+
+    if (end <= start)
+        return distance >= end ? 1.0f : 0.0f;
+
+    return std::clamp((distance - start) / (end - start), 0.0f, 1.0f);
+}
+
+/* Returns the geomorphing factors of the left, right, top and bottom border
+ * vertices of a block. Both blocks sharing a border must move its vertices
+ * the same way: if their LODs differ, the finer block is stitched to the
+ * coarser one, so the border follows the coarser block. Otherwise it is
+ * morphed by the larger of both factors. The terrain's outer borders
+ * follow the block itself. */
+glm::vec4 GeoMipMappingPlanner::edgeMorphFactors(unsigned blockId, float morph, const glm::vec3& cameraPosition)
+{
+    unsigned z = blockId / _nBlocksX;
+    unsigned x = blockId - z * _nBlocksX;
+    unsigned lod = _blocks.lod[blockId];
+
+    auto edgeMorph = [&](unsigned neighborId) {
+        unsigned neighborLod = _blocks.lod[neighborId];
+        if (neighborId == blockId || neighborLod > lod)
+            return morph;
+
+        float neighborMorph = morphFactor(neighborId, cameraPosition);
+        return neighborLod < lod ? neighborMorph : std::max(morph, neighborMorph);
+    };
+
+    return glm::vec4(edgeMorph(x > 0 ? blockId - 1 : blockId),
+        edgeMorph(x < _nBlocksX - 1 ? blockId + 1 : blockId),
+        edgeMorph(z > 0 ? blockId - _nBlocksX : blockId),
+        edgeMorph(z < _nBlocksZ - 1 ? blockId + _nBlocksX : blockId));
+}
+
+GeoMipMappingBlock GeoMipMappingPlanner::getBlock(unsigned x, unsigned z)
+{
+    return _blocks.get(z * _nBlocksX + x);
+}
+
+const GeoMipMappingBlocks& GeoMipMappingPlanner::blocks()
+{
+    return _blocks;
+}
+
+const std::vector<float>& GeoMipMappingPlanner::geometricErrors()
+{
+    return _geometricErrors;
+}
+
+float GeoMipMappingPlanner::geometricError(unsigned blockId, unsigned lod)
+{
+    return _geometricErrors[(std::size_t)blockId * (_maxLod - _minLod + 1) + (lod - _minLod)];
+}
+
+unsigned GeoMipMappingPlanner::nBlocksX()
+{
+    return _nBlocksX;
+}
+
+unsigned GeoMipMappingPlanner::nBlocksZ()
+{
+    return _nBlocksZ;
+}
+
+bool GeoMipMappingPlanner::freezeCamera()
+{
+    return _freezeCamera;
+}
+
+bool GeoMipMappingPlanner::lodActive()
+{
+    return _lodActive;
+}
+
+bool GeoMipMappingPlanner::incrementalActive()
+{
+    return _incrementalActive;
+}
+
+GeoMipMappingLodMode GeoMipMappingPlanner::lodMode()
+{
+    return _lodMode;
+}
+
+float GeoMipMappingPlanner::pixelError()
+{
+    return _pixelError;
+}
+
+unsigned GeoMipMappingPlanner::lodUpdates()
+{
+    return _lodUpdates;
+}
+
+unsigned GeoMipMappingPlanner::borderUpdates()
+{
+    return _borderUpdates;
+}
+
+const GeoMipMappingPlanTimings& GeoMipMappingPlanner::timings()
+{
+    return _timings;
+}
+
+glm::vec3 GeoMipMappingPlanner::lodCameraPosition()
+{
+    return _lastCamera.position();
+}
+
+bool GeoMipMappingPlanner::frustumCullingActive()
+{
+    return _frustumCullingActive;
+}
+
+bool GeoMipMappingPlanner::quadTreeActive()
+{
+    return _quadTreeActive;
+}
+
+bool GeoMipMappingPlanner::parallelActive()
+{
+    return _parallelActive;
+}
+
+bool GeoMipMappingPlanner::morphActive()
+{
+    return _morphActive;
+}
+
+void GeoMipMappingPlanner::freezeCamera(bool freezeCamera)
+{
+    _freezeCamera = freezeCamera;
+}
+
+void GeoMipMappingPlanner::lodActive(bool lodActive)
+{
+    if (lodActive != _lodActive)
+        _lodInvalidated = true;
+    _lodActive = lodActive;
+}
+
+void GeoMipMappingPlanner::frustumCullingActive(bool frustumCullingActive)
+{
+    _frustumCullingActive = frustumCullingActive;
+}
+
+void GeoMipMappingPlanner::quadTreeActive(bool quadTreeActive)
+{
+    _quadTreeActive = quadTreeActive;
+}
+
+void GeoMipMappingPlanner::parallelActive(bool parallelActive)
+{
+    _parallelActive = parallelActive;
+}
+
+void GeoMipMappingPlanner::morphActive(bool morphActive)
+{
+    _morphActive = morphActive;
+}
+
+void GeoMipMappingPlanner::jobSystem(JobSystem* jobSystem)
+{
+    _jobSystem = jobSystem;
+}
+
+void GeoMipMappingPlanner::baseDistance(float baseDistance)
+{
+    if (baseDistance != _baseDistance)
+        _lodInvalidated = true;
+    _baseDistance = baseDistance;
+}
+
+void GeoMipMappingPlanner::doubleDistanceEachLevel(bool doubleDistanceEachLevel)
+{
+    if (doubleDistanceEachLevel != _doubleDistanceEachLevel)
+        _lodInvalidated = true;
+    _doubleDistanceEachLevel = doubleDistanceEachLevel;
+}
+
+void GeoMipMappingPlanner::lodMode(GeoMipMappingLodMode lodMode)
+{
+    if (lodMode != _lodMode)
+        _lodInvalidated = true;
+    _lodMode = lodMode;
+}
+
+/* The pixel error and viewport height only change the distance factor,
+ * which is checked (and invalidates the LODs if needed) in plan() */
+void GeoMipMappingPlanner::pixelError(float pixelError)
+{
+    _pixelError = std::max(pixelError, 0.01f);
+}
+
+void GeoMipMappingPlanner::viewportHeight(unsigned viewportHeight)
+{
+    _viewportHeight = std::max(viewportHeight, 1u);
+}
+
+void GeoMipMappingPlanner::incrementalActive(bool incrementalActive)
+{
+    if (incrementalActive != _incrementalActive)
+        _lodInvalidated = true;
+    _incrementalActive = incrementalActive;
+}
+
+void GeoMipMappingPlanner::settings(const GeoMipMappingPlannerSettings& settings)
+{
+    baseDistance(settings.baseDistance);
+    doubleDistanceEachLevel(settings.doubleDistanceEachLevel);
+    freezeCamera(settings.freezeCamera);
+    lodActive(settings.lodActive);
+    incrementalActive(settings.incrementalActive);
+    lodMode(settings.lodMode);
+    pixelError(settings.pixelError);
+    viewportHeight(settings.viewportHeight);
+    frustumCullingActive(settings.frustumCullingActive);
+    quadTreeActive(settings.quadTreeActive);
+    parallelActive(settings.parallelActive);
+    morphActive(settings.morphActive);
+}
@@ -0,0 +1,247 @@
+#ifndef GEOMIPMAPPINGPLANNER_H
+#define GEOMIPMAPPINGPLANNER_H
+
+#include "../camera.h"
+#include "../jobsystem.h"
+#include "geomipmappingblock.h"
+#include "geomipmappingblocks.h"
+#include "geomipmappingindices.h"
+#include "geomipmappingquadtree.h"
+
+#include <vector>
+
+/* A single entry of the per-frame draw list. The index ranges are given in
+ * number of indices into the shared GeoMipMapping index buffer. LOD 0 and 1
+ * blocks do not have a center area, their center count is therefore 0. */
+struct GeoMipMappingDrawCommand {
+    unsigned blockId;
+    unsigned lod;
+    unsigned borderBitmap;
+
+    /* 2D translation to place the flat mesh to its actual center */
+    glm::vec2 translation;
+
+    /* Geomorphing factors towards the next coarser LOD, of the inner
+     * vertices and of the left, right, top and bottom border vertices */
+    float morph;
+    glm::vec4 edgeMorph;
+
+    unsigned centerStart, centerCount;
+    unsigned borderStart, borderCount;
+};
+
+/* Per-block data of the batched draw path, uploaded as instanced vertex
+ * attributes (see GeoMipMappingDrawCommand) */
+struct GeoMipMappingInstance {
+    glm::vec2 translation;
+    float lod;
+    float borderBitmap;
+    float morph;
+    glm::vec4 edgeMorph;
+};
+
+/* A single instanced draw of the batched draw path: the index range is
+ * drawn once for each of the instanceCount consecutive instances starting
+ * at firstInstance. */
+struct GeoMipMappingDrawBatch {
+    unsigned start, count;
+    unsigned firstInstance, instanceCount;
+};
+
+/* How the LOD of a visible block is selected:
+ * - DISTANCE: by the distance to the camera and the base distance
+ * - SCREEN_SPACE_ERROR: the coarsest LOD whose precomputed geometric error,
+ *   projected onto the screen, stays below the pixel error threshold */
+enum class GeoMipMappingLodMode {
+    DISTANCE,
+    SCREEN_SPACE_ERROR
+};
+
+/* CPU time in milliseconds spent in the passes of a plan() call */
+struct GeoMipMappingPlanTimings {
+    double culling = 0.0;
+    double lod = 0.0;
+    double border = 0.0; /* Border bitmaps and draw list */
+    double dispatch = 0.0; /* Of the compute shader, GPU-driven planning only */
+};
+
+/* User settings of the planner, which can be handed to it as a whole (e.g.
+ * together with the camera of a frame planned on another thread) */
+struct GeoMipMappingPlannerSettings {
+    float baseDistance = 700.0f;
+    bool doubleDistanceEachLevel = false;
+    bool freezeCamera = false;
+    bool lodActive = true;
+    bool incrementalActive = false;
+    GeoMipMappingLodMode lodMode = GeoMipMappingLodMode::DISTANCE;
+    float pixelError = 1.0f;
+    unsigned viewportHeight = 720;
+    bool frustumCullingActive = true;
+    bool quadTreeActive = true;
+    bool parallelActive = true;
+    bool morphActive = false;
+    bool tessellationActive = false; /* Plan patches instead of a draw list, see planPatches() */
+};
+
+/* The GeoMipMapping frame planner performs the per-frame block selection
+ * (frustum culling, LOD selection and border bitmap calculation) and
+ * produces a draw list, without making any OpenGL calls. This allows the
+ * CPU side of GeoMipMapping to be run and measured without a GPU.
+ *
+ * The planner owns the block metadata. The blocks are stored in row-major
+ * order, i.e. the block at (x, z) has the ID z * nBlocksX + x, as a
+ * structure of arrays (see GeoMipMappingBlocks).
+ *
+ * With a job system, the block loading and the per-block passes of the
+ * planning run in parallel, with the same result as on a single thread.
+ *
+ * Every block is morphed towards its next coarser LOD in the vertex shader,
+ * starting at MORPH_START_RATIO of its LOD's distance band. It is fully
+ * morphed when it switches to the coarser LOD, so the switch does not pop.
+ * The vertices on a border between two blocks are morphed by a factor both
+ * blocks agree on (see edgeMorphFactors()), so that no cracks open up. */
+class GeoMipMappingPlanner {
+public:
+    static constexpr float MORPH_START_RATIO = 0.66f;
+
+    GeoMipMappingPlanner();
+    GeoMipMappingPlanner(unsigned blockSize, unsigned nBlocksX, unsigned nBlocksZ, unsigned minLod, unsigned maxLod);
+
+    void loadBlocks(const unsigned short* heights, unsigned rowLength, float xzScale, float yScale);
+
+    /* Restores previously loaded blocks and their geometric errors (e.g. from the block cache) */
+    void loadBlocks(std::vector<GeoMipMappingBlock> blocks, std::vector<float> geometricErrors);
+
+    /* Loads the blocks row by row, for heightmaps which are not entirely resident */
+    void beginLoadBlocks();
+    void loadBlockRow(unsigned blockRow, const unsigned short* heights, unsigned rowLength, float xzScale, float yScale);
+    void endLoadBlocks();
+    void plan(Camera& camera, const GeoMipMappingIndices& indices, std::vector<GeoMipMappingDrawCommand>& drawList);
+
+    /* Only culls the blocks, for the tessellation path: one patch with the
+     * block's translation per visible block, the LOD and border passes are
+     * skipped (the tessellation shaders select the LOD per block edge) */
+    void planPatches(Camera& camera, std::vector<GeoMipMappingInstance>& patches);
+
+    /* Groups a draw list by (LOD, border permutation), so that it can be
+     * drawn with a single instanced draw per group and LOD center */
+    void batch(const std::vector<GeoMipMappingDrawCommand>& drawList, const GeoMipMappingIndices& indices,
+        std::vector<GeoMipMappingInstance>& instances, std::vector<GeoMipMappingDrawBatch>& batches);
+
+    /* Getters */
+    GeoMipMappingBlock getBlock(unsigned x, unsigned z);
+    const GeoMipMappingBlocks& blocks();
+    const std::vector<float>& geometricErrors();
+    float geometricError(unsigned blockId, unsigned lod);
+    unsigned nBlocksX();
+    unsigned nBlocksZ();
+    bool freezeCamera();
+    bool lodActive();
+    bool incrementalActive();
+    bool frustumCullingActive();
+    bool quadTreeActive();
+    bool parallelActive();
+    bool morphActive();
+    GeoMipMappingLodMode lodMode();
+    float pixelError();
+
+    /* Number of LOD evaluations and border bitmap calculations of the last plan() */
+    unsigned lodUpdates();
+    unsigned borderUpdates();
+    const GeoMipMappingPlanTimings& timings();
+    glm::vec3 lodCameraPosition(); /* Of the last plan(), differs from the camera if it is frozen */
+
+    /* Setters */
+    void baseDistance(float baseDistance);
+    void doubleDistanceEachLevel(bool doubleDistanceEachLevel);
+    void freezeCamera(bool freezeCamera);
+    void lodActive(bool lodActive);
+    void incrementalActive(bool incrementalActive);
+    void frustumCullingActive(bool frustumCullingActive);
+    void quadTreeActive(bool quadTreeActive);
+    void parallelActive(bool parallelActive); /* Only with a job system */
+    void morphActive(bool morphActive);
+    void jobSystem(JobSystem* jobSystem); /* Not owned, nullptr runs everything on the calling thread */
+    void lodMode(GeoMipMappingLodMode lodMode);
+    void pixelError(float pixelError);
+    void viewportHeight(unsigned viewportHeight);
+
+    /* Calls all of the setters above */
+    void settings(const GeoMipMappingPlannerSettings& settings);
+
+private:
+    template <typename Job>
+    unsigned forEachChunk(unsigned count, const Job& job);
+    void cullBlocks();
+    unsigned calculateBorderBitmap(unsigned currentBlockId);
+    void markBorderDirty(unsigned blockId);
+    float lodDistanceMargin(unsigned blockId, float distance);
+    unsigned determineLodDistance(float distance, float baseDist, bool doubleEachLevel = true);
+    unsigned determineLodPaper(unsigned blockId, float squaredDistance);
+    float lodSwitchDistance(unsigned blockId, unsigned lod);
+    float morphFactor(unsigned blockId, const glm::vec3& cameraPosition);
+    glm::vec4 edgeMorphFactors(unsigned blockId, float morph, const glm::vec3& cameraPosition);
+
+    GeoMipMappingBlocks _blocks;
+
+    /* Geometric error per block and LOD (in world units), stored as
+     * blockId * (_maxLod - _minLod + 1) + (lod - _minLod) */
+    std::vector<float> _geometricErrors;
+
+    /* Used for hierarchical frustum culling */
+    GeoMipMappingQuadTree _quadTree;
+
+    /* Number of blocks per chunk of the parallel passes */
+    static const unsigned PARALLEL_CHUNK_SIZE = 1024;
+
+    /* Reused every frame so that planning does not allocate */
+    std::vector<unsigned> _visibleBlocks;
+    std::vector<unsigned> _batchOffsets, _batchCursors;
+    std::vector<std::vector<unsigned>> _chunkBlocks; /* Per-chunk results of the passes */
+    std::vector<unsigned> _chunkCounts;
+    std::vector<float> _switchDistances; /* Per LOD, of the distance LOD mode */
+
+    JobSystem* _jobSystem = nullptr;
+    bool _parallelActive = true;
+
+    unsigned _blockSize;
+
+    /* The number of blocks on the x and z axis */
+    unsigned _nBlocksX, _nBlocksZ;
+
+    unsigned _minLod, _maxLod;
+
+    float _baseDistance = 700.0f;
+    bool _doubleDistanceEachLevel = false;
+
+    GeoMipMappingLodMode _lodMode = GeoMipMappingLodMode::DISTANCE;
+    float _pixelError = 1.0f;
+    unsigned _viewportHeight = 720;
+
+    bool _morphActive = false;
+
+    /* Factor converting a geometric error into the minimum distance at which
+     * its projection stays below the pixel error, updated every frame */
+    float _errorDistanceFactor = 0.0f;
+
+    bool _frustumCullingActive = true, _lodActive = true;
+    bool _quadTreeActive = true;
+    bool _freezeCamera = false;
+    Camera _lastCamera; /* Used for freezing the camera */
+
+    /* Incremental mode: a block's LOD is only re-evaluated once the distance
+     * travelled by the camera exceeds its expiry, i.e. once the camera could
+     * have crossed one of the block's distance band thresholds. Border
+     * bitmaps are only recalculated for blocks marked dirty, which happens
+     * when the block or one of its neighbors changed its LOD. */
+    bool _incrementalActive = false;
+    bool _lodInvalidated = true;
+    double _cameraTravel = 0.0;
+    std::vector<double> _lodExpiry;
+    std::vector<unsigned char> _borderDirty;
+
+    unsigned _lodUpdates = 0, _borderUpdates = 0;
+    GeoMipMappingPlanTimings _timings;
+};
+
+#endif // GEOMIPMAPPINGPLANNER_H
@@ -0,0 +1,101 @@
+#include "geomipmappingplanningthread.h"
+
+GeoMipMappingPlanningThread::GeoMipMappingPlanningThread(GeoMipMappingPlanner& planner, const GeoMipMappingIndices& indices)
+    : _planner(planner)
+    , _indices(indices)
+{
+    /* Started last, after all members have been initialized */
+    _thread = std::thread(&GeoMipMappingPlanningThread::run, this);
+}
+
+GeoMipMappingPlanningThread::~GeoMipMappingPlanningThread()
+{
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _stop = true;
+    }
+    _condition.notify_all();
+    _thread.join();
+}
+
+void GeoMipMappingPlanningThread::submit(const Camera& camera, const GeoMipMappingPlannerSettings& settings)
+{
+    Request& request = _requests.back();
+    request.camera = camera;
+    request.settings = settings;
+    request.number = ++_submitted;
+    _requests.publish();
+
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _requestPending = true;
+    }
+    _condition.notify_all();
+}
+
+const GeoMipMappingFrame& GeoMipMappingPlanningThread::acquire()
+{
+    _frames.update();
+
+    /* Only the very first frame has to wait for the planning thread */
+    if (_frames.front().number == 0) {
+        std::unique_lock<std::mutex> lock(_mutex);
+        _condition.wait(lock, [this] { return _framePlanned; });
+        lock.unlock();
+
+        _frames.update();
+    }
+
+    return _frames.front();
+}
+
+void GeoMipMappingPlanningThread::plan(GeoMipMappingPlanner& planner, const GeoMipMappingIndices& indices,
+    Camera& camera, const GeoMipMappingPlannerSettings& settings, GeoMipMappingFrame& frame)
+{
+    planner.settings(settings);
+
+    if (settings.tessellationActive) {
+        planner.planPatches(camera, frame.instances);
+        frame.drawList.clear();
+        frame.batches.clear();
+    } else {
+        planner.plan(camera, indices, frame.drawList);
+        planner.batch(frame.drawList, indices, frame.instances, frame.batches);
+    }
+
+    frame.lodUpdates = planner.lodUpdates();
+    frame.borderUpdates = planner.borderUpdates();
+    frame.timings = planner.timings();
+    frame.lodCameraPosition = planner.lodCameraPosition();
+}
+
+void GeoMipMappingPlanningThread::run()
+{
+    while (true) {
+        {
+            std::unique_lock<std::mutex> lock(_mutex);
+            _condition.wait(lock, [this] { return _requestPending || _stop; });
+
+            if (_stop)
+                return;
+            _requestPending = false;
+        }
+
+        /* Several submissions may have been merged into one wake-up */
+        if (!_requests.update())
+            continue;
+
+        Request& request = _requests.front();
+        GeoMipMappingFrame& frame = _frames.back();
+
+        plan(_planner, _indices, request.camera, request.settings, frame);
+        frame.number = request.number;
+        _frames.publish();
+
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            _framePlanned = true;
+        }
+        _condition.notify_all();
+    }
+}
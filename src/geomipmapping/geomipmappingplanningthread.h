@@ -0,0 +1,90 @@
+#ifndef GEOMIPMAPPINGPLANNINGTHREAD_H
+#define GEOMIPMAPPINGPLANNINGTHREAD_H
+
+#include "../camera.h"
+#include "../triplebuffer.h"
+#include "geomipmappingindices.h"
+#include "geomipmappingplanner.h"
+
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/* A planned frame: the draw list of GeoMipMappingPlanner::plan() and its
+ * batches, together with the statistics of the planner. In tessellation
+ * mode, only the instances are filled, with one patch per visible block. */
+struct GeoMipMappingFrame {
+    std::vector<GeoMipMappingDrawCommand> drawList;
+    std::vector<GeoMipMappingInstance> instances;
+    std::vector<GeoMipMappingDrawBatch> batches;
+    unsigned lodUpdates = 0, borderUpdates = 0;
+    GeoMipMappingPlanTimings timings;
+    glm::vec3 lodCameraPosition = glm::vec3(0.0f); /* The LODs were selected for */
+
+    /* Number of the submitted frame the draw list was planned for,
+     * starting at 1 (0 if nothing was planned yet) */
+    unsigned long long number = 0;
+};
+
+/* Runs the GeoMipMapping frame planner on a worker thread, so that the
+ * planning of the next frame overlaps with the submission of the current
+ * one and the render thread only issues the draws.
+ *
+ * Every frame, the render thread submits its camera and the planner
+ * settings, and acquires the most recently planned frame. Both directions
+ * are handed off through lock-free triple buffers, so neither thread waits
+ * for the other: the render thread draws the last finished frame (usually
+ * planned with the camera of the previous frame), and a camera that was
+ * not picked up in time is replaced by the next one. The mutex is only
+ * used to let the worker sleep while there is nothing to plan.
+ *
+ * The planner and the indices must not be used by any other thread while
+ * the planning thread exists. */
+class GeoMipMappingPlanningThread {
+public:
+    GeoMipMappingPlanningThread(GeoMipMappingPlanner& planner, const GeoMipMappingIndices& indices);
+    ~GeoMipMappingPlanningThread();
+
+    GeoMipMappingPlanningThread(const GeoMipMappingPlanningThread&) = delete;
+    GeoMipMappingPlanningThread& operator=(const GeoMipMappingPlanningThread&) = delete;
+
+    /* Hands the camera of the next frame to the planning thread, never waits */
+    void submit(const Camera& camera, const GeoMipMappingPlannerSettings& settings);
+
+    /* Returns the most recently planned frame, which stays valid until the
+     * next call. Only waits if no frame was planned yet. */
+    const GeoMipMappingFrame& acquire();
+
+    /* Plans a frame on the calling thread, the same way as the planning
+     * thread does */
+    static void plan(GeoMipMappingPlanner& planner, const GeoMipMappingIndices& indices,
+        Camera& camera, const GeoMipMappingPlannerSettings& settings, GeoMipMappingFrame& frame);
+
+private:
+    struct Request {
+        Camera camera;
+        GeoMipMappingPlannerSettings settings;
+        unsigned long long number = 0;
+    };
+
+    void run();
+
+    GeoMipMappingPlanner& _planner;
+    const GeoMipMappingIndices& _indices;
+
+    TripleBuffer<Request> _requests;
+    TripleBuffer<GeoMipMappingFrame> _frames;
+    unsigned long long _submitted = 0; /* Only used by the render thread */
+
+    /* Sleeping and waking up, guarded by the mutex */
+    std::mutex _mutex;
+    std::condition_variable _condition;
+    bool _requestPending = false;
+    bool _framePlanned = false;
+    bool _stop = false;
+
+    std::thread _thread;
+};
+
+#endif // GEOMIPMAPPINGPLANNINGTHREAD_H
@@ -1,89 +1,139 @@
-/* UNUSED */
-// #include "geomipmappingquadtree.h"
-
-// GeoMipMappingQuadTree::GeoMipMappingQuadTree(unsigned maxDepth /*unsigned terrainWidth, unsigned terrainHeight*/ /*, float nodeWidth, GeoMipMappingBlock* block*/)
-//{
-//     // unsigned powerOf2Width = std::ceil(std::log2(terrainWidth));
-//     // unsigned powerOf2Height = std::ceil(std::log2(terrainHeight));
-
-//    /* Scale up quadtree to next power of 2 */
-//    // unsigned dimension = std::max(powerOf2Width, powerOf2Height);
-
-//    //_block = block;
-//    //_width = 1 << dimension;
-//    //_height = 1 << dimension;
-//    _maxDepth = maxDepth; // dimension;
-
-//    /* TODO: Node width is either blockWidth (leaf node) or a multiple of that*/
-//    //_nodeWidth = nodeWidth;
-//    /*TODO center field*/
-//    //_center = glm::vec3(0, 0, 0);
-//}
-
-///**
-// * @brief GeoMipMappingQuadTree::GeoMipMappingQuadTree
-// *
-// * TODO: Free children
-// */
-// GeoMipMappingQuadTree::~GeoMipMappingQuadTree()
-//{
-//}
-
-//// bool GeoMipMappingQuadTree::isLeafNode()
-////{
-////     return _isLeafNode;
-//// }
-
-///**
-// * @brief GeoMipMappingQuadTree::build
-// *
-// * Steps:
-// * - From top-left to bottom-right, insert leaf nodes with block refs,
-// *   while keeping track of the position in the block list
-// */
-// void GeoMipMappingQuadTree::build(std::vector<GeoMipMappingBlock>& blocks, unsigned nBlocksX, unsigned nBlocksZ)
-//{
-//    /*_topLeftChild = GeoMipMappingQuadTree()
-//    _topRightChild
-//    _bottomLeftChild
-//    _bottomRightChild*/
-//}
-
-///**
-// * @brief GeoMipMappingQuadTree::buildRec
-// *
-// * rowWidth is the width of a single row in the block list (i.e. nBlocksX)
-// *
-// * @param blocks
-// * @param rowWidth
-// * @param level
-// * @param blockListPos
-// */
-// void GeoMipMappingQuadTree::buildRec(std::vector<GeoMipMappingBlock>& blocks, unsigned rowWidth, unsigned level, unsigned blockX, unsigned blockY)
-//{
-//    if (level == _maxDepth) {
-//    }
-
-//    left
-//}
-
-///**
-// * @brief GeoMipMappingQuadTree::visit
-// *
-// * Idea:
-// * - Start at root node
-// * - Check for each of children whether their AABB interesects with frustum
-// * - If true, visit them, else, ignore
-// * - Continue this recursively until the current node is a leaf node
-// * - If leaf node's AABB intersects frustum, render
-// */
-// void GeoMipMappingQuadTree::render(Camera& camera)
-//{
-//    if (isLeafNode) {
-//        if (true) { /* TODO: Camera intersects block AABB */
-//            /* OpenGL rendering stuff */
-//        }
-//    } else if (true) { /* TODO: Camera intersects quadtree AABB */
-//        _topLeftChild->render(camera);
-//    }
-//}
+#include "geomipmappingquadtree.h"
+
+#include <algorithm>
+
+GeoMipMappingQuadTree::GeoMipMappingQuadTree()
+    : _nBlocksX(0)
+{
+}
+
+/**
+ * @brief GeoMipMappingQuadTree::build
+ *
+ * Steps:
+ * - Starting at the root node covering all blocks, split each node covering
+ *   more than one block into (up to) four children and append them to the
+ *   node array
+ * - Calculate the AABBs bottom-up: since children are always stored after
+ *   their parent, iterating over the array backwards visits all children
+ *   before their parent
+ */
+void GeoMipMappingQuadTree::build(const GeoMipMappingBlocks& blocks, unsigned nBlocksX, unsigned nBlocksZ)
+{
+    _nBlocksX = nBlocksX;
+    _nodes.clear();
+
+    if (nBlocksX == 0 || nBlocksZ == 0)
+        return;
+
+    _nodes.push_back({ glm::vec3(0.0f), glm::vec3(0.0f), 0, 0, nBlocksX, nBlocksZ, 0, 0 });
+
+    unsigned depth = 0;
+    unsigned levelEnd = 1;
+
+    for (unsigned i = 0; i < _nodes.size(); i++) {
+        if (i == levelEnd) {
+            depth++;
+            levelEnd = _nodes.size();
+        }
+
+        GeoMipMappingQuadTreeNode node = _nodes[i];
+
+        if (node.nBlocksX == 1 && node.nBlocksZ == 1)
+            continue;
+
+        unsigned halfX = (node.nBlocksX + 1) / 2;
+        unsigned halfZ = (node.nBlocksZ + 1) / 2;
+
+        unsigned childrenX[] = { node.blockX, node.blockX + halfX };
+        unsigned childrenZ[] = { node.blockZ, node.blockZ + halfZ };
+        unsigned childrenWidth[] = { halfX, node.nBlocksX - halfX };
+        unsigned childrenHeight[] = { halfZ, node.nBlocksZ - halfZ };
+
+        _nodes[i].firstChild = _nodes.size();
+
+        for (unsigned k = 0; k < 2; k++) {
+            for (unsigned l = 0; l < 2; l++) {
+                /* Skip empty children of odd-sized nodes */
+                if (childrenWidth[l] == 0 || childrenHeight[k] == 0)
+                    continue;
+
+                _nodes.push_back({ glm::vec3(0.0f), glm::vec3(0.0f),
+                    childrenX[l], childrenZ[k], childrenWidth[l], childrenHeight[k], 0, 0 });
+                _nodes[i].nChildren++;
+            }
+        }
+    }
+
+    for (unsigned i = _nodes.size(); i-- > 0;) {
+        GeoMipMappingQuadTreeNode& node = _nodes[i];
+
+        if (node.nChildren == 0) {
+            unsigned blockId = node.blockZ * nBlocksX + node.blockX;
+            node.p1 = glm::vec3(blocks.minX[blockId], blocks.minY[blockId], blocks.minZ[blockId]);
+            node.p2 = glm::vec3(blocks.maxX[blockId], blocks.maxY[blockId], blocks.maxZ[blockId]);
+        } else {
+            node.p1 = _nodes[node.firstChild].p1;
+            node.p2 = _nodes[node.firstChild].p2;
+
+            for (unsigned c = 1; c < node.nChildren; c++) {
+                node.p1 = glm::min(node.p1, _nodes[node.firstChild + c].p1);
+                node.p2 = glm::max(node.p2, _nodes[node.firstChild + c].p2);
+            }
+        }
+    }
+
+    /* Every level can push at most 3 siblings in addition to the current node */
+    _stack.clear();
+    _stack.reserve(3 * (depth + 1) + 1);
+}
+
+/**
+ * @brief GeoMipMappingQuadTree::cull
+ *
+ * Idea:
+ * - Start at root node
+ * - If the node's AABB is entirely outside the frustum, skip it
+ * - If it is entirely inside, add all of its blocks
+ * - Otherwise, continue with its children until a leaf node is reached
+ */
+void GeoMipMappingQuadTree::cull(Camera& camera, std::vector<unsigned>& visibleBlocks)
+{
+    if (_nodes.empty())
+        return;
+
+    _stack.clear();
+    _stack.push_back(0);
+
+    while (!_stack.empty()) {
+        const GeoMipMappingQuadTreeNode& node = _nodes[_stack.back()];
+        _stack.pop_back();
+
+        FrustumIntersection intersection = camera.intersectViewFrustum(node.p1, node.p2);
+
+        if (intersection == FrustumIntersection::OUTSIDE)
+            continue;
+
+        if (intersection == FrustumIntersection::INSIDE || node.nChildren == 0) {
+            addAllBlocks(node, visibleBlocks);
+            continue;
+        }
+
+        /* Push children in reverse so that they are visited in order */
+        for (unsigned c = node.nChildren; c-- > 0;)
+            _stack.push_back(node.firstChild + c);
+    }
+}
+
+void GeoMipMappingQuadTree::addAllBlocks(const GeoMipMappingQuadTreeNode& node, std::vector<unsigned>& visibleBlocks)
+{
+    for (unsigned i = node.blockZ; i < node.blockZ + node.nBlocksZ; i++) {
+        for (unsigned j = node.blockX; j < node.blockX + node.nBlocksX; j++)
+            visibleBlocks.push_back(i * _nBlocksX + j);
+    }
+}
+
+const std::vector<GeoMipMappingQuadTreeNode>& GeoMipMappingQuadTree::nodes() const
+{
+    return _nodes;
+}
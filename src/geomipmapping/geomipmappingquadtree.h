@@ -1,90 +1,71 @@
-/* UNUSED */
-// #ifndef GEOMIPMAPPINGQUADTREE_H
-// #define GEOMIPMAPPINGQUADTREE_H
+#ifndef GEOMIPMAPPINGQUADTREE_H
+#define GEOMIPMAPPINGQUADTREE_H
 
-// #include "geomipmappingblock.h"
+#include "../camera.h"
+#include "geomipmappingblocks.h"
 
-///**
-// * @brief The GeoMipMappingQuadTree class
-// *
-// * Notes:
-// * - In order to allow for quadtree-based frustum culling with non-square terrains,
-// *   the size of the quadtree must be scaled up to thw next power of 2 accordingly.
-// * - More specifically, the dimension of the quadtree must be n x n, where
-// *   n is the next power of 2 greater than or equal to max(tWidth, tHeight),
-// *   and tWidth and tHeight are the width and height of the terrain.
-// *   The terrain is situated in the center of the quadtree.
-// *
-// *   The below figure shows a terrain of dimension n x 2n with a quadtree
-// *   of dimension 2n x 2n enclosing it.
-// *
-// *   TODO Open questions: what about not centering it?
-// *
-// *   O- - - - - - – - - - - - -O
-// *   |            |            |
-// *   |            |            |
-// *   .____________|____________.
-// *   I            |            I
-// *   I            |            I
-// *   I- - - - - - O - - O - - -I
-// *   I            |  |  |      I
-// *   I            |- O -|      I
-// *   .____________O__|__O______.
-// *   |            |     |      |
-// *   |            |     |      |
-// *   |            |     |      |
-// *   O- - - - - - - - - - - - -O
-// *
-// *   The symbols stand for:
-// *   - 'O': Corners of the quadtree and its child nodes
-// *   - '.': Corners of the terrain
-// *   - '-' and '|': Borders of the quadtree and its child nodes
-// *   - '_' and 'I': Borders of the terrain
-// *
-// */
-// class GeoMipMappingQuadTree {
-// public:
-//    //    struct QuadTreeNode {
-//    //        QuadTreeNode* _topLeftChild = nullptr;
-//    //        QuadTreeNode* _topRightChild = nullptr;
-//    //        QuadTreeNode* _bottomLeftChild = nullptr;
-//    //        QuadTreeNode* _bottomRightChild = nullptr;
-//    //        bool isLeafNode;
-//    //        GeoMipMappingBlock* block;
-//    //        unsigned width;
-//    //        glm::vec3 center;
-//    //        unsigned depth;
-//    //    };
+#include <vector>
 
-//    GeoMipMappingQuadTree(unsigned terrainWidth, unsigned terrainHeight /*, GeoMipMappingBlock* block = nullptr*/);
-//    ~GeoMipMappingQuadTree();
+struct GeoMipMappingQuadTreeNode {
+    /* Points defining the AABB. p1 contains minY and p2 contains maxY */
+    glm::vec3 p1, p2;
 
-//    void render(Camera& camera);
+    /* Rectangle of blocks covered by this node (in blocks) */
+    unsigned blockX, blockZ;
+    unsigned nBlocksX, nBlocksZ;
 
-//    // void build();
-//    // void buildRec(unsigned depth);
+    /* Index of the first child in the node array. The children of a node
+     * are stored contiguously, leaf nodes have no children. */
+    unsigned firstChild;
+    unsigned nChildren;
+};
 
-//    void build(std::vector<GeoMipMappingBlock>& blocks);
-//    void buildRec(std::vector<GeoMipMappingBlock>& blocks, unsigned rowWidth, unsigned level, unsigned blockListPos);
+/**
+ * @brief The GeoMipMappingQuadTree class
+ *
+ * A quadtree over the GeoMipMapping block grid used for hierarchical
+ * view-frustum culling. Each node covers a rectangle of blocks and stores
+ * the AABB enclosing them (including the min. and max. y-values).
+ *
+ * The nodes are stored in a single flat array instead of being linked
+ * with pointers, where the children of a node are always stored after
+ * their parent. Instead of scaling the quadtree up to the next power of 2,
+ * the block rectangle of each node is split in half (rounded up), which
+ * results in nodes with fewer than four children for non-power-of-two
+ * block grids:
+ *
+ *   *- - - - - - -*- - - - -*
+ *   |             |         |
+ *   |             |         |
+ *   |             |         |
+ *   *- - - - - - -*- - - - -*
+ *   |             |         |
+ *   *- - - - - - -*- - - - -*
+ *
+ * During culling, nodes entirely outside the frustum are skipped with all
+ * their blocks, and all blocks of nodes entirely inside the frustum are
+ * added without any further tests, so the culling cost scales with the
+ * visible area rather than the terrain size.
+ */
+class GeoMipMappingQuadTree {
+public:
+    GeoMipMappingQuadTree();
 
-//    GeoMipMappingQuadTree* _topLeftChild = nullptr;
-//    GeoMipMappingQuadTree* _topRightChild = nullptr;
-//    GeoMipMappingQuadTree* _bottomLeftChild = nullptr;
-//    GeoMipMappingQuadTree* _bottomRightChild = nullptr;
-//    bool isLeafNode;
-//    GeoMipMappingBlock* block;
-//    unsigned width;
-//    glm::vec3 center;
-//    unsigned depth;
-//    unsigned _maxDepth;
+    void build(const GeoMipMappingBlocks& blocks, unsigned nBlocksX, unsigned nBlocksZ);
+    void cull(Camera& camera, std::vector<unsigned>& visibleBlocks);
 
-//    // GeoMipMappingQuadTree* _topLeftChild = nullptr;
-//    // GeoMipMappingQuadTree* _topRightChild = nullptr;
-//    // GeoMipMappingQuadTree* _bottomLeftChild = nullptr;
-//    // GeoMipMappingQuadTree* _bottomRightChild = nullptr;
-//    // GeoMipMappingBlock* _block;
-//    // bool _isLeafNode;
-//    // unsigned _width, _height;
-//};
+    /* Getters */
+    const std::vector<GeoMipMappingQuadTreeNode>& nodes() const;
 
-// #endif // GEOMIPMAPPINGQUADTREE_H
+private:
+    void addAllBlocks(const GeoMipMappingQuadTreeNode& node, std::vector<unsigned>& visibleBlocks);
+
+    std::vector<GeoMipMappingQuadTreeNode> _nodes;
+
+    /* Traversal stack, reused every frame so that culling does not allocate */
+    std::vector<unsigned> _stack;
+
+    unsigned _nBlocksX;
+};
+
+#endif // GEOMIPMAPPINGQUADTREE_H
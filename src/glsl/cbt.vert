@@ -0,0 +1,48 @@
+#version 330 core
+layout (location = 0) in vec2 aWeights; /* Position inside the patch, relative to the legs b-a and c-a */
+layout (location = 1) in vec4 aTriangleAB; /* Per-leaf vertices a (xy) and b (zw) */
+layout (location = 2) in vec2 aTriangleC; /* Per-leaf vertex c */
+
+out vec3 FragPosition;
+out vec3 BlockColor;
+
+layout (std140) uniform FrameUniforms {
+    mat4 projection;
+    mat4 view;
+    mat4 model;
+    vec4 cameraPosition; /* w unused */
+    vec4 lightDirection; /* w unused */
+    vec4 skyColor; /* w unused */
+    vec4 terrainColor; /* w unused */
+    vec4 renderSettings; /* Dark mode, wireframe, fog (0 or 1), fog density */
+};
+
+uniform sampler2D heightmapTexture;
+uniform float textureWidth;
+uniform float textureHeight;
+
+void main()
+{
+    vec2 a = aTriangleAB.xy;
+    vec2 b = aTriangleAB.zw;
+    vec2 c = aTriangleC;
+
+    /* Wireframe color, alternating red, green and blue by depth (the area
+     * halves with every depth, the offset keeps the index positive) */
+    vec2 ab = b - a;
+    vec2 ac = c - a;
+    float area = 0.5 * abs(ab.x * ac.y - ab.y * ac.x);
+    BlockColor = vec3(0.3);
+    BlockColor[int(log2(area) + 32.5) % 3] = 0.7;
+
+    vec2 heightmapPos = a + aWeights.x * ab + aWeights.y * ac;
+
+    /* Texel centers, so that patch vertices on samples get their exact height */
+    vec2 texPos = (heightmapPos + 0.5) / vec2(textureWidth, textureHeight);
+    float y = texture(heightmapTexture, texPos).r * 65535;
+
+    vec3 actualPos = vec3(heightmapPos.x - 0.5 * textureWidth, y, heightmapPos.y - 0.5 * textureHeight);
+
+    FragPosition = vec3(model * vec4(actualPos, 1.0));
+    gl_Position = projection * view * model * vec4(actualPos, 1.0);
+}
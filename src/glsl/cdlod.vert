@@ -0,0 +1,70 @@
+#version 330 core
+layout (location = 0) in vec2 aPos; /* Grid position, 0 to gridSize */
+layout (location = 1) in vec4 aNode; /* Per-node position (xy), scale (z) and LOD (w) */
+
+out vec3 FragPosition;
+out vec3 BlockColor;
+
+layout (std140) uniform FrameUniforms {
+    mat4 projection;
+    mat4 view;
+    mat4 model;
+    vec4 cameraPosition; /* w unused */
+    vec4 lightDirection; /* w unused */
+    vec4 skyColor; /* w unused */
+    vec4 terrainColor; /* w unused */
+    vec4 renderSettings; /* Dark mode, wireframe, fog (0 or 1), fog density */
+};
+
+uniform sampler2D heightmapTexture;
+uniform float textureWidth;
+uniform float textureHeight;
+
+uniform vec2 morphRanges[24]; /* Morph start and end distance per LOD */
+uniform vec3 morphCameraPosition;
+uniform float morphActive;
+
+float sampleHeight(vec2 heightmapPos)
+{
+    /* Texel centers, so that grid vertices get the exact height values */
+    vec2 texPos = (heightmapPos + 0.5) / vec2(textureWidth, textureHeight);
+    return texture(heightmapTexture, texPos).r * 65535;
+}
+
+vec3 worldPosition(vec2 heightmapPos)
+{
+    /* Clamp nodes reaching over the terrain border, the clamped
+     * triangles collapse to zero area */
+    heightmapPos = min(heightmapPos, vec2(textureWidth, textureHeight) - 1.0);
+
+    return vec3(heightmapPos.x - 0.5 * textureWidth,
+                sampleHeight(heightmapPos),
+                heightmapPos.y - 0.5 * textureHeight);
+}
+
+void main()
+{
+    vec2 nodePos = aNode.xy;
+    float scale = aNode.z;
+
+    /* Wireframe color, alternating red, green and blue by LOD */
+    int lod = int(aNode.w + 0.5);
+    BlockColor = vec3(0.3);
+    BlockColor[lod % 3] = 0.7;
+
+    vec3 pos = worldPosition(nodePos + aPos * scale);
+
+    /* Morph factor from the distance to the camera: 0 at the start of the
+     * morph range, 1 at the end of the LOD's range */
+    float viewerDistance = distance(vec3(model * vec4(pos, 1.0)), morphCameraPosition);
+    vec2 range = morphRanges[lod];
+    float morph = morphActive * clamp((viewerDistance - range.x) / (range.y - range.x), 0.0, 1.0);
+
+    /* Move odd grid vertices onto the even vertex before them, which turns
+     * the grid into the grid of the next coarser LOD at morph = 1 */
+    vec2 morphedPos = aPos - mod(aPos, 2.0) * morph;
+    pos = worldPosition(nodePos + morphedPos * scale);
+
+    FragPosition = vec3(model * vec4(pos, 1.0));
+    gl_Position = projection * view * model * vec4(pos, 1.0);
+}
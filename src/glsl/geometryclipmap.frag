@@ -0,0 +1,76 @@
+#version 330 core
+
+in vec3 FragPosition;
+in vec3 Normal;
+in vec2 TexCoord;
+in vec3 LevelColor;
+
+out vec4 FragColor;
+
+layout (std140) uniform FrameUniforms {
+    mat4 projection;
+    mat4 view;
+    mat4 model;
+    vec4 cameraPosition; /* w unused */
+    vec4 lightDirection; /* w unused */
+    vec4 skyColor; /* w unused */
+    vec4 terrainColor; /* w unused */
+    vec4 renderSettings; /* Dark mode, wireframe, fog (0 or 1), fog density */
+};
+
+uniform sampler2D texture1;
+uniform float doTexture;
+
+vec3 calculateAmbient(vec3 lightColor, float strength);
+vec3 calculateDiffuse(vec3 lightColor);
+float calculateFog(float density);
+
+void main()
+{
+    /* The coarse levels extend beyond the terrain */
+    if (TexCoord.x < 0.0 || TexCoord.x > 1.0 || TexCoord.y < 0.0 || TexCoord.y > 1.0)
+        discard;
+
+    vec3 color;
+    vec3 lightColor = vec3(1.0f, 1.0f, 1.0f);
+    float useWire = renderSettings.y;
+
+   if (useWire < 0.5f) {
+        if (doTexture > 0.5) color = texture(texture1, TexCoord).xyz;
+        else color = terrainColor.rgb;
+
+        vec3 ambient = calculateAmbient(lightColor, 0.5f);
+        vec3 diffuse = calculateDiffuse(lightColor);
+        color = (ambient + diffuse) * color;
+
+        if (renderSettings.z > 0.5) {
+            vec3 fogColour = skyColor.rgb;
+            float fogFactor = calculateFog(renderSettings.w);
+            color = mix(fogColour, color, fogFactor);
+        }
+
+    } else {
+        color = LevelColor;
+    }
+    FragColor = vec4(color, 1.0f);
+}
+
+vec3 calculateAmbient(vec3 lightColor, float strength) {
+    return strength * lightColor;
+}
+
+vec3 calculateDiffuse(vec3 lightColor) {
+    vec3 norm = normalize(Normal);
+    vec3 lightDir = normalize(-lightDirection.xyz);
+
+    float diff = max(dot(norm, lightDir), 0.0f);
+    return diff * lightColor;
+}
+
+/* The distance fog concept is based on the following resource:
+ * https://opengl-notes.readthedocs.io/en/latest/topics/texturing/aliasing.html */
+float calculateFog(float density) {
+    float dist = length(cameraPosition.xyz - FragPosition);
+    float fogFactor = exp(-density * dist);
+    return clamp(fogFactor, 0.0f, 1.0f);
+}
@@ -0,0 +1,77 @@
+#version 330 core
+layout (location = 0) in vec2 aPos; /* Sample position inside the level window */
+
+out vec3 FragPosition;
+out vec3 Normal;
+out vec2 TexCoord;
+out vec3 LevelColor;
+
+layout (std140) uniform FrameUniforms {
+    mat4 projection;
+    mat4 view;
+    mat4 model;
+    vec4 cameraPosition; /* w unused */
+    vec4 lightDirection; /* w unused */
+    vec4 skyColor; /* w unused */
+    vec4 terrainColor; /* w unused */
+    vec4 renderSettings; /* Dark mode, wireframe, fog (0 or 1), fog density */
+};
+
+uniform sampler2DArray levelTextures;
+uniform int level;
+uniform int windowSize;
+uniform int textureSize;
+uniform float levelScale; /* Sample spacing of the level, 2^level */
+uniform vec2 levelOrigin; /* First sample of the level window */
+uniform vec2 viewerPosition; /* In sample coordinates of the level */
+uniform float transitionWidth; /* 0 disables the transition */
+uniform float terrainWidth;
+uniform float terrainHeight;
+uniform float yScale;
+
+/* Samples outside of the level window are not loaded, use the closest one */
+vec2 fetch(ivec2 position)
+{
+    ivec2 origin = ivec2(levelOrigin);
+    ivec2 clamped = clamp(position, origin, origin + ivec2(windowSize - 1));
+    return texelFetch(levelTextures, ivec3(clamped & ivec2(textureSize - 1), level), 0).rg;
+}
+
+void main()
+{
+    ivec2 position = ivec2(levelOrigin + aPos);
+    vec2 heights = fetch(position);
+
+    /* Blend towards the coarser level close to the outer border of the
+     * level, so that both levels match at the border (Asirvatham and Hoppe) */
+    float alpha = 0.0;
+    if (transitionWidth > 0.0) {
+        vec2 viewerDistance = abs(vec2(position) - viewerPosition);
+        vec2 alphas = clamp((viewerDistance - (0.5 * float(windowSize - 1) - transitionWidth - 1.0)) / transitionWidth, 0.0, 1.0);
+        alpha = max(alphas.x, alphas.y);
+    }
+
+    float y = mix(heights.r, heights.g, alpha);
+
+    /* Wireframe color, alternating red, green and blue by level */
+    LevelColor = vec3(0.3);
+    LevelColor[level % 3] = 0.7;
+
+    /* Normal from the neighboring samples, see geomipmapping.frag */
+    float leftHeight = fetch(position - ivec2(1, 0)).r;
+    float rightHeight = fetch(position + ivec2(1, 0)).r;
+    float upHeight = fetch(position + ivec2(0, 1)).r;
+    float downHeight = fetch(position - ivec2(0, 1)).r;
+
+    float dx = (leftHeight - rightHeight) * yScale;
+    float dz = (downHeight - upHeight) * yScale;
+    Normal = normalize(vec3(dx, 2.0f * levelScale, dz));
+
+    vec2 heightmapPos = vec2(position) * levelScale;
+    TexCoord = heightmapPos / vec2(terrainWidth, terrainHeight);
+
+    vec3 actualPos = vec3(heightmapPos.x - 0.5 * terrainWidth, y, heightmapPos.y - 0.5 * terrainHeight);
+
+    FragPosition = vec3(model * vec4(actualPos, 1.0));
+    gl_Position = projection * view * model * vec4(actualPos, 1.0);
+}
@@ -1,24 +1,25 @@
 #version 330 core
 
 in vec3 FragPosition;
+in vec3 BlockColor;
+in vec3 VertexNormal;
 
 out vec4 FragColor;
 
-uniform vec2 rendersettings;
-uniform vec4 inColor;
+layout (std140) uniform FrameUniforms {
+    mat4 projection;
+    mat4 view;
+    mat4 model;
+    vec4 cameraPosition; /* w unused */
+    vec4 lightDirection; /* w unused */
+    vec4 skyColor; /* w unused */
+    vec4 terrainColor; /* w unused */
+    vec4 renderSettings; /* Dark mode, wireframe, fog (0 or 1), fog density */
+};
 
 uniform sampler2D texture1;
-
-uniform vec3 lightDirection;
-uniform vec3 cameraPos;
 uniform float doTexture;
 
-uniform vec3 skyColor;
-uniform vec3 terrainColor;
-
-uniform float doFog;
-uniform float fogDensity;
-
 uniform sampler2D heightmapTexture;
 
 uniform float textureWidth;
@@ -29,33 +30,34 @@ vec3 calculateDiffuse(vec3 lightColor);
 float calculateFog(float density);
 
 uniform float yScale;
+uniform bool pagedHeightmap; /* The heightmap texture is not loaded, see geomipmapping.vert */
 
 void main()
 {
     vec3 color;
     vec3 lightColor = vec3(1.0f, 1.0f, 1.0f);
-    float mode = rendersettings.x;
-    float useWire = rendersettings.y;
+    float mode = renderSettings.x;
+    float useWire = renderSettings.y;
 
    if (useWire < 0.5f) {
        vec2 texPos = vec2((FragPosition.x + 0.5 * textureWidth)/ (textureWidth),
                           (FragPosition.z + 0.5 * textureHeight)/ (textureHeight));
 
        if (doTexture > 0.5) color = texture(texture1, texPos).xyz;
-       else color = terrainColor;
+       else color = terrainColor.rgb;
 
        vec3 ambient = calculateAmbient(lightColor, 0.5f);
        vec3 diffuse = calculateDiffuse(lightColor);
        color = (ambient + diffuse) * color;
 
-       if (doFog > 0.5) {
-           vec3 fogColour = skyColor;
-           float fogFactor = calculateFog(fogDensity);
+       if (renderSettings.z > 0.5) {
+           vec3 fogColour = skyColor.rgb;
+           float fogFactor = calculateFog(renderSettings.w);
            color = mix(fogColour, color, fogFactor);
        }
 
     } else {
-        color = inColor.xyz;
+        color = BlockColor;
     }
     FragColor = vec4(color, 1.0f);
 }
@@ -65,6 +67,11 @@ vec3 calculateAmbient(vec3 lightColor, float strength) {
 }
 
 vec3 calculateDiffuse(vec3 lightColor) {
+    vec3 lightDir = normalize(-lightDirection.xyz);
+
+    if (pagedHeightmap)
+        return max(dot(normalize(VertexNormal), lightDir), 0.0f) * lightColor;
+
     vec2 texPos = vec2((FragPosition.x + 0.5 * textureWidth)/ (textureWidth),
                        (FragPosition.z + 0.5 * textureHeight)/ (textureHeight));
 
@@ -80,8 +87,6 @@ vec3 calculateDiffuse(vec3 lightColor) {
 
     vec3 normal = normalize(vec3(dx, 2.0f, dz));
 
-    vec3 lightDir = normalize(-lightDirection);
-
     float diff = max(dot(normal, lightDir), 0.0f);
     return diff * lightColor;
 }
@@ -89,7 +94,7 @@ vec3 calculateDiffuse(vec3 lightColor) {
 /* The distance fog concept is based on the following resource:
  * https://opengl-notes.readthedocs.io/en/latest/topics/texturing/aliasing.html */
 float calculateFog(float density) {
-    float dist = length(cameraPos - FragPosition);
+    float dist = length(cameraPosition.xyz - FragPosition);
     float fogFactor = exp(-density * dist);
     return clamp(fogFactor, 0.0f, 1.0f);
 }
@@ -1,25 +1,136 @@
 #version 330 core
 layout (location = 0) in vec2 aPos;
+layout (location = 1) in vec4 aBlock; /* Per-block translation (xy), LOD (z) and border bitmap (w) */
+layout (location = 2) in float aMorph; /* Geomorphing factor of the inner vertices */
+layout (location = 3) in vec4 aEdgeMorph; /* Geomorphing factors of the left, right, top and bottom border vertices */
 
 out vec3 FragPosition;
+out vec3 BlockColor;
+out vec3 VertexNormal; /* Only with a paged heightmap, see geomipmapping.frag */
+
+layout (std140) uniform FrameUniforms {
+    mat4 projection;
+    mat4 view;
+    mat4 model;
+    vec4 cameraPosition; /* w unused */
+    vec4 lightDirection; /* w unused */
+    vec4 skyColor; /* w unused */
+    vec4 terrainColor; /* w unused */
+    vec4 renderSettings; /* Dark mode, wireframe, fog (0 or 1), fog density */
+};
 
-uniform mat4 projection;
-uniform mat4 view;
-uniform mat4 model;
-uniform vec2 offset;
 uniform sampler2D heightmapTexture;
 uniform float textureWidth;
 uniform float textureHeight;
 
+uniform int blockSize;
+uniform int maxLod;
+uniform float yScale;
+
+/* Paged heightmap (see HeightmapPageTexture): a layer per resident tile,
+ * with a one sample apron, the layer of every tile (-1 if it is not
+ * resident) and the fallback of tiles which are not resident, holding
+ * every fallbackStep-th sample */
+uniform bool pagedHeightmap;
+uniform sampler2DArray heightmapPages;
+uniform isampler2D heightmapPageTable;
+uniform sampler2D heightmapFallback;
+uniform int pageTileSize;
+uniform int fallbackStep;
+uniform vec2 pageOffset; /* Maps positions to heightmap samples */
+
+/* Layer (-1 for the fallback) and first sample of the tile the block lies in */
+int pageLayer;
+ivec2 pageOrigin;
+
+float heightAt(vec2 position)
+{
+    if (pagedHeightmap) {
+        ivec2 texel = ivec2(floor(position + pageOffset + 0.5));
+        if (pageLayer < 0) {
+            vec2 fallbackPos = (vec2(texel) / float(fallbackStep) + 0.5) / vec2(textureSize(heightmapFallback, 0));
+            return texture(heightmapFallback, fallbackPos).r * 65535;
+        }
+
+        return texelFetch(heightmapPages, ivec3(texel - pageOrigin, pageLayer), 0).r * 65535;
+    }
+
+    vec2 texPos = (position + 0.5 * vec2(textureWidth, textureHeight)) / vec2(textureWidth, textureHeight);
+    return texture(heightmapTexture, texPos).r * 65535;
+}
+
 void main()
 {
-    vec2 texPos =  vec2((aPos.x + offset.x + 0.5 * textureWidth) / (textureWidth),
-                        (aPos.y + offset.y + 0.5 * textureHeight) / (textureHeight));
+    vec2 position = aPos + aBlock.xy;
+
+    /* A block always lies within a single tile, whose page (or the
+     * fallback) all of its vertices sample */
+    if (pagedHeightmap) {
+        ivec2 tile = ivec2(floor(aBlock.xy + pageOffset + 0.5)) / pageTileSize;
+        pageLayer = texelFetch(heightmapPageTable, tile, 0).r;
+        pageOrigin = tile * pageTileSize - 1;
+    }
+
+    /* Wireframe color, alternating red, green and blue by LOD */
+    int lod = int(aBlock.z + 0.5);
+    BlockColor = vec3(0.3);
+    BlockColor[lod % 3] = 0.7;
+
+    /* Position of the vertex in the block's grid, and the vertex step of
+     * its LOD (see GeoMipMappingIndices) */
+    ivec2 grid = ivec2(aPos + 0.5 * float(blockSize) + 0.5);
+    int step = 1 << (maxLod - lod);
+    int last = blockSize - 1;
+
+    /* Vertices which are not part of the next coarser LOD are morphed
+     * towards the height of the coarser mesh at their position, i.e. the
+     * average of two neighbors at the distance of one step */
+    float morph = 0.0;
+    vec2 neighbor = vec2(0.0);
+
+    if (grid.x == 0 || grid.x == last || grid.y == 0 || grid.y == last) {
+        /* Border vertices only move along the border. On a border stitched
+         * to a lower LOD neighbor, the vertices are those of the neighbor's
+         * LOD, so they morph towards the neighbor's next coarser LOD. */
+        int side = grid.x == 0 ? 0 : grid.x == last ? 1 : grid.y == 0 ? 2 : 3;
+        int borderBitmap = int(aBlock.w + 0.5);
+        int borderStep = (borderBitmap & (8 >> side)) != 0 ? 2 * step : step;
+        int along = side < 2 ? grid.y : grid.x;
+
+        if ((along / borderStep) % 2 == 1) {
+            neighbor = side < 2 ? vec2(0.0, borderStep) : vec2(borderStep, 0.0);
+            morph = aEdgeMorph[side];
+        }
+    } else {
+        bvec2 odd = equal((grid / step) % 2, ivec2(1));
+
+        /* Both odd: the vertex lies on the diagonal of a coarser cell, which
+         * runs from (-x, +z) to (+x, -z) in the triangle strips */
+        if (odd.x && odd.y)
+            neighbor = vec2(-step, step);
+        else if (odd.x)
+            neighbor = vec2(step, 0.0);
+        else if (odd.y)
+            neighbor = vec2(0.0, step);
+
+        if (any(odd))
+            morph = aMorph;
+    }
+
+    float y = heightAt(position);
+    if (morph > 0.0)
+        y = mix(y, 0.5 * (heightAt(position - neighbor) + heightAt(position + neighbor)), morph);
 
-    float height = texture(heightmapTexture, texPos).r;
-    float y = height * 65535;
+    /* Without a paged heightmap, the fragment shader samples the heightmap
+     * texture for the normals instead */
+    VertexNormal = vec3(0.0, 1.0, 0.0);
+    if (pagedHeightmap) {
+        float dx = (heightAt(position - vec2(1.0, 0.0)) - heightAt(position + vec2(1.0, 0.0))) * yScale;
+        float dz = (heightAt(position - vec2(0.0, 1.0)) - heightAt(position + vec2(0.0, 1.0))) * yScale;
+        VertexNormal = normalize(vec3(dx, 2.0, dz));
+    }
 
-    vec3 actualPos = vec3(aPos.x + offset.x, y, aPos.y + offset.y);
+    vec3 actualPos = vec3(position.x, y, position.y);
 
     FragPosition = vec3(model * vec4(actualPos, 1.0));
     gl_Position = projection * view * model * vec4(actualPos, 1.0);
@@ -0,0 +1,10 @@
+#version 400 core
+layout (location = 0) in vec2 aPos; /* Block corner */
+layout (location = 1) in vec3 aBlock; /* Per-block translation (xy), z unused */
+
+out vec2 ControlPosition;
+
+void main()
+{
+    ControlPosition = aPos + aBlock.xy;
+}
@@ -7,15 +7,19 @@ in vec3 FragPosition;
 
 out vec4 FragColor;
 
-uniform vec2 rendersettings;
+layout (std140) uniform FrameUniforms {
+    mat4 projection;
+    mat4 view;
+    mat4 model;
+    vec4 cameraPosition; /* w unused */
+    vec4 lightDirection; /* w unused */
+    vec4 skyColor; /* w unused */
+    vec4 terrainColor; /* w unused */
+    vec4 renderSettings; /* Dark mode, wireframe, fog (0 or 1), fog density */
+};
+
 uniform sampler2D texture1;
-uniform vec3 lightDirection;
-uniform vec3 cameraPos;
 uniform float doTexture;
-uniform vec3 skyColor;
-uniform vec3 terrainColor;
-uniform float doFog;
-uniform float fogDensity;
 
 vec3 calculateAmbient(vec3 lightColor, float strength);
 vec3 calculateDiffuse(vec3 lightColor);
@@ -25,20 +29,20 @@ void main()
 {
     vec3 color;
     vec3 lightColor = vec3(1.0f, 1.0f, 1.0f);
-    float mode = rendersettings.x;
-    float useWire = rendersettings.y;
+    float mode = renderSettings.x;
+    float useWire = renderSettings.y;
 
    if (useWire < 0.5f) {
         if (doTexture > 0.5) color = texture(texture1, TexCoord).xyz;
-        else color = terrainColor;
+        else color = terrainColor.rgb;
 
         vec3 ambient = calculateAmbient(lightColor, 0.5f);
         vec3 diffuse = calculateDiffuse(lightColor);
         color = (ambient + diffuse) * color;
 
-        if (doFog > 0.5) {
-            vec3 fogColour = skyColor;
-            float fogFactor = calculateFog(fogDensity);
+        if (renderSettings.z > 0.5) {
+            vec3 fogColour = skyColor.rgb;
+            float fogFactor = calculateFog(renderSettings.w);
             color = mix(fogColour, color, fogFactor);
         }
 
@@ -59,7 +63,7 @@ vec3 calculateAmbient(vec3 lightColor, float strength) {
 
 vec3 calculateDiffuse(vec3 lightColor) {
     vec3 norm = normalize(Normal);
-    vec3 lightDir = normalize(-lightDirection);
+    vec3 lightDir = normalize(-lightDirection.xyz);
 
     float diff = max(dot(norm, lightDir), 0.0f);
     return diff * lightColor;
@@ -68,7 +72,7 @@ vec3 calculateDiffuse(vec3 lightColor) {
 /* The distance fog concept is based on the following resource:
  * https://opengl-notes.readthedocs.io/en/latest/topics/texturing/aliasing.html */
 float calculateFog(float density) {
-    float dist = length(cameraPos - FragPosition);
+    float dist = length(cameraPosition.xyz - FragPosition);
     float fogFactor = exp(-density * dist);
     return clamp(fogFactor, 0.0f, 1.0f);
 }
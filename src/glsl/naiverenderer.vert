@@ -7,9 +7,17 @@ out vec3 Normal;
 out vec2 TexCoord;
 out vec3 FragPosition;
 
-uniform mat4 projection;
-uniform mat4 view;
-uniform mat4 model;
+layout (std140) uniform FrameUniforms {
+    mat4 projection;
+    mat4 view;
+    mat4 model;
+    vec4 cameraPosition; /* w unused */
+    vec4 lightDirection; /* w unused */
+    vec4 skyColor; /* w unused */
+    vec4 terrainColor; /* w unused */
+    vec4 renderSettings; /* Dark mode, wireframe, fog (0 or 1), fog density */
+};
+
 uniform mat4 normalMatrix;
 
 void main()
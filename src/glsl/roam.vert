@@ -0,0 +1,37 @@
+#version 330 core
+layout (location = 0) in vec2 aPos; /* Heightmap position */
+layout (location = 1) in float aDepth; /* Depth of the triangle in the bintree */
+
+out vec3 FragPosition;
+out vec3 BlockColor;
+
+layout (std140) uniform FrameUniforms {
+    mat4 projection;
+    mat4 view;
+    mat4 model;
+    vec4 cameraPosition; /* w unused */
+    vec4 lightDirection; /* w unused */
+    vec4 skyColor; /* w unused */
+    vec4 terrainColor; /* w unused */
+    vec4 renderSettings; /* Dark mode, wireframe, fog (0 or 1), fog density */
+};
+
+uniform sampler2D heightmapTexture;
+uniform float textureWidth;
+uniform float textureHeight;
+
+void main()
+{
+    /* Wireframe color, alternating red, green and blue by depth */
+    BlockColor = vec3(0.3);
+    BlockColor[int(aDepth + 0.5) % 3] = 0.7;
+
+    /* Texel centers, so that vertices on samples get their exact height */
+    vec2 texPos = (aPos + 0.5) / vec2(textureWidth, textureHeight);
+    float y = texture(heightmapTexture, texPos).r * 65535;
+
+    vec3 actualPos = vec3(aPos.x - 0.5 * textureWidth, y, aPos.y - 0.5 * textureHeight);
+
+    FragPosition = vec3(model * vec4(actualPos, 1.0));
+    gl_Position = projection * view * model * vec4(actualPos, 1.0);
+}
@@ -0,0 +1,116 @@
+#include "gpuprofiler.h"
+
+#include <cstdlib>
+#include <iostream>
+
+void GpuProfiler::loadQueries(unsigned nSections)
+{
+    _nSections = nSections;
+    _queries.resize(nSections * LATENCY);
+    _milliseconds.assign(nSections, -1.0);
+    _primitives.assign(nSections, -1);
+
+    for (Query& query : _queries) {
+        glGenQueries(1, &query.timeQuery);
+        glGenQueries(1, &query.primitivesQuery);
+    }
+}
+
+void GpuProfiler::unloadQueries()
+{
+    for (Query& query : _queries) {
+        glDeleteQueries(1, &query.timeQuery);
+        glDeleteQueries(1, &query.primitivesQuery);
+    }
+
+    _queries.clear();
+}
+
+/* A query that is still in flight after LATENCY frames is reused, its
+ * result is lost */
+void GpuProfiler::begin(unsigned section, unsigned long long frameNumber)
+{
+    if (_activeSection >= 0) {
+        std::cerr << "GPU profiler section " << section << " begins within section " << _activeSection << std::endl;
+        std::exit(1);
+    }
+    _activeSection = section;
+
+    Query& current = query(section, frameNumber % LATENCY);
+    current.frameNumber = frameNumber;
+
+    glBeginQuery(GL_TIME_ELAPSED, current.timeQuery);
+    glBeginQuery(GL_PRIMITIVES_GENERATED, current.primitivesQuery);
+}
+
+void GpuProfiler::end(unsigned section)
+{
+    if (_activeSection != (int)section) {
+        std::cerr << "GPU profiler section " << section << " ends, but section " << _activeSection << " is active" << std::endl;
+        std::exit(1);
+    }
+    _activeSection = -1;
+
+    glEndQuery(GL_PRIMITIVES_GENERATED);
+    glEndQuery(GL_TIME_ELAPSED);
+}
+
+unsigned long long GpuProfiler::collect()
+{
+    unsigned long long oldest = 0;
+    for (const Query& query : _queries) {
+        if (query.frameNumber != 0 && (oldest == 0 || query.frameNumber < oldest))
+            oldest = query.frameNumber;
+    }
+
+    if (oldest == 0)
+        return 0;
+
+    /* The primitives query ends first, so the time query is checked */
+    unsigned slot = oldest % LATENCY;
+    for (unsigned section = 0; section < _nSections; section++) {
+        Query& current = query(section, slot);
+        if (current.frameNumber != oldest)
+            continue;
+
+        GLint available = 0;
+        glGetQueryObjectiv(current.timeQuery, GL_QUERY_RESULT_AVAILABLE, &available);
+        if (!available)
+            return 0;
+    }
+
+    for (unsigned section = 0; section < _nSections; section++) {
+        Query& current = query(section, slot);
+
+        if (current.frameNumber != oldest) {
+            _milliseconds[section] = -1.0;
+            _primitives[section] = -1;
+            continue;
+        }
+
+        GLuint64 nanoseconds = 0, primitives = 0;
+        glGetQueryObjectui64v(current.timeQuery, GL_QUERY_RESULT, &nanoseconds);
+        glGetQueryObjectui64v(current.primitivesQuery, GL_QUERY_RESULT, &primitives);
+
+        _milliseconds[section] = nanoseconds / 1000000.0;
+        _primitives[section] = (long long)primitives;
+        current.frameNumber = 0;
+    }
+
+    return oldest;
+}
+
+double GpuProfiler::milliseconds(unsigned section)
+{
+    return _milliseconds[section];
+}
+
+long long GpuProfiler::primitives(unsigned section)
+{
+    return _primitives[section];
+}
+
+GpuProfiler::Query& GpuProfiler::query(unsigned section, unsigned slot)
+{
+    return _queries[section * LATENCY + slot];
+}
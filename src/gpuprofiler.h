@@ -0,0 +1,52 @@
+#ifndef GPUPROFILER_H
+#define GPUPROFILER_H
+
+#include <GL/glew.h>
+
+#include <vector>
+
+/* Measures the GPU time and the number of generated primitives of sections
+ * of a frame with OpenGL queries. Reading a query result right after the
+ * frame would stall until the GPU has caught up, so every section has a
+ * ring of queries and the results are read LATENCY frames later, once they
+ * are available.
+ *
+ * Only one section can be measured at a time, i.e. sections must not be
+ * nested or overlap. */
+class GpuProfiler {
+public:
+    static const unsigned LATENCY = 4;
+
+    void loadQueries(unsigned nSections);
+    void unloadQueries();
+
+    /* Measures the given section of the frame with the given number, end()
+     * must be called with the section of the preceding begin() */
+    void begin(unsigned section, unsigned long long frameNumber);
+    void end(unsigned section);
+
+    /* Reads the results of the oldest frame in flight, if they are
+     * available. Returns its frame number, or 0 if there was none. */
+    unsigned long long collect();
+
+    /* Results of the frame last returned by collect(), negative if the
+     * section was not measured in that frame */
+    double milliseconds(unsigned section);
+    long long primitives(unsigned section);
+
+private:
+    struct Query {
+        GLuint timeQuery = 0, primitivesQuery = 0;
+        unsigned long long frameNumber = 0; /* 0 if not in flight */
+    };
+
+    Query& query(unsigned section, unsigned slot);
+
+    unsigned _nSections = 0;
+    int _activeSection = -1; /* Between begin() and end(), -1 otherwise */
+    std::vector<Query> _queries; /* LATENCY slots per section */
+    std::vector<double> _milliseconds;
+    std::vector<long long> _primitives;
+};
+
+#endif // GPUPROFILER_H
@@ -0,0 +1,139 @@
+#include "heightbounds.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+HeightBounds::HeightBounds()
+    : _terrainWidth(0)
+    , _terrainHeight(0)
+    , _tileSize(1)
+{
+}
+
+HeightBounds::HeightBounds(unsigned terrainWidth, unsigned terrainHeight, unsigned tileSize)
+    : _terrainWidth(terrainWidth)
+    , _terrainHeight(terrainHeight)
+    , _tileSize(tileSize)
+{
+    /* Add levels until a single tile covers the terrain on both axes */
+    unsigned nTilesX = (terrainWidth - 1 + tileSize - 1) / tileSize;
+    unsigned nTilesZ = (terrainHeight - 1 + tileSize - 1) / tileSize;
+
+    while (true) {
+        Level level;
+        level.nTilesX = nTilesX;
+        level.nTilesZ = nTilesZ;
+        level.minHeights.assign((std::size_t)nTilesX * nTilesZ, 0);
+        level.maxHeights.assign((std::size_t)nTilesX * nTilesZ, 0);
+        _levels.push_back(std::move(level));
+
+        if (nTilesX == 1 && nTilesZ == 1)
+            break;
+
+        nTilesX = (nTilesX + 1) / 2;
+        nTilesZ = (nTilesZ + 1) / 2;
+    }
+}
+
+void HeightBounds::loadHeights(const unsigned short* heights, unsigned rowLength)
+{
+    for (unsigned row = 0; row < _levels[0].nTilesZ; row++)
+        loadRow(row, heights + (std::size_t)row * _tileSize * rowLength, rowLength);
+    endLoadHeights();
+}
+
+void HeightBounds::loadRow(unsigned row, const unsigned short* strip, unsigned rowLength)
+{
+    Level& tiles = _levels[0];
+    unsigned nRows = std::min(_tileSize, _terrainHeight - 1 - row * _tileSize) + 1;
+
+    for (unsigned x = 0; x < tiles.nTilesX; x++) {
+        unsigned firstColumn = x * _tileSize;
+        unsigned lastColumn = std::min(firstColumn + _tileSize, _terrainWidth - 1);
+
+        unsigned short minHeight = std::numeric_limits<unsigned short>::max();
+        unsigned short maxHeight = 0;
+
+        for (unsigned i = 0; i < nRows; i++) {
+            const unsigned short* heights = strip + (std::size_t)i * rowLength;
+
+            for (unsigned j = firstColumn; j <= lastColumn; j++) {
+                minHeight = std::min(minHeight, heights[j]);
+                maxHeight = std::max(maxHeight, heights[j]);
+            }
+        }
+
+        tiles.minHeights[(std::size_t)row * tiles.nTilesX + x] = minHeight;
+        tiles.maxHeights[(std::size_t)row * tiles.nTilesX + x] = maxHeight;
+    }
+}
+
+/* Combines the heights of the (up to four) tiles below every tile */
+void HeightBounds::endLoadHeights()
+{
+    for (unsigned l = 1; l < _levels.size(); l++) {
+        const Level& finer = _levels[l - 1];
+        Level& level = _levels[l];
+
+        for (unsigned z = 0; z < level.nTilesZ; z++) {
+            for (unsigned x = 0; x < level.nTilesX; x++) {
+                unsigned short minHeight = std::numeric_limits<unsigned short>::max();
+                unsigned short maxHeight = 0;
+
+                for (unsigned finerZ = 2 * z; finerZ < std::min(2 * z + 2, finer.nTilesZ); finerZ++) {
+                    for (unsigned finerX = 2 * x; finerX < std::min(2 * x + 2, finer.nTilesX); finerX++) {
+                        std::size_t tile = (std::size_t)finerZ * finer.nTilesX + finerX;
+                        minHeight = std::min(minHeight, finer.minHeights[tile]);
+                        maxHeight = std::max(maxHeight, finer.maxHeights[tile]);
+                    }
+                }
+
+                level.minHeights[(std::size_t)z * level.nTilesX + x] = minHeight;
+                level.maxHeights[(std::size_t)z * level.nTilesX + x] = maxHeight;
+            }
+        }
+    }
+}
+
+void HeightBounds::bounds(float x0, float z0, float x1, float z1, unsigned short& minHeight, unsigned short& maxHeight) const
+{
+    float extent = std::max(x1 - x0, z1 - z0);
+    unsigned level = 0;
+    float tileSize = _tileSize;
+
+    while (tileSize < extent && level + 1 < _levels.size()) {
+        tileSize *= 2.0f;
+        level++;
+    }
+
+    const Level& tiles = _levels[level];
+
+    /* Tiles share their border samples, so a rectangle ending exactly on a
+     * tile border does not need the next tile */
+    unsigned firstX = std::min((unsigned)(x0 / tileSize), tiles.nTilesX - 1);
+    unsigned firstZ = std::min((unsigned)(z0 / tileSize), tiles.nTilesZ - 1);
+    unsigned lastX = std::min((unsigned)std::max(std::ceil(x1 / tileSize) - 1.0f, 0.0f), tiles.nTilesX - 1);
+    unsigned lastZ = std::min((unsigned)std::max(std::ceil(z1 / tileSize) - 1.0f, 0.0f), tiles.nTilesZ - 1);
+
+    minHeight = std::numeric_limits<unsigned short>::max();
+    maxHeight = 0;
+
+    for (unsigned z = firstZ; z <= std::max(firstZ, lastZ); z++) {
+        for (unsigned x = firstX; x <= std::max(firstX, lastX); x++) {
+            std::size_t tile = (std::size_t)z * tiles.nTilesX + x;
+            minHeight = std::min(minHeight, tiles.minHeights[tile]);
+            maxHeight = std::max(maxHeight, tiles.maxHeights[tile]);
+        }
+    }
+}
+
+unsigned HeightBounds::tileSize() const
+{
+    return _tileSize;
+}
+
+unsigned HeightBounds::nRows() const
+{
+    return _levels[0].nTilesZ;
+}
@@ -0,0 +1,52 @@
+#ifndef HEIGHTBOUNDS_H
+#define HEIGHTBOUNDS_H
+
+#include <vector>
+
+/**
+ * @brief The HeightBounds class
+ *
+ * Min. and max. heights of square tiles of the heightmap, as a pyramid
+ * whose tiles double in size with every level until a single tile covers
+ * the terrain. Used for culling and distances by the algorithms which do
+ * not keep the heights in memory (CBT and ROAM).
+ *
+ * Neighbouring tiles share their border samples, i.e. tile x of level 0
+ * spans the samples x * tileSize to (x + 1) * tileSize.
+ */
+class HeightBounds {
+public:
+    HeightBounds();
+    HeightBounds(unsigned terrainWidth, unsigned terrainHeight, unsigned tileSize);
+
+    /* Loads the heights of all tiles */
+    void loadHeights(const unsigned short* heights, unsigned rowLength);
+
+    /* Same as above, but one row of tiles at a time (for tiled heightmaps).
+     * Strip must contain the tileSize + 1 rows starting at row * tileSize
+     * (fewer for the last row of tiles). endLoadHeights() must be called
+     * after the last row. */
+    void loadRow(unsigned row, const unsigned short* strip, unsigned rowLength);
+    void endLoadHeights();
+
+    /* Min. and max. height of a rectangle of heightmap samples, looked up
+     * in the coarsest level whose tiles are at least as large as the
+     * rectangle (so at most 2 x 2 tiles are combined) */
+    void bounds(float x0, float z0, float x1, float z1, unsigned short& minHeight, unsigned short& maxHeight) const;
+
+    /* Getters */
+    unsigned tileSize() const;
+    unsigned nRows() const; /* Rows of tiles of level 0 */
+
+private:
+    struct Level {
+        unsigned nTilesX, nTilesZ;
+        std::vector<unsigned short> minHeights, maxHeights;
+    };
+    std::vector<Level> _levels;
+
+    unsigned _terrainWidth, _terrainHeight;
+    unsigned _tileSize;
+};
+
+#endif // HEIGHTBOUNDS_H
@@ -1,21 +1,29 @@
 #include "heightmap.h"
 
+#include <algorithm>
 #include <cmath>
 #include <cstdio>
 #include <filesystem>
 #include <fstream>
 #include <iostream>
 #include <sstream>
+#include <vector>
 
 #include "atlodutil.h"
+#include "heightmapfile.h"
 
 #include <GL/glew.h>
 #include <GLFW/glfw3.h>
 
 #include "stb_image.h"
 
-
 Heightmap::Heightmap()
+    : min(0)
+    , max(0)
+    , _data(nullptr)
+    , _width(0)
+    , _height(0)
+    , _heightmapTextureId(0)
 {
 }
 
@@ -29,15 +37,32 @@ unsigned Heightmap::height()
     return _height;
 }
 
-std::vector<unsigned short> Heightmap::data()
+const unsigned short* Heightmap::data()
 {
     return _data;
 }
 
+bool Heightmap::tiled()
+{
+    return _tileCache != nullptr;
+}
+
+std::size_t Heightmap::tileCacheBudget()
+{
+    return _tileCacheBudget;
+}
+
+void Heightmap::tileCacheBudget(std::size_t tileCacheBudget)
+{
+    _tileCacheBudget = tileCacheBudget;
+}
+
 void Heightmap::clear()
 {
-    _data.clear();
-    _data.shrink_to_fit();
+    /* The height values are only released once no copy refers to them anymore */
+    _storage.reset();
+    _tileCache.reset();
+    _data = nullptr;
     _height = 0;
     _width = 0;
 }
@@ -47,7 +72,7 @@ void Heightmap::unloadTexture()
     glDeleteTextures(1, &_heightmapTextureId);
 }
 
-void Heightmap::loadTexture(unsigned short* data)
+void Heightmap::loadTexture(const unsigned short* data)
 {
 
     glGenTextures(1, &_heightmapTextureId);
@@ -58,7 +83,24 @@ void Heightmap::loadTexture(unsigned short* data)
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
 
     glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
-    glTexImage2D(GL_TEXTURE_2D, 0, GL_R16, _width, _height, 0, GL_RED, GL_UNSIGNED_SHORT, data);
+
+    if (data) {
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_R16, _width, _height, 0, GL_RED, GL_UNSIGNED_SHORT, data);
+    } else {
+        /* Tiled heightmaps are uploaded in strips of tiles, so that only
+         * a single strip has to be resident at a time */
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_R16, _width, _height, 0, GL_RED, GL_UNSIGNED_SHORT, nullptr);
+
+        unsigned stripHeight = _tileCache->tileSize();
+        std::vector<unsigned short> strip((std::size_t)_width * stripHeight);
+
+        for (unsigned z = 0; z < _height; z += stripHeight) {
+            unsigned nRows = std::min(stripHeight, _height - z);
+            readRows(z, nRows, strip.data());
+            glTexSubImage2D(GL_TEXTURE_2D, 0, 0, z, _width, nRows, GL_RED, GL_UNSIGNED_SHORT, strip.data());
+        }
+    }
+
     AtlodUtil::checkGlError("Heightmap texture loading failed");
     glBindTexture(GL_TEXTURE_2D, 0);
 }
@@ -72,8 +114,11 @@ void Heightmap::load(const std::string& fileName, bool loadTextureHeightmap)
     const std::string& extension = std::filesystem::path(fileName).extension();
     if (extension == ".png") {
         loadImage(fileName, loadTextureHeightmap);
-    }
-    else {
+    } else if (extension == ".atlodh" && _tileCacheBudget > 0) {
+        loadTiled(fileName, loadTextureHeightmap);
+    } else if (extension == ".atlodh") {
+        loadAtlodh(fileName, loadTextureHeightmap);
+    } else {
         std::cerr << "File extension not supported: " << extension << std::endl;
         std::exit(1);
     }
@@ -82,12 +127,17 @@ void Heightmap::load(const std::string& fileName, bool loadTextureHeightmap)
 void Heightmap::loadImage(const std::string& fileName, bool loadTextureHeightmap)
 {
     int width, height, nrChannels;
+
+    /* With STBI_grey, the decoded image always has a single channel, so the
+     * decoded buffer can be used directly without copying it */
     unsigned short* data = stbi_load_16(fileName.c_str(), &width, &height, &nrChannels, STBI_grey);
 
     if (data) {
 
         _width = width;
         _height = height;
+        _storage = std::shared_ptr<const void>(data, stbi_image_free);
+        _data = data;
 
         if (loadTextureHeightmap)
             loadTexture(data);
@@ -98,28 +148,118 @@ void Heightmap::loadImage(const std::string& fileName, bool loadTextureHeightmap
         std::cerr << "Failed to load heightmap" << std::endl;
         std::exit(1);
     }
+}
 
-    unsigned bytePerPixel = nrChannels;
+/* Memory-maps a native heightmap file. The height values are neither
+ * decoded nor copied, they are paged in by the OS on first access. */
+void Heightmap::loadAtlodh(const std::string& fileName, bool loadTextureHeightmap)
+{
+    std::shared_ptr<MappedFile> file = std::make_shared<MappedFile>();
 
-    for (unsigned i = 0; i < height; i++) {
-        for (unsigned j = 0; j < width; j++) {
-            unsigned short* pixelOffset = data + (j + width * i) * bytePerPixel;
-            unsigned short y = pixelOffset[0];
+    if (!file->open(fileName)) {
+        std::cerr << "Failed to map heightmap " << fileName << std::endl;
+        std::exit(1);
+    }
 
-            _data.push_back(y);
-        }
+    const HeightmapFile::Header* header = HeightmapFile::header(*file);
+
+    if (!header) {
+        std::cerr << "Invalid heightmap file " << fileName << std::endl;
+        std::exit(1);
     }
 
-    stbi_image_free(data);
+    _width = header->width;
+    _height = header->height;
+    min = header->min;
+    max = header->max;
+    _data = HeightmapFile::heights(*file);
+    _storage = file;
+
+    if (loadTextureHeightmap)
+        loadTexture(_data);
+
+    std::cout << "Mapped heightmap of size " << _width << " x " << _height << std::endl;
+}
+
+/* Opens a .atlodh file for tiled access, where only the tiles fitting into
+ * the tile cache budget are resident at a time */
+void Heightmap::loadTiled(const std::string& fileName, bool loadTextureHeightmap)
+{
+    std::shared_ptr<HeightmapTileCache> tileCache = std::make_shared<HeightmapTileCache>();
+
+    if (!tileCache->open(fileName, _tileCacheBudget)) {
+        std::cerr << "Failed to open heightmap " << fileName << std::endl;
+        std::exit(1);
+    }
+
+    _width = tileCache->width();
+    _height = tileCache->height();
+    min = tileCache->min();
+    max = tileCache->max();
+    _data = nullptr;
+    _tileCache = tileCache;
+
+    if (loadTextureHeightmap)
+        loadTexture(nullptr);
+
+    std::cout << "Opened tiled heightmap of size " << _width << " x " << _height
+              << " with a tile cache of " << _tileCacheBudget / (1024 * 1024) << " MB" << std::endl;
 }
 
 unsigned Heightmap::at(unsigned x, unsigned z)
 {
     /* z -> row, x -> column*/
-    try {
-        return _data.at(z * _width + x);
-    } catch (std::out_of_range) {
+    if (x >= _width || z >= _height) {
         std::cout << "Failed fetching height at " << z << ", " << x << std::endl;
         std::exit(1);
     }
+
+    if (_tileCache)
+        return _tileCache->at(x, z);
+
+    return _data[z * _width + x];
+}
+
+/* Copies the rows [z, z + nRows) into a row-major buffer of width() * nRows
+ * values, regardless of whether the heightmap is tiled or not */
+void Heightmap::readRows(unsigned z, unsigned nRows, unsigned short* out)
+{
+    if (_tileCache) {
+        _tileCache->readRows(z, nRows, out);
+        return;
+    }
+
+    nRows = std::min(nRows, _height - z);
+    std::copy(_data + (std::size_t)z * _width, _data + (std::size_t)(z + nRows) * _width, out);
+}
+
+void Heightmap::readRegion(int x, int z, unsigned width, unsigned height, unsigned short* out)
+{
+    /* The part of the region within the heightmap, at least one sample */
+    int firstColumn = std::clamp(x, 0, (int)_width - 1);
+    int lastColumn = std::clamp(x + (int)width, firstColumn + 1, (int)_width);
+    int firstRow = std::clamp(z, 0, (int)_height - 1);
+    int lastRow = std::clamp(z + (int)height, firstRow + 1, (int)_height);
+
+    unsigned short* inside = out + (std::size_t)(firstRow - z) * width + (firstColumn - x);
+    if (_tileCache) {
+        _tileCache->readRegion(firstColumn, firstRow, lastColumn - firstColumn, lastRow - firstRow, inside, width);
+    } else {
+        for (int row = firstRow; row < lastRow; row++) {
+            const unsigned short* source = _data + (std::size_t)row * _width + firstColumn;
+            std::copy(source, source + (lastColumn - firstColumn), inside + (std::size_t)(row - firstRow) * width);
+        }
+    }
+
+    /* Clamp the rest to the edges */
+    for (int i = firstRow - z; i < lastRow - z; i++) {
+        unsigned short* row = out + (std::size_t)i * width;
+        std::fill(row, row + (firstColumn - x), row[firstColumn - x]);
+        std::fill(row + (lastColumn - x), row + width, row[lastColumn - x - 1]);
+    }
+    for (int i = 0; i < (int)height; i++) {
+        int source = std::clamp(i, firstRow - z, lastRow - z - 1);
+        if (source != i)
+            std::copy(out + (std::size_t)source * width, out + (std::size_t)(source + 1) * width, out + (std::size_t)i * width);
+    }
 }
@@ -1,32 +1,59 @@
 #ifndef HEIGHTMAP_H
 #define HEIGHTMAP_H
 
-#include <vector>
+#include "heightmaptilecache.h"
 
+#include <cstddef>
+#include <memory>
+#include <string>
+
+/* The height values are either decoded from a PNG image, memory-mapped
+ * from a native .atlodh file or, if a tile cache budget is set, paged in
+ * tile by tile from a .atlodh file. They are shared between copies of a
+ * heightmap, so passing a heightmap by value does not copy its data. */
 class Heightmap {
 
 public:
     Heightmap();
     void load(const std::string& fileName, bool loadTextureHeightmap);
     void loadImage(const std::string& fileName, bool loadTextureHeightmap);
+    void loadAtlodh(const std::string& fileName, bool loadTextureHeightmap);
+    void loadTiled(const std::string& fileName, bool loadTextureHeightmap);
 
-    void loadTexture(unsigned short* data);
+    void loadTexture(const unsigned short* data);
     void unloadTexture();
     unsigned heightmapTextureId();
 
     /* Getters */
     unsigned width();
     unsigned height();
-    std::vector<unsigned short> data();
+    const unsigned short* data(); /* nullptr if the heightmap is tiled */
+    bool tiled();
+    std::size_t tileCacheBudget();
+
+    /* Setters */
+    void tileCacheBudget(std::size_t tileCacheBudget);
 
     unsigned at(unsigned x, unsigned z);
+    void readRows(unsigned z, unsigned nRows, unsigned short* out);
+
+    /* Copies the width x height samples starting at (x, z) into a row-major
+     * buffer. The region must overlap the heightmap, samples outside of it
+     * are clamped to its edges. */
+    void readRegion(int x, int z, unsigned width, unsigned height, unsigned short* out);
     void clear();
 
     /* Minimum and maximum heightmap y-values */
     unsigned short min, max;
 
 private:
-    std::vector<unsigned short> _data;
+    /* Keeps the height values alive (decoded image or mapped file) */
+    std::shared_ptr<const void> _storage;
+    const unsigned short* _data;
+
+    std::shared_ptr<HeightmapTileCache> _tileCache;
+    std::size_t _tileCacheBudget = 0; /* In bytes, 0 disables tiling */
+
     unsigned _width;
     unsigned _height;
     unsigned _heightmapTextureId;
@@ -0,0 +1,62 @@
+#include "heightmapfile.h"
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+
+bool HeightmapFile::write(const std::string& fileName, const unsigned short* data, unsigned width, unsigned height)
+{
+    std::ofstream file(fileName, std::ios::binary);
+
+    if (!file.is_open())
+        return false;
+
+    std::size_t nValues = (std::size_t)width * height;
+
+    Header header = {};
+    std::memcpy(header.magic, MAGIC, sizeof(MAGIC));
+    header.version = VERSION;
+    header.width = width;
+    header.height = height;
+    header.min = nValues > 0 ? *std::min_element(data, data + nValues) : 0;
+    header.max = nValues > 0 ? *std::max_element(data, data + nValues) : 0;
+    header.dataOffset = sizeof(Header);
+
+    file.write(reinterpret_cast<const char*>(&header), sizeof(Header));
+    file.write(reinterpret_cast<const char*>(data), nValues * sizeof(unsigned short));
+
+    return file.good();
+}
+
+bool HeightmapFile::validate(const Header& header, std::size_t fileSize)
+{
+    if (std::memcmp(header.magic, MAGIC, sizeof(MAGIC)) != 0 || header.version != VERSION)
+        return false;
+
+    /* Height values must be 2-byte aligned and fit into the file */
+    std::size_t dataSize = (std::size_t)header.width * header.height * sizeof(unsigned short);
+    return header.dataOffset % sizeof(unsigned short) == 0 && header.dataOffset + dataSize <= fileSize;
+}
+
+const HeightmapFile::Header* HeightmapFile::header(const MappedFile& file)
+{
+    if (file.size() < sizeof(Header))
+        return nullptr;
+
+    const Header* header = reinterpret_cast<const Header*>(file.data());
+
+    if (!validate(*header, file.size()))
+        return nullptr;
+
+    return header;
+}
+
+const unsigned short* HeightmapFile::heights(const MappedFile& file)
+{
+    const Header* fileHeader = header(file);
+
+    if (!fileHeader)
+        return nullptr;
+
+    return reinterpret_cast<const unsigned short*>(file.data() + fileHeader->dataOffset);
+}
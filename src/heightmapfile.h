@@ -0,0 +1,47 @@
+#ifndef HEIGHTMAPFILE_H
+#define HEIGHTMAPFILE_H
+
+#include "mappedfile.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+/* The native ATLOD heightmap format (.atlodh) stores the height values as
+ * uncompressed 16-bit unsigned integers (little-endian, row-major) after a
+ * small header, so that the file can be memory-mapped and used directly
+ * without decoding or copying. */
+namespace HeightmapFile {
+
+const char MAGIC[8] = { 'A', 'T', 'L', 'O', 'D', 'H', '\0', '\0' };
+const uint32_t VERSION = 1;
+
+struct Header {
+    char magic[8];
+    uint32_t version;
+    uint32_t width;
+    uint32_t height;
+
+    /* Minimum and maximum height values */
+    uint16_t min;
+    uint16_t max;
+
+    /* Byte offset of the height values from the start of the file */
+    uint32_t dataOffset;
+    uint32_t reserved;
+};
+
+static_assert(sizeof(Header) == 32, "Heightmap file header must be 32 bytes");
+
+bool write(const std::string& fileName, const unsigned short* data, unsigned width, unsigned height);
+
+/* Checks whether the header is valid for a file of the given size */
+bool validate(const Header& header, std::size_t fileSize);
+
+/* Returns the validated header of a mapped heightmap file or nullptr,
+ * if the file is not a valid heightmap file */
+const Header* header(const MappedFile& file);
+const unsigned short* heights(const MappedFile& file);
+}
+
+#endif // HEIGHTMAPFILE_H
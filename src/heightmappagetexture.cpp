@@ -0,0 +1,237 @@
+#include "heightmappagetexture.h"
+#include "atlodutil.h"
+
+#include <GL/glew.h>
+
+#include <algorithm>
+#include <functional>
+#include <iostream>
+
+void HeightmapPageTexture::loadBuffers(Heightmap heightmap, unsigned tileSize, std::size_t memoryBudget)
+{
+    _heightmap = heightmap;
+    _tileSize = tileSize;
+    _nTilesX = (heightmap.width() + tileSize - 1) / tileSize;
+    _nTilesZ = (heightmap.height() + tileSize - 1) / tileSize;
+
+    /* A layer holds a tile and its apron */
+    unsigned layerSize = tileSize + 3;
+    std::size_t layerBytes = (std::size_t)layerSize * layerSize * sizeof(unsigned short);
+
+    int maxLayers;
+    glGetIntegerv(GL_MAX_ARRAY_TEXTURE_LAYERS, &maxLayers);
+
+    std::size_t nLayers = std::max<std::size_t>(1, memoryBudget / layerBytes);
+    nLayers = std::min<std::size_t>({ nLayers, (std::size_t)maxLayers, (std::size_t)_nTilesX * _nTilesZ });
+
+    _layers.assign(nLayers, Layer());
+    _freeLayers.clear();
+    for (unsigned i = nLayers; i > 0; i--)
+        _freeLayers.push_back(i - 1);
+    _lru.clear();
+    _pageTable.assign((std::size_t)_nTilesX * _nTilesZ, -1);
+    _pending.clear();
+    _handledFrames.assign((std::size_t)_nTilesX * _nTilesZ, 0);
+    _uploadBuffer.resize((std::size_t)layerSize * layerSize);
+    _frame = 0;
+
+    glGenTextures(1, &_pageTextureId);
+    glBindTexture(GL_TEXTURE_2D_ARRAY, _pageTextureId);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAX_LEVEL, 0);
+    glTexImage3D(GL_TEXTURE_2D_ARRAY, 0, GL_R16, layerSize, layerSize, nLayers, 0, GL_RED, GL_UNSIGNED_SHORT, nullptr);
+
+    glGenTextures(1, &_pageTableTextureId);
+    glBindTexture(GL_TEXTURE_2D, _pageTableTextureId);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, 0);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_R32I, _nTilesX, _nTilesZ, 0, GL_RED_INTEGER, GL_INT, _pageTable.data());
+
+    loadFallback();
+
+    glBindTexture(GL_TEXTURE_2D, 0);
+    glBindTexture(GL_TEXTURE_2D_ARRAY, 0);
+    AtlodUtil::checkGlError("Heightmap page texture creation failed");
+
+    std::cout << "Allocated " << nLayers << " heightmap pages of " << tileSize << " x " << tileSize
+              << " samples for " << _nTilesX * _nTilesZ << " tiles, and a fallback of 1 in "
+              << _fallbackStep << " samples" << std::endl;
+}
+
+/* The fallback holds every _fallbackStep-th sample of every _fallbackStep-th
+ * row, with the smallest power of two step for which it fits into
+ * MAX_FALLBACK_SIZE^2 texels */
+void HeightmapPageTexture::loadFallback()
+{
+    int maxTextureSize;
+    glGetIntegerv(GL_MAX_TEXTURE_SIZE, &maxTextureSize);
+    unsigned maxSize = std::min<unsigned>(MAX_FALLBACK_SIZE, maxTextureSize);
+
+    unsigned width = _heightmap.width(), height = _heightmap.height();
+    _fallbackStep = 1;
+    while ((width + _fallbackStep - 1) / _fallbackStep > maxSize || (height + _fallbackStep - 1) / _fallbackStep > maxSize)
+        _fallbackStep *= 2;
+
+    unsigned fallbackWidth = (width + _fallbackStep - 1) / _fallbackStep;
+    unsigned fallbackHeight = (height + _fallbackStep - 1) / _fallbackStep;
+
+    std::vector<unsigned short> row(width);
+    std::vector<unsigned short> fallback((std::size_t)fallbackWidth * fallbackHeight);
+
+    for (unsigned z = 0; z < fallbackHeight; z++) {
+        _heightmap.readRows(z * _fallbackStep, 1, row.data());
+        for (unsigned x = 0; x < fallbackWidth; x++)
+            fallback[(std::size_t)z * fallbackWidth + x] = row[x * _fallbackStep];
+    }
+
+    glGenTextures(1, &_fallbackTextureId);
+    glBindTexture(GL_TEXTURE_2D, _fallbackTextureId);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, 0);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_R16, fallbackWidth, fallbackHeight, 0, GL_RED, GL_UNSIGNED_SHORT, fallback.data());
+}
+
+void HeightmapPageTexture::unloadBuffers()
+{
+    glDeleteTextures(1, &_pageTextureId);
+    glDeleteTextures(1, &_pageTableTextureId);
+    glDeleteTextures(1, &_fallbackTextureId);
+    _pageTextureId = 0;
+    _pageTableTextureId = 0;
+    _fallbackTextureId = 0;
+}
+
+void HeightmapPageTexture::beginFrame()
+{
+    _frame++;
+    _frameUploads = 0;
+    _frameMisses = 0;
+    _pending.clear();
+}
+
+bool HeightmapPageTexture::request(unsigned tileX, unsigned tileZ, unsigned priority)
+{
+    unsigned tile = tileZ * _nTilesX + tileX;
+    int resident = _pageTable[tile];
+
+    if (resident < 0) {
+        _pending.emplace_back(priority, tile);
+        return false;
+    }
+
+    Layer& layer = _layers[resident];
+    layer.requestedFrame = _frame;
+    _lru.splice(_lru.begin(), _lru, layer.lruPosition);
+    return true;
+}
+
+void HeightmapPageTexture::update()
+{
+    /* Highest priority first, a tile may be pending more than once */
+    std::sort(_pending.begin(), _pending.end(), std::greater<std::pair<unsigned, unsigned>>());
+
+    for (const std::pair<unsigned, unsigned>& pending : _pending) {
+        unsigned tile = pending.second;
+        if (_handledFrames[tile] == _frame)
+            continue;
+        _handledFrames[tile] = _frame;
+
+        /* Deferred tiles are drawn from the fallback in the meantime */
+        if (_frameUploads == MAX_UPLOADS_PER_FRAME) {
+            _frameMisses++;
+            continue;
+        }
+
+        unsigned index;
+        if (!_freeLayers.empty()) {
+            index = _freeLayers.back();
+            _freeLayers.pop_back();
+        } else {
+            /* Evict the least recently requested tile, unless it is needed in this frame too */
+            index = _lru.back();
+            if (_layers[index].requestedFrame == _frame) {
+                _frameMisses++;
+                continue;
+            }
+
+            setPage(_layers[index].tile, -1);
+            _lru.pop_back();
+        }
+
+        Layer& layer = _layers[index];
+        layer.tile = tile;
+        layer.requestedFrame = _frame;
+        _lru.push_front(index);
+        layer.lruPosition = _lru.begin();
+
+        upload(tile % _nTilesX, tile / _nTilesX, index);
+        setPage(tile, index);
+    }
+}
+
+void HeightmapPageTexture::upload(unsigned tileX, unsigned tileZ, unsigned layer)
+{
+    unsigned layerSize = _tileSize + 3;
+    _heightmap.readRegion((int)(tileX * _tileSize) - 1, (int)(tileZ * _tileSize) - 1, layerSize, layerSize, _uploadBuffer.data());
+
+    glBindTexture(GL_TEXTURE_2D_ARRAY, _pageTextureId);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    glTexSubImage3D(GL_TEXTURE_2D_ARRAY, 0, 0, 0, layer, layerSize, layerSize, 1, GL_RED, GL_UNSIGNED_SHORT, _uploadBuffer.data());
+
+    _frameUploads++;
+}
+
+void HeightmapPageTexture::setPage(unsigned tile, int layer)
+{
+    _pageTable[tile] = layer;
+
+    glBindTexture(GL_TEXTURE_2D, _pageTableTextureId);
+    glTexSubImage2D(GL_TEXTURE_2D, 0, tile % _nTilesX, tile / _nTilesX, 1, 1, GL_RED_INTEGER, GL_INT, &layer);
+}
+
+void HeightmapPageTexture::bind(unsigned pageUnit, unsigned pageTableUnit, unsigned fallbackUnit)
+{
+    glActiveTexture(GL_TEXTURE0 + pageUnit);
+    glBindTexture(GL_TEXTURE_2D_ARRAY, _pageTextureId);
+    glActiveTexture(GL_TEXTURE0 + pageTableUnit);
+    glBindTexture(GL_TEXTURE_2D, _pageTableTextureId);
+    glActiveTexture(GL_TEXTURE0 + fallbackUnit);
+    glBindTexture(GL_TEXTURE_2D, _fallbackTextureId);
+}
+
+unsigned HeightmapPageTexture::tileSize()
+{
+    return _tileSize;
+}
+
+unsigned HeightmapPageTexture::nLayers()
+{
+    return _layers.size();
+}
+
+unsigned HeightmapPageTexture::residentTiles()
+{
+    return _lru.size();
+}
+
+unsigned HeightmapPageTexture::fallbackStep()
+{
+    return _fallbackStep;
+}
+
+unsigned HeightmapPageTexture::frameUploads()
+{
+    return _frameUploads;
+}
+
+unsigned HeightmapPageTexture::frameMisses()
+{
+    return _frameMisses;
+}
@@ -0,0 +1,97 @@
+#ifndef HEIGHTMAPPAGETEXTURE_H
+#define HEIGHTMAPPAGETEXTURE_H
+
+#include "heightmap.h"
+
+#include <list>
+#include <utility>
+#include <vector>
+
+/* GPU residency of a tiled heightmap, for terrains which are too large for
+ * a single heightmap texture. The heightmap is split into square tiles of
+ * tileSize x tileSize samples. Every resident tile occupies one layer of a
+ * texture array, which additionally holds a one sample wide apron around
+ * the tile (i.e. (tileSize + 3)^2 samples, the last row and column of a
+ * tile are shared with the next tile). A page table texture maps every
+ * tile to its layer, or to -1 if it is not resident.
+ *
+ * Tiles which are not resident are drawn from a fallback texture, which
+ * holds a subsampled copy of the whole heightmap and is always resident,
+ * so no geometry is ever dropped.
+ *
+ * Every frame, the renderer requests the tiles it is about to draw. Tiles
+ * which are not resident are read through the heightmap (and thus its tile
+ * cache) and uploaded into a free layer, or into the layer of the least
+ * recently requested tile once all layers are in use, at most
+ * MAX_UPLOADS_PER_FRAME per frame. The remaining tiles stay on the
+ * fallback until a later frame. */
+class HeightmapPageTexture {
+public:
+    static const unsigned MAX_UPLOADS_PER_FRAME = 8;
+    static const unsigned MAX_FALLBACK_SIZE = 2048;
+
+    /* At most memoryBudget bytes of layers are allocated, but at least one */
+    void loadBuffers(Heightmap heightmap, unsigned tileSize, std::size_t memoryBudget);
+    void unloadBuffers();
+
+    /* Tiles requested after beginFrame() are not evicted during the frame */
+    void beginFrame();
+
+    /* Marks a tile as needed in this frame, returns false if it is not
+     * resident (yet). Of the tiles which are not resident, those with the
+     * highest priority are uploaded first by update(). */
+    bool request(unsigned tileX, unsigned tileZ, unsigned priority);
+
+    /* Uploads the requested tiles which are not resident, within the
+     * per-frame limit */
+    void update();
+
+    /* Binds the texture array, the page table and the fallback texture to
+     * the given texture units */
+    void bind(unsigned pageUnit, unsigned pageTableUnit, unsigned fallbackUnit);
+
+    /* Getters */
+    unsigned tileSize();
+    unsigned nLayers();
+    unsigned residentTiles();
+    unsigned fallbackStep(); /* Heightmap samples per fallback texel */
+    unsigned frameUploads(); /* Tiles uploaded since the last beginFrame() */
+    unsigned frameMisses(); /* Tiles drawn from the fallback since the last beginFrame() */
+
+private:
+    struct Layer {
+        int tile = -1;
+        unsigned long long requestedFrame = 0;
+        std::list<unsigned>::iterator lruPosition;
+    };
+
+    void loadFallback();
+    void upload(unsigned tileX, unsigned tileZ, unsigned layer);
+    void setPage(unsigned tile, int layer);
+
+    Heightmap _heightmap;
+
+    unsigned _pageTextureId = 0, _pageTableTextureId = 0, _fallbackTextureId = 0;
+    unsigned _tileSize = 0;
+    unsigned _nTilesX = 0, _nTilesZ = 0;
+    unsigned _fallbackStep = 1;
+
+    std::vector<int> _pageTable; /* Layer per tile, -1 if not resident */
+    std::vector<Layer> _layers;
+
+    /* Layers holding a tile, most recently requested first */
+    std::list<unsigned> _lru;
+    std::vector<unsigned> _freeLayers;
+
+    /* Requested tiles which are not resident, as (priority, tile), possibly
+     * more than once, and the last frame update() handled every tile in */
+    std::vector<std::pair<unsigned, unsigned>> _pending;
+    std::vector<unsigned long long> _handledFrames;
+
+    std::vector<unsigned short> _uploadBuffer; /* Reused by every upload */
+
+    unsigned long long _frame = 0;
+    unsigned _frameUploads = 0, _frameMisses = 0;
+};
+
+#endif // HEIGHTMAPPAGETEXTURE_H
@@ -0,0 +1,198 @@
+#include "heightmaptilecache.h"
+#include "heightmapfile.h"
+
+#include <algorithm>
+#include <iostream>
+
+HeightmapTileCache::HeightmapTileCache()
+    : _dataOffset(0)
+    , _width(0)
+    , _height(0)
+    , _min(0)
+    , _max(0)
+    , _tileSize(DEFAULT_TILE_SIZE)
+    , _nTilesX(0)
+    , _nTilesZ(0)
+    , _maxResidentTiles(1)
+    , _lastKey(0)
+    , _lastTile(nullptr)
+    , _tileLoads(0)
+{
+}
+
+bool HeightmapTileCache::open(const std::string& fileName, std::size_t memoryBudget, unsigned tileSize)
+{
+    _file.open(fileName, std::ios::binary | std::ios::ate);
+
+    if (!_file.is_open() || tileSize == 0)
+        return false;
+
+    std::size_t fileSize = _file.tellg();
+    _file.seekg(0);
+
+    HeightmapFile::Header header;
+    if (fileSize < sizeof(header) || !_file.read(reinterpret_cast<char*>(&header), sizeof(header)))
+        return false;
+
+    if (!HeightmapFile::validate(header, fileSize))
+        return false;
+
+    _dataOffset = header.dataOffset;
+    _width = header.width;
+    _height = header.height;
+    _min = header.min;
+    _max = header.max;
+
+    _tileSize = tileSize;
+    _nTilesX = (_width + tileSize - 1) / tileSize;
+    _nTilesZ = (_height + tileSize - 1) / tileSize;
+
+    /* At least one tile must always be resident */
+    std::size_t tileBytes = (std::size_t)tileSize * tileSize * sizeof(unsigned short);
+    _maxResidentTiles = std::max<std::size_t>(1, memoryBudget / tileBytes);
+
+    _tiles.clear();
+    _lru.clear();
+    _lastTile = nullptr;
+    _tileLoads = 0;
+
+    return true;
+}
+
+unsigned short HeightmapTileCache::at(unsigned x, unsigned z)
+{
+    Tile& current = tile(x / _tileSize, z / _tileSize);
+    return current.data[(z % _tileSize) * _tileSize + (x % _tileSize)];
+}
+
+void HeightmapTileCache::readRows(unsigned z, unsigned nRows, unsigned short* out)
+{
+    unsigned end = std::min(z + nRows, _height);
+
+    /* Copy tile by tile, so that every tile is only looked up once per call */
+    for (unsigned tileZ = z / _tileSize; tileZ * _tileSize < end; tileZ++) {
+        unsigned firstRow = std::max(z, tileZ * _tileSize);
+        unsigned lastRow = std::min(end, (tileZ + 1) * _tileSize);
+
+        for (unsigned tileX = 0; tileX < _nTilesX; tileX++) {
+            Tile& current = tile(tileX, tileZ);
+            unsigned tileWidth = std::min(_tileSize, _width - tileX * _tileSize);
+
+            for (unsigned row = firstRow; row < lastRow; row++) {
+                const unsigned short* source = &current.data[(row - tileZ * _tileSize) * _tileSize];
+                std::copy(source, source + tileWidth, out + (std::size_t)(row - z) * _width + tileX * _tileSize);
+            }
+        }
+    }
+}
+
+void HeightmapTileCache::readRegion(unsigned x, unsigned z, unsigned width, unsigned height, unsigned short* out, std::size_t stride)
+{
+    unsigned endX = x + width, endZ = z + height;
+
+    /* Copy the row spans of one tile at a time, like readRows() */
+    for (unsigned tileZ = z / _tileSize; tileZ * _tileSize < endZ; tileZ++) {
+        unsigned firstRow = std::max(z, tileZ * _tileSize);
+        unsigned lastRow = std::min(endZ, (tileZ + 1) * _tileSize);
+
+        for (unsigned tileX = x / _tileSize; tileX * _tileSize < endX; tileX++) {
+            Tile& current = tile(tileX, tileZ);
+            unsigned firstColumn = std::max(x, tileX * _tileSize);
+            unsigned lastColumn = std::min(endX, (tileX + 1) * _tileSize);
+
+            for (unsigned row = firstRow; row < lastRow; row++) {
+                const unsigned short* source = &current.data[(row - tileZ * _tileSize) * _tileSize + (firstColumn - tileX * _tileSize)];
+                std::copy(source, source + (lastColumn - firstColumn), out + (row - z) * stride + (firstColumn - x));
+            }
+        }
+    }
+}
+
+HeightmapTileCache::Tile& HeightmapTileCache::tile(unsigned tileX, unsigned tileZ)
+{
+    unsigned long long key = (unsigned long long)tileZ * _nTilesX + tileX;
+
+    if (_lastTile && _lastKey == key)
+        return *_lastTile;
+
+    auto found = _tiles.find(key);
+
+    if (found != _tiles.end()) {
+        /* Move to the front of the LRU list */
+        _lru.splice(_lru.begin(), _lru, found->second.lruPosition);
+    } else {
+        /* Evict the least recently used tile if the budget is exhausted */
+        if (_tiles.size() >= _maxResidentTiles) {
+            _tiles.erase(_lru.back());
+            _lru.pop_back();
+        }
+
+        found = _tiles.emplace(key, Tile()).first;
+        _lru.push_front(key);
+        found->second.lruPosition = _lru.begin();
+
+        loadTile(tileX, tileZ, found->second);
+    }
+
+    _lastKey = key;
+    _lastTile = &found->second;
+
+    return found->second;
+}
+
+void HeightmapTileCache::loadTile(unsigned tileX, unsigned tileZ, Tile& tile)
+{
+    tile.data.assign((std::size_t)_tileSize * _tileSize, 0);
+
+    unsigned x = tileX * _tileSize;
+    unsigned tileWidth = std::min(_tileSize, _width - x);
+    unsigned tileHeight = std::min(_tileSize, _height - tileZ * _tileSize);
+
+    for (unsigned row = 0; row < tileHeight; row++) {
+        std::size_t z = (std::size_t)tileZ * _tileSize + row;
+        _file.seekg(_dataOffset + (z * _width + x) * sizeof(unsigned short));
+        _file.read(reinterpret_cast<char*>(&tile.data[row * _tileSize]), tileWidth * sizeof(unsigned short));
+    }
+
+    if (!_file) {
+        std::cerr << "Failed reading heightmap tile " << tileX << ", " << tileZ << std::endl;
+        std::exit(1);
+    }
+
+    _tileLoads++;
+}
+
+unsigned HeightmapTileCache::width()
+{
+    return _width;
+}
+
+unsigned HeightmapTileCache::height()
+{
+    return _height;
+}
+
+unsigned short HeightmapTileCache::min()
+{
+    return _min;
+}
+
+unsigned short HeightmapTileCache::max()
+{
+    return _max;
+}
+
+unsigned HeightmapTileCache::tileSize()
+{
+    return _tileSize;
+}
+
+std::size_t HeightmapTileCache::residentTiles()
+{
+    return _tiles.size();
+}
+
+unsigned long long HeightmapTileCache::tileLoads()
+{
+    return _tileLoads;
+}
@@ -0,0 +1,75 @@
+#ifndef HEIGHTMAPTILECACHE_H
+#define HEIGHTMAPTILECACHE_H
+
+#include <cstddef>
+#include <fstream>
+#include <list>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+/* Out-of-core storage for .atlodh heightmaps. The heightmap is split into
+ * square tiles of tileSize x tileSize height values, which are read from
+ * the file on demand. At most memoryBudget bytes of tiles are kept
+ * resident, the least recently used tile is evicted first.
+ *
+ * This allows working with heightmaps which are larger than the
+ * available memory. */
+class HeightmapTileCache {
+public:
+    static const unsigned DEFAULT_TILE_SIZE = 256;
+
+    HeightmapTileCache();
+
+    bool open(const std::string& fileName, std::size_t memoryBudget, unsigned tileSize = DEFAULT_TILE_SIZE);
+
+    unsigned short at(unsigned x, unsigned z);
+
+    /* Copies the rows [z, z + nRows) into a row-major buffer of width() * nRows values */
+    void readRows(unsigned z, unsigned nRows, unsigned short* out);
+
+    /* Copies the width x height values starting at (x, z), which must lie
+     * within the heightmap, into a buffer with rows of stride values */
+    void readRegion(unsigned x, unsigned z, unsigned width, unsigned height, unsigned short* out, std::size_t stride);
+
+    /* Getters */
+    unsigned width();
+    unsigned height();
+    unsigned short min();
+    unsigned short max();
+    unsigned tileSize();
+    std::size_t residentTiles();
+    unsigned long long tileLoads();
+
+private:
+    struct Tile {
+        std::vector<unsigned short> data;
+        std::list<unsigned long long>::iterator lruPosition;
+    };
+
+    Tile& tile(unsigned tileX, unsigned tileZ);
+    void loadTile(unsigned tileX, unsigned tileZ, Tile& tile);
+
+    std::ifstream _file;
+    std::size_t _dataOffset;
+
+    unsigned _width, _height;
+    unsigned short _min, _max;
+
+    unsigned _tileSize;
+    unsigned _nTilesX, _nTilesZ;
+    std::size_t _maxResidentTiles;
+
+    std::unordered_map<unsigned long long, Tile> _tiles;
+
+    /* Keys of the resident tiles, most recently used first */
+    std::list<unsigned long long> _lru;
+
+    /* Consecutive lookups usually hit the same tile */
+    unsigned long long _lastKey;
+    Tile* _lastTile;
+
+    unsigned long long _tileLoads;
+};
+
+#endif // HEIGHTMAPTILECACHE_H
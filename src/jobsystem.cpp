@@ -0,0 +1,171 @@
+#include "jobsystem.h"
+
+#include <algorithm>
+
+JobSystem::JobSystem(unsigned nThreads)
+{
+    if (nThreads == 0)
+        nThreads = std::max(1u, std::thread::hardware_concurrency());
+    _nThreads = nThreads;
+
+    for (unsigned i = 0; i < _nThreads; i++)
+        _ranges.emplace_back(new Range());
+
+    for (unsigned i = 1; i < _nThreads; i++)
+        _workers.emplace_back(&JobSystem::workerLoop, this, i);
+}
+
+JobSystem::~JobSystem()
+{
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _stop = true;
+    }
+    _workCondition.notify_all();
+
+    for (std::thread& worker : _workers)
+        worker.join();
+}
+
+void JobSystem::run(unsigned count, unsigned chunkSize, const void* job, JobFunction function)
+{
+    chunkSize = std::max(chunkSize, 1u);
+    unsigned n = nChunks(count, chunkSize);
+
+    /* Not worth waking up the workers */
+    if (_nThreads == 1 || n <= 1) {
+        for (unsigned chunk = 0; chunk < n; chunk++)
+            function(job, chunk, chunk * chunkSize, std::min(count, (chunk + 1) * chunkSize));
+        return;
+    }
+
+    std::lock_guard<std::mutex> jobLock(_jobMutex);
+
+    _job = job;
+    _jobFunction = function;
+    _count = count;
+    _chunkSize = chunkSize;
+    _remainingChunks.store(n, std::memory_order_relaxed);
+
+    /* The job is published to the other threads together with the ranges */
+    for (unsigned thread = 0; thread < _nThreads; thread++) {
+        std::lock_guard<std::mutex> lock(_ranges[thread]->mutex);
+        _ranges[thread]->begin = (unsigned)((unsigned long long)n * thread / _nThreads);
+        _ranges[thread]->end = (unsigned)((unsigned long long)n * (thread + 1) / _nThreads);
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _generation++;
+    }
+    _workCondition.notify_all();
+
+    runChunks(0);
+
+    /* Wait for the chunks still running on the workers */
+    std::unique_lock<std::mutex> lock(_mutex);
+    _doneCondition.wait(lock, [this] { return _remainingChunks.load(std::memory_order_acquire) == 0; });
+
+    _job = nullptr;
+}
+
+unsigned JobSystem::nChunks(unsigned count, unsigned chunkSize)
+{
+    chunkSize = std::max(chunkSize, 1u);
+    return (count + chunkSize - 1) / chunkSize;
+}
+
+unsigned JobSystem::nThreads() const
+{
+    return _nThreads;
+}
+
+void JobSystem::workerLoop(unsigned thread)
+{
+    unsigned long long generation = 0;
+
+    while (true) {
+        {
+            std::unique_lock<std::mutex> lock(_mutex);
+            _workCondition.wait(lock, [&] { return _stop || _generation != generation; });
+
+            if (_stop)
+                return;
+            generation = _generation;
+        }
+
+        runChunks(thread);
+    }
+}
+
+/* Runs chunks until there are none left to take or steal */
+void JobSystem::runChunks(unsigned thread)
+{
+    do {
+        unsigned chunk;
+
+        while (takeChunk(thread, chunk)) {
+            unsigned begin = chunk * _chunkSize;
+            _jobFunction(_job, chunk, begin, std::min(_count, begin + _chunkSize));
+
+            if (_remainingChunks.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+                std::lock_guard<std::mutex> lock(_mutex);
+                _doneCondition.notify_all();
+            }
+        }
+    } while (stealChunks(thread));
+}
+
+bool JobSystem::takeChunk(unsigned thread, unsigned& chunk)
+{
+    Range& range = *_ranges[thread];
+    std::lock_guard<std::mutex> lock(range.mutex);
+
+    if (range.begin == range.end)
+        return false;
+
+    chunk = range.begin++;
+    return true;
+}
+
+/* Moves the back half of the largest range of another thread into the
+ * (empty) range of the given thread, returns false if there was nothing
+ * left to steal */
+bool JobSystem::stealChunks(unsigned thread)
+{
+    while (true) {
+        unsigned victim = thread, largest = 0;
+
+        for (unsigned i = 1; i < _nThreads; i++) {
+            unsigned other = (thread + i) % _nThreads;
+            std::lock_guard<std::mutex> lock(_ranges[other]->mutex);
+
+            if (_ranges[other]->end - _ranges[other]->begin > largest) {
+                largest = _ranges[other]->end - _ranges[other]->begin;
+                victim = other;
+            }
+        }
+
+        if (largest == 0)
+            return false;
+
+        unsigned begin, end;
+        {
+            Range& range = *_ranges[victim];
+            std::lock_guard<std::mutex> lock(range.mutex);
+
+            /* Might have been taken by now */
+            if (range.begin == range.end)
+                continue;
+
+            end = range.end;
+            begin = range.end - (range.end - range.begin + 1) / 2;
+            range.end = begin;
+        }
+
+        std::lock_guard<std::mutex> lock(_ranges[thread]->mutex);
+        _ranges[thread]->begin = begin;
+        _ranges[thread]->end = end;
+        return true;
+    }
+}
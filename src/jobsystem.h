@@ -0,0 +1,96 @@
+#ifndef JOBSYSTEM_H
+#define JOBSYSTEM_H
+
+#include <atomic>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/**
+ * @brief The JobSystem class
+ *
+ * A small pool of worker threads running data-parallel loops, shared by
+ * everything in the application that splits its work into chunks (block
+ * loading, normal generation, the GeoMipMapping planner, ...).
+ *
+ * parallelFor() splits the loop into chunks and hands every thread (the
+ * calling thread included) a contiguous range of chunks. Each thread runs
+ * the chunks of its own range from the front, and once it runs out,
+ * steals the back half of the largest remaining range of another thread.
+ * So, uneven chunks (e.g. blocks outside the view-frustum which are
+ * skipped) are balanced, while every thread mostly works on neighbouring
+ * chunks.
+ *
+ * Which thread runs a chunk is not deterministic, so jobs which have to
+ * produce the same output as a serial loop must only write to the data of
+ * their own chunk (the chunk index can be used to address per-chunk
+ * results, which are combined in chunk order afterwards).
+ *
+ * parallelFor() can be called from any thread, calls from several threads
+ * are run one after another. It must not be called from within a job.
+ */
+class JobSystem {
+public:
+    /* The number of threads includes the calling thread, 0 uses all
+     * hardware threads */
+    JobSystem(unsigned nThreads = 0);
+    ~JobSystem();
+
+    JobSystem(const JobSystem&) = delete;
+    JobSystem& operator=(const JobSystem&) = delete;
+
+    /* Calls job(chunk, begin, end) for the chunks [begin, end) of the range
+     * [0, count), every chunk but the last containing chunkSize items, and
+     * returns once all chunks have been run. The job is called through a
+     * plain function pointer, so that no std::function has to be allocated. */
+    template <typename Job>
+    void parallelFor(unsigned count, unsigned chunkSize, const Job& job)
+    {
+        run(count, chunkSize, &job, [](const void* job, unsigned chunk, unsigned begin, unsigned end) {
+            (*static_cast<const Job*>(job))(chunk, begin, end);
+        });
+    }
+
+    /* Number of chunks parallelFor() splits the range into */
+    static unsigned nChunks(unsigned count, unsigned chunkSize);
+
+    /* Getters */
+    unsigned nThreads() const;
+
+private:
+    using JobFunction = void (*)(const void* job, unsigned chunk, unsigned begin, unsigned end);
+
+    /* Range of chunks owned by a thread, the owner takes chunks from the
+     * front, thieves from the back */
+    struct Range {
+        std::mutex mutex;
+        unsigned begin = 0, end = 0;
+    };
+
+    void run(unsigned count, unsigned chunkSize, const void* job, JobFunction function);
+    void workerLoop(unsigned thread);
+    void runChunks(unsigned thread);
+    bool takeChunk(unsigned thread, unsigned& chunk);
+    bool stealChunks(unsigned thread);
+
+    unsigned _nThreads;
+    std::vector<std::unique_ptr<Range>> _ranges; /* Index 0 is the calling thread */
+    std::vector<std::thread> _workers;
+
+    /* Job of the current parallelFor() */
+    std::mutex _jobMutex; /* Held by the calling thread for the whole parallelFor() */
+    const void* _job = nullptr;
+    JobFunction _jobFunction = nullptr;
+    unsigned _count = 0, _chunkSize = 1;
+    std::atomic<unsigned> _remainingChunks { 0 };
+
+    /* Waking up the workers and the calling thread */
+    std::mutex _mutex;
+    std::condition_variable _workCondition, _doneCondition;
+    unsigned long long _generation = 0;
+    bool _stop = false;
+};
+
+#endif // JOBSYSTEM_H
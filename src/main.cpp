@@ -4,10 +4,11 @@
 
 int main(int argc, char** argv)
 {
-    if (Application::setup() != 0)
+    /* The arguments decide how the window is created */
+    if (Application::parseArguments(argc, argv) != 0)
         return 1;
 
-    if (Application::parseArguments(argc, argv) != 0)
+    if (Application::setup() != 0)
         return 1;
 
     return Application::run();
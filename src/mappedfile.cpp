@@ -0,0 +1,108 @@
+#include "mappedfile.h"
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+MappedFile::MappedFile()
+{
+}
+
+MappedFile::~MappedFile()
+{
+    close();
+}
+
+bool MappedFile::open(const std::string& fileName)
+{
+    close();
+
+#ifdef _WIN32
+    HANDLE file = CreateFileA(fileName.c_str(), GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+    if (file == INVALID_HANDLE_VALUE)
+        return false;
+
+    LARGE_INTEGER fileSize;
+    if (!GetFileSizeEx(file, &fileSize) || fileSize.QuadPart == 0) {
+        CloseHandle(file);
+        return false;
+    }
+
+    HANDLE mapping = CreateFileMappingA(file, NULL, PAGE_READONLY, 0, 0, NULL);
+    if (mapping == NULL) {
+        CloseHandle(file);
+        return false;
+    }
+
+    void* data = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+    if (data == NULL) {
+        CloseHandle(mapping);
+        CloseHandle(file);
+        return false;
+    }
+
+    _file = file;
+    _mapping = mapping;
+    _data = static_cast<const unsigned char*>(data);
+    _size = (std::size_t)fileSize.QuadPart;
+#else
+    int file = ::open(fileName.c_str(), O_RDONLY);
+    if (file < 0)
+        return false;
+
+    struct stat fileStat;
+    if (fstat(file, &fileStat) != 0 || fileStat.st_size == 0) {
+        ::close(file);
+        return false;
+    }
+
+    void* data = mmap(nullptr, fileStat.st_size, PROT_READ, MAP_PRIVATE, file, 0);
+
+    /* The mapping stays valid after closing the file descriptor */
+    ::close(file);
+
+    if (data == MAP_FAILED)
+        return false;
+
+    _data = static_cast<const unsigned char*>(data);
+    _size = fileStat.st_size;
+#endif
+
+    return true;
+}
+
+void MappedFile::close()
+{
+    if (!_data)
+        return;
+
+#ifdef _WIN32
+    UnmapViewOfFile(_data);
+    CloseHandle(_mapping);
+    CloseHandle(_file);
+    _mapping = nullptr;
+    _file = nullptr;
+#else
+    munmap(const_cast<unsigned char*>(_data), _size);
+#endif
+
+    _data = nullptr;
+    _size = 0;
+}
+
+const unsigned char* MappedFile::data() const
+{
+    return _data;
+}
+
+std::size_t MappedFile::size() const
+{
+    return _size;
+}
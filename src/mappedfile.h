@@ -0,0 +1,34 @@
+#ifndef MAPPEDFILE_H
+#define MAPPEDFILE_H
+
+#include <cstddef>
+#include <string>
+
+/* Read-only memory mapping of a whole file. The mapping is released when
+ * the instance is destroyed, therefore instances cannot be copied. */
+class MappedFile {
+public:
+    MappedFile();
+    ~MappedFile();
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    bool open(const std::string& fileName);
+    void close();
+
+    /* Getters */
+    const unsigned char* data() const;
+    std::size_t size() const;
+
+private:
+    const unsigned char* _data = nullptr;
+    std::size_t _size = 0;
+
+#ifdef _WIN32
+    void* _file = nullptr;
+    void* _mapping = nullptr;
+#endif
+};
+
+#endif // MAPPEDFILE_H
@@ -4,7 +4,7 @@
 #define STB_IMAGE_IMPLEMENTATION
 #include "../stb_image.h"
 
-NaiveRenderer::NaiveRenderer(Heightmap heightmap, float xzScale, float yScale)
+NaiveRenderer::NaiveRenderer(Heightmap heightmap, float xzScale, float yScale, JobSystem* jobSystem)
 {
     _shader = Shader("../src/glsl/naiverenderer.vert", "../src/glsl/naiverenderer.frag");
     _heightmap = heightmap;
@@ -13,6 +13,7 @@ NaiveRenderer::NaiveRenderer(Heightmap heightmap, float xzScale, float yScale)
     _height = heightmap.height();
     _width = heightmap.width();
     _hasTexture = false;
+    _jobSystem = jobSystem;
 }
 
 NaiveRenderer::~NaiveRenderer()
@@ -20,8 +21,10 @@ NaiveRenderer::~NaiveRenderer()
     std::cout << "Naive terrain destroyed" << std::endl;
 }
 
-void NaiveRenderer::render(Camera camera)
+void NaiveRenderer::render(Camera& camera)
 {
+    shader().use();
+
     glEnable(GL_PRIMITIVE_RESTART);
     glPrimitiveRestartIndex(RESTART_INDEX);
 
@@ -35,6 +38,8 @@ void NaiveRenderer::render(Camera camera)
 
     glBindVertexArray(_vao);
     glDrawElements(GL_TRIANGLE_STRIP, _nIndices * sizeof(unsigned int), GL_UNSIGNED_INT, (void*)0);
+    _visibleBlocks = 1;
+    _drawCalls = 1;
     AtlodUtil::checkGlError("Naive algorithm render failed");
 }
 
@@ -108,7 +113,10 @@ void NaiveRenderer::loadBuffers()
     AtlodUtil::checkGlError("Naive algorithm load failed");
 }
 
-void NaiveRenderer::calculateNormal(unsigned j, unsigned int i, bool isBottomRight)
+/* Normal of one of the two triangles of the quad at (j, i): the top left
+ * one spans (j, i), (j + 1, i) and (j, i + 1), the bottom right one
+ * (j + 1, i + 1), (j, i + 1) and (j + 1, i) */
+glm::vec3 NaiveRenderer::triangleNormal(unsigned j, unsigned int i, bool isBottomRight)
 {
     int signedHeight = (int)_height;
     int signedWidth = (int)_width;
@@ -140,37 +148,53 @@ void NaiveRenderer::calculateNormal(unsigned j, unsigned int i, bool isBottomRig
     glm::vec3 a = v1 - v0;
     glm::vec3 b = v2 - v0;
 
-    glm::vec3 normal = glm::cross(b, a);
-
-    _normals[i * _width + j] += normal;
-    _normals[i * _width + j + offset] += normal;
-    _normals[(i + offset) * _width + j] += normal;
+    return glm::cross(b, a);
 }
 
 /* This normal calculating method is based on SLProject's calcNormals() method.
- * SLProject is developed at the Bern University of Applied Sciences. */
+ * SLProject is developed at the Bern University of Applied Sciences.
+ *
+ * Instead of adding the normal of every triangle to its three corners,
+ * every vertex sums up the normals of the (up to six) triangles it is a
+ * corner of. So every vertex only writes its own normal, and the rows are
+ * calculated in parallel on the job system. The tile cache of tiled
+ * heightmaps is not thread-safe, so those are done on a single thread. */
 void NaiveRenderer::loadNormals()
 {
-    _normals.resize(_height * _width);
-
-    for (unsigned int i = 0; i < _height - 1; i++) {
-        for (unsigned int j = 0; j < _width - 1; j++) {
-            _normals.push_back(glm::vec3(0.0f));
-        }
-    }
-
-    /* Load normals for every vertex */
-    for (unsigned int i = 0; i < _height - 1; i++) {
-        for (unsigned int j = 0; j < _width - 1; j++) {
-            calculateNormal(j, i, false);
-            calculateNormal(j, i, true);
+    _normals.assign((std::size_t)_height * _width, glm::vec3(0.0f));
+
+    auto loadRows = [&](unsigned, unsigned begin, unsigned end) {
+        for (unsigned int i = begin; i < end; i++) {
+            for (unsigned int j = 0; j < _width; j++) {
+                bool right = j < _width - 1, bottom = i < _height - 1;
+                glm::vec3 normal(0.0f);
+
+                /* Top left triangles of the quads (j, i), (j - 1, i) and (j, i - 1) */
+                if (right && bottom)
+                    normal += triangleNormal(j, i, false);
+                if (j > 0 && bottom)
+                    normal += triangleNormal(j - 1, i, false);
+                if (right && i > 0)
+                    normal += triangleNormal(j, i - 1, false);
+
+                /* Bottom right triangles of the quads (j - 1, i - 1), (j, i - 1) and (j - 1, i) */
+                if (j > 0 && i > 0)
+                    normal += triangleNormal(j - 1, i - 1, true);
+                if (right && i > 0)
+                    normal += triangleNormal(j, i - 1, true);
+                if (j > 0 && bottom)
+                    normal += triangleNormal(j - 1, i, true);
+
+                /* Normalize each summed up corner vector */
+                _normals[(std::size_t)i * _width + j] = glm::normalize(normal);
+            }
         }
-    }
+    };
 
-    /* Normalize each summed up corner vector */
-    for (int i = 0; i < _normals.size(); i++) {
-        _normals[i] = glm::normalize(_normals[i]);
-    }
+    if (_jobSystem && !_heightmap.tiled())
+        _jobSystem->parallelFor(_height, 16, loadRows);
+    else
+        loadRows(0, 0, _height);
 }
 
 void NaiveRenderer::unloadBuffers()
@@ -2,6 +2,7 @@
 #define NAIVERENDERER_H
 
 #include "../camera.h"
+#include "../jobsystem.h"
 #include "../terrain.h"
 
 #include <GL/glew.h>
@@ -9,17 +10,20 @@
 
 #include "../heightmap.h"
 
+#include <vector>
+
 class NaiveRenderer : public Terrain {
 public:
-    NaiveRenderer(Heightmap heightmap, float xzScale = 1.0f, float yScale = 1.0f);
+    /* The normals are calculated on the job system (not owned), if given */
+    NaiveRenderer(Heightmap heightmap, float xzScale = 1.0f, float yScale = 1.0f, JobSystem* jobSystem = nullptr);
     ~NaiveRenderer();
     void loadBuffers();
-    void render(Camera camera);
+    void render(Camera& camera);
     void unloadBuffers();
 
 private:
     void loadNormals();
-    void calculateNormal(unsigned j, unsigned int i, bool isBottomRight);
+    glm::vec3 triangleNormal(unsigned j, unsigned int i, bool isBottomRight);
 
     std::vector<float> _vertices;
     std::vector<unsigned int> _indices;
@@ -27,6 +31,8 @@ private:
 
     unsigned int _vao, _vbo, _ebo;
     unsigned int _nIndices;
+
+    JobSystem* _jobSystem;
 };
 
 #endif // NAIVERENDERER_H
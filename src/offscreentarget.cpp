@@ -0,0 +1,81 @@
+#include "offscreentarget.h"
+#include "atlodutil.h"
+
+#include <GL/glew.h>
+
+#include <fstream>
+#include <iostream>
+
+void OffscreenTarget::loadBuffers(unsigned width, unsigned height)
+{
+    _width = width;
+    _height = height;
+
+    glGenRenderbuffers(1, &_colorRbo);
+    glBindRenderbuffer(GL_RENDERBUFFER, _colorRbo);
+    glRenderbufferStorage(GL_RENDERBUFFER, GL_RGBA8, width, height);
+
+    glGenRenderbuffers(1, &_depthRbo);
+    glBindRenderbuffer(GL_RENDERBUFFER, _depthRbo);
+    glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH_COMPONENT24, width, height);
+
+    glGenFramebuffers(1, &_fbo);
+    glBindFramebuffer(GL_FRAMEBUFFER, _fbo);
+    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, _colorRbo);
+    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_RENDERBUFFER, _depthRbo);
+
+    if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE) {
+        std::cerr << "Error: offscreen framebuffer of size " << width << " x " << height << " is incomplete" << std::endl;
+        std::exit(1);
+    }
+
+    glViewport(0, 0, width, height);
+    AtlodUtil::checkGlError("Offscreen framebuffer creation failed");
+}
+
+void OffscreenTarget::unloadBuffers()
+{
+    if (_fbo == 0)
+        return;
+
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    glDeleteFramebuffers(1, &_fbo);
+    glDeleteRenderbuffers(1, &_colorRbo);
+    glDeleteRenderbuffers(1, &_depthRbo);
+}
+
+void OffscreenTarget::bind()
+{
+    glBindFramebuffer(GL_FRAMEBUFFER, _fbo);
+}
+
+unsigned OffscreenTarget::width()
+{
+    return _width;
+}
+
+unsigned OffscreenTarget::height()
+{
+    return _height;
+}
+
+bool saveFramebuffer(const std::string& fileName, unsigned width, unsigned height)
+{
+    std::vector<unsigned char> pixels((std::size_t)width * height * 3);
+
+    glPixelStorei(GL_PACK_ALIGNMENT, 1);
+    glReadPixels(0, 0, width, height, GL_RGB, GL_UNSIGNED_BYTE, pixels.data());
+
+    std::ofstream file(fileName, std::ios::binary);
+    if (!file)
+        return false;
+
+    file << "P6\n"
+         << width << " " << height << "\n255\n";
+
+    /* OpenGL stores the bottom row first, PPM the top row */
+    for (unsigned i = height; i > 0; i--)
+        file.write((const char*)&pixels[(std::size_t)(i - 1) * width * 3], (std::streamsize)width * 3);
+
+    return (bool)file;
+}
@@ -0,0 +1,32 @@
+#ifndef OFFSCREENTARGET_H
+#define OFFSCREENTARGET_H
+
+#include <string>
+#include <vector>
+
+/* A framebuffer object with a color and a depth renderbuffer, which the
+ * frames are rendered into in headless mode instead of the default
+ * framebuffer of a (visible) window. */
+class OffscreenTarget {
+public:
+    void loadBuffers(unsigned width, unsigned height);
+    void unloadBuffers();
+
+    /* Makes the framebuffer the target of all following draws */
+    void bind();
+
+    /* Getters */
+    unsigned width();
+    unsigned height();
+
+private:
+    unsigned _fbo = 0;
+    unsigned _colorRbo = 0, _depthRbo = 0;
+    unsigned _width = 0, _height = 0;
+};
+
+/* Reads back the currently bound framebuffer and writes it as a binary
+ * PPM image, returns false if the file could not be written */
+bool saveFramebuffer(const std::string& fileName, unsigned width, unsigned height);
+
+#endif // OFFSCREENTARGET_H
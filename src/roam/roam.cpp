@@ -0,0 +1,193 @@
+#include "roam.h"
+#include "../atlodutil.h"
+
+#include <algorithm>
+#include <chrono>
+
+Roam::Roam(Heightmap heightmap, float xzScale, float yScale, unsigned maxTriangleBudget)
+{
+    std::cout << "Initialize ROAM" << std::endl;
+
+    _xzScale = xzScale;
+    _yScale = yScale;
+    _heightmap = heightmap;
+    _width = heightmap.width();
+    _height = heightmap.height();
+    _shader = Shader("../src/glsl/roam.vert", "../src/glsl/geomipmapping.frag");
+
+    _planner = RoamPlanner(maxTriangleBudget, _width, _height, _xzScale);
+
+    loadHeights();
+
+    std::cout << "ROAM with a budget of " << _planner.maxTriangleBudget() << " triangles ("
+              << _planner.memoryBytes() / 1024 << " KB)" << std::endl;
+
+    /* Set uniforms */
+    shader().use();
+    shader().setInt("texture1", 0);
+    shader().setInt("heightmapTexture", 1);
+    shader().setFloat("textureWidth", _heightmap.width());
+    shader().setFloat("textureHeight", _heightmap.height());
+}
+
+Roam::~Roam()
+{
+    std::cout << "ROAM terrain destroyed" << std::endl;
+}
+
+void Roam::render(Camera& camera)
+{
+    shader().use();
+    shader().setFloat("yScale", _yScale);
+
+    if (!_freezeCamera)
+        _lastCamera = camera;
+
+    _planner.update(_lastCamera, _yScale, _vertices);
+    _visibleBlocks = _vertices.size() / 3;
+    _drawCalls = _vertices.empty() ? 0 : 1;
+
+    glBindVertexArray(_vao);
+
+    /* Apply overlay texture (if existent) */
+    if (_hasTexture) {
+        glActiveTexture(GL_TEXTURE0);
+        glBindTexture(GL_TEXTURE_2D, _textureId);
+        shader().setFloat("doTexture", 1.0f);
+    } else
+        shader().setFloat("doTexture", 0.0f);
+
+    /* Apply heightmap texture */
+    glActiveTexture(GL_TEXTURE1);
+    glBindTexture(GL_TEXTURE_2D, _heightmap.heightmapTextureId());
+
+    if (_vertices.empty())
+        return;
+
+    glBindBuffer(GL_ARRAY_BUFFER, _vbo);
+    glBufferData(GL_ARRAY_BUFFER, _vertices.size() * sizeof(RoamVertex), &_vertices[0], GL_STREAM_DRAW);
+
+    glDrawArrays(GL_TRIANGLES, 0, _vertices.size());
+
+    AtlodUtil::checkGlError("ROAM render failed");
+}
+
+void Roam::loadHeights()
+{
+    auto start = std::chrono::steady_clock::now();
+    unsigned tileSize = RoamPlanner::HEIGHT_TILE_SIZE;
+
+    if (!_heightmap.tiled()) {
+        _planner.loadHeights(_heightmap.data(), _heightmap.width());
+    } else {
+        /* Only read the rows covered by a single row of height tiles at a time */
+        std::vector<unsigned short> strip((std::size_t)_heightmap.width() * (tileSize + 1));
+        unsigned nRows = (_heightmap.height() - 1 + tileSize - 1) / tileSize;
+
+        for (unsigned i = 0; i < nRows; i++) {
+            unsigned rows = std::min(tileSize + 1, _heightmap.height() - i * tileSize);
+            _heightmap.readRows(i * tileSize, rows, strip.data());
+            _planner.loadHeightRow(i, strip.data(), _heightmap.width());
+        }
+        _planner.endLoadHeights();
+    }
+
+    std::cout << "Loaded ROAM height bounds in " << AtlodUtil::millisecondsSince(start) << " ms" << std::endl;
+}
+
+/* The vertices change every frame, so there is only a stream buffer */
+void Roam::loadBuffers()
+{
+    glGenVertexArrays(1, &_vao);
+    glBindVertexArray(_vao);
+
+    glGenBuffers(1, &_vbo);
+    glBindBuffer(GL_ARRAY_BUFFER, _vbo);
+
+    /* Position attribute */
+    glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, sizeof(RoamVertex), (void*)0);
+    glEnableVertexAttribArray(0);
+
+    /* Depth attribute */
+    glVertexAttribPointer(1, 1, GL_FLOAT, GL_FALSE, sizeof(RoamVertex), (void*)sizeof(glm::vec2));
+    glEnableVertexAttribArray(1);
+}
+
+void Roam::unloadBuffers()
+{
+    std::cout << "Unloading buffers" << std::endl;
+    glDeleteVertexArrays(1, &_vao);
+    glDeleteBuffers(1, &_vbo);
+
+    AtlodUtil::checkGlError("ROAM deletion failed");
+}
+
+unsigned Roam::maxDepth()
+{
+    return _planner.maxDepth();
+}
+
+unsigned Roam::leafCount()
+{
+    return _planner.leafCount();
+}
+
+unsigned Roam::drawnTriangles()
+{
+    return _vertices.size() / 3;
+}
+
+unsigned Roam::maxTriangleBudget()
+{
+    return _planner.maxTriangleBudget();
+}
+
+unsigned Roam::splits()
+{
+    return _planner.splits();
+}
+
+unsigned Roam::merges()
+{
+    return _planner.merges();
+}
+
+std::size_t Roam::memoryBytes()
+{
+    return _planner.memoryBytes();
+}
+
+bool Roam::freezeCamera()
+{
+    return _freezeCamera;
+}
+
+void Roam::triangleBudget(unsigned triangleBudget)
+{
+    _planner.triangleBudget(triangleBudget);
+}
+
+void Roam::pixelError(float pixelError)
+{
+    _planner.pixelError(pixelError);
+}
+
+void Roam::maxOperations(unsigned maxOperations)
+{
+    _planner.maxOperations(maxOperations);
+}
+
+void Roam::viewportHeight(unsigned viewportHeight)
+{
+    _planner.viewportHeight(viewportHeight);
+}
+
+void Roam::freezeCamera(bool freezeCamera)
+{
+    _freezeCamera = freezeCamera;
+}
+
+void Roam::frustumCullingActive(bool frustumCullingActive)
+{
+    _planner.frustumCullingActive(frustumCullingActive);
+}
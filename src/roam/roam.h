@@ -0,0 +1,67 @@
+#ifndef ROAM_H
+#define ROAM_H
+
+#include "../camera.h"
+#include "../terrain.h"
+#include "roamplanner.h"
+
+#include <GL/glew.h>
+#include <GLFW/glfw3.h>
+
+#include <vector>
+
+/* Real-time optimally adapting meshes (M. Duchaineau et al., 1997).
+ *
+ * The RoamPlanner adapts a triangle bintree every frame with its split and
+ * merge queues, so that the number of triangles stays at the triangle
+ * budget independent of the terrain size. The visible triangles are
+ * streamed to the GPU every frame, and their heights are sampled from the
+ * heightmap texture. */
+class Roam : public Terrain {
+    static const unsigned DEFAULT_TRIANGLE_BUDGET = 65536;
+
+public:
+    /* The triangle budget can be lowered later, but not raised above this
+     * budget (it determines the size of the triangle pool) */
+    Roam(Heightmap heightmap, float xzScale = 1.0f, float yScale = 1.0f, unsigned maxTriangleBudget = DEFAULT_TRIANGLE_BUDGET);
+    ~Roam();
+
+    /* Overriden virtual methods */
+    void render(Camera& camera);
+    void loadBuffers();
+    void unloadBuffers();
+
+    /* Getters */
+    unsigned maxDepth();
+    unsigned leafCount();
+    unsigned drawnTriangles();
+    unsigned maxTriangleBudget();
+    unsigned splits();
+    unsigned merges();
+    std::size_t memoryBytes();
+    bool freezeCamera();
+
+    /* Setters */
+    void triangleBudget(unsigned triangleBudget);
+    void pixelError(float pixelError);
+    void maxOperations(unsigned maxOperations);
+    void viewportHeight(unsigned viewportHeight);
+    void freezeCamera(bool freezeCamera);
+    void frustumCullingActive(bool frustumCullingActive);
+
+private:
+    void loadHeights();
+
+    RoamPlanner _planner;
+
+    /* Vertices of the visible triangles, reused every frame */
+    std::vector<RoamVertex> _vertices;
+
+    Camera _lastCamera; /* Camera of the last unfrozen frame */
+
+    bool _freezeCamera = false;
+
+    unsigned _vao, _vbo;
+};
+
+#endif // ROAM_H
@@ -0,0 +1,494 @@
+#include "roamplanner.h"
+
+#include <algorithm>
+#include <cmath>
+
+RoamPlanner::RoamPlanner()
+    : _terrainWidth(0)
+    , _terrainHeight(0)
+    , _xzScale(1.0f)
+    , _maxDepth(0)
+    , _maxTriangleBudget(0)
+    , _triangleBudget(0)
+{
+}
+
+RoamPlanner::RoamPlanner(unsigned maxTriangleBudget, unsigned terrainWidth, unsigned terrainHeight, float xzScale)
+    : _heightBounds(terrainWidth, terrainHeight, HEIGHT_TILE_SIZE)
+    , _terrainWidth(terrainWidth)
+    , _terrainHeight(terrainHeight)
+    , _xzScale(xzScale)
+    , _maxTriangleBudget(std::max(maxTriangleBudget, 2u))
+    , _triangleBudget(_maxTriangleBudget)
+{
+    /* The legs of the triangles of depth 2d are size / 2^d samples long,
+     * stop once they are one sample long */
+    unsigned size = std::max(terrainWidth, terrainHeight) - 1;
+    unsigned log2Size = 0;
+    while ((1u << log2Size) < size)
+        log2Size++;
+
+    _maxDepth = 2 * log2Size;
+
+    /* A bintree with n leaves has 2n - 2 triangles, plus room for the
+     * forced splits exceeding the budget until the next merges */
+    unsigned nPairs = _maxTriangleBudget + 4 * (_maxDepth + 2);
+    _triangles.resize(2 * nPairs);
+    _priorities.resize(2 * nPairs);
+    _freePairs.reserve(nPairs);
+
+    _splitQueue = RoamQueue(_triangles.size(), true);
+    _mergeQueue = RoamQueue(_triangles.size(), false);
+
+    reset();
+}
+
+void RoamPlanner::loadHeights(const unsigned short* heights, unsigned rowLength)
+{
+    _heightBounds.loadHeights(heights, rowLength);
+    reset();
+}
+
+void RoamPlanner::loadHeightRow(unsigned row, const unsigned short* strip, unsigned rowLength)
+{
+    _heightBounds.loadRow(row, strip, rowLength);
+}
+
+void RoamPlanner::endLoadHeights()
+{
+    _heightBounds.endLoadHeights();
+    reset();
+}
+
+void RoamPlanner::update(Camera& camera, float yScale, std::vector<RoamVertex>& vertices)
+{
+    _camera = &camera;
+    _cameraPosition = camera.position();
+    _selectYScale = yScale;
+    _pixelsPerUnit = _viewportHeight / (2.0f * std::tan(glm::radians(camera.zoom()) / 2.0f));
+    _splits = 0;
+    _merges = 0;
+
+    /* The triangulation and the queues are kept from the last frame, only
+     * the priorities change with the camera. They are needed for all leaves
+     * and all triangles of mergeable diamonds (whose children are leaves),
+     * which are found by walking the pool in memory order instead of
+     * following the scattered tree links. */
+    for (unsigned pair = 0; pair < _triangles.size(); pair += 2) {
+        if (!_triangles[pair].allocated)
+            continue;
+
+        bool leftLeaf = isLeaf(pair), rightLeaf = isLeaf(pair + 1);
+        if (leftLeaf)
+            updatePriority(pair);
+        if (rightLeaf)
+            updatePriority(pair + 1);
+        if (leftLeaf && rightLeaf && _triangles[pair].parent != NONE)
+            updatePriority(_triangles[pair].parent);
+    }
+
+    for (unsigned i = 0; i < _splitQueue.size(); i++)
+        _splitQueue.setPriorityAt(i, _priorities[_splitQueue.itemAt(i)]);
+    _splitQueue.rebuild();
+
+    for (unsigned i = 0; i < _mergeQueue.size(); i++)
+        _mergeQueue.setPriorityAt(i, diamondPriority(_mergeQueue.itemAt(i)));
+    _mergeQueue.rebuild();
+
+    for (unsigned operations = 0; operations < _maxOperations; operations++) {
+        /* Too many triangles (after forced splits, or a lowered budget) */
+        if (_leafCount > _triangleBudget) {
+            if (_mergeQueue.empty())
+                break;
+
+            merge(_mergeQueue.top());
+            continue;
+        }
+
+        /* Diamonds which are accurate enough without their children */
+        if (!_mergeQueue.empty() && _mergeQueue.topPriority() < _pixelError) {
+            merge(_mergeQueue.top());
+            continue;
+        }
+
+        if (_splitQueue.empty() || _splitQueue.topPriority() <= _pixelError)
+            break;
+
+        /* If the split (including the forced splits) does not fit into the
+         * budget, the most important triangle can only be split by merging
+         * the least important diamonds first. Going over the budget instead
+         * would merge the new diamond again right away. */
+        unsigned t = _splitQueue.top();
+
+        if (_leafCount + splitCost(t) > _triangleBudget) {
+            if (_mergeQueue.empty() || _mergeQueue.topPriority() >= _splitQueue.topPriority())
+                break;
+
+            merge(_mergeQueue.top());
+            continue;
+        }
+
+        /* A split forces at most two splits on every coarser depth */
+        if (_freePairs.size() < 2u * (_triangles[t].depth + 2u))
+            break;
+
+        split(t);
+    }
+
+    /* Collect the visible leaves, all of which got their visibility from
+     * updatePriority() this frame */
+    vertices.clear();
+    for (const Triangle& triangle : _triangles) {
+        if (!triangle.allocated || triangle.leftChild != NONE || !triangle.visible)
+            continue;
+
+        float depth = (float)triangle.depth;
+        vertices.push_back({ triangle.apex, depth });
+        vertices.push_back({ triangle.left, depth });
+        vertices.push_back({ triangle.right, depth });
+    }
+
+    _camera = nullptr;
+}
+
+void RoamPlanner::reset()
+{
+    _splitQueue.clear();
+    _mergeQueue.clear();
+
+    for (Triangle& triangle : _triangles)
+        triangle.allocated = false;
+
+    /* Pair 0 holds the two roots */
+    _freePairs.clear();
+    for (unsigned pair = _triangles.size() / 2; pair-- > 1;)
+        _freePairs.push_back(2 * pair);
+
+    /* Both roots have their base on the diagonal, and are oriented
+     * clockwise in (x, z), i.e. counterclockwise when seen from above */
+    float w = (float)(_terrainWidth - 1), h = (float)(_terrainHeight - 1);
+    initTriangle(0, glm::vec2(w, 0.0f), glm::vec2(0.0f, 0.0f), glm::vec2(w, h), NONE, 0);
+    initTriangle(1, glm::vec2(0.0f, h), glm::vec2(w, h), glm::vec2(0.0f, 0.0f), NONE, 0);
+    _triangles[0].baseNeighbor = 1;
+    _triangles[1].baseNeighbor = 0;
+
+    _leafCount = 2;
+    _splitQueue.insert(0, 0.0f);
+    _splitQueue.insert(1, 0.0f);
+}
+
+/* Splits a leaf and its base neighbor, after first splitting the base
+ * neighbor's parent if the base neighbor is coarser */
+void RoamPlanner::split(unsigned t)
+{
+    unsigned base = _triangles[t].baseNeighbor;
+
+    if (base != NONE && _triangles[base].baseNeighbor != t) {
+        split(base);
+        base = _triangles[t].baseNeighbor;
+    }
+
+    splitOne(t);
+
+    if (base != NONE) {
+        splitOne(base);
+
+        /* Link the children across the former base */
+        Triangle& triangle = _triangles[t];
+        Triangle& baseTriangle = _triangles[base];
+        _triangles[triangle.leftChild].rightNeighbor = baseTriangle.leftChild + 1;
+        _triangles[triangle.leftChild + 1].leftNeighbor = baseTriangle.leftChild;
+        _triangles[baseTriangle.leftChild].rightNeighbor = triangle.leftChild + 1;
+        _triangles[baseTriangle.leftChild + 1].leftNeighbor = triangle.leftChild;
+    }
+
+    _mergeQueue.insert(diamondKey(t), diamondPriority(diamondKey(t)));
+}
+
+/* Number of leaves added by split() */
+unsigned RoamPlanner::splitCost(unsigned t) const
+{
+    unsigned cost = 0;
+
+    while (true) {
+        unsigned base = _triangles[t].baseNeighbor;
+
+        if (base == NONE)
+            return cost + 1;
+        if (_triangles[base].baseNeighbor == t)
+            return cost + 2;
+
+        /* The coarser base is split first, then t and its new base */
+        cost += 2;
+        t = base;
+    }
+}
+
+/* Splits a single leaf, the links across its base are set by split() */
+void RoamPlanner::splitOne(unsigned t)
+{
+    unsigned leftChild = _freePairs.back();
+    unsigned rightChild = leftChild + 1;
+    _freePairs.pop_back();
+
+    Triangle& triangle = _triangles[t];
+    glm::vec2 center = (triangle.left + triangle.right) * 0.5f;
+
+    initTriangle(leftChild, center, triangle.apex, triangle.left, t, triangle.depth + 1);
+    initTriangle(rightChild, center, triangle.right, triangle.apex, t, triangle.depth + 1);
+
+    _triangles[leftChild].baseNeighbor = triangle.leftNeighbor;
+    _triangles[leftChild].leftNeighbor = rightChild;
+    _triangles[rightChild].baseNeighbor = triangle.rightNeighbor;
+    _triangles[rightChild].rightNeighbor = leftChild;
+
+    if (triangle.leftNeighbor != NONE)
+        replaceNeighbor(triangle.leftNeighbor, t, leftChild);
+    if (triangle.rightNeighbor != NONE)
+        replaceNeighbor(triangle.rightNeighbor, t, rightChild);
+
+    triangle.leftChild = leftChild;
+
+    /* The triangle is no longer a leaf, and the diamond of its parent is
+     * no longer mergeable */
+    _splitQueue.remove(t);
+    if (triangle.parent != NONE)
+        _mergeQueue.remove(diamondKey(triangle.parent));
+
+    /* Also at the maximum depth for the visibility */
+    updatePriority(leftChild);
+    updatePriority(rightChild);
+
+    if (triangle.depth + 1u < _maxDepth) {
+        _splitQueue.insert(leftChild, _priorities[leftChild]);
+        _splitQueue.insert(rightChild, _priorities[rightChild]);
+    }
+
+    _leafCount++;
+    _splits++;
+}
+
+/* Merges both triangles of a mergeable diamond */
+void RoamPlanner::merge(unsigned diamond)
+{
+    _mergeQueue.remove(diamond);
+
+    unsigned base = _triangles[diamond].baseNeighbor;
+
+    mergeOne(diamond);
+    if (base != NONE)
+        mergeOne(base);
+
+    /* The diamonds of the parents may have become mergeable */
+    for (unsigned t : { diamond, base }) {
+        if (t == NONE)
+            continue;
+
+        unsigned parent = _triangles[t].parent;
+        if (parent == NONE || !isMergeable(parent) || _mergeQueue.contains(diamondKey(parent)))
+            continue;
+
+        /* Split triangles only have an up to date priority if their
+         * children were leaves at the start of the frame */
+        updatePriority(parent);
+        if (_triangles[parent].baseNeighbor != NONE)
+            updatePriority(_triangles[parent].baseNeighbor);
+
+        _mergeQueue.insert(diamondKey(parent), diamondPriority(diamondKey(parent)));
+    }
+}
+
+/* Merges the two leaf children of a triangle, the links across its base
+ * are still those from before the split */
+void RoamPlanner::mergeOne(unsigned t)
+{
+    Triangle& triangle = _triangles[t];
+    unsigned leftChild = triangle.leftChild;
+    unsigned rightChild = leftChild + 1;
+
+    triangle.leftNeighbor = _triangles[leftChild].baseNeighbor;
+    triangle.rightNeighbor = _triangles[rightChild].baseNeighbor;
+
+    if (triangle.leftNeighbor != NONE)
+        replaceNeighbor(triangle.leftNeighbor, leftChild, t);
+    if (triangle.rightNeighbor != NONE)
+        replaceNeighbor(triangle.rightNeighbor, rightChild, t);
+
+    _splitQueue.remove(leftChild);
+    _splitQueue.remove(rightChild);
+    _triangles[leftChild].allocated = false;
+    _triangles[rightChild].allocated = false;
+    _freePairs.push_back(leftChild);
+    triangle.leftChild = NONE;
+
+    _splitQueue.insert(t, updatePriority(t));
+
+    _leafCount--;
+    _merges++;
+}
+
+void RoamPlanner::replaceNeighbor(unsigned t, unsigned oldNeighbor, unsigned newNeighbor)
+{
+    Triangle& triangle = _triangles[t];
+
+    if (triangle.leftNeighbor == oldNeighbor)
+        triangle.leftNeighbor = newNeighbor;
+    else if (triangle.rightNeighbor == oldNeighbor)
+        triangle.rightNeighbor = newNeighbor;
+    else if (triangle.baseNeighbor == oldNeighbor)
+        triangle.baseNeighbor = newNeighbor;
+}
+
+bool RoamPlanner::isLeaf(unsigned t) const
+{
+    return _triangles[t].leftChild == NONE;
+}
+
+/* Whether the triangle and its base neighbor are split into leaves */
+bool RoamPlanner::isMergeable(unsigned t) const
+{
+    const Triangle& triangle = _triangles[t];
+
+    if (isLeaf(t) || !isLeaf(triangle.leftChild) || !isLeaf(triangle.leftChild + 1))
+        return false;
+
+    unsigned base = triangle.baseNeighbor;
+    if (base == NONE)
+        return true;
+
+    return _triangles[base].baseNeighbor == t && !isLeaf(base)
+        && isLeaf(_triangles[base].leftChild) && isLeaf(_triangles[base].leftChild + 1);
+}
+
+/* A diamond is identified by the lower index of its two triangles */
+unsigned RoamPlanner::diamondKey(unsigned t) const
+{
+    return std::min(t, _triangles[t].baseNeighbor);
+}
+
+void RoamPlanner::initTriangle(unsigned t, glm::vec2 apex, glm::vec2 left, glm::vec2 right, unsigned parent, unsigned depth)
+{
+    Triangle& triangle = _triangles[t];
+    triangle.apex = apex;
+    triangle.left = left;
+    triangle.right = right;
+    triangle.parent = parent;
+    triangle.leftChild = NONE;
+    triangle.leftNeighbor = NONE;
+    triangle.rightNeighbor = NONE;
+    triangle.baseNeighbor = NONE;
+    triangle.depth = depth;
+    triangle.allocated = true;
+    triangle.visible = true;
+
+    glm::vec2 minimum = glm::min(glm::min(apex, left), right);
+    glm::vec2 maximum = glm::max(glm::max(apex, left), right);
+    _heightBounds.bounds(minimum.x, minimum.y, maximum.x, maximum.y, triangle.minHeight, triangle.maxHeight);
+
+    float halfWidth = _terrainWidth / 2.0f, halfHeight = _terrainHeight / 2.0f;
+    triangle.minX = (minimum.x - halfWidth) * _xzScale;
+    triangle.minZ = (minimum.y - halfHeight) * _xzScale;
+    triangle.maxX = (maximum.x - halfWidth) * _xzScale;
+    triangle.maxZ = (maximum.y - halfHeight) * _xzScale;
+}
+
+/* World space AABB of a triangle */
+void RoamPlanner::bounds(const Triangle& triangle, glm::vec3& p1, glm::vec3& p2) const
+{
+    p1 = glm::vec3(triangle.minX, triangle.minHeight * _selectYScale, triangle.minZ);
+    p2 = glm::vec3(triangle.maxX, triangle.maxHeight * _selectYScale, triangle.maxZ);
+}
+
+/* Height range of the triangle projected at its closest distance to the
+ * camera, 0 outside the view-frustum (so those triangles are merged first
+ * and never split). Stores the priority and the visibility of the
+ * triangle for the current frame. */
+float RoamPlanner::updatePriority(unsigned t)
+{
+    Triangle& triangle = _triangles[t];
+
+    glm::vec3 p1, p2;
+    bounds(triangle, p1, p2);
+
+    triangle.visible = !_frustumCullingActive || _camera->intersectViewFrustum(p1, p2) != FrustumIntersection::OUTSIDE;
+
+    if (!triangle.visible)
+        return _priorities[t] = 0.0f;
+
+    glm::vec3 closest = glm::clamp(_cameraPosition, p1, p2) - _cameraPosition;
+    float distance = std::max(std::sqrt(glm::dot(closest, closest)), 1e-3f);
+
+    return _priorities[t] = (p2.y - p1.y) * _pixelsPerUnit / distance;
+}
+
+/* From the stored priorities of the two triangles */
+float RoamPlanner::diamondPriority(unsigned diamond) const
+{
+    unsigned base = _triangles[diamond].baseNeighbor;
+    float diamondPriority = _priorities[diamond];
+
+    if (base != NONE)
+        diamondPriority = std::max(diamondPriority, _priorities[base]);
+
+    return diamondPriority;
+}
+
+unsigned RoamPlanner::leafCount() const
+{
+    return _leafCount;
+}
+
+unsigned RoamPlanner::maxDepth() const
+{
+    return _maxDepth;
+}
+
+unsigned RoamPlanner::maxTriangleBudget() const
+{
+    return _maxTriangleBudget;
+}
+
+unsigned RoamPlanner::triangleBudget() const
+{
+    return _triangleBudget;
+}
+
+unsigned RoamPlanner::splits() const
+{
+    return _splits;
+}
+
+unsigned RoamPlanner::merges() const
+{
+    return _merges;
+}
+
+std::size_t RoamPlanner::memoryBytes() const
+{
+    return _triangles.size() * (sizeof(Triangle) + sizeof(float) + 2 * (sizeof(unsigned) + sizeof(float) + sizeof(unsigned)));
+}
+
+void RoamPlanner::triangleBudget(unsigned triangleBudget)
+{
+    _triangleBudget = std::min(std::max(triangleBudget, 2u), _maxTriangleBudget);
+}
+
+void RoamPlanner::pixelError(float pixelError)
+{
+    _pixelError = pixelError;
+}
+
+void RoamPlanner::maxOperations(unsigned maxOperations)
+{
+    _maxOperations = maxOperations;
+}
+
+void RoamPlanner::viewportHeight(unsigned viewportHeight)
+{
+    _viewportHeight = viewportHeight;
+}
+
+void RoamPlanner::frustumCullingActive(bool frustumCullingActive)
+{
+    _frustumCullingActive = frustumCullingActive;
+}
@@ -0,0 +1,149 @@
+#ifndef ROAMPLANNER_H
+#define ROAMPLANNER_H
+
+#include "../camera.h"
+#include "../heightbounds.h"
+#include "roamqueue.h"
+
+#include <vector>
+
+/* A vertex of a drawn triangle, in heightmap coordinates. The depth of the
+ * triangle in the bintree is only used for the wireframe colors. */
+struct RoamVertex {
+    glm::vec2 position;
+    float depth;
+};
+
+/**
+ * @brief The RoamPlanner class
+ *
+ * Real-time optimally adapting meshes (M. Duchaineau et al., 1997). The
+ * terrain is covered by a triangle bintree, starting with the two
+ * triangles of the square, in which every triangle is split at the
+ * midpoint of its hypotenuse (base). The triangulation persists from frame
+ * to frame and is adapted with two priority queues:
+ * - The split queue contains all leaf triangles
+ * - The merge queue contains all mergeable diamonds, i.e. pairs of split
+ *   triangles sharing their base whose four children are leaves
+ * The priority of a triangle is its geometric error projected to the
+ * screen (in pixels), that of a diamond the higher priority of its two
+ * triangles. Every frame, the highest priority triangles are split and
+ * the lowest priority diamonds merged, until the triangle budget is
+ * reached and the highest split priority is below the lowest merge
+ * priority, or until the maximum number of operations per frame.
+ *
+ * Splits are forced onto the base neighbor (recursively, if it is
+ * coarser), so the triangulation never has T-junctions. The geometric
+ * error is bounded conservatively by the height range of the triangle,
+ * looked up in a HeightBounds pyramid.
+ *
+ * The triangles are stored in a pool of fixed size with neighbor links,
+ * so the memory is given by the triangle budget and not by the terrain
+ * size. Like the planners of the other algorithms, this class does not
+ * make any OpenGL calls.
+ */
+class RoamPlanner {
+public:
+    RoamPlanner();
+    RoamPlanner(unsigned maxTriangleBudget, unsigned terrainWidth, unsigned terrainHeight, float xzScale);
+
+    /* Loads the min. and max. heights used for the errors and culling */
+    void loadHeights(const unsigned short* heights, unsigned rowLength);
+
+    /* Same as above, but one row of height tiles at a time (for tiled
+     * heightmaps), see HeightBounds::loadRow() */
+    void loadHeightRow(unsigned row, const unsigned short* strip, unsigned rowLength);
+    void endLoadHeights();
+
+    /* Adapts the triangulation and returns the visible triangles, three
+     * vertices each */
+    void update(Camera& camera, float yScale, std::vector<RoamVertex>& vertices);
+
+    /* Resets the triangulation to the two triangles of the square */
+    void reset();
+
+    static const unsigned HEIGHT_TILE_SIZE = 8;
+
+    /* Getters */
+    unsigned leafCount() const;
+    unsigned maxDepth() const;
+    unsigned maxTriangleBudget() const;
+    unsigned triangleBudget() const;
+    unsigned splits() const;
+    unsigned merges() const;
+    std::size_t memoryBytes() const;
+
+    /* Setters */
+    void triangleBudget(unsigned triangleBudget); /* At most maxTriangleBudget() */
+    void pixelError(float pixelError);
+    void maxOperations(unsigned maxOperations);
+    void viewportHeight(unsigned viewportHeight);
+    void frustumCullingActive(bool frustumCullingActive);
+
+private:
+    static const unsigned NONE = 0xffffffff;
+
+    /* A bintree triangle with its right angle at the apex, and its base
+     * from the left to the right vertex. The neighbors are those across
+     * the edges apex-left, right-apex and the base, they are only kept up
+     * to date for leaves. The children are allocated as a pair, the right
+     * child is leftChild + 1. */
+    struct Triangle {
+        glm::vec2 apex, left, right;
+        float minX, minZ, maxX, maxZ; /* World space AABB on the xz-plane */
+        unsigned parent, leftChild;
+        unsigned leftNeighbor, rightNeighbor, baseNeighbor;
+        unsigned short minHeight, maxHeight;
+        unsigned short depth;
+        bool allocated; /* Pairs on the free list are not */
+        bool visible; /* Of the current frame, see updatePriority() */
+    };
+
+    void split(unsigned t);
+    unsigned splitCost(unsigned t) const;
+    void splitOne(unsigned t);
+    void merge(unsigned diamond);
+    void mergeOne(unsigned t);
+    void replaceNeighbor(unsigned t, unsigned oldNeighbor, unsigned newNeighbor);
+    bool isLeaf(unsigned t) const;
+    bool isMergeable(unsigned t) const;
+    unsigned diamondKey(unsigned t) const;
+    void initTriangle(unsigned t, glm::vec2 apex, glm::vec2 left, glm::vec2 right, unsigned parent, unsigned depth);
+    void bounds(const Triangle& triangle, glm::vec3& p1, glm::vec3& p2) const;
+    float updatePriority(unsigned t);
+    float diamondPriority(unsigned diamond) const;
+
+    HeightBounds _heightBounds;
+
+    /* Triangle pool, pairs of triangles are allocated from the free list */
+    std::vector<Triangle> _triangles;
+    std::vector<unsigned> _freePairs;
+
+    /* Priorities of the current frame by triangle, see update() */
+    std::vector<float> _priorities;
+
+    RoamQueue _splitQueue; /* Leaves, highest priority first */
+    RoamQueue _mergeQueue; /* Mergeable diamonds by diamondKey(), lowest priority first */
+
+    /* Camera state during update() */
+    Camera* _camera = nullptr;
+    glm::vec3 _cameraPosition;
+    float _selectYScale = 1.0f;
+    float _pixelsPerUnit = 1.0f; /* At a distance of 1 */
+
+    unsigned _terrainWidth, _terrainHeight;
+    float _xzScale;
+    unsigned _maxDepth;
+    unsigned _maxTriangleBudget;
+
+    unsigned _triangleBudget;
+    float _pixelError = 1.0f;
+    unsigned _maxOperations = 4096; /* Splits and merges per frame */
+    unsigned _viewportHeight = 720;
+    bool _frustumCullingActive = true;
+
+    unsigned _leafCount = 0;
+    unsigned _splits = 0, _merges = 0; /* Of the last update() */
+};
+
+#endif // ROAMPLANNER_H
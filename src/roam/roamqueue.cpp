@@ -0,0 +1,142 @@
+#include "roamqueue.h"
+
+#include <utility>
+
+RoamQueue::RoamQueue()
+    : _maxFirst(true)
+{
+}
+
+RoamQueue::RoamQueue(unsigned capacity, bool maxFirst)
+    : _positions(capacity, NONE)
+    , _maxFirst(maxFirst)
+{
+    _items.reserve(capacity);
+    _priorities.reserve(capacity);
+}
+
+void RoamQueue::insert(unsigned item, float priority)
+{
+    _positions[item] = _items.size();
+    _items.push_back(item);
+    _priorities.push_back(priority);
+    siftUp(_items.size() - 1);
+}
+
+void RoamQueue::remove(unsigned item)
+{
+    unsigned position = _positions[item];
+    if (position == NONE)
+        return;
+
+    /* Move the last item into the gap, which may have to move up or down */
+    unsigned last = _items.size() - 1;
+    swap(position, last);
+    _positions[item] = NONE;
+    _items.pop_back();
+    _priorities.pop_back();
+
+    if (position < _items.size()) {
+        siftUp(position);
+        siftDown(position);
+    }
+}
+
+bool RoamQueue::contains(unsigned item) const
+{
+    return _positions[item] != NONE;
+}
+
+void RoamQueue::clear()
+{
+    for (unsigned item : _items)
+        _positions[item] = NONE;
+
+    _items.clear();
+    _priorities.clear();
+}
+
+unsigned RoamQueue::itemAt(unsigned position) const
+{
+    return _items[position];
+}
+
+void RoamQueue::setPriorityAt(unsigned position, float priority)
+{
+    _priorities[position] = priority;
+}
+
+void RoamQueue::rebuild()
+{
+    for (unsigned i = _items.size() / 2; i-- > 0;)
+        siftDown(i);
+}
+
+bool RoamQueue::empty() const
+{
+    return _items.empty();
+}
+
+unsigned RoamQueue::size() const
+{
+    return _items.size();
+}
+
+unsigned RoamQueue::top() const
+{
+    return _items[0];
+}
+
+float RoamQueue::topPriority() const
+{
+    return _priorities[0];
+}
+
+/* Whether the item at position i belongs above the item at position j */
+bool RoamQueue::before(unsigned i, unsigned j) const
+{
+    return _maxFirst ? _priorities[i] > _priorities[j] : _priorities[i] < _priorities[j];
+}
+
+void RoamQueue::swap(unsigned i, unsigned j)
+{
+    std::swap(_items[i], _items[j]);
+    std::swap(_priorities[i], _priorities[j]);
+    _positions[_items[i]] = i;
+    _positions[_items[j]] = j;
+}
+
+void RoamQueue::siftUp(unsigned position)
+{
+    while (position > 0) {
+        unsigned parent = (position - 1) / 2;
+
+        if (!before(position, parent))
+            break;
+
+        swap(position, parent);
+        position = parent;
+    }
+}
+
+void RoamQueue::siftDown(unsigned position)
+{
+    unsigned size = _items.size();
+
+    while (true) {
+        unsigned first = position;
+        unsigned left = 2 * position + 1;
+        unsigned right = left + 1;
+
+        if (left < size && before(left, first))
+            first = left;
+        if (right < size && before(right, first))
+            first = right;
+
+        if (first == position)
+            break;
+
+        swap(position, first);
+        position = first;
+    }
+}
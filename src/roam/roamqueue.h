@@ -0,0 +1,60 @@
+#ifndef ROAMQUEUE_H
+#define ROAMQUEUE_H
+
+#include <vector>
+
+/**
+ * @brief The RoamQueue class
+ *
+ * Priority queue of the ROAM split and merge queues, a binary heap of items
+ * (indices below the capacity) which additionally stores the position of
+ * every item, so that arbitrary items can be removed in O(log n).
+ *
+ * Since all priorities change with the camera, they are not updated one by
+ * one: setPriorityAt() changes the priorities in place and rebuild()
+ * restores the heap in O(n) afterwards.
+ */
+class RoamQueue {
+public:
+    RoamQueue();
+
+    /* The item with the highest priority is on top if maxFirst is true,
+     * otherwise the item with the lowest priority */
+    RoamQueue(unsigned capacity, bool maxFirst);
+
+    void insert(unsigned item, float priority);
+    void remove(unsigned item);
+    bool contains(unsigned item) const;
+    void clear();
+
+    /* Access by position in the heap (0 to size() - 1), for updating all
+     * priorities */
+    unsigned itemAt(unsigned position) const;
+    void setPriorityAt(unsigned position, float priority);
+    void rebuild();
+
+    /* Getters */
+    bool empty() const;
+    unsigned size() const;
+    unsigned top() const;
+    float topPriority() const;
+
+private:
+    bool before(unsigned i, unsigned j) const;
+    void swap(unsigned i, unsigned j);
+    void siftUp(unsigned position);
+    void siftDown(unsigned position);
+
+    static const unsigned NONE = 0xffffffff;
+
+    /* The heap, as items and their priorities */
+    std::vector<unsigned> _items;
+    std::vector<float> _priorities;
+
+    /* Position of every item in the heap, NONE if not contained */
+    std::vector<unsigned> _positions;
+
+    bool _maxFirst;
+};
+
+#endif // ROAMQUEUE_H
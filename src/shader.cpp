@@ -1,18 +1,118 @@
 #include "shader.h"
+#include "shadercache.h"
+#include "uniformbuffer.h"
+
+#include <algorithm>
+#include <vector>
+
+std::string Shader::_binaryCacheFolder;
 
 Shader::Shader() { }
 
 Shader::Shader(const char* vertexPath, const char* fragmentPath)
+{
+    load({ { GL_VERTEX_SHADER, vertexPath }, { GL_FRAGMENT_SHADER, fragmentPath } });
+}
+
+Shader::Shader(const char* vertexPath, const char* tessControlPath, const char* tessEvaluationPath, const char* fragmentPath)
+{
+    load({ { GL_VERTEX_SHADER, vertexPath },
+        { GL_TESS_CONTROL_SHADER, tessControlPath },
+        { GL_TESS_EVALUATION_SHADER, tessEvaluationPath },
+        { GL_FRAGMENT_SHADER, fragmentPath } });
+}
+
+Shader::Shader(const char* computePath)
+{
+    load({ { GL_COMPUTE_SHADER, computePath } });
+}
+
+void Shader::load(const std::vector<std::pair<GLenum, const char*>>& stages)
+{
+    std::vector<std::pair<GLenum, std::string>> codes;
+    for (const auto& stage : stages)
+        codes.emplace_back(stage.first, readShaderSource(stage.second));
+
+    _id = glCreateProgram();
+
+    /* Use the program binary of an earlier launch if it is still valid */
+    std::string cacheFileName;
+    ShaderCache::Key cacheKey;
+    if (!_binaryCacheFolder.empty() && ShaderCache::supported()) {
+        cacheKey = ShaderCache::key(codes);
+        cacheFileName = ShaderCache::fileName(_binaryCacheFolder, cacheKey);
+    }
+
+    if (!cacheFileName.empty() && ShaderCache::load(cacheFileName, cacheKey, _id)) {
+        std::cout << "Loaded shader program from " << cacheFileName << std::endl;
+    } else {
+        linkProgram(codes, !cacheFileName.empty());
+
+        if (!cacheFileName.empty() && !ShaderCache::save(cacheFileName, cacheKey, _id))
+            std::cerr << "Warning: could not write shader cache file " << cacheFileName << std::endl;
+    }
+
+    reflectUniforms();
+
+    /* Connect the shared uniform blocks to their buffers */
+    for (unsigned binding = 0; binding < N_UNIFORM_BLOCK_BINDINGS; binding++) {
+        unsigned index = glGetUniformBlockIndex(_id, UNIFORM_BLOCK_NAMES[binding]);
+        if (index != GL_INVALID_INDEX)
+            glUniformBlockBinding(_id, index, binding);
+    }
+}
+
+/* Caches the locations of all active uniforms outside of uniform blocks. An
+ * array is reported once as "name[0]", its elements get consecutive
+ * locations, the name without index refers to the first element as well. */
+void Shader::reflectUniforms()
+{
+    int nUniforms, maxNameLength;
+    glGetProgramiv(_id, GL_ACTIVE_UNIFORMS, &nUniforms);
+    glGetProgramiv(_id, GL_ACTIVE_UNIFORM_MAX_LENGTH, &maxNameLength);
+
+    std::vector<char> nameBuffer(std::max(maxNameLength, 1));
+    _uniformLocations.clear();
+
+    for (int i = 0; i < nUniforms; i++) {
+        int size, length;
+        GLenum type;
+        glGetActiveUniform(_id, i, (GLsizei)nameBuffer.size(), &length, &size, &type, nameBuffer.data());
+
+        std::string name(nameBuffer.data(), length);
+        int location = glGetUniformLocation(_id, name.c_str());
+        if (location < 0)
+            continue;
+
+        _uniformLocations[name] = location;
+
+        std::size_t bracket = name.rfind("[0]");
+        if (bracket == std::string::npos || bracket + 3 != name.size())
+            continue;
+
+        std::string arrayName = name.substr(0, bracket);
+        _uniformLocations[arrayName] = location;
+        for (int element = 1; element < size; element++)
+            _uniformLocations[arrayName + "[" + std::to_string(element) + "]"] = location + element;
+    }
+}
+
+void Shader::linkProgram(const std::vector<std::pair<GLenum, std::string>>& stages, bool retrievable)
 {
     int success;
     char info[512];
-    int vertexId = loadShaderProgram(vertexPath, GL_VERTEX_SHADER);
-    int fragmentId = loadShaderProgram(fragmentPath, GL_FRAGMENT_SHADER);
+
+    std::vector<int> shaderIds;
+    for (const auto& stage : stages)
+        shaderIds.push_back(compileShader(stage.second, stage.first));
 
     /* Create and link shader program */
-    _id = glCreateProgram();
-    glAttachShader(_id, vertexId);
-    glAttachShader(_id, fragmentId);
+    for (int shaderId : shaderIds)
+        glAttachShader(_id, shaderId);
+
+    if (retrievable)
+        glProgramParameteri(_id, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+
     glLinkProgram(_id);
 
     /* Check linking errors */
@@ -28,11 +128,13 @@ Shader::Shader(const char* vertexPath, const char* fragmentPath)
     }
 
     /* Shaders are linked, therefore no longer necessary, delete them */
-    glDeleteShader(vertexId);
-    glDeleteShader(fragmentId);
+    for (int shaderId : shaderIds) {
+        glDetachShader(_id, shaderId);
+        glDeleteShader(shaderId);
+    }
 }
 
-int Shader::loadShaderProgram(const char* path, GLenum type)
+std::string Shader::readShaderSource(const char* path)
 {
     std::string shaderCode;
     std::ifstream shaderFile;
@@ -59,6 +161,11 @@ int Shader::loadShaderProgram(const char* path, GLenum type)
         std::exit(1);
     }
 
+    return shaderCode;
+}
+
+int Shader::compileShader(const std::string& shaderCode, GLenum type)
+{
     const char* shaderCodeCStr = shaderCode.c_str();
 
     unsigned int shaderId;
@@ -87,6 +194,11 @@ void Shader::handleErrors()
 {
 }
 
+void Shader::binaryCacheFolder(const std::string& folder)
+{
+    _binaryCacheFolder = folder;
+}
+
 void Shader::use()
 {
     glUseProgram(this->_id);
@@ -97,62 +209,128 @@ unsigned int Shader::id() const
     return _id;
 }
 
+int Shader::uniformLocation(const std::string& name) const
+{
+    auto it = _uniformLocations.find(name);
+    return it != _uniformLocations.end() ? it->second : -1;
+}
+
 void Shader::setBool(const std::string& name, bool value) const
 {
-    glUniform1i(glGetUniformLocation(_id, name.c_str()), (int)value);
+    setBool(uniformLocation(name), value);
 }
 
 void Shader::setInt(const std::string& name, int value) const
 {
-    glUniform1i(glGetUniformLocation(_id, name.c_str()), value);
+    setInt(uniformLocation(name), value);
+}
+
+void Shader::setUint(const std::string& name, unsigned value) const
+{
+    setUint(uniformLocation(name), value);
 }
 
 void Shader::setFloat(const std::string& name, float value) const
 {
-    glUniform1f(glGetUniformLocation(_id, name.c_str()), value);
+    setFloat(uniformLocation(name), value);
 }
 
 void Shader::setVec2(const std::string& name, const glm::vec2& value) const
 {
-    glUniform2fv(glGetUniformLocation(_id, name.c_str()), 1, &value[0]);
+    setVec2(uniformLocation(name), value);
 }
 
 void Shader::setVec2(const std::string& name, float x, float y) const
 {
-    glUniform2f(glGetUniformLocation(_id, name.c_str()), x, y);
+    setVec2(uniformLocation(name), glm::vec2(x, y));
 }
 
 void Shader::setVec3(const std::string& name, const glm::vec3& value) const
 {
-    glUniform3fv(glGetUniformLocation(_id, name.c_str()), 1, &value[0]);
+    setVec3(uniformLocation(name), value);
 }
 
 void Shader::setVec3(const std::string& name, float x, float y, float z) const
 {
-    glUniform3f(glGetUniformLocation(_id, name.c_str()), x, y, z);
+    setVec3(uniformLocation(name), glm::vec3(x, y, z));
 }
 
 void Shader::setVec4(const std::string& name, const glm::vec4& value) const
 {
-    glUniform4fv(glGetUniformLocation(_id, name.c_str()), 1, &value[0]);
+    setVec4(uniformLocation(name), value);
 }
 
 void Shader::setVec4(const std::string& name, float x, float y, float z, float w) const
 {
-    glUniform4f(glGetUniformLocation(_id, name.c_str()), x, y, z, w);
+    setVec4(uniformLocation(name), glm::vec4(x, y, z, w));
 }
 
 void Shader::setMat2(const std::string& name, const glm::mat2& mat) const
 {
-    glUniformMatrix2fv(glGetUniformLocation(_id, name.c_str()), 1, GL_FALSE, &mat[0][0]);
+    setMat2(uniformLocation(name), mat);
 }
 
 void Shader::setMat3(const std::string& name, const glm::mat3& mat) const
 {
-    glUniformMatrix3fv(glGetUniformLocation(_id, name.c_str()), 1, GL_FALSE, &mat[0][0]);
+    setMat3(uniformLocation(name), mat);
 }
 
 void Shader::setMat4(const std::string& name, const glm::mat4& mat) const
 {
-    glUniformMatrix4fv(glGetUniformLocation(_id, name.c_str()), 1, GL_FALSE, &mat[0][0]);
+    setMat4(uniformLocation(name), mat);
+}
+
+void Shader::setBool(int location, bool value) const
+{
+    glUniform1i(location, (int)value);
+}
+
+void Shader::setInt(int location, int value) const
+{
+    glUniform1i(location, value);
+}
+
+void Shader::setUint(int location, unsigned value) const
+{
+    glUniform1ui(location, value);
+}
+
+void Shader::setFloat(int location, float value) const
+{
+    glUniform1f(location, value);
+}
+
+void Shader::setVec2(int location, const glm::vec2& value) const
+{
+    glUniform2fv(location, 1, &value[0]);
+}
+
+void Shader::setVec2Array(int location, const glm::vec2* values, unsigned count) const
+{
+    glUniform2fv(location, count, &values[0][0]);
+}
+
+void Shader::setVec3(int location, const glm::vec3& value) const
+{
+    glUniform3fv(location, 1, &value[0]);
+}
+
+void Shader::setVec4(int location, const glm::vec4& value) const
+{
+    glUniform4fv(location, 1, &value[0]);
+}
+
+void Shader::setMat2(int location, const glm::mat2& mat) const
+{
+    glUniformMatrix2fv(location, 1, GL_FALSE, &mat[0][0]);
+}
+
+void Shader::setMat3(int location, const glm::mat3& mat) const
+{
+    glUniformMatrix3fv(location, 1, GL_FALSE, &mat[0][0]);
+}
+
+void Shader::setMat4(int location, const glm::mat4& mat) const
+{
+    glUniformMatrix4fv(location, 1, GL_FALSE, &mat[0][0]);
 }
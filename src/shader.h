@@ -9,17 +9,39 @@
 #include <iostream>
 #include <sstream>
 #include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
 
 /* The basic structure of this class is based on the Shader class from
- * learnopengl.com. */
+ * learnopengl.com. The locations of all active uniforms are looked up once
+ * after linking. The setters taking a location skip the lookup entirely and
+ * are meant for uniforms set per draw call. */
 class Shader {
 public:
     Shader();
     Shader(const char* vertexPath, const char* fragmentPath);
+
+    /* With tessellation control and evaluation shaders, needs OpenGL 4.0 */
+    Shader(const char* vertexPath, const char* tessControlPath, const char* tessEvaluationPath, const char* fragmentPath);
+
+    /* Compute shader only, needs OpenGL 4.3 */
+    explicit Shader(const char* computePath);
+
+    /* Folder of the program binary cache (see ShaderCache) used by all
+     * shaders created afterwards, empty to always compile from source */
+    static void binaryCacheFolder(const std::string& folder);
+
     void use();
     unsigned int id() const;
+
+    /* Location of an active uniform (array elements as "name[i]"), -1 if
+     * the uniform is not used by the program, setting it is then a no-op */
+    int uniformLocation(const std::string& name) const;
+
     void setBool(const std::string& name, bool value) const;
     void setInt(const std::string& name, int value) const;
+    void setUint(const std::string& name, unsigned value) const;
     void setFloat(const std::string& name, float value) const;
     void setVec2(const std::string& name, const glm::vec2& value) const;
     void setVec2(const std::string& name, float x, float y) const;
@@ -31,10 +53,30 @@ public:
     void setMat3(const std::string& name, const glm::mat3& mat) const;
     void setMat4(const std::string& name, const glm::mat4& mat) const;
 
+    void setBool(int location, bool value) const;
+    void setInt(int location, int value) const;
+    void setUint(int location, unsigned value) const;
+    void setFloat(int location, float value) const;
+    void setVec2(int location, const glm::vec2& value) const;
+    void setVec2Array(int location, const glm::vec2* values, unsigned count) const;
+    void setVec3(int location, const glm::vec3& value) const;
+    void setVec4(int location, const glm::vec4& value) const;
+    void setMat2(int location, const glm::mat2& mat) const;
+    void setMat3(int location, const glm::mat3& mat) const;
+    void setMat4(int location, const glm::mat4& mat) const;
+
 private:
     unsigned int _id;
+    std::unordered_map<std::string, int> _uniformLocations;
+
+    static std::string _binaryCacheFolder;
+
     void handleErrors();
-    int loadShaderProgram(const char* path, GLenum type);
+    void reflectUniforms();
+    void load(const std::vector<std::pair<GLenum, const char*>>& stages);
+    void linkProgram(const std::vector<std::pair<GLenum, std::string>>& stages, bool retrievable);
+    std::string readShaderSource(const char* path);
+    int compileShader(const std::string& shaderCode, GLenum type);
 };
 
 #endif // SHADER_H
@@ -0,0 +1,156 @@
+#include "shadercache.h"
+
+#include <GL/glew.h>
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+#include <vector>
+
+namespace {
+
+struct Header {
+    char magic[8];
+    uint32_t version;
+    uint32_t binaryFormat;
+    uint32_t binaryLength;
+    uint32_t reserved;
+
+    ShaderCache::Key key;
+};
+
+const uint64_t HASH_SEED = 0xcbf29ce484222325ull;
+
+/* FNV-1a */
+uint64_t hashString(const std::string& value, uint64_t hash = HASH_SEED)
+{
+    for (unsigned char c : value)
+        hash = (hash ^ c) * 0x100000001b3ull;
+
+    /* Separates consecutive strings, so that "ab" + "c" and "a" + "bc" differ */
+    return (hash ^ 0xff) * 0x100000001b3ull;
+}
+
+std::string glString(GLenum name)
+{
+    const GLubyte* value = glGetString(name);
+    return value ? (const char*)value : "";
+}
+
+bool formatSupported(GLenum format)
+{
+    int nFormats = 0;
+    glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &nFormats);
+
+    std::vector<int> formats(std::max(nFormats, 1));
+    glGetIntegerv(GL_PROGRAM_BINARY_FORMATS, formats.data());
+
+    return std::find(formats.begin(), formats.begin() + nFormats, (int)format) != formats.begin() + nFormats;
+}
+
+}
+
+bool ShaderCache::supported()
+{
+    if (!GLEW_VERSION_4_1 && !GLEW_ARB_get_program_binary)
+        return false;
+
+    int nFormats = 0;
+    glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &nFormats);
+    return nFormats > 0;
+}
+
+ShaderCache::Key ShaderCache::key(const std::vector<std::pair<unsigned, std::string>>& stages)
+{
+    /* The same source may be attached as different stages */
+    Key key;
+    key.sourceHash = HASH_SEED;
+    for (const auto& stage : stages)
+        key.sourceHash = hashString(stage.second, hashString(std::to_string(stage.first), key.sourceHash));
+
+    key.driverHash = hashString(glString(GL_VERSION), hashString(glString(GL_RENDERER), hashString(glString(GL_VENDOR))));
+    return key;
+}
+
+std::string ShaderCache::fileName(const std::string& folder, const Key& key)
+{
+    std::ostringstream name;
+    name << folder << "/shader-" << std::hex << std::setw(16) << std::setfill('0') << key.sourceHash << ".atlods";
+
+    return name.str();
+}
+
+bool ShaderCache::load(const std::string& fileName, const Key& key, unsigned program)
+{
+    std::ifstream file(fileName, std::ios::binary);
+
+    if (!file.is_open())
+        return false;
+
+    Header header;
+    file.read(reinterpret_cast<char*>(&header), sizeof(Header));
+
+    if (!file.good()
+        || std::memcmp(header.magic, MAGIC, sizeof(MAGIC)) != 0
+        || header.version != VERSION
+        || std::memcmp(&header.key, &key, sizeof(Key)) != 0
+        || header.binaryLength == 0)
+        return false;
+
+    /* An unknown format would raise an OpenGL error instead of just failing */
+    if (!formatSupported(header.binaryFormat))
+        return false;
+
+    std::vector<char> binary(header.binaryLength);
+    file.read(binary.data(), binary.size());
+    if (!file.good())
+        return false;
+
+    glProgramBinary(program, header.binaryFormat, binary.data(), binary.size());
+
+    int success;
+    glGetProgramiv(program, GL_LINK_STATUS, &success);
+    return success;
+}
+
+bool ShaderCache::save(const std::string& fileName, const Key& key, unsigned program)
+{
+    int length = 0;
+    glGetProgramiv(program, GL_PROGRAM_BINARY_LENGTH, &length);
+    if (length <= 0)
+        return false;
+
+    std::vector<char> binary(length);
+    GLenum format;
+    glGetProgramBinary(program, length, &length, &format, binary.data());
+
+    /* Write to a temporary file first, so that an interrupted write never
+     * leaves a partial cache file behind */
+    std::string tempFileName = fileName + ".tmp";
+
+    {
+        std::ofstream file(tempFileName, std::ios::binary);
+
+        if (!file.is_open())
+            return false;
+
+        Header header = {};
+        std::memcpy(header.magic, MAGIC, sizeof(MAGIC));
+        header.version = VERSION;
+        header.binaryFormat = format;
+        header.binaryLength = length;
+        header.key = key;
+
+        file.write(reinterpret_cast<const char*>(&header), sizeof(Header));
+        file.write(binary.data(), length);
+
+        if (!file.good())
+            return false;
+    }
+
+    std::remove(fileName.c_str());
+    return std::rename(tempFileName.c_str(), fileName.c_str()) == 0;
+}
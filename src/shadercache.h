@@ -0,0 +1,51 @@
+#ifndef SHADERCACHE_H
+#define SHADERCACHE_H
+
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+/* On-disk cache of linked shader programs in the driver's binary format
+ * (glGetProgramBinary), so that relaunches skip compiling and linking.
+ *
+ * A program binary depends on its sources and on the driver, so the key
+ * consists of a hash of the types and sources of all stages and a hash of the
+ * vendor, renderer and version strings. The file name only depends on the
+ * sources, a file written by a different driver is stale and rewritten.
+ * Drivers may also reject a binary whose key matches (e.g. after an update
+ * that kept the version string), the program is then compiled from source
+ * as usual. */
+namespace ShaderCache {
+
+const char MAGIC[8] = { 'A', 'T', 'L', 'O', 'D', 'S', '\0', '\0' };
+const uint32_t VERSION = 1;
+
+struct Key {
+    uint64_t sourceHash;
+    uint64_t driverHash;
+};
+
+static_assert(sizeof(Key) == 16, "Shader cache key must be 16 bytes");
+
+/* Whether the current context can retrieve and load program binaries */
+bool supported();
+
+/* Key of the program with the given stage types (e.g. GL_VERTEX_SHADER)
+ * and sources (in the order they are attached) for the current context */
+Key key(const std::vector<std::pair<unsigned, std::string>>& stages);
+
+/* Returns the cache file name for the given key inside the given folder */
+std::string fileName(const std::string& folder, const Key& key);
+
+/* Loads the program binary from the given cache file into the given program.
+ * Returns false if the file does not exist, is invalid, was written for a
+ * different key or is rejected by the driver, the program must then be
+ * linked from source. */
+bool load(const std::string& fileName, const Key& key, unsigned program);
+
+/* The program must have been linked with GL_PROGRAM_BINARY_RETRIEVABLE_HINT */
+bool save(const std::string& fileName, const Key& key, unsigned program);
+}
+
+#endif // SHADERCACHE_H
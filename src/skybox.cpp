@@ -51,7 +51,7 @@ void Skybox::loadTexture(const std::string& path)
 
 }
 
-Shader Skybox::shader() {
+Shader& Skybox::shader() {
     return _shader;
 }
 
@@ -14,7 +14,7 @@ public:
     void loadBuffers();
     void render();
     void unloadBuffers();
-    Shader shader();
+    Shader& shader();
 
 private:
     std::vector<unsigned> _textureFaces;
@@ -68,6 +68,26 @@ float Terrain::yScale()
     return _yScale;
 }
 
+Heightmap& Terrain::heightmap()
+{
+    return _heightmap;
+}
+
+bool Terrain::hasTexture()
+{
+    return _hasTexture;
+}
+
+unsigned Terrain::visibleBlocks()
+{
+    return _visibleBlocks;
+}
+
+unsigned Terrain::drawCalls()
+{
+    return _drawCalls;
+}
+
 void Terrain::yScale(float yScale)
 {
     _yScale = yScale;
@@ -1,6 +1,7 @@
 #ifndef TERRAIN_H
 #define TERRAIN_H
 
+#include "atlodutil.h"
 #include "camera.h"
 #include "heightmap.h"
 #include "shader.h"
@@ -10,9 +11,6 @@
 
 #include <string>
 
-/* For primitive restarts when creating index buffers */
-const GLuint RESTART_INDEX = std::numeric_limits<GLuint>::max();
-
 class Terrain {
 
 public:
@@ -20,7 +18,7 @@ public:
     virtual ~Terrain() = 0;
     virtual void loadBuffers() = 0;
     virtual void unloadBuffers() = 0;
-    virtual void render(Camera camera) = 0;
+    virtual void render(Camera& camera) = 0;
 
     void loadTexture(const std::string& fileName);
     void unloadTexture();
@@ -34,6 +32,11 @@ public:
     float yScale();
     bool hasTexture();
 
+    /* Statistics of the last render() call, visible blocks are the blocks,
+     * nodes or patches selected for drawing */
+    unsigned visibleBlocks();
+    unsigned drawCalls();
+
     /* Setters */
     void yScale(float yScale);
 
@@ -52,6 +55,8 @@ protected:
     float _yScale;
 
     bool _hasTexture = false;
+
+    unsigned _visibleBlocks = 0, _drawCalls = 0;
 };
 
 #endif // TERRAIN_H
@@ -0,0 +1,44 @@
+/* ATLOD heightmap converter
+ *
+ * Converts a 16-bit grayscale PNG heightmap into the native ATLOD
+ * heightmap format (.atlodh), which can be memory-mapped directly on
+ * startup instead of being decoded.
+ *
+ * Example usage:
+ * ./atlod_convert ../data/heightmaps/6k-x-6k-heightmap.png ../data/heightmaps/6k-x-6k-heightmap.atlodh
+ */
+#include "../heightmapfile.h"
+
+#define STB_IMAGE_IMPLEMENTATION
+#include "../stb_image.h"
+
+#include <iostream>
+
+int main(int argc, char** argv)
+{
+    if (argc != 3) {
+        std::cerr << "Usage: atlod_convert <input.png> <output.atlodh>" << std::endl;
+        return 1;
+    }
+
+    int width, height, nrChannels;
+    unsigned short* data = stbi_load_16(argv[1], &width, &height, &nrChannels, STBI_grey);
+
+    if (!data) {
+        std::cerr << "Failed to load heightmap " << argv[1] << std::endl;
+        return 1;
+    }
+
+    std::cout << "Loaded heightmap image of size " << width << " x " << height << std::endl;
+
+    bool written = HeightmapFile::write(argv[2], data, width, height);
+    stbi_image_free(data);
+
+    if (!written) {
+        std::cerr << "Failed to write heightmap " << argv[2] << std::endl;
+        return 1;
+    }
+
+    std::cout << "Wrote " << argv[2] << std::endl;
+    return 0;
+}
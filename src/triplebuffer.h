@@ -0,0 +1,56 @@
+#ifndef TRIPLEBUFFER_H
+#define TRIPLEBUFFER_H
+
+#include <atomic>
+
+/* Lock-free hand-off of values from a single writer thread to a single
+ * reader thread. The writer fills the back slot and publishes it by
+ * swapping it with the middle slot, the reader takes the middle slot by
+ * swapping it with its front slot. Neither side ever waits for the other,
+ * the reader always gets the most recently published value and a value
+ * that was never read is overwritten by the next one.
+ *
+ * The slots are reused, so values containing vectors keep their capacity
+ * and the hand-off does not allocate. */
+template <typename T>
+class TripleBuffer {
+public:
+    /* Slot being written, only to be used by the writer */
+    T& back()
+    {
+        return _slots[_back];
+    }
+
+    /* Makes the back slot available to the reader */
+    void publish()
+    {
+        _back = _middle.exchange(_back | FRESH, std::memory_order_acq_rel) & INDEX;
+    }
+
+    /* Takes the most recently published slot if there is one that was not
+     * taken yet, returns whether front() changed */
+    bool update()
+    {
+        if ((_middle.load(std::memory_order_relaxed) & FRESH) == 0)
+            return false;
+
+        _front = _middle.exchange(_front, std::memory_order_acq_rel) & INDEX;
+        return true;
+    }
+
+    /* Slot last taken by update(), only to be used by the reader */
+    T& front()
+    {
+        return _slots[_front];
+    }
+
+private:
+    static const unsigned INDEX = 3;
+    static const unsigned FRESH = 4;
+
+    T _slots[3];
+    unsigned _back = 0, _front = 1;
+    std::atomic<unsigned> _middle { 2 };
+};
+
+#endif // TRIPLEBUFFER_H
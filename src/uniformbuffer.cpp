@@ -0,0 +1,29 @@
+#include "uniformbuffer.h"
+#include "atlodutil.h"
+
+void UniformBuffer::loadBuffer(unsigned size, UniformBlockBinding binding)
+{
+    _size = size;
+
+    glGenBuffers(1, &_ubo);
+    glBindBuffer(GL_UNIFORM_BUFFER, _ubo);
+    glBufferData(GL_UNIFORM_BUFFER, size, NULL, GL_DYNAMIC_DRAW);
+    glBindBufferBase(GL_UNIFORM_BUFFER, binding, _ubo);
+
+    AtlodUtil::checkGlError("Uniform buffer creation failed");
+}
+
+void UniformBuffer::unloadBuffer()
+{
+    if (_ubo == 0)
+        return;
+
+    glDeleteBuffers(1, &_ubo);
+    _ubo = 0;
+}
+
+void UniformBuffer::update(const void* data)
+{
+    glBindBuffer(GL_UNIFORM_BUFFER, _ubo);
+    glBufferSubData(GL_UNIFORM_BUFFER, 0, _size, data);
+}
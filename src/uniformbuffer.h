@@ -0,0 +1,53 @@
+#ifndef UNIFORMBUFFER_H
+#define UNIFORMBUFFER_H
+
+#include <GL/glew.h>
+#include <glm/glm.hpp>
+
+/* Binding points of the uniform blocks shared by several programs, every
+ * Shader binds the blocks it uses to them after linking */
+enum UniformBlockBinding {
+    FRAME_UNIFORMS_BINDING,
+    N_UNIFORM_BLOCK_BINDINGS
+};
+
+/* Names of the blocks in the GLSL sources */
+const char* const UNIFORM_BLOCK_NAMES[N_UNIFORM_BLOCK_BINDINGS] = { "FrameUniforms" };
+
+/* Per-frame state of the terrain shaders, mirrors the std140 FrameUniforms
+ * block. Only mat4 and vec4 members, which need no padding in std140. */
+struct FrameUniforms {
+    glm::mat4 projection;
+    glm::mat4 view;
+    glm::mat4 model;
+    glm::vec4 cameraPosition; /* w unused */
+    glm::vec4 lightDirection; /* w unused */
+    glm::vec4 skyColor; /* w unused */
+    glm::vec4 terrainColor; /* w unused */
+    glm::vec4 renderSettings; /* Dark mode, wireframe, fog (0 or 1), fog density */
+};
+
+static_assert(sizeof(FrameUniforms) == 3 * 64 + 5 * 16, "FrameUniforms must match the std140 layout");
+
+/* A uniform buffer object bound to a fixed binding point, whose contents are
+ * replaced at once, e.g. once per frame */
+class UniformBuffer {
+public:
+    void loadBuffer(unsigned size, UniformBlockBinding binding);
+    void unloadBuffer();
+
+    /* Replaces the contents of the buffer, data must be of the loaded size */
+    void update(const void* data);
+
+    template <typename T>
+    void update(const T& data)
+    {
+        update((const void*)&data);
+    }
+
+private:
+    unsigned _ubo = 0;
+    unsigned _size = 0;
+};
+
+#endif // UNIFORMBUFFER_H